@@ -0,0 +1,152 @@
+/*
+ * bvh_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Benchmark for the scene BVH. Builds the tree over randomly
+ *      placed boxes and times building, refitting after a fraction
+ *      of the objects moved, and frustum/ray/nearest queries.
+ *
+ *      bvh-benchmark [object counts...]    // defaults to 10k 100k 1M
+ */
+
+#include "BVH.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// boxes of varying size scattered through a cube that grows with the object count
+std::vector<AABB> randomBoxes(int count, float worldSize, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> size(0.25f, 2.0f);
+
+    std::vector<AABB> boxes(count);
+    for (AABB& box : boxes) {
+        glm::vec3 center(position(rng), position(rng), position(rng));
+        glm::vec3 half(size(rng) * 0.5f);
+        box = AABB(center - half, center + half);
+    }
+    return boxes;
+}
+
+void runBenchmark(int count) {
+    std::mt19937 rng(1234);
+    float worldSize = std::cbrt((float)count) * 4.0f;
+    std::vector<AABB> boxes = randomBoxes(count, worldSize, rng);
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    BVH bvh;
+
+    Clock::time_point start = Clock::now();
+    bvh.Build(boxes, 1);
+    double buildSerial = millisecondsSince(start);
+
+    start = Clock::now();
+    bvh.Build(boxes, threads);
+    double buildParallel = millisecondsSince(start);
+
+    // move 1% of the objects by a small amount and refit
+    std::uniform_int_distribution<int> pick(0, count - 1);
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+    int moved = std::max(1, count / 100);
+    start = Clock::now();
+    for (int i = 0; i < moved; i++) {
+        int id = pick(rng);
+        glm::vec3 offset(jitter(rng), jitter(rng), jitter(rng));
+        const AABB& box = bvh.GetObjectBounds(id);
+        bvh.UpdateObject(id, AABB(box.min + offset, box.max + offset));
+    }
+    bvh.Refit();
+    double refit = millisecondsSince(start);
+
+    // frustums looking from random points in random directions
+    const int frustumQueries = 100;
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, worldSize);
+    std::vector<Frustum> frustums;
+    for (int i = 0; i < frustumQueries; i++) {
+        glm::vec3 eye(position(rng), position(rng), position(rng));
+        glm::vec3 target(position(rng), position(rng), position(rng));
+        frustums.emplace_back(projection * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    std::vector<int> visible;
+    size_t totalVisible = 0;
+    start = Clock::now();
+    for (const Frustum& frustum : frustums) {
+        visible.clear();
+        bvh.QueryFrustum(frustum, visible);
+        totalVisible += visible.size();
+    }
+    double frustumTime = millisecondsSince(start) / frustumQueries;
+
+    // brute force reference for the same frustums
+    size_t bruteVisible = 0;
+    start = Clock::now();
+    for (const Frustum& frustum : frustums) {
+        for (int id = 0; id < count; id++) {
+            if (frustum.Intersects(bvh.GetObjectBounds(id)))
+                bruteVisible++;
+        }
+    }
+    double bruteTime = millisecondsSince(start) / frustumQueries;
+
+    const int rayQueries = 10000;
+    int rayHits = 0;
+    start = Clock::now();
+    for (int i = 0; i < rayQueries; i++) {
+        glm::vec3 origin(position(rng), position(rng), position(rng));
+        glm::vec3 direction(jitter(rng), jitter(rng), jitter(rng));
+        float distance;
+        if (bvh.Raycast(Ray(origin, direction + glm::vec3(0.0f, 0.0f, 0.01f)), distance) != -1)
+            rayHits++;
+    }
+    double rayTime = millisecondsSince(start) * 1000.0 / rayQueries;
+
+    const int nearestQueries = 10000;
+    start = Clock::now();
+    for (int i = 0; i < nearestQueries; i++) {
+        float distance;
+        bvh.Nearest(glm::vec3(position(rng), position(rng), position(rng)), distance);
+    }
+    double nearestTime = millisecondsSince(start) * 1000.0 / nearestQueries;
+
+    printf("%9d | %9.2f %9.2f (%2u thr) | %8.3f (%d moved) | %8.3f vs %8.3f brute%s | %7.2f us (%d%% hit) | %7.2f us | %d nodes\n",
+            count, buildSerial, buildParallel, threads, refit, moved,
+            frustumTime, bruteTime, totalVisible == bruteVisible ? "" : " MISMATCH",
+            rayTime, rayHits * 100 / rayQueries, nearestTime, bvh.GetNodeCount());
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++)
+        counts.push_back(std::atoi(argv[i]));
+    if (counts.empty())
+        counts = { 10000, 100000, 1000000 };
+
+    printf("  objects |  build ms  serial / parallel | refit ms          | frustum ms (per query)            | ray (per query)     | nearest    |\n");
+    for (int count : counts) {
+        if (count > 0)
+            runBenchmark(count);
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*
+ * matrix_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Benchmark for the SIMD matrix kernels. Times view-projection
+ *      times every model matrix (the MVP of every instance), parent
+ *      times local matrix pairs and bounding box transforms, plain glm
+ *      loops against MatrixBatch, and checks the results agree. The
+ *      array kernels only live here, the scene update multiplies every
+ *      object by a different parent.
+ *
+ *      matrix-benchmark [matrix counts...]    // defaults to 10k 100k 1M
+ */
+
+#include "MatrixBatch.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// every timing is the best of this many runs, the first run also warms the caches
+const int REPEATS = 5;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename Function>
+double bestOf(Function function) {
+    double best = 1e30;
+    for (int i = 0; i < REPEATS; i++) {
+        Clock::time_point start = Clock::now();
+        function();
+        best = std::min(best, millisecondsSince(start));
+    }
+    return best;
+}
+
+// largest difference relative to the magnitude of the values, 0 when the bits match
+float largestError(const float* a, const float* b, size_t count) {
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        error = std::max(error, std::fabs(a[i] - b[i]) / std::max(1.0f, std::fabs(a[i])));
+    return error;
+}
+
+// "scalar", "SSE", "AVX" or "AVX+FMA", whatever the kernels were compiled for
+const char* matrixKernelPath() {
+#if defined(RENDERER_SIMD_AVX) && defined(__FMA__)
+    return "AVX+FMA";
+#elif defined(RENDERER_SIMD_AVX)
+    return "AVX";
+#elif defined(RENDERER_SIMD_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
+
+#ifdef RENDERER_SIMD_AVX
+// two columns of the product per 256-bit register: both halves hold "left" and each half
+// multiplies it by one column of "right"
+inline __m256 multiplyColumnPair(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 b) {
+#ifdef __FMA__
+    __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+    r = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, 0x55), r);
+    r = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, 0xAA), r);
+    return _mm256_fmadd_ps(a3, _mm256_permute_ps(b, 0xFF), r);
+#else
+    __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(b, 0x55)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(b, 0xAA)));
+    return _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(b, 0xFF)));
+#endif
+}
+#endif
+
+// out[i] = left * right[i], e.g. view-projection times every model matrix
+void multiplyMatricesScalar(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = left * right[i];
+}
+
+void multiplyMatrices(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, size_t count) {
+#if defined(RENDERER_SIMD_AVX)
+    __m256 a0 = _mm256_broadcast_ps((const __m128*)&left[0][0]);
+    __m256 a1 = _mm256_broadcast_ps((const __m128*)&left[1][0]);
+    __m256 a2 = _mm256_broadcast_ps((const __m128*)&left[2][0]);
+    __m256 a3 = _mm256_broadcast_ps((const __m128*)&left[3][0]);
+    for (size_t i = 0; i < count; i++) {
+        const float* b = &right[i][0][0];
+        __m256 low = multiplyColumnPair(a0, a1, a2, a3, _mm256_loadu_ps(b));
+        __m256 high = multiplyColumnPair(a0, a1, a2, a3, _mm256_loadu_ps(b + 8));
+        float* r = &out[i][0][0];
+        _mm256_storeu_ps(r, low);
+        _mm256_storeu_ps(r + 8, high);
+    }
+#elif defined(RENDERER_SIMD_SSE)
+    for (size_t i = 0; i < count; i++)
+        MultiplyMatrix(left, right[i], out[i]);
+#else
+    multiplyMatricesScalar(left, right, out, count);
+#endif
+}
+
+// out[i] = boxes[i] transformed by matrices[i]
+void transformBounds(const glm::mat4* matrices, const AABB* boxes, AABB* out, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = TransformBox(matrices[i], boxes[i]);
+}
+
+void transformBoundsScalar(const glm::mat4* matrices, const AABB* boxes, AABB* out, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        out[i] = boxes[i].Transformed(matrices[i]);
+}
+
+void printRow(const char* name, double scalarMs, double simdMs, float error) {
+    printf("  %-26s %10.3f %10.3f %8.2fx   max error %.2g\n", name, scalarMs, simdMs, scalarMs / simdMs, error);
+}
+
+void runBenchmark(int count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.5f, 2.0f);
+
+    // transforms like the scene's: translation * rotation * scale
+    std::vector<glm::mat4> models(count);
+    std::vector<glm::mat4> locals(count);
+    std::vector<AABB> boxes(count);
+    for (int i = 0; i < count; i++) {
+        glm::quat rotation = glm::normalize(glm::quat(unit(rng), unit(rng), unit(rng), unit(rng)));
+        models[i] = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(position(rng), position(rng), position(rng)))
+                * glm::mat4_cast(rotation), glm::vec3(size(rng)));
+        locals[i] = glm::translate(glm::mat4(1.0f), glm::vec3(unit(rng), unit(rng), unit(rng))) * glm::mat4_cast(rotation);
+        glm::vec3 half(size(rng) * 0.5f);
+        boxes[i] = AABB(-half, half);
+    }
+    glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f)
+            * glm::lookAt(glm::vec3(0.0f, 20.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<glm::mat4> scalarMatrices(count), simdMatrices(count);
+    std::vector<AABB> scalarBoxes(count), simdBoxes(count);
+
+    printf("%d matrices\n", count);
+    printf("  %-26s %10s %10s %9s\n", "", "scalar ms", "SIMD ms", "speedup");
+
+    double scalarMs = bestOf([&] { multiplyMatricesScalar(viewProjection, models.data(), scalarMatrices.data(), count); });
+    double simdMs = bestOf([&] { multiplyMatrices(viewProjection, models.data(), simdMatrices.data(), count); });
+    printRow("view-projection * model", scalarMs, simdMs,
+            largestError(&scalarMatrices[0][0][0], &simdMatrices[0][0][0], count * 16));
+
+    // parent * local like a hierarchy update, each parent a different matrix
+    scalarMs = bestOf([&] {
+        for (int i = 0; i < count; i++)
+            scalarMatrices[i] = models[i] * locals[i];
+    });
+    simdMs = bestOf([&] {
+        for (int i = 0; i < count; i++)
+            MultiplyMatrix(models[i], locals[i], simdMatrices[i]);
+    });
+    printRow("parent * local", scalarMs, simdMs,
+            largestError(&scalarMatrices[0][0][0], &simdMatrices[0][0][0], count * 16));
+
+    scalarMs = bestOf([&] { transformBoundsScalar(models.data(), boxes.data(), scalarBoxes.data(), count); });
+    simdMs = bestOf([&] { transformBounds(models.data(), boxes.data(), simdBoxes.data(), count); });
+    printRow("bounds transform", scalarMs, simdMs,
+            largestError(&scalarBoxes[0].min.x, &simdBoxes[0].min.x, count * 6));
+    printf("\n");
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++) {
+        int count = std::atoi(argv[i]);
+        if (count > 0)
+            counts.push_back(count);
+    }
+    if (counts.empty())
+        counts = { 10000, 100000, 1000000 };
+
+    printf("matrix kernels: %s, best of %d runs\n\n", matrixKernelPath(), REPEATS);
+    for (int count : counts)
+        runBenchmark(count);
+    return 0;
+}
@@ -0,0 +1,754 @@
+/*
+ * render_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Benchmark for the whole renderer. Builds a synthetic scene,
+ *      flies the camera along a fixed path with a fixed timestep
+ *      instead of mouse and keyboard input, and draws a fixed number
+ *      of frames uncapped into an offscreen framebuffer. Every frame
+ *      records CPU time, GPU time (timer queries), the CPU phases,
+ *      draw calls, triangles and heap allocations; the summary goes to
+ *      JSON, the frames to CSV.
+ *
+ *      Given a baseline (the JSON of an earlier run) it compares the
+ *      summary against it and exits with 1 when a metric got worse by
+ *      more than the tolerance, so it can gate merges against the
+ *      committed bench/baseline.json (see the README). --headless uses
+ *      GLFW's null platform with an OSMesa context, no display needed.
+ *      Run it from the repository root, shaders and textures are
+ *      loaded from there.
+ *
+ *      render-benchmark [options]
+ *      --cubes N           objects in the grid, rounded to a square         10000
+ *      --materials M       distinct materials                               1
+ *      --textures K        distinct textures the materials use              1
+ *      --texture-mode MODE separate, array, atlas or bindless               array
+ *                          (see MaterialTextures.h)
+ *      --texture-budget MB streams the material texture mips under this     off
+ *                          budget (see TextureStreamer.h)
+ *      --lights N          moving point lights (see LightClusters.h)        0
+ *      --lighting MODE     off, naive or clustered                          clustered with lights
+ *      --render-path PATH  forward or deferred (see DeferredRenderer.h)     forward
+ *      --shadows           sun with cascaded shadow maps (ShadowCascades.h) off
+ *      --tonemap --bloom --fxaa  post effects (see PostProcess.h)           off
+ *      --post-fragment     bloom as fragment passes instead of compute      compute on GL 4.3
+ *      --particles N       GPU particles (see ParticleSystem.h)             0
+ *      --particles-feedback  simulate them with transform feedback          compute on GL 4.3
+ *      --voxels            chunked voxel terrain (see VoxelWorld.h)         off
+ *      --voxel-edits       dig through it every frame, chunks remesh        off
+ *      --terrain           streamed quadtree terrain (see Terrain.h), the   off
+ *                          flythrough crosses it instead of circling the grid
+ *      --frames F          recorded frames                                  600
+ *      --warmup F          frames drawn before recording                    60
+ *      --timestep S        animation and camera step per frame              1/60
+ *      --replay FILE       camera input recording (see InputRecorder.h)     flythrough
+ *                          to drive the camera instead, it holds still once the recording ends
+ *      --threads T         threads for the CPU frame, 0 = hardware          0
+ *      --gpu-driven --pipelined --stress --no-lod --no-occlusion --headless
+ *      --json FILE         summary                                          render_benchmark.json
+ *      --csv FILE          one row per recorded frame                       off
+ *      --baseline FILE     JSON of an earlier run to compare against        off
+ *      --tolerance PCT     allowed regression in percent                    10
+ */
+
+#include "AllocationCounter.h"
+#include "Camera.h"
+#include "FrameBuffer.h"
+#include "FramePacer.h"
+#include "InputRecorder.h"
+#include "Logger.h"
+#include "graphics.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int WIDTH = 1280;
+const int HEIGHT = 720;
+// frames between issuing a timer query and reading it back, so reading never stalls
+const int QUERY_LATENCY = 4;
+const float GRID_SPACING = 2.0f;        // graphics.cpp lays the grid out 2 units apart
+
+struct Options {
+    int cubes = 10000;
+    int materials = 1;
+    int textures = 1;
+    MaterialTextureMode textureMode = MaterialTextureMode::Array;
+    int textureBudgetKb = 0;        // 0 keeps every mip level
+    int lights = 0;
+    int lighting = -1;              // LightingMode, -1 picks clustered when there are lights
+    RenderPath renderPath = RenderPath::Forward;
+    bool shadows = false;
+    PostSettings post;
+    int particles = 0;
+    bool particleCompute = true;
+    bool voxels = false;
+    bool voxelEdits = false;
+    bool terrain = false;
+    int frames = 600;
+    int warmup = 60;
+    float timestep = 1.0f / 60.0f;
+    int threads = 0;
+    bool gpuDriven = false;
+    bool pipelined = false;
+    bool stress = false;
+    bool lod = true;
+    bool occlusion = true;
+    bool headless = false;
+    std::string jsonPath = "render_benchmark.json";
+    std::string csvPath;
+    std::string baselinePath;
+    std::string replayPath;
+    float tolerance = 10.0f;
+};
+
+struct FrameRecord {
+    float cpuMs = 0.0f;
+    float gpuMs = 0.0f;
+    float updateMs = 0.0f;
+    float cullMs = 0.0f;
+    float sortMs = 0.0f;
+    float submitMs = 0.0f;
+    int drawCalls = 0;
+    int textureBinds = 0;
+    float textureResidentMb = 0.0f;
+    float textureBandwidthMb = 0.0f;
+    float lightMs = 0.0f;
+    int shadowDrawCalls = 0;
+    float shadowGpuMs = 0.0f;
+    float postGpuMs = 0.0f;
+    float particleSimulateMs = 0.0f;
+    float particleRenderMs = 0.0f;
+    float voxelMeshMs = 0.0f;
+    float voxelMeshesPerSecond = 0.0f;
+    float terrainLatencyMs = 0.0f;
+    float terrainResidentMb = 0.0f;
+    int triangles = 0;
+    int visible = 0;
+    int occluded = 0;
+    int allocations = 0;
+};
+
+// one metric of the summary that is compared against the baseline, higher is worse
+struct Metric {
+    const char* key;
+    double value;
+    double slack;       // absolute difference that never counts, for values close to zero
+};
+
+// one setting of the scene, a baseline recorded with a different value can't be compared
+struct SceneSetting {
+    const char* key;
+    int value;
+};
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+bool parseTextureMode(const std::string& name, MaterialTextureMode& outMode) {
+    const MaterialTextureMode modes[] = { MaterialTextureMode::Separate, MaterialTextureMode::Array,
+            MaterialTextureMode::Bindless, MaterialTextureMode::Atlas };
+    for (MaterialTextureMode mode : modes) {
+        std::string modeName = MaterialTextureModeName(mode);
+        std::transform(modeName.begin(), modeName.end(), modeName.begin(), ::tolower);
+        if (name == modeName) {
+            outMode = mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseLighting(const std::string& name, int& outMode) {
+    const LightingMode modes[] = { LightingMode::Off, LightingMode::Naive, LightingMode::Clustered };
+    for (LightingMode mode : modes) {
+        std::string modeName = LightingModeName(mode);
+        std::transform(modeName.begin(), modeName.end(), modeName.begin(), ::tolower);
+        if (name == modeName) {
+            outMode = (int)mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseRenderPath(const std::string& name, RenderPath& outPath) {
+    const RenderPath paths[] = { RenderPath::Forward, RenderPath::Deferred };
+    for (RenderPath path : paths) {
+        std::string pathName = RenderPathName(path);
+        std::transform(pathName.begin(), pathName.end(), pathName.begin(), ::tolower);
+        if (name == pathName) {
+            outPath = path;
+            return true;
+        }
+    }
+    return false;
+}
+
+// the enabled post effects as bits, tonemap 1, bloom 2, FXAA 4
+int postEffects(const PostSettings& post) {
+    return (post.tonemap ? 1 : 0) | (post.bloom ? 2 : 0) | (post.fxaa ? 4 : 0);
+}
+
+bool parseArguments(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool takesValue = true;
+
+        if (argument == "--cubes" && value) options.cubes = std::atoi(value);
+        else if (argument == "--materials" && value) options.materials = std::atoi(value);
+        else if (argument == "--textures" && value) options.textures = std::atoi(value);
+        else if (argument == "--texture-mode" && value) {
+            if (!parseTextureMode(value, options.textureMode)) {
+                fprintf(stderr, "Unknown texture mode \"%s\", use separate, array, atlas or bindless.\n", value);
+                return false;
+            }
+        }
+        else if (argument == "--texture-budget" && value) options.textureBudgetKb = std::max(0, (int)(std::atof(value) * 1024.0));
+        else if (argument == "--lights" && value) options.lights = std::max(0, std::atoi(value));
+        else if (argument == "--lighting" && value) {
+            if (!parseLighting(value, options.lighting)) {
+                fprintf(stderr, "Unknown lighting \"%s\", use off, naive or clustered.\n", value);
+                return false;
+            }
+        }
+        else if (argument == "--render-path" && value) {
+            if (!parseRenderPath(value, options.renderPath)) {
+                fprintf(stderr, "Unknown render path \"%s\", use forward or deferred.\n", value);
+                return false;
+            }
+        }
+        else if (argument == "--particles" && value) options.particles = std::max(0, std::atoi(value));
+        else if (argument == "--frames" && value) options.frames = std::max(1, std::atoi(value));
+        else if (argument == "--warmup" && value) options.warmup = std::max(0, std::atoi(value));
+        else if (argument == "--timestep" && value) options.timestep = (float)std::atof(value);
+        else if (argument == "--threads" && value) options.threads = std::atoi(value);
+        else if (argument == "--json" && value) options.jsonPath = value;
+        else if (argument == "--csv" && value) options.csvPath = value;
+        else if (argument == "--baseline" && value) options.baselinePath = value;
+        else if (argument == "--replay" && value) options.replayPath = value;
+        else if (argument == "--tolerance" && value) options.tolerance = (float)std::atof(value);
+        else {
+            takesValue = false;
+            if (argument == "--gpu-driven") options.gpuDriven = true;
+            else if (argument == "--pipelined") options.pipelined = true;
+            else if (argument == "--shadows") options.shadows = true;
+            else if (argument == "--tonemap") options.post.tonemap = true;
+            else if (argument == "--bloom") options.post.bloom = true;
+            else if (argument == "--fxaa") options.post.fxaa = true;
+            else if (argument == "--post-fragment") options.post.compute = false;
+            else if (argument == "--particles-feedback") options.particleCompute = false;
+            else if (argument == "--voxels") options.voxels = true;
+            else if (argument == "--voxel-edits") options.voxelEdits = true;
+            else if (argument == "--terrain") options.terrain = true;
+            else if (argument == "--stress") options.stress = true;
+            else if (argument == "--no-lod") options.lod = false;
+            else if (argument == "--no-occlusion") options.occlusion = false;
+            else if (argument == "--headless") options.headless = true;
+            else {
+                fprintf(stderr, "Unknown argument \"%s\", see the top of bench/render_benchmark.cpp.\n", argv[i]);
+                return false;
+            }
+        }
+        if (takesValue)
+            i++;
+    }
+    return true;
+}
+
+GLFWwindow* createWindow(bool headless) {
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    if (!glfwInit())
+        return nullptr;
+
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (headless)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+
+    // same order as the application, newest context first
+    const int GL_versions[][2] = { {4, 6}, {4, 5}, {4, 3}, {3, 3} };
+    for (const auto& version : GL_versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "render-benchmark", NULL, NULL);
+        if (window)
+            return window;
+    }
+    return nullptr;
+}
+
+// orbits the middle of the grid, swinging between its edge and close to the centre and
+// bobbing up and down, so culling, LOD and occlusion see near and far views
+void flyCamera(float time, float gridExtent) {
+    float radius = std::max(6.0f, gridExtent * 0.45f) * (0.65f + 0.35f * std::cos(time * 0.23f));
+    float angle = time * 0.35f;
+    float height = 3.0f + 2.0f * std::sin(time * 0.5f);
+
+    glm::vec3 position(std::cos(angle) * radius, height, std::sin(angle) * radius);
+    glm::vec3 target(std::cos(angle + 0.6f) * radius * 0.3f, -1.5f, std::sin(angle + 0.6f) * radius * 0.3f);
+    GlobalCamera::camera.LookAt(position, target);
+}
+
+// a straight run over the terrain with a slow weave, fast enough that tiles keep streaming in
+// ahead and out behind, at a fixed height over the ground
+void flyOverTerrain(float time) {
+    const float SPEED = 80.0f;
+    const float WEAVE = 150.0f;
+    const float WEAVE_RATE = 0.2f;
+
+    glm::vec3 position(time * SPEED, 0.0f, std::sin(time * WEAVE_RATE) * WEAVE);
+    position.y = Terrain::GetHeight(position.x, position.z) + 15.0f;
+    glm::vec3 direction = glm::normalize(glm::vec3(SPEED, 0.0f, std::cos(time * WEAVE_RATE) * WEAVE * WEAVE_RATE));
+    GlobalCamera::camera.LookAt(position, position + direction * 40.0f - glm::vec3(0.0f, 15.0f, 0.0f));
+}
+
+// resident set of this process, 0 where it isn't known
+double residentMegabytes() {
+#ifdef __linux__
+    long pages = 0, resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        fclose(statm);
+    }
+    return resident * 4096.0 / (1024.0 * 1024.0);
+#else
+    return 0.0;
+#endif
+}
+
+FramePacingStats summarize(const std::vector<FrameRecord>& records, float FrameRecord::* field) {
+    std::vector<float> values, scratch;
+    values.reserve(records.size());
+    for (const FrameRecord& record : records)
+        values.push_back(record.*field);
+    return ComputePacingStats(values, scratch);
+}
+
+template <typename T>
+double average(const std::vector<FrameRecord>& records, T FrameRecord::* field) {
+    double total = 0.0;
+    for (const FrameRecord& record : records)
+        total += record.*field;
+    return records.empty() ? 0.0 : total / records.size();
+}
+
+bool writeCsv(const std::string& path, const std::vector<FrameRecord>& records) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "frame,cpu_ms,gpu_ms,update_ms,cull_ms,sort_ms,submit_ms,draw_calls,triangles,visible,occluded,heap_allocations,texture_binds,texture_resident_mb,texture_stream_mb_s,light_ms,shadow_draw_calls,shadow_gpu_ms,post_gpu_ms,particle_sim_ms,particle_render_ms,voxel_mesh_ms,terrain_tile_ms,terrain_resident_mb\n");
+    for (size_t i = 0; i < records.size(); i++) {
+        const FrameRecord& r = records[i];
+        fprintf(file, "%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%d,%d,%d,%d,%d,%.3f,%.3f,%.4f,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f\n", i, r.cpuMs, r.gpuMs, r.updateMs, r.cullMs,
+                r.sortMs, r.submitMs, r.drawCalls, r.triangles, r.visible, r.occluded, r.allocations, r.textureBinds,
+                r.textureResidentMb, r.textureBandwidthMb, r.lightMs, r.shadowDrawCalls, r.shadowGpuMs, r.postGpuMs,
+                r.particleSimulateMs, r.particleRenderMs, r.voxelMeshMs, r.terrainLatencyMs, r.terrainResidentMb);
+    }
+    fclose(file);
+    return true;
+}
+
+// the driver strings may hold anything, same escaping as the application's benchmark report
+void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+// the summary is flat on purpose, the baseline reader only has to find "key": number
+bool writeJson(const std::string& path, const Options& options, const std::vector<Metric>& metrics,
+        const std::vector<FrameRecord>& records, double rssMegabytes) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+
+    const graphics::SceneStats& stats = graphics::GetSceneStats();
+    fprintf(file, "{\n");
+    fprintf(file, "  \"renderer\": ");
+    writeJsonString(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n  \"gl_version\": ");
+    writeJsonString(file, (const char*)glGetString(GL_VERSION));
+    fprintf(file, ",\n");
+    fprintf(file, "  \"cubes\": %d,\n", options.cubes);
+    fprintf(file, "  \"objects\": %d,\n", stats.objects);
+    fprintf(file, "  \"materials\": %d,\n", options.materials);
+    fprintf(file, "  \"textures\": %d,\n", options.textures);
+    fprintf(file, "  \"texture_mode\": %d,\n", (int)graphics::GetTextureMode());
+    fprintf(file, "  \"texture_budget_kb\": %d,\n", options.textureBudgetKb);
+    fprintf(file, "  \"lights\": %d,\n", options.lights);
+    fprintf(file, "  \"lighting\": %d,\n", (int)graphics::GetLighting());
+    fprintf(file, "  \"render_path\": %d,\n", (int)graphics::GetRenderPath());
+    fprintf(file, "  \"gbuffer_bytes_per_pixel\": %d,\n", graphics::GetSceneStats().gBufferBytesPerPixel);
+    fprintf(file, "  \"shadows\": %d,\n", (int)graphics::IsShadows());
+    fprintf(file, "  \"post_effects\": %d,\n", postEffects(options.post));
+    fprintf(file, "  \"post_compute\": %d,\n", (int)graphics::GetSceneStats().post.compute);
+    fprintf(file, "  \"particles\": %d,\n", graphics::GetParticleCount());
+    fprintf(file, "  \"particle_compute\": %d,\n", (int)graphics::GetSceneStats().particles.compute);
+    fprintf(file, "  \"voxels\": %d,\n", (int)graphics::IsVoxelWorld());
+    fprintf(file, "  \"voxel_edits\": %d,\n", (int)graphics::IsVoxelEdits());
+    fprintf(file, "  \"voxel_build_ms\": %.1f,\n", stats.voxels.buildMs);
+    fprintf(file, "  \"terrain\": %d,\n", (int)graphics::IsTerrain());
+    fprintf(file, "  \"terrain_tiles_generated\": %lld,\n", stats.terrain.generatedTiles);
+    fprintf(file, "  \"terrain_tiles_evicted\": %lld,\n", stats.terrain.evictedTiles);
+    fprintf(file, "  \"frames\": %d,\n", (int)records.size());
+    fprintf(file, "  \"timestep\": %.6f,\n", options.timestep);
+    fprintf(file, "  \"threads\": %d,\n", graphics::GetWorkerThreads());
+    fprintf(file, "  \"gpu_driven\": %d,\n", (int)graphics::IsGpuDriven());
+    fprintf(file, "  \"pipelined\": %d,\n", (int)graphics::IsPipelined());
+    fprintf(file, "  \"stress\": %d,\n", (int)options.stress);
+    fprintf(file, "  \"lod\": %d,\n", (int)options.lod);
+    fprintf(file, "  \"occlusion\": %d,\n", (int)options.occlusion);
+    for (const Metric& metric : metrics)
+        fprintf(file, "  \"%s\": %.4f,\n", metric.key, metric.value);
+    fprintf(file, "  \"triangles_avg\": %.1f,\n", average(records, &FrameRecord::triangles));
+    fprintf(file, "  \"visible_avg\": %.1f,\n", average(records, &FrameRecord::visible));
+    fprintf(file, "  \"voxel_meshes_per_s\": %.1f,\n", average(records, &FrameRecord::voxelMeshesPerSecond));
+    fprintf(file, "  \"terrain_tile_ms_max\": %.2f,\n", summarize(records, &FrameRecord::terrainLatencyMs).maxMs);
+    fprintf(file, "  \"rss_mb\": %.1f\n", rssMegabytes);
+    fprintf(file, "}\n");
+    fclose(file);
+    return true;
+}
+
+bool readJsonNumber(const std::string& json, const char* key, double& outValue) {
+    std::string quoted = std::string("\"") + key + "\":";
+    size_t at = json.find(quoted);
+    if (at == std::string::npos)
+        return false;
+    outValue = std::strtod(json.c_str() + at + quoted.size(), nullptr);
+    return true;
+}
+
+// 0 when nothing regressed, 1 on a regression, 2 when the baseline can't be used
+int compareBaseline(const std::string& path, const Options& options, const std::vector<Metric>& metrics) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        fprintf(stderr, "Unable to read baseline %s.\n", path.c_str());
+        return 2;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string json = contents.str();
+
+    // numbers from a different scene say nothing
+    const SceneSetting scene[] = {
+        { "cubes", options.cubes },
+        { "materials", options.materials },
+        { "textures", options.textures },
+        { "texture_mode", (int)graphics::GetTextureMode() },
+        { "texture_budget_kb", options.textureBudgetKb },
+        { "lights", options.lights },
+        { "lighting", (int)graphics::GetLighting() },
+        { "render_path", (int)graphics::GetRenderPath() },
+        { "shadows", (int)graphics::IsShadows() },
+        { "post_effects", postEffects(options.post) },
+        { "post_compute", (int)graphics::GetSceneStats().post.compute },
+        { "particles", graphics::GetParticleCount() },
+        { "particle_compute", (int)graphics::GetSceneStats().particles.compute },
+        { "voxels", (int)graphics::IsVoxelWorld() },
+        { "voxel_edits", (int)graphics::IsVoxelEdits() },
+        { "terrain", (int)graphics::IsTerrain() },
+        { "gpu_driven", (int)graphics::IsGpuDriven() },
+        { "pipelined", (int)graphics::IsPipelined() },
+        { "stress", (int)options.stress },
+        { "lod", (int)options.lod },
+        { "occlusion", (int)options.occlusion },
+        { "threads", graphics::GetWorkerThreads() },
+        { "frames", options.frames },
+    };
+    for (size_t i = 0; i < std::size(scene); i++) {
+        double value;
+        if (!readJsonNumber(json, scene[i].key, value) || (int)value != scene[i].value) {
+            fprintf(stderr, "Baseline %s was recorded with a different \"%s\".\n", path.c_str(), scene[i].key);
+            return 2;
+        }
+    }
+    // the summary writes the timestep with 6 decimals
+    double timestep;
+    if (!readJsonNumber(json, "timestep", timestep) || std::fabs(timestep - options.timestep) > 1.0e-6) {
+        fprintf(stderr, "Baseline %s was recorded with a different \"timestep\".\n", path.c_str());
+        return 2;
+    }
+
+    printf("\n%-24s %12s %12s %9s\n", "metric", "baseline", "current", "change");
+    bool regressed = false;
+    for (const Metric& metric : metrics) {
+        double base;
+        if (!readJsonNumber(json, metric.key, base))
+            continue;
+
+        double limit = base * (1.0 + options.tolerance / 100.0) + metric.slack;
+        bool worse = metric.value > limit;
+        regressed = regressed || worse;
+        double change = base != 0.0 ? (metric.value - base) / base * 100.0 : 0.0;
+        printf("%-24s %12.4f %12.4f %+8.1f%% %s\n", metric.key, base, metric.value, change, worse ? "REGRESSED" : "");
+    }
+    printf("%s (tolerance %.1f%%)\n", regressed ? "Regression against the baseline." : "No regression against the baseline.",
+            options.tolerance);
+    return regressed ? 1 : 0;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options))
+        return 2;
+
+    GLFWwindow* window = createWindow(options.headless);
+    if (!window) {
+        fprintf(stderr, "Unable to create an OpenGL context%s.\n", options.headless ? " (headless needs OSMesa)" : "");
+        return 2;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        fprintf(stderr, "Unable to load OpenGL functions.\n");
+        return 2;
+    }
+    glfwSwapInterval(0);
+    glEnable(GL_DEPTH_TEST);
+
+    FrameBuffer* sceneBuffer = new FrameBuffer(WIDTH, HEIGHT);
+    graphics::Prerender();
+
+    int gridSize = (int)std::lround(std::sqrt((double)std::max(0, options.cubes)));
+    if (options.threads > 0)
+        graphics::SetWorkerThreads(options.threads);
+    graphics::SetStressScene(options.stress);
+    graphics::SetMaterials(options.materials, options.textures);
+    graphics::SetTextureMode(options.textureMode);
+    if (options.textureBudgetKb > 0) {
+        graphics::SetTextureBudget(options.textureBudgetKb * 1024LL);
+        graphics::SetTextureStreaming(true);
+    }
+    graphics::SetCubeGrid(gridSize);
+    graphics::SetLightCount(options.lights);
+    if (options.lighting == -1)
+        options.lighting = (int)(options.lights > 0 ? LightingMode::Clustered : LightingMode::Off);
+    graphics::SetLighting((LightingMode)options.lighting);
+    graphics::SetRenderPath(options.renderPath);
+    graphics::SetShadows(options.shadows);
+    graphics::SetPostSettings(options.post);
+    graphics::SetParticleCompute(options.particleCompute);
+    graphics::SetParticleCount(options.particles);
+    graphics::SetVoxelWorld(options.voxels);
+    graphics::SetVoxelEdits(options.voxelEdits);
+    graphics::SetTerrain(options.terrain);
+    graphics::SetLODEnabled(options.lod);
+    graphics::SetOcclusionCulling(options.occlusion);
+    graphics::SetGpuDriven(options.gpuDriven);
+    graphics::SetPipelined(options.pipelined);
+
+    int totalFrames = options.warmup + options.frames;
+    std::vector<FrameRecord> records(totalFrames);
+    GLuint queries[QUERY_LATENCY];
+    glGenQueries(QUERY_LATENCY, queries);
+
+    if (!options.replayPath.empty() && !GlobalInput::recorder.StartReplay(options.replayPath, GlobalCamera::camera, options.timestep)) {
+        fprintf(stderr, "Unable to read camera input recording %s.\n", options.replayPath.c_str());
+        return 2;
+    }
+
+    float gridExtent = gridSize * GRID_SPACING;
+    for (int frame = 0; frame < totalFrames + QUERY_LATENCY; frame++) {
+        // GPU times arrive QUERY_LATENCY frames late, the last few frames only collect them
+        int finished = frame - QUERY_LATENCY;
+        if (finished >= 0) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[finished % QUERY_LATENCY], GL_QUERY_RESULT, &nanoseconds);
+            records[finished].gpuMs = (float)(nanoseconds / 1.0e6);
+        }
+        if (frame >= totalFrames)
+            continue;
+
+        // one simulation step per frame, the frame draws exactly the simulated state
+        if (options.replayPath.empty() && options.terrain)
+            flyOverTerrain(frame * options.timestep);
+        else if (options.replayPath.empty())
+            flyCamera(frame * options.timestep, gridExtent);
+        else
+            GlobalInput::recorder.Step(GlobalCamera::camera);
+        GlobalCamera::renderCamera = GlobalCamera::camera;
+        graphics::SetAnimationTime((frame + 1) * options.timestep);
+
+        Clock::time_point start = Clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame % QUERY_LATENCY]);
+        sceneBuffer->Bind();
+        glClearColor(0.05f, 0.15f, 0.20f, 1.00f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        graphics::Render();
+        graphics::UpdateOcclusion(sceneBuffer);
+        graphics::ApplyPostProcessing(sceneBuffer);
+        sceneBuffer->Unbind();
+        glEndQuery(GL_TIME_ELAPSED);
+        glfwSwapBuffers(window);
+        graphics::EndFrame();
+
+        const graphics::SceneStats& stats = graphics::GetSceneStats();
+        FrameRecord& record = records[frame];
+        record.cpuMs = (float)millisecondsSince(start);
+        record.updateMs = stats.updateMs;
+        record.cullMs = stats.cullMs;
+        record.sortMs = stats.sortMs;
+        record.submitMs = stats.submitMs;
+        record.drawCalls = stats.drawCalls;
+        record.textureBinds = stats.textureBinds;
+        record.textureResidentMb = (float)(stats.textureResidentBytes / 1048576.0);
+        record.textureBandwidthMb = stats.textureBandwidth / 1048576.0f;
+        record.lightMs = stats.lightMs;
+        record.shadowDrawCalls = stats.shadowDrawCalls;
+        record.shadowGpuMs = stats.shadowGpuMs;
+        record.postGpuMs = stats.post.bloomMs + stats.post.compositeMs + stats.post.fxaaMs;
+        record.particleSimulateMs = stats.particles.simulateMs;
+        record.particleRenderMs = stats.particles.renderMs;
+        record.voxelMeshMs = stats.voxels.meshMs;
+        record.voxelMeshesPerSecond = (float)stats.voxels.meshesPerSecond;
+        record.terrainLatencyMs = stats.terrain.latencyMs;
+        record.terrainResidentMb = (float)(stats.terrain.residentBytes / 1048576.0);
+        record.triangles = stats.triangles;
+        record.visible = stats.visible;
+        record.occluded = stats.occluded;
+        record.allocations = stats.frameAllocations;
+    }
+    glDeleteQueries(QUERY_LATENCY, queries);
+    records.erase(records.begin(), records.begin() + options.warmup);
+
+    FramePacingStats cpu = summarize(records, &FrameRecord::cpuMs);
+    FramePacingStats gpu = summarize(records, &FrameRecord::gpuMs);
+    std::vector<Metric> metrics = {
+        { "cpu_ms_avg", cpu.averageMs, 0.05 },
+        { "cpu_ms_p50", cpu.medianMs, 0.05 },
+        { "cpu_ms_p95", cpu.p95Ms, 0.05 },
+        { "cpu_ms_p99", cpu.p99Ms, 0.05 },
+        { "gpu_ms_avg", gpu.averageMs, 0.05 },
+        { "gpu_ms_p95", gpu.p95Ms, 0.05 },
+        { "update_ms_avg", summarize(records, &FrameRecord::updateMs).averageMs, 0.02 },
+        { "cull_ms_avg", summarize(records, &FrameRecord::cullMs).averageMs, 0.02 },
+        { "sort_ms_avg", summarize(records, &FrameRecord::sortMs).averageMs, 0.02 },
+        { "submit_ms_avg", summarize(records, &FrameRecord::submitMs).averageMs, 0.02 },
+        { "light_ms_avg", summarize(records, &FrameRecord::lightMs).averageMs, 0.02 },
+        { "shadow_gpu_ms_avg", summarize(records, &FrameRecord::shadowGpuMs).averageMs, 0.02 },
+        { "shadow_draw_calls_avg", average(records, &FrameRecord::shadowDrawCalls), 0.0 },
+        { "post_gpu_ms_avg", summarize(records, &FrameRecord::postGpuMs).averageMs, 0.02 },
+        { "particle_sim_ms_avg", summarize(records, &FrameRecord::particleSimulateMs).averageMs, 0.02 },
+        { "particle_render_ms_avg", summarize(records, &FrameRecord::particleRenderMs).averageMs, 0.02 },
+        { "voxel_mesh_ms_avg", summarize(records, &FrameRecord::voxelMeshMs).averageMs, 0.05 },
+        { "terrain_tile_ms_avg", summarize(records, &FrameRecord::terrainLatencyMs).averageMs, 0.5 },
+        { "terrain_resident_mb_avg", average(records, &FrameRecord::terrainResidentMb), 0.01 },
+        { "draw_calls_avg", average(records, &FrameRecord::drawCalls), 0.0 },
+        { "texture_binds_avg", average(records, &FrameRecord::textureBinds), 0.0 },
+        { "texture_resident_mb_avg", average(records, &FrameRecord::textureResidentMb), 0.01 },
+        { "heap_allocations_avg", average(records, &FrameRecord::allocations), 0.0 },
+    };
+    double rss = residentMegabytes();
+
+    printf("%s\n", (const char*)glGetString(GL_RENDERER));
+    printf("%d objects, %d materials, %d textures (%s), %d frames (+%d warm-up), %d threads%s%s\n",
+            graphics::GetSceneStats().objects, options.materials, options.textures,
+            MaterialTextureModeName(graphics::GetTextureMode()), options.frames, options.warmup,
+            graphics::GetWorkerThreads(), graphics::IsGpuDriven() ? ", GPU-driven" : "", graphics::IsPipelined() ? ", pipelined" : "");
+    printf("CPU ms: %.3f avg, %.3f p50, %.3f p95, %.3f p99, %.3f max\n", cpu.averageMs, cpu.medianMs, cpu.p95Ms, cpu.p99Ms, cpu.maxMs);
+    printf("GPU ms: %.3f avg, %.3f p50, %.3f p95, %.3f p99, %.3f max\n", gpu.averageMs, gpu.medianMs, gpu.p95Ms, gpu.p99Ms, gpu.maxMs);
+    printf("%.1f draw calls, %.0f triangles, %.1f heap allocations per frame%s, %.1f MB resident\n",
+            average(records, &FrameRecord::drawCalls), average(records, &FrameRecord::triangles),
+            average(records, &FrameRecord::allocations), IsAllocationCountingEnabled() ? "" : " (not counted)", rss);
+    if (graphics::GetLighting() != LightingMode::Off) {
+        const graphics::SceneStats& stats = graphics::GetSceneStats();
+        printf("%d lights (%s): %.3f ms assignment, %d cluster entries, at most %d per fragment\n", stats.lights,
+                LightingModeName(graphics::GetLighting()), summarize(records, &FrameRecord::lightMs).averageMs,
+                stats.lightIndices, stats.maxClusterLights);
+    }
+    if (graphics::GetSceneStats().renderPath == RenderPath::Deferred) {
+        printf("Deferred: G-buffer %d bytes per pixel, %.1f MB\n", graphics::GetSceneStats().gBufferBytesPerPixel,
+                graphics::GetSceneStats().gBufferBytes / 1048576.0);
+    }
+    if (graphics::GetSceneStats().shadows) {
+        const graphics::SceneStats& stats = graphics::GetSceneStats();
+        printf("Shadows: %.1f draw calls, %.3f ms GPU per frame, %.1f MB of maps; last frame by cascade:",
+                average(records, &FrameRecord::shadowDrawCalls), summarize(records, &FrameRecord::shadowGpuMs).averageMs,
+                stats.shadowMapBytes / 1048576.0);
+        for (const graphics::CascadeStats& cascade : stats.cascades)
+            printf(" [%d draws, %d casters%s, %.3f ms]", cascade.drawCalls, cascade.casters, cascade.cached ? ", cached" : "", cascade.gpuMs);
+        printf("\n");
+    }
+    if (graphics::GetSceneStats().post.passes > 0) {
+        const PostProcess::Stats& post = graphics::GetSceneStats().post;
+        printf("Post: %.3f ms GPU per frame, last frame bloom %.3f ms, composite %.3f ms, FXAA %.3f ms, %d passes%s, %.1f MB of targets\n",
+                summarize(records, &FrameRecord::postGpuMs).averageMs, post.bloomMs, post.compositeMs, post.fxaaMs, post.passes,
+                post.compute ? " (compute bloom)" : "", post.targetBytes / 1048576.0);
+    }
+    if (graphics::GetSceneStats().particles.capacity > 0) {
+        const ParticleSystem::Stats& particles = graphics::GetSceneStats().particles;
+        printf("Particles: %d slots, %d alive in the last counted frame (%s), simulate %.3f ms, render %.3f ms GPU per frame, %.1f MB\n",
+                particles.capacity, particles.alive, particles.compute ? "compute" : "transform feedback, not counted",
+                summarize(records, &FrameRecord::particleSimulateMs).averageMs, summarize(records, &FrameRecord::particleRenderMs).averageMs,
+                particles.bytes / 1048576.0);
+    }
+    if (graphics::GetSceneStats().voxels.chunks > 0) {
+        const VoxelWorld::Stats& voxels = graphics::GetSceneStats().voxels;
+        printf("Voxels: %d chunks built in %.0f ms, %.3f ms per chunk mesh, %.1f meshes/s on %d threads, %d chunks and %lld quads drawn last frame, %.1f MB meshes\n",
+                voxels.chunks, voxels.buildMs, summarize(records, &FrameRecord::voxelMeshMs).averageMs,
+                average(records, &FrameRecord::voxelMeshesPerSecond), voxels.meshThreads, voxels.visibleChunks, voxels.quads,
+                voxels.meshBytes / 1048576.0);
+    }
+    if (graphics::GetSceneStats().terrain.bufferBytes > 0) {
+        const Terrain::Stats& terrain = graphics::GetSceneStats().terrain;
+        printf("Terrain: %.2f ms tile latency on average, %.2f ms at worst, %.2f ms generation, %lld tiles generated, %lld evicted, %.2f MB resident on average of %.1f MB, %d tiles drawn last frame\n",
+                summarize(records, &FrameRecord::terrainLatencyMs).averageMs, summarize(records, &FrameRecord::terrainLatencyMs).maxMs,
+                terrain.generateMs, terrain.generatedTiles, terrain.evictedTiles, average(records, &FrameRecord::terrainResidentMb),
+                terrain.bufferBytes / 1048576.0, terrain.drawnTiles);
+    }
+    if (graphics::GetSceneStats().textureStreaming) {
+        printf("Texture streaming: %.2f MB resident on average of %.2f MB budget (%.2f MB with every level), %.2f MB/s\n",
+                average(records, &FrameRecord::textureResidentMb), options.textureBudgetKb / 1024.0,
+                graphics::GetSceneStats().textureFullBytes / 1048576.0, average(records, &FrameRecord::textureBandwidthMb));
+    }
+
+    int result = 0;
+    if (!writeJson(options.jsonPath, options, metrics, records, rss)) {
+        fprintf(stderr, "Unable to write %s.\n", options.jsonPath.c_str());
+        result = 2;
+    }
+    if (!options.csvPath.empty() && !writeCsv(options.csvPath, records)) {
+        fprintf(stderr, "Unable to write %s.\n", options.csvPath.c_str());
+        result = 2;
+    }
+    if (result == 0 && !options.baselinePath.empty())
+        result = compareBaseline(options.baselinePath, options, metrics);
+
+    graphics::Cleanup();
+    delete sceneBuffer;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
@@ -0,0 +1,171 @@
+/*
+ * scene_benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Benchmark for the parallel part of the frame. Builds a scene of
+ *      parents with a few children each, spins every parent each frame
+ *      and times transform propagation, BVH refit, culling + LOD + sort
+ *      keys and the final sort for every thread count, then prints the
+ *      speedup over one thread.
+ *
+ *      scene-benchmark [object count] [max threads]    // defaults to 100k, hardware
+ */
+
+#include "BVH.h"
+#include "RenderQueue.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const int CHILDREN_PER_PARENT = 4;
+const int FRAMES = 20;
+const int LOD_LEVELS = 4;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct PhaseTimes {
+    double transforms = 0.0;
+    double refit = 0.0;
+    double cull = 0.0;
+    double sort = 0.0;
+    size_t drawItems = 0;
+
+    double Total() const { return transforms + refit + cull + sort; }
+};
+
+// parents scattered over a plane, children orbiting them, all with the same mesh that has a LOD chain
+void buildScene(Scene& scene, std::vector<Entity>& parents, int count) {
+    std::mt19937 rng(1234);
+    int parentCount = std::max(1, count / (CHILDREN_PER_PARENT + 1));
+    float worldSize = std::sqrt((float)parentCount) * 3.0f;
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    const AABB unitBox(glm::vec3(-0.5f), glm::vec3(0.5f));
+
+    for (int i = 0; i < parentCount; i++) {
+        Entity parent = scene.CreateEntity();
+        scene.SetPosition(parent, glm::vec3(position(rng), 0.0f, position(rng)));
+        scene.SetLocalBounds(parent, unitBox);
+        scene.SetMesh(parent, 1);
+        parents.push_back(parent);
+
+        for (int c = 0; c < CHILDREN_PER_PARENT; c++) {
+            Entity child = scene.CreateEntity(parent);
+            float angle = glm::two_pi<float>() * c / CHILDREN_PER_PARENT;
+            scene.SetPosition(child, glm::vec3(std::cos(angle) * 1.2f, 0.4f, std::sin(angle) * 1.2f));
+            scene.SetScale(child, glm::vec3(0.35f));
+            scene.SetLocalBounds(child, unitBox);
+            scene.SetMesh(child, 1);
+        }
+    }
+    scene.UpdateTransforms();
+}
+
+PhaseTimes runFrames(Scene& scene, const std::vector<Entity>& parents, int threads) {
+    ThreadPool pool(threads);
+    BVH bvh;
+    bvh.Build(scene.GetWorldBounds());
+
+    const std::vector<int> meshLevels = { 1, LOD_LEVELS };
+    std::vector<int> objectLODs(scene.GetEntityCount(), 0);
+
+    // camera above the middle of the field looking down the diagonal
+    glm::vec3 eye(0.0f, 15.0f, 0.0f);
+    glm::vec3 target(50.0f, 0.0f, 50.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+    glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    CullInput input;
+    input.bvh = &bvh;
+    input.bounds = &scene.GetWorldBounds();
+    input.meshes = &scene.GetMeshes();
+    input.meshLevels = &meshLevels;
+    input.objectLODs = &objectLODs;
+    input.frustum = Frustum(projection * view);
+    input.cameraPosition = eye;
+    input.cameraForward = glm::normalize(target - eye);
+    input.fovY = glm::radians(45.0f);
+    input.farPlane = 500.0f;
+
+    RenderQueue queue;
+    PhaseTimes times;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        glm::quat spin = glm::angleAxis(glm::radians(frame * 5.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        for (Entity parent : parents)
+            scene.SetRotation(parent, spin);
+
+        Clock::time_point start = Clock::now();
+        scene.UpdateTransforms(&pool);
+        times.transforms += millisecondsSince(start);
+
+        start = Clock::now();
+        const std::vector<AABB>& bounds = scene.GetWorldBounds();
+        for (int id : scene.GetChangedObjects())
+            bvh.UpdateObject(id, bounds[id]);
+        bvh.Refit();
+        times.refit += millisecondsSince(start);
+
+        start = Clock::now();
+        queue.Build(input, pool);
+        times.cull += millisecondsSince(start);
+
+        start = Clock::now();
+        queue.Sort();
+        times.sort += millisecondsSince(start);
+        times.drawItems = queue.GetItems().size();
+    }
+
+    times.transforms /= FRAMES;
+    times.refit /= FRAMES;
+    times.cull /= FRAMES;
+    times.sort /= FRAMES;
+    return times;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int maxThreads = argc > 2 ? std::atoi(argv[2]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    maxThreads = std::max(1, maxThreads);
+
+    Scene scene;
+    std::vector<Entity> parents;
+    buildScene(scene, parents, count);
+
+    printf("%d objects (%d parents x %d children), %d frames per run, %u hardware threads\n",
+            scene.GetEntityCount(), (int)parents.size(), CHILDREN_PER_PARENT, FRAMES, std::thread::hardware_concurrency());
+    printf(" threads | transforms |    refit | cull+LOD |     sort |    total | speedup | draw items\n");
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        PhaseTimes times = runFrames(scene, parents, threads);
+        if (threads == 1)
+            baseline = times.Total();
+
+        printf("%8d | %10.3f | %8.3f | %8.3f | %8.3f | %8.3f | %6.2fx | %zu\n",
+                threads, times.transforms, times.refit, times.cull, times.sort, times.Total(),
+                baseline / times.Total(), times.drawItems);
+    }
+    return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * AllocationCounter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the heap allocation instrumentation.
+ *      The replacements forward to malloc/free. On top of that every
+ *      new and delete looks up the block's usable size, adds it to or
+ *      subtracts it from the bytes in use with relaxed atomics, and a
+ *      new also runs a compare-and-swap loop to raise the peak. That
+ *      costs something in allocation heavy code; configure with
+ *      RENDERER_COUNT_ALLOCATIONS=OFF to measure without it.
+ */
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+
+#ifdef RENDERER_COUNT_ALLOCATIONS
+
+namespace {
+
+std::atomic<uint64_t> allocationCount(0);
+std::atomic<uint64_t> allocatedBytes(0);
+std::atomic<uint64_t> bytesInUse(0);
+std::atomic<uint64_t> bytesPeak(0);
+
+std::size_t usableSize(void* memory) {
+#if defined(_WIN32)
+    return _msize(memory);
+#elif defined(__APPLE__)
+    return malloc_size(memory);
+#else
+    return malloc_usable_size(memory);
+#endif
+}
+
+// blocks from countedAllocateAligned(), on Windows they come from _aligned_malloc and only the
+// _aligned_ functions may look at them
+std::size_t usableSizeAligned(void* memory, std::size_t alignment) {
+#if defined(_WIN32)
+    return _aligned_msize(memory, alignment, 0);
+#else
+    (void)alignment;
+    return usableSize(memory);
+#endif
+}
+
+void trackAllocated(std::size_t size) {
+    uint64_t inUse = bytesInUse.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = bytesPeak.load(std::memory_order_relaxed);
+    while (inUse > peak && !bytesPeak.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+        ;
+}
+
+void countedFree(void* memory) {
+    if (!memory)
+        return;
+    bytesInUse.fetch_sub(usableSize(memory), std::memory_order_relaxed);
+    std::free(memory);
+}
+
+void countedFreeAligned(void* memory, std::align_val_t alignment) {
+    if (!memory)
+        return;
+    bytesInUse.fetch_sub(usableSizeAligned(memory, (std::size_t)alignment), std::memory_order_relaxed);
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void* countedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    trackAllocated(usableSize(memory));
+    return memory;
+}
+
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    // aligned_alloc wants the size to be a multiple of the alignment, MSVC has no aligned_alloc
+    std::size_t align = (std::size_t)alignment;
+    std::size_t rounded = (size + align - 1) / align * align;
+#if defined(_WIN32)
+    void* memory = _aligned_malloc(rounded ? rounded : align, align);
+#else
+    void* memory = std::aligned_alloc(align, rounded ? rounded : align);
+#endif
+    if (!memory)
+        throw std::bad_alloc();
+    trackAllocated(usableSizeAligned(memory, align));
+    return memory;
+}
+
+}
+
+
+void* operator new(std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAllocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAllocateAligned(size, alignment);
+}
+
+void operator delete(void* memory) noexcept {
+    countedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    countedFree(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    countedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    countedFree(memory);
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+    countedFreeAligned(memory, alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    countedFreeAligned(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFreeAligned(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    countedFreeAligned(memory, alignment);
+}
+
+
+AllocationCount GetAllocationCount() {
+    return { allocationCount.load(std::memory_order_relaxed), allocatedBytes.load(std::memory_order_relaxed) };
+}
+
+uint64_t GetHeapBytesInUse() {
+    return bytesInUse.load(std::memory_order_relaxed);
+}
+
+uint64_t GetHeapBytesPeak() {
+    return bytesPeak.load(std::memory_order_relaxed);
+}
+
+bool IsAllocationCountingEnabled() {
+    return true;
+}
+
+#else
+
+AllocationCount GetAllocationCount() {
+    return AllocationCount();
+}
+
+uint64_t GetHeapBytesInUse() {
+    return 0;
+}
+
+uint64_t GetHeapBytesPeak() {
+    return 0;
+}
+
+bool IsAllocationCountingEnabled() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * AllocationCounter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the heap allocation instrumentation. When the
+ *      build defines RENDERER_COUNT_ALLOCATIONS the global operator
+ *      new/delete are replaced with versions that count every
+ *      allocation made through them on any thread, so the frame loop
+ *      can show how many allocations a frame made (the goal is zero
+ *      once the scene stops changing). It also keeps the bytes in use
+ *      and their peak, measured with the allocator's usable size of
+ *      each block. malloc calls from C libraries and the GL driver are
+ *      not seen.
+ *
+ *      AllocationCount before = GetAllocationCount();
+ *      ...
+ *      AllocationCount made = GetAllocationCount() - before;
+ */
+
+#pragma once
+
+#include <cstdint>
+
+
+struct AllocationCount {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationCount operator-(const AllocationCount& other) const {
+        return { allocations - other.allocations, bytes - other.bytes };
+    }
+};
+
+// totals since the program started, zero when counting is compiled out
+AllocationCount GetAllocationCount();
+// heap memory currently allocated through operator new, and the most there ever was
+uint64_t GetHeapBytesInUse();
+uint64_t GetHeapBytesPeak();
+bool IsAllocationCountingEnabled();
@@ -0,0 +1,448 @@
+/*
+ * BVH.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the bounding volume hierarchy.
+ *      Nodes are allocated from one flat array so subtrees can be
+ *      built on separate threads without any locking, each task only
+ *      touches its own slice of the primitive index list.
+ */
+
+#include "BVH.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+
+namespace {
+
+const int MAX_LEAF_SIZE = 4;            // always split above this many objects...
+const int MAX_SAH_LEAF_SIZE = 16;       // ...unless SAH says a leaf is cheaper
+const int SAH_BINS = 16;
+const int PARALLEL_THRESHOLD = 8192;    // subtrees smaller than this stay on one thread
+const int SAH_MAX_DEPTH = 48;           // past this depth fall back to median splits
+const int STACK_SIZE = 128;             // traversal stack, the build keeps depth well below this
+
+
+struct BuildContext {
+    const std::vector<AABB>& bounds;
+    std::vector<glm::vec3> centroids;
+    std::vector<int>& indices;
+    std::vector<BVH::Node>& nodes;
+    std::vector<int>& objectLeaf;
+    std::atomic<int> nodeCount;
+    std::atomic<int> spareThreads;
+
+    BuildContext(const std::vector<AABB>& b, std::vector<int>& i, std::vector<BVH::Node>& n, std::vector<int>& l)
+        : bounds(b), indices(i), nodes(n), objectLeaf(l), nodeCount(0), spareThreads(0) {}
+};
+
+void makeLeaf(BuildContext& ctx, int nodeIndex, int first, int count) {
+    BVH::Node& node = ctx.nodes[nodeIndex];
+    node.firstPrim = first;
+    node.primCount = count;
+    for (int i = first; i < first + count; i++)
+        ctx.objectLeaf[ctx.indices[i]] = nodeIndex;
+}
+
+void buildNode(BuildContext& ctx, int nodeIndex, int first, int count, int depth) {
+    BVH::Node& node = ctx.nodes[nodeIndex];
+
+    AABB centroidBounds;
+    node.bounds = AABB();
+    for (int i = first; i < first + count; i++) {
+        node.bounds.Expand(ctx.bounds[ctx.indices[i]]);
+        centroidBounds.Expand(ctx.centroids[ctx.indices[i]]);
+    }
+
+    if (count <= MAX_LEAF_SIZE) {
+        makeLeaf(ctx, nodeIndex, first, count);
+        return;
+    }
+
+    // binned SAH over the axis with the best split
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    glm::vec3 centroidExtent = centroidBounds.Extent();
+
+    for (int axis = 0; axis < 3 && depth < SAH_MAX_DEPTH; axis++) {
+        if (centroidExtent[axis] <= 0.0f)
+            continue;
+
+        AABB binBounds[SAH_BINS];
+        int binCount[SAH_BINS] = {};
+        float scale = SAH_BINS / centroidExtent[axis];
+
+        for (int i = first; i < first + count; i++) {
+            int id = ctx.indices[i];
+            int bin = std::min(SAH_BINS - 1, (int)((ctx.centroids[id][axis] - centroidBounds.min[axis]) * scale));
+            binBounds[bin].Expand(ctx.bounds[id]);
+            binCount[bin]++;
+        }
+
+        // sweep from the right to get suffix areas, then from the left
+        float rightArea[SAH_BINS];
+        int rightCount[SAH_BINS];
+        AABB accum;
+        int accumCount = 0;
+        for (int bin = SAH_BINS - 1; bin > 0; bin--) {
+            accum.Expand(binBounds[bin]);
+            accumCount += binCount[bin];
+            rightArea[bin] = accum.SurfaceArea();
+            rightCount[bin] = accumCount;
+        }
+
+        accum = AABB();
+        accumCount = 0;
+        for (int split = 1; split < SAH_BINS; split++) {
+            accum.Expand(binBounds[split - 1]);
+            accumCount += binCount[split - 1];
+            if (accumCount == 0 || rightCount[split] == 0)
+                continue;
+
+            float cost = accum.SurfaceArea() * accumCount + rightArea[split] * rightCount[split];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    int mid;
+    if (bestAxis == -1) {
+        // degenerate centroids or a very deep branch, split at the median of the widest axis
+        int axis = 0;
+        if (centroidExtent.y > centroidExtent[axis]) axis = 1;
+        if (centroidExtent.z > centroidExtent[axis]) axis = 2;
+        mid = first + count / 2;
+        std::nth_element(ctx.indices.data() + first, ctx.indices.data() + mid, ctx.indices.data() + first + count,
+                [&](int a, int b) { return ctx.centroids[a][axis] < ctx.centroids[b][axis]; });
+    } else {
+        float leafCost = node.bounds.SurfaceArea() * count;
+        if (count <= MAX_SAH_LEAF_SIZE && leafCost <= bestCost) {
+            makeLeaf(ctx, nodeIndex, first, count);
+            return;
+        }
+
+        float scale = SAH_BINS / centroidExtent[bestAxis];
+        float minimum = centroidBounds.min[bestAxis];
+        auto* it = std::partition(ctx.indices.data() + first, ctx.indices.data() + first + count,
+                [&](int id) {
+                    int bin = std::min(SAH_BINS - 1, (int)((ctx.centroids[id][bestAxis] - minimum) * scale));
+                    return bin < bestSplit;
+                });
+        mid = (int)(it - ctx.indices.data());
+    }
+
+    int left = ctx.nodeCount.fetch_add(2);
+    int right = left + 1;
+    node.left = left;
+    node.right = right;
+    ctx.nodes[left].parent = nodeIndex;
+    ctx.nodes[right].parent = nodeIndex;
+
+    int leftCount = mid - first;
+    int rightCount = count - leftCount;
+
+    // hand one half to another thread while there are threads to spare
+    bool spawn = false;
+    if (count >= PARALLEL_THRESHOLD) {
+        spawn = ctx.spareThreads.fetch_sub(1) > 0;
+        if (!spawn)
+            ctx.spareThreads.fetch_add(1);
+    }
+
+    if (spawn) {
+        auto task = std::async(std::launch::async, buildNode, std::ref(ctx), left, first, leftCount, depth + 1);
+        buildNode(ctx, right, mid, rightCount, depth + 1);
+        task.get();
+        ctx.spareThreads.fetch_add(1);
+    } else {
+        buildNode(ctx, left, first, leftCount, depth + 1);
+        buildNode(ctx, right, mid, rightCount, depth + 1);
+    }
+}
+
+}
+
+
+void BVH::Build(const std::vector<AABB>& objectBounds, unsigned int threadCount) {
+    int count = (int)objectBounds.size();
+
+    primBounds = objectBounds;
+    primIndices.resize(count);
+    objectLeaf.assign(count, -1);
+    dirtyLeaves.clear();
+    nodes.clear();
+    nodeCount = 0;
+
+    if (count == 0) {
+        leafDirty.clear();
+        return;
+    }
+
+    for (int i = 0; i < count; i++)
+        primIndices[i] = i;
+
+    // a binary tree with at least one object per leaf never needs more than 2n - 1 nodes
+    nodes.resize(2 * count - 1);
+
+    BuildContext ctx(primBounds, primIndices, nodes, objectLeaf);
+    ctx.centroids.resize(count);
+    for (int i = 0; i < count; i++)
+        ctx.centroids[i] = primBounds[i].Center();
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    ctx.spareThreads = (int)threadCount - 1;
+    ctx.nodeCount = 1;
+
+    buildNode(ctx, 0, 0, count, 0);
+
+    nodeCount = ctx.nodeCount;
+    nodes.resize(nodeCount);
+    leafDirty.assign(nodeCount, 0);
+}
+
+void BVH::UpdateObject(int objectId, const AABB& bounds) {
+    primBounds[objectId] = bounds;
+
+    int leaf = objectLeaf[objectId];
+    if (!leafDirty[leaf]) {
+        leafDirty[leaf] = 1;
+        dirtyLeaves.push_back(leaf);
+    }
+}
+
+void BVH::Refit() {
+    for (int leaf : dirtyLeaves) {
+        leafDirty[leaf] = 0;
+
+        Node& node = nodes[leaf];
+        node.bounds = AABB();
+        for (int i = node.firstPrim; i < node.firstPrim + node.primCount; i++)
+            node.bounds.Expand(primBounds[primIndices[i]]);
+
+        // walk towards the root, stop as soon as an ancestor is unaffected
+        for (int n = node.parent; n != -1; n = nodes[n].parent) {
+            AABB merged = nodes[nodes[n].left].bounds;
+            merged.Expand(nodes[nodes[n].right].bounds);
+            if (merged == nodes[n].bounds)
+                break;
+            nodes[n].bounds = merged;
+        }
+    }
+    dirtyLeaves.clear();
+}
+
+void BVH::appendSubtree(int nodeIndex, std::vector<int>& outObjects) const {
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = nodeIndex;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.IsLeaf()) {
+            outObjects.insert(outObjects.end(), primIndices.begin() + node.firstPrim,
+                    primIndices.begin() + node.firstPrim + node.primCount);
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<int>& outObjects) const {
+    QueryFrustum(frustum, outObjects, 0);
+}
+
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<int>& outObjects, int rootNode) const {
+    if (nodeCount == 0)
+        return;
+
+    int stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = rootNode;
+
+    while (top > 0) {
+        int nodeIndex = stack[--top];
+        const Node& node = nodes[nodeIndex];
+
+        FrustumTest test = frustum.Classify(node.bounds);
+        if (test == FRUSTUM_OUTSIDE)
+            continue;
+
+        // everything below a fully contained node is visible, skip the plane tests
+        if (test == FRUSTUM_INSIDE) {
+            appendSubtree(nodeIndex, outObjects);
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            for (int i = node.firstPrim; i < node.firstPrim + node.primCount; i++) {
+                if (frustum.Intersects(primBounds[primIndices[i]]))
+                    outObjects.push_back(primIndices[i]);
+            }
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+void BVH::CollectSubtrees(int count, std::vector<int>& outRoots) const {
+    outRoots.clear();
+    if (nodeCount == 0)
+        return;
+
+    // split breadth first so the subtrees end up roughly the same size, each level is
+    // appended behind the previous one which is then dropped, so no scratch list is needed
+    outRoots.push_back(0);
+    while ((int)outRoots.size() < count) {
+        size_t level = outRoots.size();
+        for (size_t i = 0; i < level; i++) {
+            const Node& node = nodes[outRoots[i]];
+            if (node.IsLeaf()) {
+                outRoots.push_back(outRoots[i]);
+            } else {
+                outRoots.push_back(node.left);
+                outRoots.push_back(node.right);
+            }
+        }
+        outRoots.erase(outRoots.begin(), outRoots.begin() + level);
+        if (outRoots.size() == level)
+            break;
+    }
+}
+
+int BVH::Raycast(const Ray& ray, float& outDistance, const RayHitTest& hitTest, float maxDistance) const {
+    int hit = -1;
+    float closest = maxDistance;
+    float entry;
+
+    if (nodeCount == 0 || !IntersectRayAABB(ray, nodes[0].bounds, closest, entry))
+        return -1;
+
+    struct Entry { int node; float t; };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = { 0, entry };
+
+    while (top > 0) {
+        Entry current = stack[--top];
+        if (current.t > closest)
+            continue;
+
+        const Node& node = nodes[current.node];
+        if (node.IsLeaf()) {
+            for (int i = node.firstPrim; i < node.firstPrim + node.primCount; i++) {
+                int id = primIndices[i];
+                float t;
+                if (!IntersectRayAABB(ray, primBounds[id], closest, t))
+                    continue;
+                if (hitTest && !hitTest(id, ray, t))
+                    continue;
+                if (t < closest) {
+                    closest = t;
+                    hit = id;
+                }
+            }
+            continue;
+        }
+
+        float tLeft, tRight;
+        bool hitLeft = IntersectRayAABB(ray, nodes[node.left].bounds, closest, tLeft);
+        bool hitRight = IntersectRayAABB(ray, nodes[node.right].bounds, closest, tRight);
+
+        // push the farther child first so the nearer one is visited first
+        if (hitLeft && hitRight) {
+            if (tLeft < tRight) {
+                stack[top++] = { node.right, tRight };
+                stack[top++] = { node.left, tLeft };
+            } else {
+                stack[top++] = { node.left, tLeft };
+                stack[top++] = { node.right, tRight };
+            }
+        } else if (hitLeft) {
+            stack[top++] = { node.left, tLeft };
+        } else if (hitRight) {
+            stack[top++] = { node.right, tRight };
+        }
+    }
+
+    if (hit != -1)
+        outDistance = closest;
+    return hit;
+}
+
+int BVH::Nearest(const glm::vec3& point, float& outDistance, float maxDistance) const {
+    if (nodeCount == 0)
+        return -1;
+
+    int nearest = -1;
+    float best = maxDistance == std::numeric_limits<float>::max() ? maxDistance : maxDistance * maxDistance;
+
+    struct Entry { int node; float d; };
+    Entry stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = { 0, DistanceSquared(nodes[0].bounds, point) };
+
+    while (top > 0) {
+        Entry current = stack[--top];
+        if (current.d >= best)
+            continue;
+
+        const Node& node = nodes[current.node];
+        if (node.IsLeaf()) {
+            for (int i = node.firstPrim; i < node.firstPrim + node.primCount; i++) {
+                float d = DistanceSquared(primBounds[primIndices[i]], point);
+                if (d < best) {
+                    best = d;
+                    nearest = primIndices[i];
+                }
+            }
+            continue;
+        }
+
+        float dLeft = DistanceSquared(nodes[node.left].bounds, point);
+        float dRight = DistanceSquared(nodes[node.right].bounds, point);
+        if (dLeft < dRight) {
+            stack[top++] = { node.right, dRight };
+            stack[top++] = { node.left, dLeft };
+        } else {
+            stack[top++] = { node.left, dLeft };
+            stack[top++] = { node.right, dRight };
+        }
+    }
+
+    if (nearest != -1)
+        outDistance = std::sqrt(best);
+    return nearest;
+}
+
+const AABB& BVH::GetObjectBounds(int objectId) const {
+    return primBounds[objectId];
+}
+
+int BVH::GetObjectCount() const {
+    return (int)primBounds.size();
+}
+
+int BVH::GetNodeCount() const {
+    return nodeCount;
+}
+
+int BVH::GetPendingUpdates() const {
+    return (int)dirtyLeaves.size();
+}
+
+const std::vector<BVH::Node>& BVH::GetNodes() const {
+    return nodes;
+}
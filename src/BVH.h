@@ -0,0 +1,87 @@
+/*
+ * BVH.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the bounding volume hierarchy used to
+ *      spatially index scene objects. The tree is built with a
+ *      binned surface area heuristic (in parallel for large scenes)
+ *      and supports cheap refitting when only a few objects move.
+ *
+ *      BVH bvh;
+ *      bvh.Build(objectBounds);               // full (re)build
+ *      bvh.UpdateObject(id, newBounds);       // object moved
+ *      bvh.Refit();                           // O(changed) update
+ *      bvh.QueryFrustum(frustum, visible);    // hierarchical culling
+ */
+
+#pragma once
+
+#include "Bounds.h"
+
+#include <functional>
+#include <vector>
+
+
+class BVH {
+
+public:
+    struct Node {
+        AABB bounds;
+        int left = -1;          // child indices, -1 for leaves
+        int right = -1;
+        int parent = -1;
+        int firstPrim = 0;      // range into the primitive index list (leaves only)
+        int primCount = 0;
+
+        bool IsLeaf() const { return primCount > 0; }
+    };
+
+    // narrow phase test for ray picking, returns true and writes "t" on a hit
+    using RayHitTest = std::function<bool(int objectId, const Ray& ray, float& t)>;
+
+    // builds the tree over "objectBounds", object ids are indices into that list
+    // threadCount of 0 uses every hardware thread
+    void Build(const std::vector<AABB>& objectBounds, unsigned int threadCount = 0);
+
+    // change the bounds of a single object, takes effect on the next Refit()
+    void UpdateObject(int objectId, const AABB& bounds);
+
+    // propagates pending object updates up the tree, cost scales with changed objects
+    void Refit();
+
+    // appends every object whose bounds intersect the frustum
+    void QueryFrustum(const Frustum& frustum, std::vector<int>& outObjects) const;
+    // same, restricted to the subtree below "rootNode"
+    void QueryFrustum(const Frustum& frustum, std::vector<int>& outObjects, int rootNode) const;
+
+    // splits the tree into at least "count" disjoint subtrees (fewer if it runs out of
+    // inner nodes), querying all of them covers every object exactly once
+    void CollectSubtrees(int count, std::vector<int>& outRoots) const;
+
+    // closest object hit by the ray, -1 if nothing was hit
+    int Raycast(const Ray& ray, float& outDistance, const RayHitTest& hitTest = nullptr,
+            float maxDistance = std::numeric_limits<float>::max()) const;
+
+    // closest object (by bounds) to a point, -1 if the tree is empty
+    int Nearest(const glm::vec3& point, float& outDistance,
+            float maxDistance = std::numeric_limits<float>::max()) const;
+
+    const AABB& GetObjectBounds(int objectId) const;
+    int GetObjectCount() const;
+    int GetNodeCount() const;
+    int GetPendingUpdates() const;
+    const std::vector<Node>& GetNodes() const;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<int> primIndices;       // object ids, grouped by leaf
+    std::vector<AABB> primBounds;       // per object id
+    std::vector<int> objectLeaf;        // per object id, leaf node holding it
+    std::vector<int> dirtyLeaves;
+    std::vector<unsigned char> leafDirty;
+    int nodeCount = 0;
+
+    void appendSubtree(int nodeIndex, std::vector<int>& outObjects) const;
+};
@@ -0,0 +1,150 @@
+/*
+ * BackgroundQueue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for a queue of jobs worked off by threads of its
+ *      own, for work that is handed out on one frame and picked up on
+ *      a later one (texture levels, chunk meshes, terrain tiles).
+ *      Unlike ThreadPool::ParallelFor() nobody waits for it.
+ *
+ *      A job is a record of any movable type. The owner fills one from
+ *      Acquire(), hands it over with Submit() and gets it back done
+ *      from Collect(), in the order the jobs finished. Recycle() keeps
+ *      a record for the next Acquire(), so the vectors inside keep
+ *      their capacity instead of being allocated again for every job.
+ *
+ *      BackgroundQueue<TileJob> queue;
+ *      queue.Start(2, [](TileJob& job, int thread) { generate(job); });
+ *      TileJob job = queue.Acquire();
+ *      ...
+ *      queue.Submit(std::move(job));
+ *      ...
+ *      queue.Collect(finished);        // a frame or more later
+ *      for (TileJob& job : finished)
+ *          queue.Recycle(std::move(job));
+ *
+ *      The threads stop in the destructor, so the queue has to be
+ *      declared after everything the work touches.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+template <typename Job>
+class BackgroundQueue {
+
+public:
+    // runs on one of the queue's threads, thread is in [0, threadCount)
+    using Work = std::function<void(Job& job, int thread)>;
+
+    BackgroundQueue() : busy(0), running(false) {}
+    ~BackgroundQueue() { Stop(); }
+
+    BackgroundQueue(const BackgroundQueue&) = delete;
+    BackgroundQueue& operator=(const BackgroundQueue&) = delete;
+
+    void Start(int threadCount, Work work) {
+        this->work = std::move(work);
+        running = true;
+        for (int i = 0; i < threadCount; i++)
+            threads.emplace_back(&BackgroundQueue::threadLoop, this, i);
+    }
+
+    // jobs being worked on are finished, the queued ones are left alone
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        wakeUp.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+        threads.clear();
+    }
+
+    // a recycled record if there is one, its contents are whatever its last job left
+    Job Acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (spare.empty())
+            return Job();
+        Job job = std::move(spare.back());
+        spare.pop_back();
+        return job;
+    }
+
+    void Recycle(Job job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        spare.push_back(std::move(job));
+    }
+
+    void Submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wakeUp.notify_one();
+    }
+
+    // appends the jobs finished since the last call to "finished", oldest first
+    void Collect(std::vector<Job>& finished) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Job& job : done)
+            finished.push_back(std::move(job));
+        done.clear();
+    }
+
+    // recycles every queued and finished job and waits for the ones being worked on, nothing
+    // submitted before comes out of Collect() afterwards
+    void Cancel() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (Job& job : jobs)
+            spare.push_back(std::move(job));
+        jobs.clear();
+        idle.wait(lock, [this] { return busy == 0; });
+        for (Job& job : done)
+            spare.push_back(std::move(job));
+        done.clear();
+    }
+
+private:
+    std::vector<std::thread> threads;
+    Work work;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable idle;           // busy dropped to 0
+    std::deque<Job> jobs;
+    std::vector<Job> done;
+    std::vector<Job> spare;
+    int busy;
+    bool running;
+
+    void threadLoop(int thread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wakeUp.wait(lock, [this] { return !running || !jobs.empty(); });
+            if (!running)
+                return;
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            busy++;
+            lock.unlock();
+
+            work(job, thread);
+
+            lock.lock();
+            busy--;
+            done.push_back(std::move(job));
+            if (busy == 0)
+                idle.notify_all();
+        }
+    }
+};
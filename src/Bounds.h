@@ -0,0 +1,170 @@
+/*
+ * Bounds.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Small geometric primitives shared by the scene
+ *      queries: axis aligned boxes, rays and view frustums.
+ *      Everything here is header-only and free of any GL state.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+
+
+// axis aligned bounding box, starts out "inverted" so merging into it works
+struct AABB {
+    glm::vec3 min = glm::vec3( std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    AABB() = default;
+    AABB(const glm::vec3& minimum, const glm::vec3& maximum) : min(minimum), max(maximum) {}
+
+    bool IsValid() const {
+        return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+    }
+
+    void Expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void Expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 Center() const {
+        return (min + max) * 0.5f;
+    }
+
+    glm::vec3 Extent() const {
+        return max - min;
+    }
+
+    float SurfaceArea() const {
+        if (!IsValid())
+            return 0.0f;
+        glm::vec3 e = Extent();
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    bool operator==(const AABB& other) const {
+        return min == other.min && max == other.max;
+    }
+
+    bool operator!=(const AABB& other) const {
+        return !(*this == other);
+    }
+
+    // returns the box that encloses this box after being transformed by "m"
+    AABB Transformed(const glm::mat4& m) const {
+        // Arvo's method: project each axis of the box onto the new basis
+        glm::vec3 newMin(m[3]);
+        glm::vec3 newMax(m[3]);
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++) {
+                float a = m[column][row] * min[column];
+                float b = m[column][row] * max[column];
+                newMin[row] += std::min(a, b);
+                newMax[row] += std::max(a, b);
+            }
+        }
+        return AABB(newMin, newMax);
+    }
+};
+
+// squared distance from a point to the closest point of the box, zero when inside
+inline float DistanceSquared(const AABB& box, const glm::vec3& point) {
+    glm::vec3 d = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+
+struct Ray {
+    glm::vec3 Origin;
+    glm::vec3 Direction;
+    glm::vec3 InvDirection;
+
+    Ray(const glm::vec3& origin, const glm::vec3& direction)
+        : Origin(origin), Direction(glm::normalize(direction)) {
+        InvDirection = 1.0f / Direction;
+    }
+};
+
+// slab test, "tHit" receives the entry distance (zero when the origin is inside)
+inline bool IntersectRayAABB(const Ray& ray, const AABB& box, float tMax, float& tHit) {
+    glm::vec3 t0 = (box.min - ray.Origin) * ray.InvDirection;
+    glm::vec3 t1 = (box.max - ray.Origin) * ray.InvDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar  = glm::max(t0, t1);
+
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit  = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+
+    if (enter > exit)
+        return false;
+
+    tHit = enter;
+    return true;
+}
+
+
+enum FrustumTest {
+    FRUSTUM_OUTSIDE,
+    FRUSTUM_INTERSECT,
+    FRUSTUM_INSIDE
+};
+
+struct Frustum {
+    // plane equations (normal.xyz, distance) pointing inwards
+    glm::vec4 Planes[6];
+
+    Frustum() = default;
+
+    // extracts the six clip planes of a projection * view matrix (Gribb/Hartmann)
+    explicit Frustum(const glm::mat4& viewProjection) {
+        const glm::mat4& m = viewProjection;
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+        Planes[0] = row3 + row0;    // left
+        Planes[1] = row3 - row0;    // right
+        Planes[2] = row3 + row1;    // bottom
+        Planes[3] = row3 - row1;    // top
+        Planes[4] = row3 + row2;    // near
+        Planes[5] = row3 - row2;    // far
+
+        for (glm::vec4& plane : Planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    FrustumTest Classify(const AABB& box) const {
+        glm::vec3 center = box.Center();
+        glm::vec3 halfExtent = box.Extent() * 0.5f;
+        FrustumTest result = FRUSTUM_INSIDE;
+
+        for (const glm::vec4& plane : Planes) {
+            glm::vec3 normal(plane);
+            float distance = glm::dot(normal, center) + plane.w;
+            float radius = glm::dot(halfExtent, glm::abs(normal));
+
+            if (distance < -radius)
+                return FRUSTUM_OUTSIDE;
+            if (distance < radius)
+                result = FRUSTUM_INTERSECT;
+        }
+        return result;
+    }
+
+    bool Intersects(const AABB& box) const {
+        return Classify(box) != FRUSTUM_OUTSIDE;
+    }
+};
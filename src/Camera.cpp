@@ -5,3 +5,4 @@
 #include <glm/gtc/type_ptr.hpp>
 
 Camera GlobalCamera::camera(glm::vec3(0.0f, 0.0f, 3.0f));
+Camera GlobalCamera::renderCamera(glm::vec3(0.0f, 0.0f, 3.0f));
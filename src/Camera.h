@@ -116,6 +116,30 @@ public:
             Zoom = 45.0f;
     }
 
+    // moves the camera to "position" and turns it towards "target", for scripted camera paths
+    void LookAt(const glm::vec3& position, const glm::vec3& target) {
+        Position = position;
+        glm::vec3 direction = glm::normalize(target - position);
+        Yaw = glm::degrees(atan2(direction.z, direction.x));
+        Pitch = glm::degrees(asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+        updateCameraVectors();
+    }
+
+    // sets the euler angles directly, for restoring a saved camera
+    void SetOrientation(float yaw, float pitch) {
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
+    // becomes the state "alpha" of the way from "previous" to "current", for drawing between two simulation steps
+    void Interpolate(const Camera& previous, const Camera& current, float alpha) {
+        *this = current;
+        Position = glm::mix(previous.Position, current.Position, alpha);
+        Zoom = glm::mix(previous.Zoom, current.Zoom, alpha);
+        SetOrientation(glm::mix(previous.Yaw, current.Yaw, alpha), glm::mix(previous.Pitch, current.Pitch, alpha));
+    }
+
 private:
     // calculates the front vector from the Camera's (updated) Euler Angles
     void updateCameraVectors() {
@@ -136,7 +160,10 @@ private:
 class GlobalCamera {
 public:
     //static Camera camera;
+    // simulated camera, input and replays move this one
     static Camera camera;
+    // what the renderer draws from: the simulated camera interpolated to the frame
+    static Camera renderCamera;
 
 };
 
@@ -0,0 +1,126 @@
+/*
+ * DeferredRenderer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the deferred shading path.
+ */
+
+#include "DeferredRenderer.h"
+
+#include "FrameBuffer.h"
+#include "GpuResources.h"
+#include "MaterialTextures.h"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+const char* PATH_NAMES[] = { "Forward", "Deferred" };
+
+// albedo + specular, octahedral normal
+const std::vector<ColorFormat> GBUFFER_FORMATS = {
+    { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4 },
+    { GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4 }
+};
+
+}
+
+
+const char* RenderPathName(RenderPath path) {
+    return PATH_NAMES[(int)path];
+}
+
+DeferredRenderer::DeferredRenderer() : gBuffer(nullptr), bindlessShader(nullptr), target(0) {
+    geometryShader = new Shader("src/shaders/vertex_shader.vert", "src/shaders/gbuffer.frag");
+    if (MaterialTextures::IsBindlessSupported())
+        bindlessShader = new Shader("src/shaders/vertex_shader.vert", "src/shaders/gbuffer_bindless.frag");
+
+    lightingShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/deferred_lighting.frag");
+    lightingShader->use();
+    lightingShader->setInt("gAlbedo", ALBEDO_UNIT);
+    lightingShader->setInt("gNormal", NORMAL_UNIT);
+    lightingShader->setInt("gDepth", DEPTH_UNIT);
+
+    emptyVAO = resources::CreateVertexArray("DeferredRenderer", "fullscreen pass");
+}
+
+DeferredRenderer::~DeferredRenderer() {
+    delete gBuffer;
+    delete geometryShader;
+    delete bindlessShader;
+    delete lightingShader;
+    resources::Delete(resources::ResourceType::VertexArray, emptyVAO);
+}
+
+Shader* DeferredRenderer::GetGeometryShader(bool bindless) const {
+    return bindless ? bindlessShader : geometryShader;
+}
+
+Shader* DeferredRenderer::GetLightingShader() const {
+    return lightingShader;
+}
+
+void DeferredRenderer::BeginGeometry() {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int width = std::max(1, (int)viewport[2]);
+    int height = std::max(1, (int)viewport[3]);
+
+    if (!gBuffer) {
+        gBuffer = new FrameBuffer(width, height, GBUFFER_FORMATS);
+    } else if (gBuffer->getWidth() != width || gBuffer->getHeight() != height) {
+        gBuffer->RescaleFrameBuffer(width, height);
+    }
+
+    // the color attachments are written wherever the depth is, the lighting pass skips the rest
+    gBuffer->Bind();
+    glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+
+void DeferredRenderer::Resolve() {
+    // the target's depth attachment has to be DEPTH24_STENCIL8 like the G-buffer's
+    int width = gBuffer->getWidth();
+    int height = gBuffer->getHeight();
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    lightingShader->use();
+    const GLuint units[] = { ALBEDO_UNIT, NORMAL_UNIT, DEPTH_UNIT };
+    const GLuint textures[] = { gBuffer->getColorTexture(0), gBuffer->getColorTexture(1), gBuffer->getDepthTexture() };
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    // unbound again, next frame draws into them
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+int DeferredRenderer::GetBytesPerPixel() const {
+    int bytes = 4;      // depth/stencil
+    for (const ColorFormat& format : GBUFFER_FORMATS)
+        bytes += format.bytesPerPixel;
+    return bytes;
+}
+
+size_t DeferredRenderer::GetBytes() const {
+    return gBuffer ? (size_t)gBuffer->getWidth() * gBuffer->getHeight() * gBuffer->getBytesPerPixel() : 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * DeferredRenderer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the deferred shading path of the CPU renderer.
+ *      The sorted queue is drawn once into a G-buffer with the
+ *      geometry shaders, then one fullscreen pass lights every pixel
+ *      into the framebuffer that was bound before, so the lighting cost
+ *      follows the pixels on screen instead of the fragments drawn.
+ *
+ *      The G-buffer is kept small, 12 bytes per pixel:
+ *
+ *      color 0     RGBA8, albedo and the material's specular strength
+ *      color 1     RG16, the normal, octahedral encoded
+ *      depth       DEPTH24_STENCIL8, positions are rebuilt from it with
+ *                  the inverse view-projection instead of being stored
+ *
+ *      The depth is copied into the target afterwards, so the Hi-Z
+ *      pyramid and everything drawn later see the scene as if it had
+ *      been drawn forward.
+ *
+ *      deferred.BeginGeometry();
+ *      ...                                     // draw with GetGeometryShader()
+ *      deferred.Resolve();                     // Camera and Lighting blocks bound
+ */
+
+#pragma once
+
+#include "Shader.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+class FrameBuffer;
+
+
+enum class RenderPath {
+    Forward,
+    Deferred
+};
+
+const char* RenderPathName(RenderPath path);
+
+
+class DeferredRenderer {
+
+public:
+    // texture units the lighting pass reads the G-buffer from, after the light buffers
+    static const GLuint ALBEDO_UNIT = 5;
+    static const GLuint NORMAL_UNIT = 6;
+    static const GLuint DEPTH_UNIT = 7;
+
+    DeferredRenderer();
+    ~DeferredRenderer();
+    DeferredRenderer(const DeferredRenderer&) = delete;
+    DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+    // takes the place of the forward cube shaders, the bindless one is null without
+    // ARB_bindless_texture; the caller sets their blocks and samplers like the forward ones'
+    Shader* GetGeometryShader(bool bindless) const;
+    // reads the Camera and Lighting blocks and the light buffers, the G-buffer samplers are set
+    Shader* GetLightingShader() const;
+
+    // remembers the bound framebuffer, binds the G-buffer at the viewport's size and clears it
+    void BeginGeometry();
+    // back to the remembered framebuffer: copies the depth over and lights the covered pixels
+    void Resolve();
+
+    int GetBytesPerPixel() const;
+    // the G-buffer at its current size, 0 before the first frame
+    size_t GetBytes() const;
+
+private:
+    FrameBuffer* gBuffer;
+    Shader* geometryShader;
+    Shader* bindlessShader;
+    Shader* lightingShader;
+    GLuint emptyVAO;
+    GLint target;
+};
+
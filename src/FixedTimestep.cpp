@@ -0,0 +1,93 @@
+/*
+ * FixedTimestep.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the fixed timestep clock.
+ */
+
+#include "FixedTimestep.h"
+
+#include <algorithm>
+
+
+FixedTimestep GlobalTimestep::clock;
+
+namespace {
+
+// shortest step accepted, keeps a bad setting from running thousands of steps a second
+const double MIN_STEP = 1.0 / 1000.0;
+
+}
+
+
+FixedTimestep::FixedTimestep(double step)
+    : step(std::max(MIN_STEP, step)), accumulator(0.0), time(0.0), lockstep(false), lastSteps(0), droppedSeconds(0.0) {
+}
+
+void FixedTimestep::SetStep(double newStep) {
+    step = std::max(MIN_STEP, newStep);
+    accumulator = std::min(accumulator, step);
+}
+
+double FixedTimestep::GetStep() const {
+    return step;
+}
+
+void FixedTimestep::SetLockstep(bool enabled) {
+    lockstep = enabled;
+    accumulator = 0.0;
+}
+
+bool FixedTimestep::IsLockstep() const {
+    return lockstep;
+}
+
+void FixedTimestep::Reset() {
+    accumulator = 0.0;
+    time = 0.0;
+}
+
+int FixedTimestep::Advance(double frameSeconds) {
+    if (lockstep) {
+        time += step;
+        lastSteps = 1;
+        return lastSteps;
+    }
+
+    accumulator += std::max(0.0, frameSeconds);
+    int steps = (int)(accumulator / step);
+    if (steps > MAX_STEPS_PER_FRAME) {
+        droppedSeconds += accumulator - MAX_STEPS_PER_FRAME * step;
+        accumulator = MAX_STEPS_PER_FRAME * step;
+        steps = MAX_STEPS_PER_FRAME;
+    }
+
+    accumulator -= steps * step;
+    time += steps * step;
+    lastSteps = steps;
+    return steps;
+}
+
+float FixedTimestep::GetAlpha() const {
+    return lockstep ? 1.0f : (float)std::min(1.0, accumulator / step);
+}
+
+double FixedTimestep::GetTime() const {
+    return time;
+}
+
+double FixedTimestep::GetInterpolatedTime() const {
+    // before the first step previous and latest are both the start, and negative times mean
+    // "use the wall clock" to graphics::SetAnimationTime()
+    return std::max(0.0, time - step + GetAlpha() * step);
+}
+
+int FixedTimestep::GetLastSteps() const {
+    return lastSteps;
+}
+
+double FixedTimestep::GetDroppedSeconds() const {
+    return droppedSeconds;
+}
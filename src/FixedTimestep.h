@@ -0,0 +1,76 @@
+/*
+ * FixedTimestep.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the fixed timestep clock. The real time between
+ *      frames goes into an accumulator that is spent in steps of a
+ *      fixed length, so the simulation sees the same steps however
+ *      fast or unevenly the frames come. What is left over after the
+ *      last step is returned as the interpolation factor between the
+ *      last two simulated states, which is what gets drawn.
+ *
+ *      A frame that took very long (a hitch, a breakpoint) runs at most
+ *      MAX_STEPS_PER_FRAME steps and the rest of its time is dropped:
+ *      the simulation falls behind the clock instead of spending ever
+ *      longer frames catching up with it.
+ *
+ *      int steps = clock.Advance(frameSeconds);
+ *      for (int i = 0; i < steps; i++) {
+ *          previous = current;
+ *          step(current, clock.GetStep());
+ *      }
+ *      draw(interpolate(previous, current, clock.GetAlpha()));
+ */
+
+#pragma once
+
+
+class FixedTimestep {
+
+public:
+    static const int MAX_STEPS_PER_FRAME = 8;
+
+    explicit FixedTimestep(double step = 1.0 / 120.0);
+
+    // takes effect from the next Advance(), the accumulated time carries over
+    void SetStep(double step);
+    double GetStep() const;
+
+    // one step per frame whatever the real time, alpha stays 1; for replays that have to
+    // match frame for frame
+    void SetLockstep(bool enabled);
+    bool IsLockstep() const;
+
+    // back to time 0 with nothing accumulated
+    void Reset();
+
+    // adds the real time since the last frame, returns how many steps to run now
+    int Advance(double frameSeconds);
+
+    // how far the frame is between the previous step and the latest one, 0 to 1
+    float GetAlpha() const;
+    // simulated time at the latest step, and interpolated to the frame (never below 0)
+    double GetTime() const;
+    double GetInterpolatedTime() const;
+
+    int GetLastSteps() const;
+    // real time dropped because frames were longer than MAX_STEPS_PER_FRAME steps
+    double GetDroppedSeconds() const;
+
+private:
+    double step;
+    double accumulator;
+    double time;
+    bool lockstep;
+    int lastSteps;
+    double droppedSeconds;
+};
+
+
+// CREATE GLOBAL INSTANCE OF THE SIMULATION CLOCK
+class GlobalTimestep {
+public:
+    static FixedTimestep clock;
+};
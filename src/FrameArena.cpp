@@ -0,0 +1,85 @@
+/*
+ * FrameArena.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the frame arena.
+ */
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <new>
+
+
+FrameArena::FrameArena(size_t capacity)
+    : blocks(nullptr), cursor(nullptr), end(nullptr), used(0), capacity(std::max<size_t>(capacity, 256)) {
+
+    addBlock(this->capacity);
+}
+
+FrameArena::~FrameArena() {
+    freeBlocks();
+}
+
+void FrameArena::Reset() {
+    // the frame spilled into extra blocks, next time it gets one block that holds all of it
+    if (blocks->next) {
+        capacity = std::max(capacity * 2, used);
+        freeBlocks();
+        addBlock(capacity);
+    }
+
+    cursor = (uint8_t*)(blocks + 1);
+    used = 0;
+}
+
+size_t FrameArena::GetBytesUsed() const {
+    return used;
+}
+
+size_t FrameArena::GetCapacity() const {
+    return capacity;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t start = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (start + bytes > (uintptr_t)end) {
+        addBlock(std::max(bytes + alignment, capacity));
+        start = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+
+    used += start + bytes - (uintptr_t)cursor;
+    cursor = (uint8_t*)(start + bytes);
+    return (void*)start;
+}
+
+void FrameArena::do_deallocate(void* memory, size_t bytes, size_t) {
+    // only the newest allocation can be given back, e.g. a vector shrinking its last growth
+    if ((uint8_t*)memory + bytes == cursor) {
+        cursor = (uint8_t*)memory;
+        used -= bytes;
+    }
+}
+
+bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void FrameArena::addBlock(size_t size) {
+    Block* block = (Block*)::operator new(sizeof(Block) + size);
+    block->next = blocks;
+    blocks = block;
+
+    cursor = (uint8_t*)(block + 1);
+    end = cursor + size;
+}
+
+void FrameArena::freeBlocks() {
+    while (blocks) {
+        Block* next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * FrameArena.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the frame arena, a linear allocator for data
+ *      that only lives for one frame (draw lists, sort keys, batches).
+ *      Allocating bumps a cursor and freeing does nothing, Reset()
+ *      hands the whole arena back at once.
+ *
+ *      It is a std::pmr::memory_resource, so standard containers use it
+ *      through the pmr aliases. When a frame needs more than the arena
+ *      holds the rest comes from extra heap blocks, and the next
+ *      Reset() replaces everything with one block big enough for that
+ *      frame, so after a few frames the arena stops touching the heap.
+ *
+ *      An arena belongs to one thread, workers get one each.
+ *
+ *      FrameArena arena;
+ *      std::pmr::vector<DrawItem> items(&arena);
+ *      ...                                 // fill and use items
+ *      items = std::pmr::vector<DrawItem>(&arena);
+ *      arena.Reset();                      // nothing may still point into the arena
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+
+class FrameArena : public std::pmr::memory_resource {
+
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // frees everything allocated since the last Reset()
+    void Reset();
+
+    // bytes handed out since the last Reset(), alignment padding included
+    size_t GetBytesUsed() const;
+    // size of the main block, what a frame can use without going to the heap
+    size_t GetCapacity() const;
+
+private:
+    // heap block, the data follows the header
+    struct Block {
+        Block* next;
+        size_t padding;     // keeps the data after the header 16 byte aligned
+    };
+
+    Block* blocks;          // newest first, only the last one is the main block
+    uint8_t* cursor;
+    uint8_t* end;
+    size_t used;
+    size_t capacity;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void addBlock(size_t size);
+    void freeBlocks();
+};
@@ -9,58 +9,120 @@
 #include <iostream>
 #include <glad/glad.h>
 #include <memory>
+#include <string>
 #include "FrameBuffer.h"
 #include "Logger.h"
+#include "GpuResources.h"
 
-FrameBuffer::FrameBuffer(float width, float height) {
-    glGenFramebuffers(1, &fbo);
+namespace {
+
+// half float, lighting can go past 1 and the post-processing chain tonemaps it (PostProcess.h)
+const ColorFormat SCENE_COLOR = { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8 };
+const int DEPTH_BYTES_PER_PIXEL = 4;
+
+}
+
+FrameBuffer::FrameBuffer(float width, float height) : FrameBuffer(width, height, { SCENE_COLOR }) {
+}
+
+FrameBuffer::FrameBuffer(float width, float height, const std::vector<ColorFormat>& colorFormats)
+    : formats(colorFormats), width(width), height(height) {
+    fbo = resources::CreateFramebuffer("FrameBuffer");
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < formats.size(); i++) {
+        std::string label = formats.size() == 1 ? "color" : "color " + std::to_string(i);
+        textures.push_back(resources::CreateTexture("FrameBuffer", label));
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + (GLenum)i);
+    }
+    depthTexture = resources::CreateTexture("FrameBuffer", "depth/stencil");
+    allocate();
 
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+    for (size_t i = 0; i < textures.size(); i++) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, textures[i], 0);
+    }
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glDrawBuffers((GLsizei)drawBuffers.size(), drawBuffers.data());
 
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         Global::logger.log(ERROR, "Framebuffer isn't complete.");
     }
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
     Global::logger.log(INFO, "Framebuffer created.");
 }
 
 FrameBuffer::~FrameBuffer() {
-    glDeleteFramebuffers(1, &fbo);
-    glDeleteTextures(1, &texture);
-    glDeleteRenderbuffers(1, &rbo);
+    resources::Delete(resources::ResourceType::Framebuffer, fbo);
+    for (unsigned int texture : textures)
+        resources::Delete(resources::ResourceType::Texture, texture);
+    resources::Delete(resources::ResourceType::Texture, depthTexture);
+}
+
+void FrameBuffer::allocate() {
+    // the attachments keep their names, so the framebuffer sees the new storage without
+    // being attached again
+    for (size_t i = 0; i < textures.size(); i++) {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, formats[i].internalFormat, width, height, 0, formats[i].format, formats[i].type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    updateSizes();
+}
+
+void FrameBuffer::updateSizes() {
+    for (size_t i = 0; i < textures.size(); i++) {
+        resources::SetSize(resources::ResourceType::Texture, textures[i], resources::TextureBytes(width, height, formats[i].bytesPerPixel));
+    }
+    resources::SetSize(resources::ResourceType::Texture, depthTexture, resources::TextureBytes(width, height, DEPTH_BYTES_PER_PIXEL));
 }
 
 unsigned int FrameBuffer::getFrameTexture() {
-    return texture;
+    return textures[0];
+}
+
+unsigned int FrameBuffer::getColorTexture(int index) {
+    return textures[index];
+}
+
+int FrameBuffer::getColorCount() const {
+    return (int)textures.size();
+}
+
+unsigned int FrameBuffer::getDepthTexture() {
+    return depthTexture;
+}
+
+int FrameBuffer::getWidth() const {
+    return width;
+}
+
+int FrameBuffer::getHeight() const {
+    return height;
+}
+
+int FrameBuffer::getBytesPerPixel() const {
+    int bytes = DEPTH_BYTES_PER_PIXEL;
+    for (const ColorFormat& format : formats)
+        bytes += format.bytesPerPixel;
+    return bytes;
 }
 
 void FrameBuffer::RescaleFrameBuffer(float width, float height) {
     Global::logger.log(DEBUG, "Frame Buffer Rescaled.");
 
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
-
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+    this->width = width;
+    this->height = height;
+    allocate();
 }
 
 void FrameBuffer::Bind() const {
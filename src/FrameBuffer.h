@@ -7,21 +7,49 @@
 
 #pragma once
 
+#include <vector>
+
+
+// format of one color attachment, the GL enums of glTexImage2D
+struct ColorFormat {
+    unsigned int internalFormat;
+    unsigned int format;
+    unsigned int type;
+    int bytesPerPixel;          // what the driver stores, for the resource registry
+};
 
 class FrameBuffer {
 
 public:
+    // one RGBA16F color attachment, the scene view
     FrameBuffer(float width, float height);
+    // one color attachment per format, drawn to all at once (GL_COLOR_ATTACHMENT0 + i)
+    FrameBuffer(float width, float height, const std::vector<ColorFormat>& colorFormats);
     ~FrameBuffer();
     unsigned int getFrameTexture();
+    unsigned int getColorTexture(int index);
+    int getColorCount() const;
+    // depth/stencil attachment, sampleable so the Hi-Z pyramid can be built from it
+    unsigned int getDepthTexture();
+    int getWidth() const;
+    int getHeight() const;
+    // every attachment together, depth included
+    int getBytesPerPixel() const;
     void RescaleFrameBuffer(float width, float height);
     void Bind() const;
     void Unbind() const;
 
 private:
+    // (re)specifies every attachment at the current size
+    void allocate();
+    // tells the resource registry about the attachments' memory
+    void updateSizes();
+
     unsigned int fbo;
-    unsigned int texture;
-    unsigned int rbo;
+    std::vector<ColorFormat> formats;
+    std::vector<unsigned int> textures;
+    unsigned int depthTexture;
+    int width;
+    int height;
 };
 
-
@@ -0,0 +1,192 @@
+/*
+ * FramePacer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the frame pacer.
+ */
+
+#include "FramePacer.h"
+
+#include "Logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+
+
+FramePacer GlobalPacer::pacer;
+
+
+namespace {
+
+// sleeping wakes up late by up to about a millisecond, the last stretch is spun instead
+const std::chrono::microseconds SPIN_MARGIN(1000);
+// how often the pacing statistics are recomputed
+const std::chrono::milliseconds STATS_INTERVAL(250);
+// a frame this many times slower than the median counts as a stutter
+const float STUTTER_FACTOR = 2.0f;
+
+const char* PRESENT_MODE_NAMES[] = { "vsync", "adaptive", "uncapped", "limited" };
+
+}
+
+
+const char* PresentModeName(PresentMode mode) {
+    return PRESENT_MODE_NAMES[(int)mode];
+}
+
+bool ParsePresentMode(const char* name, PresentMode& outMode) {
+    for (int i = 0; i < 4; i++) {
+        if (std::strcmp(name, PRESENT_MODE_NAMES[i]) == 0) {
+            outMode = (PresentMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+FramePacingStats ComputePacingStats(const std::vector<float>& frameMs, std::vector<float>& scratch) {
+    FramePacingStats result;
+    if (frameMs.empty())
+        return result;
+
+    scratch.assign(frameMs.begin(), frameMs.end());
+    std::sort(scratch.begin(), scratch.end());
+    size_t count = scratch.size();
+
+    auto percentile = [&](float p) { return scratch[std::min(count - 1, (size_t)(p * (count - 1) + 0.5f))]; };
+
+    double total = 0.0;
+    for (float ms : scratch)
+        total += ms;
+
+    result.frames = (int)count;
+    result.averageMs = (float)(total / count);
+    result.averageFps = result.averageMs > 0.0f ? 1000.0f / result.averageMs : 0.0f;
+    result.medianMs = percentile(0.5f);
+    result.p95Ms = percentile(0.95f);
+    result.p99Ms = percentile(0.99f);
+    result.maxMs = scratch.back();
+
+    // slowest 1%, at least one frame
+    size_t slowCount = std::max<size_t>(1, count / 100);
+    double slowTotal = 0.0;
+    for (size_t i = count - slowCount; i < count; i++)
+        slowTotal += scratch[i];
+    result.onePercentLowFps = slowTotal > 0.0 ? (float)(1000.0 * slowCount / slowTotal) : 0.0f;
+
+    float stutterMs = result.medianMs * STUTTER_FACTOR;
+    result.stutters = (int)(scratch.end() - std::upper_bound(scratch.begin(), scratch.end(), stutterMs));
+    return result;
+}
+
+
+FramePacer::FramePacer()
+    : mode(PresentMode::VSync), targetFps(60.0f), started(false), historyNext(0), recording(false) {
+
+    history.reserve(HISTORY_SIZE);
+    scratch.reserve(HISTORY_SIZE);
+}
+
+void FramePacer::SetPresentMode(PresentMode newMode) {
+    int interval = 0;
+    if (newMode == PresentMode::VSync) {
+        interval = 1;
+    } else if (newMode == PresentMode::Adaptive) {
+        interval = -1;
+        if (!IsAdaptiveSupported()) {
+            Global::logger.log(WARNING, "Adaptive vsync is not supported, using vsync.");
+            interval = 1;
+        }
+    }
+    glfwSwapInterval(interval);
+
+    mode = newMode;
+    deadline = Clock::now();
+
+    // statistics across two modes mean nothing, start over
+    history.clear();
+    historyNext = 0;
+    stats = FramePacingStats();
+    Global::logger.log(INFO, std::string("Present mode: ") + PresentModeName(mode) + ".");
+}
+
+PresentMode FramePacer::GetPresentMode() const {
+    return mode;
+}
+
+bool FramePacer::IsAdaptiveSupported() const {
+    return glfwGetCurrentContext() != NULL
+            && (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"));
+}
+
+void FramePacer::SetTargetFps(float fps) {
+    targetFps = std::max(1.0f, fps);
+}
+
+float FramePacer::GetTargetFps() const {
+    return targetFps;
+}
+
+void FramePacer::Wait() {
+    if (mode != PresentMode::Limited)
+        return;
+
+    // a late frame starts a new schedule instead of rushing the ones after it
+    Clock::time_point now = Clock::now();
+    deadline += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+    if (deadline < now) {
+        deadline = now;
+        return;
+    }
+
+    if (deadline - now > SPIN_MARGIN)
+        std::this_thread::sleep_until(deadline - SPIN_MARGIN);
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::FrameEnd() {
+    Clock::time_point now = Clock::now();
+    if (started) {
+        float ms = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+        if ((int)history.size() < HISTORY_SIZE) {
+            history.push_back(ms);
+        } else {
+            history[historyNext] = ms;
+            historyNext = (historyNext + 1) % HISTORY_SIZE;
+        }
+        if (recording)
+            recorded.push_back(ms);
+
+        if (now - statsUpdated >= STATS_INTERVAL) {
+            stats = ComputePacingStats(history, scratch);
+            statsUpdated = now;
+        }
+    }
+    lastFrame = now;
+    started = true;
+}
+
+const FramePacingStats& FramePacer::GetStats() const {
+    return stats;
+}
+
+void FramePacer::StartRecording(size_t expectedFrames) {
+    recorded.clear();
+    recorded.reserve(expectedFrames);
+    recording = true;
+}
+
+void FramePacer::StopRecording() {
+    recording = false;
+}
+
+const std::vector<float>& FramePacer::GetRecording() const {
+    return recorded;
+}
@@ -0,0 +1,108 @@
+/*
+ * FramePacer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the frame pacer. It owns the present mode
+ *      (vsync, adaptive vsync, uncapped, or a fixed frame rate that
+ *      the pacer holds itself) and measures the time between frames.
+ *      From those it keeps pacing statistics over the last frames:
+ *      percentiles, the 1% lows and how many frames stuttered, which
+ *      says much more about smoothness than an averaged FPS.
+ *
+ *      GlobalPacer::pacer.SetPresentMode(PresentMode::Limited);  // needs a current context
+ *      ...
+ *      GlobalPacer::pacer.Wait();          // right before glfwSwapBuffers
+ *      glfwSwapBuffers(window);
+ *      GlobalPacer::pacer.FrameEnd();
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+
+enum class PresentMode {
+    VSync,          // swap interval 1
+    Adaptive,       // swap interval -1, tears instead of halving the rate when a frame is late
+    Uncapped,       // swap interval 0, as fast as the renderer goes
+    Limited         // swap interval 0, the pacer sleeps and spins up to a fixed frame rate
+};
+
+const char* PresentModeName(PresentMode mode);
+// accepts the names PresentModeName() returns, false for anything else
+bool ParsePresentMode(const char* name, PresentMode& outMode);
+
+struct FramePacingStats {
+    int frames = 0;
+    float averageMs = 0.0f;
+    float averageFps = 0.0f;
+    float medianMs = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+    float onePercentLowFps = 0.0f;  // frame rate averaged over the slowest 1% of frames
+    int stutters = 0;               // frames that took more than twice the median
+};
+
+// statistics over frame times in milliseconds, "scratch" keeps a sorted copy
+FramePacingStats ComputePacingStats(const std::vector<float>& frameMs, std::vector<float>& scratch);
+
+
+class FramePacer {
+
+public:
+    FramePacer();
+
+    // sets the swap interval of the current context, adaptive falls back to vsync without
+    // the swap_control_tear extension
+    void SetPresentMode(PresentMode mode);
+    PresentMode GetPresentMode() const;
+    bool IsAdaptiveSupported() const;
+
+    // frame rate of PresentMode::Limited
+    void SetTargetFps(float fps);
+    float GetTargetFps() const;
+
+    // holds the frame back until the target frame time has passed, limited mode only
+    void Wait();
+    // records the time since the previous FrameEnd()
+    void FrameEnd();
+
+    // over the last HISTORY_SIZE frames, refreshed a few times per second
+    const FramePacingStats& GetStats() const;
+
+    // keeps every frame time from now on, for reports over a whole run
+    void StartRecording(size_t expectedFrames);
+    void StopRecording();
+    const std::vector<float>& GetRecording() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static const int HISTORY_SIZE = 1000;
+
+    PresentMode mode;
+    float targetFps;
+    Clock::time_point deadline;
+    Clock::time_point lastFrame;
+    bool started;
+
+    std::vector<float> history;     // ring buffer of frame times in ms
+    int historyNext;
+    std::vector<float> scratch;
+    FramePacingStats stats;
+    Clock::time_point statsUpdated;
+
+    bool recording;
+    std::vector<float> recorded;
+};
+
+
+// CREATE GLOBAL INSTANCE OF THE PACER
+class GlobalPacer {
+public:
+    static FramePacer pacer;
+};
@@ -0,0 +1,175 @@
+/*
+ * GpuResources.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the GL resource registry.
+ */
+
+#include "GpuResources.h"
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+
+
+namespace resources {
+
+namespace {
+
+const char* RESOURCE_TYPE_NAMES[] = { "Buffer", "Texture", "Renderbuffer", "Framebuffer", "Vertex array", "Program" };
+
+// dense list for the Memory window, the map finds an entry by type and name
+std::vector<GpuResource> registry;
+std::unordered_map<uint64_t, size_t> registryIndex;
+
+uint64_t key(ResourceType type, GLuint id) {
+    return ((uint64_t)type << 32) | id;
+}
+
+GpuResource* find(ResourceType type, GLuint id) {
+    auto it = registryIndex.find(key(type, id));
+    return it == registryIndex.end() ? nullptr : &registry[it->second];
+}
+
+}
+
+
+const char* ResourceTypeName(ResourceType type) {
+    return RESOURCE_TYPE_NAMES[(int)type];
+}
+
+GLuint CreateBuffer(const char* owner, const std::string& label) {
+    GLuint id = 0;
+    glGenBuffers(1, &id);
+    Track(ResourceType::Buffer, id, owner, label);
+    return id;
+}
+
+GLuint CreateTexture(const char* owner, const std::string& label) {
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    Track(ResourceType::Texture, id, owner, label);
+    return id;
+}
+
+GLuint CreateRenderbuffer(const char* owner, const std::string& label) {
+    GLuint id = 0;
+    glGenRenderbuffers(1, &id);
+    Track(ResourceType::Renderbuffer, id, owner, label);
+    return id;
+}
+
+GLuint CreateFramebuffer(const char* owner, const std::string& label) {
+    GLuint id = 0;
+    glGenFramebuffers(1, &id);
+    Track(ResourceType::Framebuffer, id, owner, label);
+    return id;
+}
+
+GLuint CreateVertexArray(const char* owner, const std::string& label) {
+    GLuint id = 0;
+    glGenVertexArrays(1, &id);
+    Track(ResourceType::VertexArray, id, owner, label);
+    return id;
+}
+
+void Track(ResourceType type, GLuint id, const char* owner, const std::string& label) {
+    if (id == 0)
+        return;
+    if (GpuResource* existing = find(type, id)) {
+        // a name the driver handed out again after a delete that bypassed the registry
+        existing->bytes = 0;
+        existing->owner = owner;
+        existing->label = label;
+        return;
+    }
+    registryIndex[key(type, id)] = registry.size();
+    registry.push_back({ type, id, 0, owner, label });
+}
+
+void Untrack(ResourceType type, GLuint id) {
+    auto it = registryIndex.find(key(type, id));
+    if (it == registryIndex.end())
+        return;
+
+    // swap the last entry into the hole
+    size_t index = it->second;
+    registryIndex.erase(it);
+    if (index != registry.size() - 1) {
+        registry[index] = std::move(registry.back());
+        registryIndex[key(registry[index].type, registry[index].id)] = index;
+    }
+    registry.pop_back();
+}
+
+void Delete(ResourceType type, GLuint& id) {
+    if (id == 0)
+        return;
+    Untrack(type, id);
+
+    switch (type) {
+    case ResourceType::Buffer:       glDeleteBuffers(1, &id); break;
+    case ResourceType::Texture:      glDeleteTextures(1, &id); break;
+    case ResourceType::Renderbuffer: glDeleteRenderbuffers(1, &id); break;
+    case ResourceType::Framebuffer:  glDeleteFramebuffers(1, &id); break;
+    case ResourceType::VertexArray:  glDeleteVertexArrays(1, &id); break;
+    case ResourceType::Program:      glDeleteProgram(id); break;
+    default: break;
+    }
+    id = 0;
+}
+
+void SetSize(ResourceType type, GLuint id, size_t bytes) {
+    if (GpuResource* resource = find(type, id))
+        resource->bytes = bytes;
+}
+
+size_t TextureBytes(int width, int height, int bytesPerTexel, int levels) {
+    size_t bytes = 0;
+    for (int level = 0; levels <= 0 || level < levels; level++) {
+        bytes += (size_t)width * height * bytesPerTexel;
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return bytes;
+}
+
+ResourceTotals GetTotals() {
+    ResourceTotals totals;
+    for (const GpuResource& resource : registry) {
+        totals.count[(int)resource.type]++;
+        totals.bytes[(int)resource.type] += resource.bytes;
+        totals.totalBytes += resource.bytes;
+    }
+    totals.totalCount = (int)registry.size();
+    return totals;
+}
+
+const std::vector<GpuResource>& GetResources() {
+    return registry;
+}
+
+int ReportLeaks() {
+    if (registry.empty()) {
+        Global::logger.log(INFO, "All GL resources were released.");
+        return 0;
+    }
+
+    for (const GpuResource& resource : registry) {
+        char line[256];
+        snprintf(line, sizeof(line), "Leaked %s %u (%.1f KB) created by %s%s%s.", ResourceTypeName(resource.type),
+                resource.id, resource.bytes / 1024.0, resource.owner,
+                resource.label.empty() ? "" : ": ", resource.label.c_str());
+        Global::logger.log(WARNING, line);
+    }
+    Global::logger.log(WARNING, std::to_string(registry.size()) + " GL resources were never released.");
+    return (int)registry.size();
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+ * GpuResources.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the GL resource registry. Every buffer, texture,
+ *      renderbuffer, framebuffer, vertex array and shader program the
+ *      renderer creates goes through here and is remembered with its
+ *      owner and an estimate of the memory behind it, so the Memory
+ *      window can show where GPU memory goes and whatever is still
+ *      alive at shutdown is reported as a leak.
+ *
+ *      Sizes are what the renderer asked for (buffer sizes, texel
+ *      counts times texel size plus mip levels), not what the driver
+ *      actually reserves. Only call these on the GL thread.
+ *
+ *      GLuint buffer = resources::CreateBuffer("StreamBuffer");
+ *      glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+ *      resources::SetSize(resources::ResourceType::Buffer, buffer, size);
+ *      ...
+ *      resources::Delete(resources::ResourceType::Buffer, buffer);    // also zeroes "buffer"
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+namespace resources {
+
+enum class ResourceType {
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Framebuffer,
+    VertexArray,
+    Program,
+    COUNT
+};
+
+const char* ResourceTypeName(ResourceType type);
+
+struct GpuResource {
+    ResourceType type;
+    GLuint id;
+    size_t bytes;
+    const char* owner;      // string literal naming the class or file that created it
+    std::string label;      // optional detail, e.g. the file a texture came from
+};
+
+struct ResourceTotals {
+    int count[(int)ResourceType::COUNT] = {};
+    size_t bytes[(int)ResourceType::COUNT] = {};
+    int totalCount = 0;
+    size_t totalBytes = 0;
+};
+
+// glGen* plus registration
+GLuint CreateBuffer(const char* owner, const std::string& label = std::string());
+GLuint CreateTexture(const char* owner, const std::string& label = std::string());
+GLuint CreateRenderbuffer(const char* owner, const std::string& label = std::string());
+GLuint CreateFramebuffer(const char* owner, const std::string& label = std::string());
+GLuint CreateVertexArray(const char* owner, const std::string& label = std::string());
+
+// registration only, for objects created some other way (glCreateProgram)
+void Track(ResourceType type, GLuint id, const char* owner, const std::string& label = std::string());
+void Untrack(ResourceType type, GLuint id);
+
+// unregisters and deletes the object, then sets "id" to 0; nothing happens for 0
+void Delete(ResourceType type, GLuint& id);
+
+// memory behind the object, call again whenever it is reallocated
+void SetSize(ResourceType type, GLuint id, size_t bytes);
+// bytes of a width x height texture with "levels" mip levels (0 = the full chain)
+size_t TextureBytes(int width, int height, int bytesPerTexel, int levels = 1);
+
+ResourceTotals GetTotals();
+const std::vector<GpuResource>& GetResources();
+
+// logs every resource still registered as a leak, returns how many there were
+int ReportLeaks();
+
+}
@@ -0,0 +1,332 @@
+/*
+ * HiZBuffer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the Hi-Z occlusion pyramid. The
+ *      reduction runs as fullscreen fragment passes so it also works
+ *      on the GL 3.3 fallback path.
+ */
+
+#include "HiZBuffer.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+// widest level that gets downloaded for the CPU path
+const int READBACK_MAX_WIDTH = 160;
+
+int levelCount(int width, int height) {
+    return 1 + (int)std::floor(std::log2((float)std::max(width, height)));
+}
+
+}
+
+
+HiZBuffer::HiZBuffer()
+    : texture(0), width(0), height(0), levels(0), viewProjection(1.0f), valid(false),
+      readbackIndex(0), readbackLevel(0), cpuViewProjection(1.0f), cpuBaseWidth(0), cpuBaseHeight(0), cpuVersion(0) {
+
+    depthShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/hiz_depth.frag");
+    downsampleShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/hiz_downsample.frag");
+
+    fbo = resources::CreateFramebuffer("HiZBuffer");
+    emptyVAO = resources::CreateVertexArray("HiZBuffer", "fullscreen pass");
+    for (Readback& readback : readbacks)
+        readback.buffer = resources::CreateBuffer("HiZBuffer", "readback");
+}
+
+HiZBuffer::~HiZBuffer() {
+    for (Readback& readback : readbacks) {
+        if (readback.fence)
+            glDeleteSync(readback.fence);
+        resources::Delete(resources::ResourceType::Buffer, readback.buffer);
+    }
+    resources::Delete(resources::ResourceType::Texture, texture);
+    resources::Delete(resources::ResourceType::Framebuffer, fbo);
+    resources::Delete(resources::ResourceType::VertexArray, emptyVAO);
+
+    delete depthShader;
+    delete downsampleShader;
+}
+
+void HiZBuffer::resize(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    levels = levelCount(width, height);
+    valid = false;
+
+    resources::Delete(resources::ResourceType::Texture, texture);
+    texture = resources::CreateTexture("HiZBuffer", "depth pyramid");
+    resources::SetSize(resources::ResourceType::Texture, texture, resources::TextureBytes(width, height, 4, levels));
+    glBindTexture(GL_TEXTURE_2D, texture);
+    int w = width, h = height;
+    readbackLevel = levels - 1;
+    for (int level = 0; level < levels; level++) {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, w, h, 0, GL_RED, GL_FLOAT, NULL);
+        if (w <= READBACK_MAX_WIDTH && readbackLevel == levels - 1)
+            readbackLevel = level;
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // drop CPU data from the old size
+    cpuDepth.clear();
+    cpuLevels.clear();
+    cpuVersion++;
+    for (Readback& readback : readbacks) {
+        if (readback.fence)
+            glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+
+    Global::logger.log(INFO, "Hi-Z pyramid created (" + std::to_string(width) + "x" + std::to_string(height) + ", "
+            + std::to_string(levels) + " levels).");
+}
+
+void HiZBuffer::Build(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection) {
+    if (width != this->width || height != this->height)
+        resize(width, height);
+
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glBindVertexArray(emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    // level 0, copy of the depth attachment
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glViewport(0, 0, width, height);
+    depthShader->use();
+    depthShader->setInt("depthTexture", 0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // every other level reads the one before it, restricted through base/max level
+    downsampleShader->use();
+    downsampleShader->setInt("previousLevel", 0);
+    GLint previousSize = glGetUniformLocation(downsampleShader->ID, "previousSize");
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    int w = width, h = height;
+    for (int level = 1; level < levels; level++) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, level);
+
+        glUniform2i(previousSize, w, h);
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+        glViewport(0, 0, w, h);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    // queue the coarse level for the CPU path, picked up when the fence has passed
+    for (int i = 0; i < 2; i++)
+        collectReadback(readbacks[(readbackIndex + i) % 2]);     // oldest first
+
+    Readback& readback = readbacks[readbackIndex];
+    if (!readback.fence) {
+        readback.width = std::max(1, width >> readbackLevel);
+        readback.height = std::max(1, height >> readbackLevel);
+        readback.baseWidth = width;
+        readback.baseHeight = height;
+        readback.viewProjection = viewProjection;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, readback.width * readback.height * sizeof(float), NULL, GL_STREAM_READ);
+        resources::SetSize(resources::ResourceType::Buffer, readback.buffer, readback.width * readback.height * sizeof(float));
+        glGetTexImage(GL_TEXTURE_2D, readbackLevel, GL_RED, GL_FLOAT, (void*)0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readbackIndex = (readbackIndex + 1) % 2;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+
+    this->viewProjection = viewProjection;
+    valid = true;
+}
+
+void HiZBuffer::collectReadback(Readback& readback) {
+    if (!readback.fence)
+        return;
+
+    GLenum state = glClientWaitSync(readback.fence, 0, 0);
+    if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED)
+        return;
+
+    glDeleteSync(readback.fence);
+    readback.fence = nullptr;
+
+    // downloaded level first, then a small CPU mip chain on top of it
+    int w = readback.width, h = readback.height;
+    cpuDepth.resize(w * h);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, w * h * sizeof(float), cpuDepth.data());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    cpuLevels.clear();
+    cpuLevels.push_back({ w, h, readbackLevel, nullptr });
+    size_t offset = 0;
+    while (w > 1 || h > 1) {
+        int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+        size_t next = offset + w * h;
+        cpuDepth.resize(next + nw * nh, 0.0f);
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                // odd leftovers fold into the last texel, same as the GPU pass
+                int tx = std::min(x / 2, nw - 1), ty = std::min(y / 2, nh - 1);
+                float& target = cpuDepth[next + ty * nw + tx];
+                target = std::max(target, cpuDepth[offset + y * w + x]);
+            }
+        }
+        cpuLevels.push_back({ nw, nh, cpuLevels.back().shift + 1, nullptr });
+        offset = next;
+        w = nw;
+        h = nh;
+    }
+
+    // the data only stops moving once every level is in place
+    offset = 0;
+    for (DepthLevel& level : cpuLevels) {
+        level.data = cpuDepth.data() + offset;
+        offset += level.width * level.height;
+    }
+
+    cpuViewProjection = readback.viewProjection;
+    cpuBaseWidth = readback.baseWidth;
+    cpuBaseHeight = readback.baseHeight;
+    cpuVersion++;
+}
+
+bool HiZBuffer::TestOcclusion(const AABB& box, const glm::mat4& viewProjection, int width, int height,
+        const std::vector<DepthLevel>& levels) {
+
+    glm::vec2 ndcMin(std::numeric_limits<float>::max());
+    glm::vec2 ndcMax(-std::numeric_limits<float>::max());
+    float nearestDepth = 1.0f;
+
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner((i & 1) ? box.max.x : box.min.x,
+                         (i & 2) ? box.max.y : box.min.y,
+                         (i & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+
+        // crosses the camera plane, the projection is meaningless
+        if (clip.w <= 0.0f)
+            return false;
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    glm::vec2 size((float)width, (float)height);
+    glm::vec2 pixelMin = glm::clamp(ndcMin * 0.5f + 0.5f, 0.0f, 1.0f) * size;
+    glm::vec2 pixelMax = glm::clamp(ndcMax * 0.5f + 0.5f, 0.0f, 1.0f) * size;
+
+    // finest level where the footprint spans at most two texels per axis
+    float extent = std::max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y);
+    int wanted = (int)std::ceil(std::log2(std::max(extent, 1.0f)));
+
+    const DepthLevel* level = &levels.back();
+    for (const DepthLevel& candidate : levels) {
+        if (candidate.shift >= wanted) {
+            level = &candidate;
+            break;
+        }
+    }
+
+    int x0 = std::min((int)pixelMin.x >> level->shift, level->width - 1);
+    int y0 = std::min((int)pixelMin.y >> level->shift, level->height - 1);
+    int x1 = std::min((int)pixelMax.x >> level->shift, level->width - 1);
+    int y1 = std::min((int)pixelMax.y >> level->shift, level->height - 1);
+
+    float farthest = 0.0f;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++)
+            farthest = std::max(farthest, level->data[y * level->width + x]);
+    }
+
+    return nearestDepth > farthest;
+}
+
+bool HiZBuffer::IsOccluded(const AABB& box) const {
+    if (cpuLevels.empty())
+        return false;
+
+    return TestOcclusion(box, cpuViewProjection, cpuBaseWidth, cpuBaseHeight, cpuLevels);
+}
+
+int HiZBuffer::GetCpuVersion() const {
+    return cpuVersion;
+}
+
+void HiZBuffer::CopyCpuPyramid(CpuPyramid& out) const {
+    out.depth = cpuDepth;
+    out.levels = cpuLevels;
+    for (DepthLevel& level : out.levels)
+        level.data = out.depth.data() + (level.data - cpuDepth.data());
+
+    out.viewProjection = cpuViewProjection;
+    out.baseWidth = cpuBaseWidth;
+    out.baseHeight = cpuBaseHeight;
+}
+
+bool HiZBuffer::CpuPyramid::IsOccluded(const AABB& box) const {
+    if (levels.empty())
+        return false;
+
+    return TestOcclusion(box, viewProjection, baseWidth, baseHeight, levels);
+}
+
+bool HiZBuffer::IsValid() const {
+    return valid;
+}
+
+GLuint HiZBuffer::GetTexture() const {
+    return texture;
+}
+
+int HiZBuffer::GetWidth() const {
+    return width;
+}
+
+int HiZBuffer::GetHeight() const {
+    return height;
+}
+
+int HiZBuffer::GetLevels() const {
+    return levels;
+}
+
+const glm::mat4& HiZBuffer::GetViewProjection() const {
+    return viewProjection;
+}
@@ -0,0 +1,116 @@
+/*
+ * HiZBuffer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the hierarchical depth (Hi-Z) pyramid used
+ *      for occlusion culling. After the scene is drawn the depth
+ *      attachment is reduced into a mip chain where every texel holds
+ *      the farthest depth below it. Next frame objects are projected
+ *      with the matrix that produced the pyramid (so camera movement
+ *      is reprojected) and rejected when they lie behind it.
+ *
+ *      The GPU-driven path samples the pyramid directly in cull.comp,
+ *      the CPU path tests against a coarse level that is downloaded
+ *      asynchronously, so neither ever waits on the GPU.
+ */
+
+#pragma once
+
+#include "Bounds.h"
+#include "Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+class HiZBuffer {
+
+public:
+    HiZBuffer();
+    ~HiZBuffer();
+
+    // rebuilds the pyramid from the scene depth that was rendered with "viewProjection",
+    // the bound framebuffer and viewport are restored afterwards
+    void Build(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection);
+
+    // CPU test against the most recent downloaded level, false while none has arrived
+    bool IsOccluded(const AABB& box) const;
+
+    bool IsValid() const;
+    GLuint GetTexture() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetLevels() const;
+    // the matrix the pyramid was built with, used to reproject current bounds
+    const glm::mat4& GetViewProjection() const;
+
+    // one level of depth data on the CPU
+    struct DepthLevel {
+        int width;
+        int height;
+        int shift;          // level 0 pixel coordinates are shifted right by this to address the level
+        const float* data;
+    };
+
+    // conservative test of "box" against a depth pyramid of a width x height target,
+    // shared by the CPU path and mirrored by occluded() in cull.comp
+    static bool TestOcclusion(const AABB& box, const glm::mat4& viewProjection, int width, int height,
+            const std::vector<DepthLevel>& levels);
+
+    // private copy of the downloaded levels, so another thread can keep testing against
+    // them while the render thread collects the next readback
+    struct CpuPyramid {
+        std::vector<float> depth;
+        std::vector<DepthLevel> levels;
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+        int baseWidth = 0;
+        int baseHeight = 0;
+
+        bool IsOccluded(const AABB& box) const;
+    };
+
+    // bumps whenever a new level has been downloaded
+    int GetCpuVersion() const;
+    void CopyCpuPyramid(CpuPyramid& out) const;
+
+private:
+    struct Readback {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        glm::mat4 viewProjection;
+        int width = 0;
+        int height = 0;
+        int baseWidth = 0;
+        int baseHeight = 0;
+    };
+
+    Shader* depthShader;
+    Shader* downsampleShader;
+
+    GLuint texture;
+    GLuint fbo;
+    GLuint emptyVAO;
+    int width;
+    int height;
+    int levels;
+    glm::mat4 viewProjection;
+    bool valid;
+
+    // coarse level kept on the CPU for the non GPU-driven path
+    Readback readbacks[2];
+    int readbackIndex;
+    int readbackLevel;
+    std::vector<float> cpuDepth;
+    std::vector<DepthLevel> cpuLevels;
+    glm::mat4 cpuViewProjection;
+    int cpuBaseWidth;
+    int cpuBaseHeight;
+    int cpuVersion;
+
+    void resize(int newWidth, int newHeight);
+    void collectReadback(Readback& readback);
+};
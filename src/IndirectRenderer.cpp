@@ -0,0 +1,340 @@
+/*
+ * IndirectRenderer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the GPU-driven render path.
+ *      With GL 4.6 the cull shader compacts visible commands and the
+ *      draw count is sourced from the counter buffer; on 4.3-4.5 every
+ *      object keeps its own command and culled ones get zero instances.
+ */
+
+#include "IndirectRenderer.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+
+
+namespace {
+
+// matches DrawCommand in cull.comp
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+// matches Counter in cull.comp
+struct CullCounters {
+    GLuint visible;
+    GLuint occluded;
+    GLuint triangles;
+};
+
+const int CULL_GROUP_SIZE = 64;
+const int HIZ_TEXTURE_UNIT = 2;
+
+}
+
+
+bool IndirectRenderer::IsSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+IndirectRenderer::IndirectRenderer(GLuint vertexBuffer, GLuint indexBuffer, const std::vector<LODLevel>& levels)
+    : readbackFence{ nullptr, nullptr }, frameIndex(0), lodEnabled(true),
+      objectCount(0), capacity(0), visibleCount(0), occludedCount(0), triangleCount(0) {
+
+    compact = GLAD_GL_VERSION_4_6;
+
+    cullShader = new Shader("src/shaders/cull.comp");
+    drawShader = new Shader("src/shaders/indirect.vert", "src/shaders/indirect.frag");
+
+    objectBuffer = resources::CreateBuffer("IndirectRenderer", "objects");
+    commandBuffer = resources::CreateBuffer("IndirectRenderer", "draw commands");
+    counterBuffer = resources::CreateBuffer("IndirectRenderer", "counters");
+    objectIDBuffer = resources::CreateBuffer("IndirectRenderer", "object ids");
+    objectLODBuffer = resources::CreateBuffer("IndirectRenderer", "object LOD levels");
+    for (GLuint& buffer : readbackBuffer)
+        buffer = resources::CreateBuffer("IndirectRenderer", "counter readback");
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CullCounters), NULL, GL_DYNAMIC_DRAW);
+    resources::SetSize(resources::ResourceType::Buffer, counterBuffer, sizeof(CullCounters));
+    for (GLuint buffer : readbackBuffer) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(CullCounters), NULL, GL_STREAM_READ);
+        resources::SetSize(resources::ResourceType::Buffer, buffer, sizeof(CullCounters));
+    }
+
+    // same vertex layout as the CPU path plus the per-instance object id
+    vao = resources::CreateVertexArray("IndirectRenderer");
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, objectIDBuffer);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    SetMesh(vertexBuffer, indexBuffer, levels);
+
+    drawShader->use();
+    drawShader->setInt("texture1", 0);
+    drawShader->setInt("texture2", 1);
+
+    Global::logger.log(INFO, compact ? "GPU-driven path ready (compacted, indirect count)."
+                                     : "GPU-driven path ready (one command per object).");
+}
+
+IndirectRenderer::~IndirectRenderer() {
+    for (GLsync& fence : readbackFence) {
+        if (fence)
+            glDeleteSync(fence);
+    }
+    resources::Delete(resources::ResourceType::VertexArray, vao);
+    resources::Delete(resources::ResourceType::Buffer, objectBuffer);
+    resources::Delete(resources::ResourceType::Buffer, commandBuffer);
+    resources::Delete(resources::ResourceType::Buffer, counterBuffer);
+    resources::Delete(resources::ResourceType::Buffer, objectIDBuffer);
+    resources::Delete(resources::ResourceType::Buffer, objectLODBuffer);
+    for (GLuint& buffer : readbackBuffer)
+        resources::Delete(resources::ResourceType::Buffer, buffer);
+
+    delete cullShader;
+    delete drawShader;
+}
+
+void IndirectRenderer::SetMesh(GLuint vertexBuffer, GLuint indexBuffer, const std::vector<LODLevel>& levels) {
+    this->levels.assign(levels.begin(), levels.begin() + std::min((int)levels.size(), LODMesh::MAX_LEVELS));
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void IndirectRenderer::SetLODEnabled(bool enabled) {
+    lodEnabled = enabled;
+}
+
+void IndirectRenderer::SetObjects(const std::vector<glm::mat4>& models, const std::vector<AABB>& bounds) {
+    objectCount = (int)models.size();
+
+    std::vector<GpuObject> objects(objectCount);
+    for (int i = 0; i < objectCount; i++) {
+        objects[i].model = models[i];
+        objects[i].boundsMin = glm::vec4(bounds[i].min, 1.0f);
+        objects[i].boundsMax = glm::vec4(bounds[i].max, 1.0f);
+    }
+
+    if (objectCount > capacity) {
+        capacity = objectCount;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(GpuObject), NULL, GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+        // object ids never change, the instanced attribute just counts up
+        std::vector<GLuint> ids(capacity);
+        for (int i = 0; i < capacity; i++)
+            ids[i] = i;
+        glBindBuffer(GL_ARRAY_BUFFER, objectIDBuffer);
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(GLuint), ids.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        resources::SetSize(resources::ResourceType::Buffer, objectBuffer, capacity * sizeof(GpuObject));
+        resources::SetSize(resources::ResourceType::Buffer, commandBuffer, capacity * sizeof(DrawElementsIndirectCommand));
+        resources::SetSize(resources::ResourceType::Buffer, objectIDBuffer, capacity * sizeof(GLuint));
+        resources::SetSize(resources::ResourceType::Buffer, objectLODBuffer, capacity * sizeof(GLuint));
+    }
+
+    // new objects start at full detail
+    std::vector<GLuint> objectLevels(capacity, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectLODBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(GLuint), objectLevels.data(), GL_DYNAMIC_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, objectCount * sizeof(GpuObject), objects.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void IndirectRenderer::UpdateObject(int id, const glm::mat4& model, const AABB& bounds) {
+    GpuObject object = { model, glm::vec4(bounds.min, 1.0f), glm::vec4(bounds.max, 1.0f) };
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, id * sizeof(GpuObject), sizeof(GpuObject), &object);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void IndirectRenderer::UpdateObjects(const std::vector<int>& ids, const std::vector<glm::mat4>& models,
+        const std::vector<AABB>& bounds, StreamBuffer& stream) {
+    if (ids.empty())
+        return;
+
+    GLintptr offset;
+    GpuObject* staged = (GpuObject*)stream.Allocate(UploadSize((int)ids.size()), sizeof(glm::vec4), offset);
+    if (!staged) {
+        for (size_t i = 0; i < ids.size(); i++)
+            UpdateObject(ids[i], models[i], bounds[i]);
+        return;
+    }
+
+    for (size_t i = 0; i < ids.size(); i++)
+        staged[i] = { models[i], glm::vec4(bounds[i].min, 1.0f), glm::vec4(bounds[i].max, 1.0f) };
+    stream.Flush();
+
+    // GPU side copies, ordered with the draws that use the objects instead of stalling on them
+    glBindBuffer(GL_COPY_READ_BUFFER, stream.GetBuffer());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, objectBuffer);
+    for (size_t i = 0; i < ids.size(); i++) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                offset + i * sizeof(GpuObject), ids[i] * sizeof(GpuObject), sizeof(GpuObject));
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+GLsizeiptr IndirectRenderer::UploadSize(int count) {
+    return count * sizeof(GpuObject);
+}
+
+void IndirectRenderer::Draw(const glm::mat4& projection, const glm::mat4& view, int pickedObject, const HiZBuffer* hiZ) {
+    if (objectCount == 0)
+        return;
+
+    collectReadback(frameIndex);
+
+    // 1. cull, the counter doubles as compaction cursor and visible statistic
+    CullCounters zero = { 0, 0, 0 };
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullCounters), &zero);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, counterBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectLODBuffer);
+
+    Frustum frustum(projection * view);
+    cullShader->use();
+    glUniform4fv(glGetUniformLocation(cullShader->ID, "frustumPlanes"), 6, glm::value_ptr(frustum.Planes[0]));
+    glUniform1ui(glGetUniformLocation(cullShader->ID, "objectCount"), objectCount);
+    cullShader->setBool("compact", compact);
+
+    // pad the chain to the shader's array size, unused levels repeat the last one
+    GLuint firstIndex[LODMesh::MAX_LEVELS];
+    GLuint indexCount[LODMesh::MAX_LEVELS];
+    float thresholds[LODMesh::MAX_LEVELS];
+    for (int i = 0; i < LODMesh::MAX_LEVELS; i++) {
+        const LODLevel& level = levels[std::min(i, (int)levels.size() - 1)];
+        firstIndex[i] = level.firstIndex;
+        indexCount[i] = level.indexCount;
+        thresholds[i] = LODMesh::LevelThreshold(i);
+    }
+    cullShader->setInt("lodCount", lodEnabled ? (int)levels.size() : 1);
+    glUniform1uiv(glGetUniformLocation(cullShader->ID, "lodFirstIndex"), LODMesh::MAX_LEVELS, firstIndex);
+    glUniform1uiv(glGetUniformLocation(cullShader->ID, "lodIndexCount"), LODMesh::MAX_LEVELS, indexCount);
+    glUniform1fv(glGetUniformLocation(cullShader->ID, "lodThresholds"), LODMesh::MAX_LEVELS, thresholds);
+    cullShader->setFloat("lodHysteresis", LODMesh::Hysteresis());
+    cullShader->setVec3("cameraPosition", glm::vec3(glm::inverse(view)[3]));
+    cullShader->setFloat("lodScale", projection[1][1]);
+
+    bool occlusion = hiZ && hiZ->IsValid();
+    cullShader->setBool("occlusionEnabled", occlusion);
+    if (occlusion) {
+        glActiveTexture(GL_TEXTURE0 + HIZ_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_2D, hiZ->GetTexture());
+        glActiveTexture(GL_TEXTURE0);
+        cullShader->setInt("hiZ", HIZ_TEXTURE_UNIT);
+        cullShader->setMat4("previousViewProjection", hiZ->GetViewProjection());
+        cullShader->setVec2("hiZSize", (float)hiZ->GetWidth(), (float)hiZ->GetHeight());
+        cullShader->setInt("hiZLevels", hiZ->GetLevels());
+    }
+    glDispatchCompute((objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // 2. the commands and the count are consumed as indirect arguments
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    drawShader->use();
+    drawShader->setMat4("projection", projection);
+    drawShader->setMat4("view", view);
+    drawShader->setInt("pickedObject", pickedObject);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    if (compact) {
+        glBindBuffer(GL_PARAMETER_BUFFER, counterBuffer);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, 0, 0, objectCount, 0);
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    } else {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, objectCount, 0);
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // 3. queue the counters for readback once the GPU gets there
+    glBindBuffer(GL_COPY_READ_BUFFER, counterBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffer[frameIndex]);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(CullCounters));
+    readbackFence[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    frameIndex = (frameIndex + 1) % 2;
+}
+
+void IndirectRenderer::collectReadback(int slot) {
+    if (!readbackFence[slot])
+        return;
+
+    // never block, if the GPU is still behind keep showing the older value
+    GLenum state = glClientWaitSync(readbackFence[slot], 0, 0);
+    if (state != GL_ALREADY_SIGNALED && state != GL_CONDITION_SATISFIED) {
+        glDeleteSync(readbackFence[slot]);
+        readbackFence[slot] = nullptr;
+        return;
+    }
+
+    CullCounters counters = { 0, 0, 0 };
+    glBindBuffer(GL_COPY_READ_BUFFER, readbackBuffer[slot]);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(CullCounters), &counters);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    visibleCount = (int)counters.visible;
+    occludedCount = (int)counters.occluded;
+    triangleCount = (int)counters.triangles;
+
+    glDeleteSync(readbackFence[slot]);
+    readbackFence[slot] = nullptr;
+}
+
+int IndirectRenderer::GetVisibleCount() const {
+    return visibleCount;
+}
+
+int IndirectRenderer::GetOccludedCount() const {
+    return occludedCount;
+}
+
+int IndirectRenderer::GetTriangleCount() const {
+    return triangleCount;
+}
+
+bool IndirectRenderer::IsCompacting() const {
+    return compact;
+}
@@ -0,0 +1,97 @@
+/*
+ * IndirectRenderer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the GPU-driven render path (GL 4.3+).
+ *      Every object's model matrix and bounds live in an SSBO, a
+ *      compute shader frustum culls them and writes one
+ *      DrawElementsIndirectCommand per object, and the whole scene
+ *      is drawn with a single glMultiDrawElementsIndirect call.
+ */
+
+#pragma once
+
+#include "Bounds.h"
+#include "HiZBuffer.h"
+#include "LODMesh.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+class IndirectRenderer {
+
+public:
+    // true when the current context exposes compute shaders, SSBOs and MDI
+    static bool IsSupported();
+
+    // the renderer draws the indexed mesh stored in vertexBuffer/indexBuffer
+    // (position + texture coordinate, 5 floats per vertex), "levels" is its LOD chain
+    IndirectRenderer(GLuint vertexBuffer, GLuint indexBuffer, const std::vector<LODLevel>& levels);
+    ~IndirectRenderer();
+
+    // switches every object to another mesh, the vertex layout must stay the same
+    void SetMesh(GLuint vertexBuffer, GLuint indexBuffer, const std::vector<LODLevel>& levels);
+    // with LOD off every object is drawn with level 0
+    void SetLODEnabled(bool enabled);
+
+    // uploads every object, call whenever objects are added or removed
+    void SetObjects(const std::vector<glm::mat4>& models, const std::vector<AABB>& bounds);
+    // re-uploads a single object after it moved
+    void UpdateObject(int id, const glm::mat4& model, const AABB& bounds);
+    // re-uploads every moved object through the frame's stream buffer, no implicit sync
+    void UpdateObjects(const std::vector<int>& ids, const std::vector<glm::mat4>& models,
+            const std::vector<AABB>& bounds, StreamBuffer& stream);
+    // stream buffer space UpdateObjects() takes for "count" objects
+    static GLsizeiptr UploadSize(int count);
+
+    // culls on the GPU and draws every visible object, textures must already be bound
+    // objects are also occlusion tested when a valid Hi-Z pyramid is passed
+    void Draw(const glm::mat4& projection, const glm::mat4& view, int pickedObject, const HiZBuffer* hiZ = nullptr);
+
+    // visible/occluded objects and submitted triangles from the last frame whose result reached the CPU
+    int GetVisibleCount() const;
+    int GetOccludedCount() const;
+    int GetTriangleCount() const;
+    bool IsCompacting() const;
+
+private:
+    // matches ObjectData in cull.comp and indirect.vert (std430)
+    struct GpuObject {
+        glm::mat4 model;
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+    };
+
+    Shader* cullShader;
+    Shader* drawShader;
+
+    GLuint vao;
+    GLuint objectBuffer;
+    GLuint commandBuffer;
+    GLuint counterBuffer;
+    GLuint objectIDBuffer;
+    GLuint objectLODBuffer;
+
+    // the counters are copied here and read back a frame later to avoid stalling
+    GLuint readbackBuffer[2];
+    GLsync readbackFence[2];
+    int frameIndex;
+
+    std::vector<LODLevel> levels;
+    bool lodEnabled;
+    int objectCount;
+    int capacity;
+    int visibleCount;
+    int occludedCount;
+    int triangleCount;
+    bool compact;
+
+    void collectReadback(int slot);
+};
@@ -0,0 +1,261 @@
+/*
+ * InputRecorder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the camera input recorder.
+ */
+
+#include "InputRecorder.h"
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+InputRecorder GlobalInput::recorder;
+
+
+namespace {
+
+// file layout: header, starting camera state, then eventCount events, all little-endian as
+// written by the machine that recorded it
+const char FILE_MAGIC[4] = { 'R', 'C', 'A', 'M' };
+const uint32_t FILE_VERSION = 1;
+// a recording this long never grows the event list mid-frame
+const size_t RESERVED_EVENTS = 64 * 1024;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t eventCount;
+};
+
+const Camera_Movement MOVEMENTS[] = { FORWARD, BACKWARD, LEFT, RIGHT, UP, DOWN };
+
+}
+
+
+void ApplyCameraKeys(Camera& camera, uint8_t keys, float deltaTime) {
+    if (keys & INPUT_KEY_FAST)
+        deltaTime *= 5;
+    if (keys & INPUT_KEY_SLOW)
+        deltaTime /= 5;
+
+    for (Camera_Movement direction : MOVEMENTS) {
+        if (keys & InputKeyBit(direction))
+            camera.ProcessKeyboard(direction, deltaTime);
+    }
+}
+
+
+InputRecorder::InputRecorder()
+    : recording(false), replaying(false), lastKeys(0), start(), nextEvent(0), replayTime(0.0), replayStep(0.0f), replayKeys(0) {
+}
+
+InputRecorder::CameraState InputRecorder::captureCamera(const Camera& camera) {
+    CameraState state;
+    state.position[0] = camera.Position.x;
+    state.position[1] = camera.Position.y;
+    state.position[2] = camera.Position.z;
+    state.yaw = camera.Yaw;
+    state.pitch = camera.Pitch;
+    state.zoom = camera.Zoom;
+    state.movementSpeed = camera.MovementSpeed;
+    state.mouseSensitivity = camera.MouseSensitivity;
+    return state;
+}
+
+void InputRecorder::restoreCamera(const CameraState& state, Camera& camera) {
+    camera.Position = glm::vec3(state.position[0], state.position[1], state.position[2]);
+    camera.Zoom = state.zoom;
+    camera.MovementSpeed = state.movementSpeed;
+    camera.MouseSensitivity = state.mouseSensitivity;
+    camera.SetOrientation(state.yaw, state.pitch);
+}
+
+float InputRecorder::secondsSinceStart() const {
+    return std::chrono::duration<float>(Clock::now() - recordStart).count();
+}
+
+
+void InputRecorder::StartRecording(const Camera& camera) {
+    StopReplay();
+    events.clear();
+    events.reserve(RESERVED_EVENTS);
+    start = captureCamera(camera);
+    recordStart = Clock::now();
+    lastKeys = 0;
+    recording = true;
+    Global::logger.log(INFO, "Camera input recording started.");
+}
+
+bool InputRecorder::StopRecording(const std::string& path) {
+    if (!recording)
+        return false;
+    recording = false;
+
+    // releases whatever is still held and marks the end, so a replay also lasts as long
+    InputEvent end = {};
+    end.time = secondsSinceStart();
+    end.type = EVENT_KEYS;
+    events.push_back(end);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        Global::logger.log(ERROR, "Unable to write camera input recording to " + path + ".");
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.eventCount = (uint32_t)events.size();
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(&start, sizeof(start), 1, file) == 1
+            && fwrite(events.data(), sizeof(InputEvent), events.size(), file) == events.size();
+    fclose(file);
+
+    if (!written) {
+        Global::logger.log(ERROR, "Unable to write camera input recording to " + path + ".");
+        return false;
+    }
+    Global::logger.log(INFO, "Camera input recording (" + std::to_string(events.size()) + " events) written to " + path + ".");
+    return true;
+}
+
+bool InputRecorder::IsRecording() const {
+    return recording;
+}
+
+void InputRecorder::RecordKeys(uint8_t keys) {
+    if (!recording || keys == lastKeys)
+        return;
+    lastKeys = keys;
+
+    InputEvent event = {};
+    event.time = secondsSinceStart();
+    event.type = EVENT_KEYS;
+    event.keys = keys;
+    events.push_back(event);
+}
+
+void InputRecorder::RecordMouse(float xoffset, float yoffset) {
+    if (!recording)
+        return;
+
+    InputEvent event = {};
+    event.time = secondsSinceStart();
+    event.type = EVENT_MOUSE;
+    event.x = xoffset;
+    event.y = yoffset;
+    events.push_back(event);
+}
+
+void InputRecorder::RecordScroll(float yoffset) {
+    if (!recording)
+        return;
+
+    InputEvent event = {};
+    event.time = secondsSinceStart();
+    event.type = EVENT_SCROLL;
+    event.y = yoffset;
+    events.push_back(event);
+}
+
+
+bool InputRecorder::StartReplay(const std::string& path, Camera& camera, float step) {
+    recording = false;
+    replaying = false;
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        Global::logger.log(ERROR, "Unable to read camera input recording " + path + ".");
+        return false;
+    }
+
+    FileHeader header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1
+            && std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0
+            && header.version == FILE_VERSION
+            && fread(&start, sizeof(start), 1, file) == 1;
+    // the events have to fill the rest of the file exactly, a damaged count must not size the vector
+    if (valid) {
+        long eventsAt = ftell(file);
+        valid = eventsAt >= 0 && fseek(file, 0, SEEK_END) == 0;
+        long end = valid ? ftell(file) : -1;
+        valid = valid && end >= eventsAt && fseek(file, eventsAt, SEEK_SET) == 0
+                && (unsigned long long)(end - eventsAt) == (unsigned long long)header.eventCount * sizeof(InputEvent);
+    }
+    if (valid) {
+        events.resize(header.eventCount);
+        valid = fread(events.data(), sizeof(InputEvent), events.size(), file) == events.size();
+    }
+    fclose(file);
+
+    if (!valid) {
+        events.clear();
+        Global::logger.log(ERROR, path + " isn't a camera input recording.");
+        return false;
+    }
+
+    restoreCamera(start, camera);
+    nextEvent = 0;
+    replayTime = 0.0;
+    replayStep = step > 0.0f ? step : 1.0f / 60.0f;
+    replayKeys = 0;
+    replaying = true;
+    Global::logger.log(INFO, "Replaying " + path + " (" + std::to_string(events.size()) + " events).");
+    return true;
+}
+
+bool InputRecorder::Step(Camera& camera) {
+    if (!replaying)
+        return false;
+    if (nextEvent >= events.size()) {
+        StopReplay();
+        return false;
+    }
+
+    // everything that happened up to the end of this step, then the movement of the held keys
+    replayTime += replayStep;
+    while (nextEvent < events.size() && events[nextEvent].time <= replayTime) {
+        const InputEvent& event = events[nextEvent++];
+        if (event.type == EVENT_KEYS)
+            replayKeys = event.keys;
+        else if (event.type == EVENT_MOUSE)
+            camera.ProcessMouseMovement(event.x, event.y);
+        else if (event.type == EVENT_SCROLL)
+            camera.ProcessMouseScroll(event.y);
+    }
+    ApplyCameraKeys(camera, replayKeys, replayStep);
+    return true;
+}
+
+void InputRecorder::StopReplay() {
+    if (replaying)
+        Global::logger.log(INFO, "Camera input replay finished.");
+    replaying = false;
+}
+
+bool InputRecorder::IsReplaying() const {
+    return replaying;
+}
+
+float InputRecorder::GetReplayStep() const {
+    return replayStep;
+}
+
+float InputRecorder::GetReplayProgress() const {
+    if (!replaying || events.empty())
+        return 0.0f;
+    return events.back().time > 0.0f ? std::min(1.0f, (float)(replayTime / events.back().time)) : 1.0f;
+}
+
+int InputRecorder::GetEventCount() const {
+    return (int)events.size();
+}
@@ -0,0 +1,130 @@
+/*
+ * InputRecorder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the camera input recorder. While recording it
+ *      keeps every camera input the application applies (the held
+ *      movement keys whenever they change, mouse look offsets and
+ *      scroll steps) with its time since the recording started, and
+ *      writes them to a small binary file together with the camera
+ *      state they started from.
+ *
+ *      Replaying puts the camera back into that state and advances
+ *      the recording by a fixed step per frame instead of the wall
+ *      clock, so the camera path depends only on the file and the
+ *      step: two replays at any frame rate see the same camera in
+ *      the same frame.
+ *
+ *      GlobalInput::recorder.StartReplay("camera.rec", GlobalCamera::camera, 1.0f / 60.0f);
+ *      ...
+ *      if (!GlobalInput::recorder.Step(GlobalCamera::camera))   // once per frame
+ *          ...                                                  // replay finished
+ */
+
+#pragma once
+
+#include "Camera.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// recording file of the Controls window, and of --record when the application exits mid-recording
+const char* const DEFAULT_INPUT_RECORDING = "camera_input.rec";
+
+// held camera keys as one bit per Camera_Movement plus the speed modifiers
+const uint8_t INPUT_KEY_FAST = 1 << 6;     // left shift, five times the speed
+const uint8_t INPUT_KEY_SLOW = 1 << 7;     // left control, a fifth of the speed
+
+inline uint8_t InputKeyBit(Camera_Movement direction) {
+    return (uint8_t)(1 << direction);
+}
+
+// moves the camera for the held keys over "deltaTime" seconds, live input and replay both go through here
+void ApplyCameraKeys(Camera& camera, uint8_t keys, float deltaTime);
+
+
+class InputRecorder {
+
+public:
+    InputRecorder();
+
+    // starts a new recording from the camera's current state, replaces one in progress
+    void StartRecording(const Camera& camera);
+    // writes the recording to "path", false when the file can't be written
+    bool StopRecording(const std::string& path);
+    bool IsRecording() const;
+
+    // live input, recorded only while recording; keys are recorded when they change
+    void RecordKeys(uint8_t keys);
+    void RecordMouse(float xoffset, float yoffset);
+    void RecordScroll(float yoffset);
+
+    // loads "path" and moves the camera to where the recording started, false when it
+    // can't be read; every Step() then advances the recording by "step" seconds
+    bool StartReplay(const std::string& path, Camera& camera, float step);
+    // applies the next step of the replay, false once it has run out
+    bool Step(Camera& camera);
+    void StopReplay();
+    bool IsReplaying() const;
+    float GetReplayStep() const;
+    // 0 to 1 through the replay
+    float GetReplayProgress() const;
+
+    int GetEventCount() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum EventType : uint8_t {
+        EVENT_KEYS,
+        EVENT_MOUSE,
+        EVENT_SCROLL
+    };
+
+    // written to the file as is, 16 bytes
+    struct InputEvent {
+        float time;         // seconds since the recording started
+        EventType type;
+        uint8_t keys;       // EVENT_KEYS
+        uint16_t reserved;
+        float x, y;         // EVENT_MOUSE offsets, EVENT_SCROLL uses y
+    };
+    static_assert(sizeof(InputEvent) == 16, "InputEvent is written to the file as is");
+
+    // camera state the recording starts from
+    struct CameraState {
+        float position[3];
+        float yaw, pitch, zoom;
+        float movementSpeed, mouseSensitivity;
+    };
+
+    static CameraState captureCamera(const Camera& camera);
+    static void restoreCamera(const CameraState& state, Camera& camera);
+    float secondsSinceStart() const;
+
+    bool recording;
+    bool replaying;
+    Clock::time_point recordStart;
+    uint8_t lastKeys;
+
+    CameraState start;
+    std::vector<InputEvent> events;
+
+    // replay
+    size_t nextEvent;
+    double replayTime;
+    float replayStep;
+    uint8_t replayKeys;
+};
+
+
+// CREATE GLOBAL INSTANCE OF THE RECORDER
+class GlobalInput {
+public:
+    static InputRecorder recorder;
+};
@@ -0,0 +1,394 @@
+/*
+ * LODMesh.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for LOD meshes. The simplifier follows
+ *      Garland and Heckbert's quadric error metric but only collapses
+ *      an edge onto one of its existing endpoints, which is what lets
+ *      every level share a single vertex buffer.
+ */
+
+#include "LODMesh.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+
+namespace {
+
+const float LOD_BASE_SIZE = 0.25f;      // level 0 while the object covers a quarter of the screen height
+const float LOD_HYSTERESIS = 0.15f;
+const float LOD_REDUCTION = 0.5f;       // each level aims for half the triangles of the previous one
+const float LOD_MAX_ERROR = 0.1f;       // relative to the mesh radius
+const float MIN_FLIP_DOT = 0.2f;        // reject collapses that turn a face by more than ~78 degrees
+
+
+// symmetric 4x4 matrix, the sum of squared distances to a set of planes
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0;
+    double b2 = 0, bc = 0, bd = 0;
+    double c2 = 0, cd = 0;
+    double d2 = 0;
+    double weight = 0;
+
+    static Quadric FromPlane(const glm::dvec3& normal, double d, double weight) {
+        Quadric q;
+        q.a2 = normal.x * normal.x * weight; q.ab = normal.x * normal.y * weight;
+        q.ac = normal.x * normal.z * weight; q.ad = normal.x * d * weight;
+        q.b2 = normal.y * normal.y * weight; q.bc = normal.y * normal.z * weight;
+        q.bd = normal.y * d * weight;
+        q.c2 = normal.z * normal.z * weight; q.cd = normal.z * d * weight;
+        q.d2 = d * d * weight;
+        q.weight = weight;
+        return q;
+    }
+
+    void Add(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+    }
+
+    // area weighted mean squared distance of p to the planes
+    double Evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                     + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                     + c2 * z * z + 2 * cd * z
+                     + d2;
+        return weight > 0 ? std::fabs(error) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    unsigned int from;
+    unsigned int to;
+    double cost;
+};
+
+glm::vec3 triangleNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    return glm::cross(b - a, c - a);
+}
+
+// vertices sharing a position (texture seams) get the same id
+std::vector<unsigned int> weldPositions(const std::vector<MeshVertex>& vertices) {
+    std::vector<unsigned int> order(vertices.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (unsigned int)i;
+
+    auto less = [&](unsigned int l, unsigned int r) {
+        const glm::vec3& a = vertices[l].position;
+        const glm::vec3& b = vertices[r].position;
+        if (a.x != b.x) return a.x < b.x;
+        if (a.y != b.y) return a.y < b.y;
+        return a.z < b.z;
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<unsigned int> weld(vertices.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        bool same = i > 0 && vertices[order[i]].position == vertices[order[i - 1]].position;
+        weld[order[i]] = same ? weld[order[i - 1]] : order[i];
+    }
+    return weld;
+}
+
+}
+
+
+std::vector<unsigned int> SimplifyMesh(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices,
+        size_t targetIndexCount, float maxError, float* resultError) {
+
+    size_t vertexCount = vertices.size();
+    std::vector<unsigned int> triangles = indices;
+    if (resultError)
+        *resultError = 0.0f;
+    if (triangles.size() <= targetIndexCount)
+        return triangles;
+
+    AABB meshBounds;
+    for (const MeshVertex& vertex : vertices)
+        meshBounds.Expand(vertex.position);
+    double radius = glm::length(meshBounds.Extent()) * 0.5;
+    double maxCost = (maxError * radius) * (maxError * radius);
+
+    // seam vertices and open borders are locked, moving them would tear the surface
+    std::vector<unsigned int> weld = weldPositions(vertices);
+    std::vector<char> locked(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount; i++) {
+        if (weld[i] != i) {
+            locked[i] = 1;
+            locked[weld[i]] = 1;
+        }
+    }
+
+    std::unordered_map<uint64_t, int> edgeUse;
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        for (int e = 0; e < 3; e++) {
+            uint64_t a = weld[triangles[t + e]];
+            uint64_t b = weld[triangles[t + (e + 1) % 3]];
+            edgeUse[std::min(a, b) << 32 | std::max(a, b)]++;
+        }
+    }
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        for (int e = 0; e < 3; e++) {
+            unsigned int a = triangles[t + e];
+            unsigned int b = triangles[t + (e + 1) % 3];
+            uint64_t wa = weld[a], wb = weld[b];
+            if (edgeUse[std::min(wa, wb) << 32 | std::max(wa, wb)] == 1) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+    }
+
+    // every vertex starts with the planes of the faces around it, weighted by area
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        const glm::vec3& p0 = vertices[triangles[t]].position;
+        glm::dvec3 normal = triangleNormal(p0, vertices[triangles[t + 1]].position, vertices[triangles[t + 2]].position);
+        double area = glm::length(normal);
+        if (area <= 0.0)
+            continue;
+        normal /= area;
+        Quadric plane = Quadric::FromPlane(normal, -glm::dot(normal, glm::dvec3(p0)), area * 0.5);
+        for (int i = 0; i < 3; i++)
+            quadrics[weld[triangles[t + i]]].Add(plane);
+    }
+    for (size_t i = 0; i < vertexCount; i++)
+        quadrics[i] = quadrics[weld[i]];
+
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<char> touched(vertexCount);
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1);
+    std::vector<unsigned int> adjacency;
+    std::vector<Collapse> collapses;
+    double appliedCost = 0.0;
+
+    // every pass collapses a set of independent edges, then compacts the triangle list
+    while (triangles.size() > targetIndexCount) {
+        size_t triangleCount = triangles.size() / 3;
+
+        std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+        for (unsigned int index : triangles)
+            adjacencyOffset[index + 1]++;
+        for (size_t i = 0; i < vertexCount; i++)
+            adjacencyOffset[i + 1] += adjacencyOffset[i];
+        adjacency.resize(triangles.size());
+        std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < triangles.size(); i++)
+            adjacency[fill[triangles[i]]++] = (unsigned int)(i / 3);
+
+        collapses.clear();
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            for (int e = 0; e < 3; e++) {
+                unsigned int a = triangles[t + e];
+                unsigned int b = triangles[t + (e + 1) % 3];
+                if (a > b)
+                    continue;   // the twin half edge covers the other direction, open borders are locked anyway
+
+                Quadric sum = quadrics[a];
+                sum.Add(quadrics[b]);
+                double costToB = locked[a] ? INFINITY : sum.Evaluate(vertices[b].position);
+                double costToA = locked[b] ? INFINITY : sum.Evaluate(vertices[a].position);
+                if (costToB <= costToA && costToB <= maxCost)
+                    collapses.push_back({ a, b, costToB });
+                else if (costToA < costToB && costToA <= maxCost)
+                    collapses.push_back({ b, a, costToA });
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                [](const Collapse& l, const Collapse& r) { return l.cost < r.cost; });
+
+        for (size_t i = 0; i < vertexCount; i++)
+            remap[i] = (unsigned int)i;
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t removed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (triangleCount - removed <= targetIndexCount / 3)
+                break;
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+
+            // moving "from" onto "to" must not fold any remaining face over
+            const glm::vec3& target = vertices[collapse.to].position;
+            bool flips = false;
+            size_t collapsedFaces = 0;
+            for (unsigned int k = adjacencyOffset[collapse.from]; k < adjacencyOffset[collapse.from + 1] && !flips; k++) {
+                const unsigned int* tri = &triangles[adjacency[k] * 3];
+                if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+                    collapsedFaces++;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (int i = 0; i < 3; i++) {
+                    p[i] = vertices[tri[i]].position;
+                    q[i] = tri[i] == collapse.from ? target : p[i];
+                }
+                glm::vec3 before = triangleNormal(p[0], p[1], p[2]);
+                glm::vec3 after = triangleNormal(q[0], q[1], q[2]);
+                float lengths = glm::length(before) * glm::length(after);
+                flips = lengths <= 0.0f || glm::dot(before, after) < MIN_FLIP_DOT * lengths;
+            }
+            if (flips)
+                continue;
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].Add(quadrics[collapse.from]);
+            appliedCost = std::max(appliedCost, collapse.cost);
+            removed += collapsedFaces;
+
+            // keep the neighbourhood stable for the rest of the pass
+            for (unsigned int k = adjacencyOffset[collapse.from]; k < adjacencyOffset[collapse.from + 1]; k++) {
+                const unsigned int* tri = &triangles[adjacency[k] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+            }
+        }
+
+        if (removed == 0)
+            break;
+
+        size_t kept = 0;
+        for (size_t t = 0; t < triangles.size(); t += 3) {
+            unsigned int a = remap[triangles[t]], b = remap[triangles[t + 1]], c = remap[triangles[t + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            triangles[kept++] = a;
+            triangles[kept++] = b;
+            triangles[kept++] = c;
+        }
+        triangles.resize(kept);
+    }
+
+    if (resultError)
+        *resultError = (float)(std::sqrt(appliedCost) / radius);
+    return triangles;
+}
+
+float ProjectedSize(const AABB& box, const glm::vec3& cameraPosition, float fovY) {
+    float radius = glm::length(box.Extent()) * 0.5f;
+    float distance = glm::length(box.Center() - cameraPosition);
+    if (distance <= radius)
+        return 1.0f;
+    return radius / (distance * std::tan(fovY * 0.5f));
+}
+
+int SelectLODLevel(float projectedSize, int currentLevel, int levelCount) {
+    int lastLevel = levelCount - 1;
+    int level = std::max(0, std::min(currentLevel, lastLevel));
+
+    // coarser only once clearly below the current level's threshold, finer only once clearly above
+    while (level < lastLevel && projectedSize < LODMesh::LevelThreshold(level) * (1.0f - LOD_HYSTERESIS))
+        level++;
+    while (level > 0 && projectedSize > LODMesh::LevelThreshold(level - 1) * (1.0f + LOD_HYSTERESIS))
+        level--;
+    return level;
+}
+
+
+LODMesh::LODMesh(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices, int maxLevels) {
+    double start = glfwGetTime();
+
+    // level 0 is the source mesh, each further level simplifies the previous one
+    std::vector<unsigned int> allIndices = indices;
+    levels.push_back({ 0, (unsigned int)indices.size(), 0.0f });
+
+    std::vector<unsigned int> current = indices;
+    while ((int)levels.size() < std::min(maxLevels, MAX_LEVELS)) {
+        size_t target = (size_t)(current.size() * LOD_REDUCTION) / 3 * 3;
+        float error;
+        std::vector<unsigned int> simplified = SimplifyMesh(vertices, current, target, LOD_MAX_ERROR, &error);
+
+        // stop once the error budget no longer allows a meaningful reduction
+        if (simplified.size() > current.size() * 0.9f)
+            break;
+
+        levels.push_back({ (unsigned int)allIndices.size(), (unsigned int)simplified.size(),
+                std::max(error, levels.back().error) });
+        allIndices.insert(allIndices.end(), simplified.begin(), simplified.end());
+        current.swap(simplified);
+    }
+
+    vao = resources::CreateVertexArray("LODMesh");
+    vbo = resources::CreateBuffer("LODMesh", "vertices");
+    ebo = resources::CreateBuffer("LODMesh", "indices, all levels");
+    resources::SetSize(resources::ResourceType::Buffer, vbo, vertices.size() * sizeof(MeshVertex));
+    resources::SetSize(resources::ResourceType::Buffer, ebo, allIndices.size() * sizeof(unsigned int));
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, allIndices.size() * sizeof(unsigned int), allIndices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::string triangleCounts;
+    for (size_t i = 0; i < levels.size(); i++)
+        triangleCounts += (i ? " / " : "") + std::to_string(levels[i].indexCount / 3);
+    Global::logger.log(INFO, "Generated " + std::to_string(levels.size()) + " LOD levels (" + triangleCounts
+            + " triangles) in " + std::to_string((int)((glfwGetTime() - start) * 1000.0)) + " ms.");
+}
+
+LODMesh::~LODMesh() {
+    resources::Delete(resources::ResourceType::VertexArray, vao);
+    resources::Delete(resources::ResourceType::Buffer, vbo);
+    resources::Delete(resources::ResourceType::Buffer, ebo);
+}
+
+float LODMesh::LevelThreshold(int level) {
+    return LOD_BASE_SIZE / (float)(1 << level);
+}
+
+float LODMesh::Hysteresis() {
+    return LOD_HYSTERESIS;
+}
+
+int LODMesh::SelectLevel(float projectedSize, int currentLevel) const {
+    return SelectLODLevel(projectedSize, currentLevel, (int)levels.size());
+}
+
+void LODMesh::Draw(int level, int instanceCount) const {
+    const LODLevel& range = levels[level];
+    glDrawElementsInstanced(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT,
+            (void*)(range.firstIndex * sizeof(unsigned int)), instanceCount);
+}
+
+GLuint LODMesh::GetVAO() const {
+    return vao;
+}
+
+GLuint LODMesh::GetVertexBuffer() const {
+    return vbo;
+}
+
+GLuint LODMesh::GetIndexBuffer() const {
+    return ebo;
+}
+
+const std::vector<LODLevel>& LODMesh::GetLevels() const {
+    return levels;
+}
+
+unsigned int LODMesh::GetTriangleCount(int level) const {
+    return levels[level].indexCount / 3;
+}
@@ -0,0 +1,80 @@
+/*
+ * LODMesh.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for meshes with a level-of-detail chain. When a
+ *      mesh is created its simplified levels are generated with
+ *      quadric error edge collapses and stored back to back in one
+ *      index buffer, every level reuses the original vertices.
+ *
+ *      At runtime SelectLevel() picks a level from the projected
+ *      size of the object on screen, with hysteresis so objects
+ *      sitting on a threshold don't flicker between two levels.
+ */
+
+#pragma once
+
+#include "Bounds.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+// position + texture coordinate, same layout as the cube vertices in graphics.cpp
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec2 texCoord;
+};
+
+// range of the shared index buffer that holds one level
+struct LODLevel {
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    float error;                // geometric error relative to the mesh radius
+};
+
+// collapses edges (cheapest quadric error first) until at most targetIndexCount indices
+// remain or the next collapse would exceed maxError, returns indices into the same vertices
+std::vector<unsigned int> SimplifyMesh(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices,
+        size_t targetIndexCount, float maxError, float* resultError = nullptr);
+
+// bounding sphere of "box" as a fraction of the screen height, for a projection with vertical fov "fovY"
+float ProjectedSize(const AABB& box, const glm::vec3& cameraPosition, float fovY);
+
+// same as LODMesh::SelectLevel for a chain of "levelCount" levels, usable without the mesh
+int SelectLODLevel(float projectedSize, int currentLevel, int levelCount);
+
+
+class LODMesh {
+
+public:
+    // also the size of the LOD arrays in cull.comp
+    static constexpr int MAX_LEVELS = 4;
+
+    LODMesh(const std::vector<MeshVertex>& vertices, const std::vector<unsigned int>& indices, int maxLevels = MAX_LEVELS);
+    ~LODMesh();
+
+    // level to draw for an object currently drawn at "currentLevel", level i is kept
+    // while the projected size stays above LOD_BASE_SIZE / 2^i (mirrored in cull.comp)
+    int SelectLevel(float projectedSize, int currentLevel) const;
+    static float LevelThreshold(int level);
+    static float Hysteresis();
+    // draws one level "instanceCount" times, the mesh VAO must be bound
+    void Draw(int level, int instanceCount = 1) const;
+
+    GLuint GetVAO() const;
+    GLuint GetVertexBuffer() const;
+    GLuint GetIndexBuffer() const;
+    const std::vector<LODLevel>& GetLevels() const;
+    unsigned int GetTriangleCount(int level) const;
+
+private:
+    GLuint vao;
+    GLuint vbo;
+    GLuint ebo;
+    std::vector<LODLevel> levels;
+};
@@ -0,0 +1,246 @@
+/*
+ * LightClusters.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for clustered forward lighting.
+ */
+
+#include "LightClusters.h"
+
+#include "GpuResources.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+const char* MODE_NAMES[] = { "Off", "Naive", "Clustered" };
+const char* BUFFER_NAMES[] = { "lights", "clusters", "light indices" };
+
+// slice of a view depth, the inverse of the exponential split
+int depthSlice(float depth, float nearPlane, float farPlane) {
+    float slice = std::log(depth / nearPlane) / std::log(farPlane / nearPlane) * LightClusters::CLUSTERS_Z;
+    return std::clamp((int)std::floor(slice), 0, LightClusters::CLUSTERS_Z - 1);
+}
+
+int tile(float ndc, int tiles) {
+    return std::clamp((int)std::floor((ndc + 1.0f) * 0.5f * tiles), 0, tiles - 1);
+}
+
+bool sphereTouchesBox(const glm::vec3& center, float radius, const AABB& box) {
+    glm::vec3 closest = glm::clamp(center, box.min, box.max);
+    glm::vec3 offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+}
+
+}
+
+
+const char* LightingModeName(LightingMode mode) {
+    return MODE_NAMES[(int)mode];
+}
+
+LightClusters::LightClusters()
+    : boundsProjection(0.0f), slices(CLUSTERS_Z) {
+    for (int i = 0; i < 3; i++) {
+        buffers[i] = resources::CreateBuffer("LightClusters", BUFFER_NAMES[i]);
+        textures[i] = resources::CreateTexture("LightClusters", BUFFER_NAMES[i]);
+        bufferBytes[i] = 0;
+    }
+
+    // never empty, so the texture buffers always have a store; the textures see every later
+    // glBufferData of their buffer without being attached again
+    const GLenum formats[] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+    const unsigned char zeros[16] = {};
+    for (int i = 0; i < 3; i++) {
+        upload(i, zeros, sizeof(zeros));
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+    }
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+LightClusters::~LightClusters() {
+    for (int i = 0; i < 3; i++) {
+        resources::Delete(resources::ResourceType::Texture, textures[i]);
+        resources::Delete(resources::ResourceType::Buffer, buffers[i]);
+    }
+}
+
+void LightClusters::Build(const glm::mat4& view, const glm::mat4& projection, float viewportWidth, float viewportHeight,
+        ThreadPool& pool, LightGrid& grid) {
+    // frustum shape straight from the perspective matrix
+    float tanHalfY = 1.0f / projection[1][1];
+    float tanHalfX = 1.0f / projection[0][0];
+    float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+    if (projection != boundsProjection) {
+        buildClusterBounds(tanHalfX, tanHalfY, nearPlane, farPlane);
+        boundsProjection = projection;
+    }
+
+    float logRange = std::log(farPlane / nearPlane);
+    grid.clusterScale = glm::vec4(CLUSTERS_X / viewportWidth, CLUSTERS_Y / viewportHeight,
+            CLUSTERS_Z / logRange, -CLUSTERS_Z * std::log(nearPlane) / logRange);
+
+    // view space spheres and the cluster ranges they may touch
+    int lightCount = (int)grid.lights.size();
+    ranges.resize(lightCount);
+    pool.ParallelFor(lightCount, 256, [&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) {
+            const PointLight& light = grid.lights[i];
+            LightRange& range = ranges[i];
+            range.center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            range.radius = light.radius;
+            range.z0 = 1;
+            range.z1 = 0;
+
+            float depth = -range.center.z;
+            float nearest = std::max(depth - light.radius, nearPlane);
+            float farthest = std::min(depth + light.radius, farPlane);
+            if (nearest > farthest)
+                continue;
+
+            // x / depth is smallest at the near end for negative x and at the far end otherwise
+            float left = range.center.x - light.radius;
+            float right = range.center.x + light.radius;
+            float bottom = range.center.y - light.radius;
+            float top = range.center.y + light.radius;
+            float ndcLeft = left / ((left < 0.0f ? nearest : farthest) * tanHalfX);
+            float ndcRight = right / ((right > 0.0f ? nearest : farthest) * tanHalfX);
+            float ndcBottom = bottom / ((bottom < 0.0f ? nearest : farthest) * tanHalfY);
+            float ndcTop = top / ((top > 0.0f ? nearest : farthest) * tanHalfY);
+            if (ndcLeft > 1.0f || ndcRight < -1.0f || ndcBottom > 1.0f || ndcTop < -1.0f)
+                continue;
+
+            range.x0 = tile(ndcLeft, CLUSTERS_X);
+            range.x1 = tile(ndcRight, CLUSTERS_X);
+            range.y0 = tile(ndcBottom, CLUSTERS_Y);
+            range.y1 = tile(ndcTop, CLUSTERS_Y);
+            range.z0 = depthSlice(nearest, nearPlane, farPlane);
+            range.z1 = depthSlice(farthest, nearPlane, farPlane);
+        }
+    });
+
+    // every slice sorts its own light lists, by counting
+    const int sliceClusters = CLUSTERS_X * CLUSTERS_Y;
+    pool.ParallelFor(CLUSTERS_Z, 1, [&](int begin, int end, int) {
+        for (int z = begin; z < end; z++) {
+            Slice& slice = slices[z];
+            slice.counts.assign(sliceClusters, 0);
+            slice.pairs.clear();
+            const AABB* bounds = &clusterBounds[z * sliceClusters];
+
+            for (int i = 0; i < lightCount; i++) {
+                const LightRange& range = ranges[i];
+                if (z < range.z0 || z > range.z1)
+                    continue;
+                for (int y = range.y0; y <= range.y1; y++) {
+                    for (int x = range.x0; x <= range.x1; x++) {
+                        int cluster = y * CLUSTERS_X + x;
+                        if (sphereTouchesBox(range.center, range.radius, bounds[cluster])) {
+                            slice.pairs.push_back(glm::uvec2(cluster, i));
+                            slice.counts[cluster]++;
+                        }
+                    }
+                }
+            }
+
+            // counts become first indices, the pairs fall into place behind them
+            GLuint first = 0;
+            for (GLuint& count : slice.counts) {
+                GLuint next = first + count;
+                count = first;
+                first = next;
+            }
+            slice.indices.resize(slice.pairs.size());
+            for (const glm::uvec2& pair : slice.pairs)
+                slice.indices[slice.counts[pair.x]++] = pair.y;
+        }
+    });
+
+    // join the slices, after the scatter counts[c] is where cluster c ends
+    size_t total = 0;
+    for (const Slice& slice : slices)
+        total += slice.indices.size();
+    grid.indices.resize(total);
+    grid.clusters.resize(CLUSTER_COUNT);
+    grid.maxClusterLights = 0;
+
+    GLuint base = 0;
+    for (int z = 0; z < CLUSTERS_Z; z++) {
+        const Slice& slice = slices[z];
+        GLuint start = 0;
+        for (int c = 0; c < sliceClusters; c++) {
+            GLuint count = slice.counts[c] - start;
+            grid.clusters[z * sliceClusters + c] = glm::uvec2(base + start, count);
+            grid.maxClusterLights = std::max(grid.maxClusterLights, (int)count);
+            start = slice.counts[c];
+        }
+        if (!slice.indices.empty())
+            std::memcpy(&grid.indices[base], slice.indices.data(), slice.indices.size() * sizeof(GLuint));
+        base += (GLuint)slice.indices.size();
+    }
+}
+
+void LightClusters::Upload(const LightGrid& grid) {
+    if (!grid.lights.empty())
+        upload(0, grid.lights.data(), grid.lights.size() * sizeof(PointLight));
+    if (!grid.clusters.empty())
+        upload(1, grid.clusters.data(), grid.clusters.size() * sizeof(glm::uvec2));
+    if (!grid.indices.empty())
+        upload(2, grid.indices.data(), grid.indices.size() * sizeof(GLuint));
+}
+
+void LightClusters::Bind() const {
+    const GLuint units[] = { LIGHTS_UNIT, CLUSTERS_UNIT, INDICES_UNIT };
+    for (int i = 0; i < 3; i++) {
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+size_t LightClusters::GetGpuBytes() const {
+    return bufferBytes[0] + bufferBytes[1] + bufferBytes[2];
+}
+
+void LightClusters::buildClusterBounds(float tanHalfX, float tanHalfY, float nearPlane, float farPlane) {
+    clusterBounds.resize(CLUSTER_COUNT);
+    for (int z = 0; z < CLUSTERS_Z; z++) {
+        float depths[2] = {
+            nearPlane * std::pow(farPlane / nearPlane, (float)z / CLUSTERS_Z),
+            nearPlane * std::pow(farPlane / nearPlane, (float)(z + 1) / CLUSTERS_Z)
+        };
+        for (int y = 0; y < CLUSTERS_Y; y++) {
+            for (int x = 0; x < CLUSTERS_X; x++) {
+                // the cell's tile rectangle at both ends of the slice
+                AABB box;
+                for (float depth : depths) {
+                    for (int corner = 0; corner < 4; corner++) {
+                        float ndcX = -1.0f + 2.0f * (x + (corner & 1)) / CLUSTERS_X;
+                        float ndcY = -1.0f + 2.0f * (y + (corner >> 1)) / CLUSTERS_Y;
+                        box.Expand(glm::vec3(ndcX * depth * tanHalfX, ndcY * depth * tanHalfY, -depth));
+                    }
+                }
+                clusterBounds[(z * CLUSTERS_Y + y) * CLUSTERS_X + x] = box;
+            }
+        }
+    }
+}
+
+void LightClusters::upload(int index, const void* data, size_t bytes) {
+    // a new store every frame, the GPU may still read the last one
+    glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+    glBufferData(GL_TEXTURE_BUFFER, bytes, data, GL_STREAM_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    if (bytes != bufferBytes[index]) {
+        bufferBytes[index] = bytes;
+        resources::SetSize(resources::ResourceType::Buffer, buffers[index], bytes);
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * LightClusters.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for clustered forward lighting. The view frustum
+ *      is cut into CLUSTERS_X x CLUSTERS_Y screen tiles and CLUSTERS_Z
+ *      depth slices (exponential in depth, so clusters stay roughly
+ *      cube shaped), every frame each point light is assigned to the
+ *      clusters its sphere touches and the fragment shader only walks
+ *      the lights of its own cluster instead of all of them.
+ *
+ *      Build() runs on the pool and touches no GL, so it can be part
+ *      of the simulation thread's frame: the view space light ranges
+ *      are computed in parallel over the lights, then every depth
+ *      slice collects its lists on its own, and the slices are joined
+ *      into one compact index list. Upload() and Bind() are for the GL
+ *      thread, the three arrays go into texture buffers so the shaders
+ *      work on GL 3.3:
+ *
+ *      lights      RGBA32F, two texels per light: position + radius,
+ *                  color + intensity (world space)
+ *      clusters    RG32UI, first index and light count per cluster
+ *      indices     R32UI, the lights of every cluster back to back
+ *
+ *      clusters.Build(view, projection, width, height, pool, grid);
+ *      ...
+ *      clusters.Upload(grid);
+ *      clusters.Bind();
+ */
+
+#pragma once
+
+#include "Bounds.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class ThreadPool;
+
+
+// lightInfo.x of the Lighting block in the fragment shaders
+enum class LightingMode {
+    Off,
+    Naive,          // every fragment loops over every light
+    Clustered
+};
+
+const char* LightingModeName(LightingMode mode);
+
+struct PointLight {
+    glm::vec3 position;
+    float radius;           // no light past it
+    glm::vec3 color;
+    float intensity;
+};
+
+// the lights of one frame and, once built, their cluster lists
+struct LightGrid {
+    std::vector<PointLight> lights;
+    std::vector<glm::uvec2> clusters;       // first index and count, x fastest, then y, then z
+    std::vector<GLuint> indices;
+    // what the fragment shader maps gl_FragCoord and view depth with: xy tiles per pixel,
+    // z/w scale and bias of log(depth) to the slice
+    glm::vec4 clusterScale = glm::vec4(0.0f);
+    int maxClusterLights = 0;
+};
+
+
+class LightClusters {
+
+public:
+    static const int CLUSTERS_X = 16;
+    static const int CLUSTERS_Y = 9;
+    static const int CLUSTERS_Z = 24;
+    static const int CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+    // texture units of the three buffers, after the material textures on 0 and 1
+    static const GLuint LIGHTS_UNIT = 2;
+    static const GLuint CLUSTERS_UNIT = 3;
+    static const GLuint INDICES_UNIT = 4;
+
+    LightClusters();
+    ~LightClusters();
+    LightClusters(const LightClusters&) = delete;
+    LightClusters& operator=(const LightClusters&) = delete;
+
+    // fills grid.clusters and grid.indices for grid.lights as seen through view and projection,
+    // any thread but only one at a time
+    void Build(const glm::mat4& view, const glm::mat4& projection, float viewportWidth, float viewportHeight,
+            ThreadPool& pool, LightGrid& grid);
+
+    // GL thread: replaces the buffer contents with "grid", the cluster lists only when it has them
+    void Upload(const LightGrid& grid);
+    void Bind() const;
+    // the three buffers as last uploaded
+    size_t GetGpuBytes() const;
+
+private:
+    // view space sphere of a light and the cluster index ranges it may touch, empty when z0 > z1
+    struct LightRange {
+        glm::vec3 center;
+        float radius;
+        int x0, x1, y0, y1, z0, z1;
+    };
+
+    // one depth slice's lists before they are joined
+    struct Slice {
+        std::vector<GLuint> counts;             // per cluster of the slice
+        std::vector<glm::uvec2> pairs;          // cluster of the slice, light
+        std::vector<GLuint> indices;
+    };
+
+    // view space bounds of every cluster, only rebuilt when the projection changes
+    std::vector<AABB> clusterBounds;
+    glm::mat4 boundsProjection;
+    std::vector<LightRange> ranges;
+    std::vector<Slice> slices;
+
+    GLuint buffers[3];
+    GLuint textures[3];
+    size_t bufferBytes[3];
+
+    void buildClusterBounds(float tanHalfX, float tanHalfY, float nearPlane, float farPlane);
+    void upload(int index, const void* data, size_t bytes);
+};
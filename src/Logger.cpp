@@ -18,8 +18,8 @@
 #include "Logger.h"
 #include "framework.h"
 #include <ctime>
-#include <sstream>
 #include <iostream>
+#include <memory_resource>
 
 // declare global logger
 // writes to "logfile.txt"
@@ -48,34 +48,38 @@ Logger::~Logger() {
     logFile.close();
 }
 
-void Logger::log(logLevel level, const string& message) {
+void Logger::log(logLevel level, string_view message) {
     time_t now = time(0);
     tm* timeinfo = localtime(&now);
     char timestamp[20];
     strftime(timestamp, sizeof(timestamp),
             "%Y-%m-%d %H:%M:%S", timeinfo);
 
-    ostringstream logEntry;
-    logEntry << "[" << timestamp << "] "
-             << levelToString(level) << ": " << message
-             << "\n";
+    // the entry is built in a stack buffer, only very long messages spill onto the heap
+    char storage[512];
+    pmr::monotonic_buffer_resource entryMemory(storage, sizeof(storage));
+    pmr::string logEntry(&entryMemory);
+    logEntry.reserve(message.size() + 40);
+    logEntry.append("[").append(timestamp).append("] ");
+    size_t levelStart = logEntry.size();
+    logEntry.append(levelToString(level)).append(": ").append(message).append("\n");
 
-    cout << logEntry.str();
+    cout.write(logEntry.data(), logEntry.size());
 
-    std::string print = levelToString(level) + ": " + message + "\n";
-    Global::GLlogBuffer.appendf(print.c_str());
+    // the ImGui log window leaves out the timestamp
+    Global::GLlogBuffer.append(logEntry.data() + levelStart, logEntry.data() + logEntry.size());
     //Global::GLlogBuffer.appendf(logEntry.str().c_str());
     //Global::GLlogBuffer.appendf(message.c_str());
     //Global::GLlogBuffer.appendf("\n");
 
 
     if (logFile.is_open()) {
-        logFile << logEntry.str();
+        logFile.write(logEntry.data(), logEntry.size());
         logFile.flush();
     }
 }
 
-string Logger::levelToString(logLevel level){
+const char* Logger::levelToString(logLevel level){
     switch (level) {
     case DEBUG:
         return "DEBUG";
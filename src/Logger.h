@@ -19,6 +19,7 @@
 #include "framework.h"
 #include <fstream>
 #include <string>
+#include <string_view>
 
 
 enum logLevel {
@@ -33,11 +34,12 @@ public:
 
     Logger(const std::string& filename);
     ~Logger();
-    void log(logLevel level, const std::string& message);
+    // takes literals and std::strings alike without building a temporary string
+    void log(logLevel level, std::string_view message);
 
 private:
     std::ofstream logFile;
-    std::string levelToString(logLevel level);
+    const char* levelToString(logLevel level);
 
 
 
@@ -0,0 +1,387 @@
+/*
+ * MaterialTextures.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the material texture backend.
+ */
+
+#include "MaterialTextures.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+namespace {
+
+const char* MODE_NAMES[] = { "Separate", "Array", "Bindless", "Atlas" };
+
+const long long DEFAULT_STREAMING_BUDGET = 16 << 20;
+
+// ARB_bindless_texture is not part of the generated loader, the three entry points
+// it needs are fetched by hand
+typedef GLuint64 (APIENTRYP GetTextureHandleFunction)(GLuint texture);
+typedef void (APIENTRYP MakeTextureHandleResidentFunction)(GLuint64 handle);
+typedef void (APIENTRYP MakeTextureHandleNonResidentFunction)(GLuint64 handle);
+
+GetTextureHandleFunction getTextureHandle = nullptr;
+MakeTextureHandleResidentFunction makeTextureHandleResident = nullptr;
+MakeTextureHandleNonResidentFunction makeTextureHandleNonResident = nullptr;
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool loadBindless() {
+    if (!GLAD_GL_VERSION_4_3 || !hasExtension("GL_ARB_bindless_texture"))
+        return false;
+
+    getTextureHandle = (GetTextureHandleFunction)glfwGetProcAddress("glGetTextureHandleARB");
+    makeTextureHandleResident = (MakeTextureHandleResidentFunction)glfwGetProcAddress("glMakeTextureHandleResidentARB");
+    makeTextureHandleNonResident = (MakeTextureHandleNonResidentFunction)glfwGetProcAddress("glMakeTextureHandleNonResidentARB");
+    return getTextureHandle && makeTextureHandleResident && makeTextureHandleNonResident;
+}
+
+// 2x2 box filter into the next mip level, like glGenerateMipmap does for power of two sizes
+void downsample(const std::vector<unsigned char>& source, int width, int height, std::vector<unsigned char>& target) {
+    int targetWidth = std::max(1, width / 2);
+    int targetHeight = std::max(1, height / 2);
+    target.resize((size_t)targetWidth * targetHeight * 4);
+    for (int y = 0; y < targetHeight; y++) {
+        int y0 = std::min(2 * y, height - 1);
+        int y1 = std::min(2 * y + 1, height - 1);
+        for (int x = 0; x < targetWidth; x++) {
+            int x0 = std::min(2 * x, width - 1);
+            int x1 = std::min(2 * x + 1, width - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c]
+                        + source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                target[((size_t)y * targetWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+}
+
+
+const char* MaterialTextureModeName(MaterialTextureMode mode) {
+    return MODE_NAMES[(int)mode];
+}
+
+bool MaterialTextures::IsBindlessSupported() {
+    static bool supported = loadBindless();
+    return supported;
+}
+
+bool MaterialTextures::LoadImageFile(const std::string& path, MaterialImage& outImage) {
+    stbi_set_flip_vertically_on_load(true);
+
+    int channels;
+    unsigned char* data = stbi_load(path.c_str(), &outImage.width, &outImage.height, &channels, 4);
+    if (!data)
+        return false;
+
+    outImage.pixels.assign(data, data + (size_t)outImage.width * outImage.height * 4);
+    outImage.path = path;
+    stbi_image_free(data);
+    return true;
+}
+
+MaterialTextures::MaterialTextures()
+    : mode(MaterialTextureMode::Array), handleBuffer(0), streamingBudget(DEFAULT_STREAMING_BUDGET) {
+
+    // the block is always bound whole, the shader declares all MAX_TEXTURES entries
+    regionBuffer = resources::CreateBuffer("MaterialTextures", "texture regions");
+    resources::SetSize(resources::ResourceType::Buffer, regionBuffer, MAX_TEXTURES * sizeof(glm::vec4));
+    glBindBuffer(GL_UNIFORM_BUFFER, regionBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, MAX_TEXTURES * sizeof(glm::vec4), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+MaterialTextures::~MaterialTextures() {
+    destroy();
+    resources::Delete(resources::ResourceType::Buffer, regionBuffer);
+}
+
+void MaterialTextures::Create(const std::vector<MaterialImage>& images, MaterialTextureMode requestedMode, bool streamed) {
+    destroy();
+
+    mode = requestedMode;
+    if (mode == MaterialTextureMode::Bindless && !IsBindlessSupported()) {
+        Global::logger.log(WARNING, "ARB_bindless_texture not available, material textures use arrays.");
+        mode = MaterialTextureMode::Array;
+    }
+
+    std::vector<glm::vec4> regions(MAX_TEXTURES, glm::vec4(1.0f, 1.0f, 0.0f, 0.0f));
+    streamed = streamed && (mode == MaterialTextureMode::Separate || mode == MaterialTextureMode::Array);
+    if (!streamed) {
+        streamer.reset();
+    } else if (!streamer) {
+        streamer.reset(new TextureStreamer(streamingBudget));
+    }
+
+    if (mode == MaterialTextureMode::Atlas) {
+        createAtlas(images, regions);
+    } else {
+        createArrays(images, streamed);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, regionBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, MAX_TEXTURES * sizeof(glm::vec4), regions.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // with bindless every texture draws with every other
+    groups.resize(images.size());
+    sizes.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        groups[i] = mode == MaterialTextureMode::Bindless ? 0 : placements[i].array;
+        sizes[i] = std::max(images[i].width, images[i].height);
+    }
+}
+
+void MaterialTextures::createAtlas(const std::vector<MaterialImage>& images, std::vector<glm::vec4>& regions) {
+    atlas.reset(new TextureAtlas());
+    placements.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        AtlasRegion region;
+        if (images[i].pixels.size() >= (size_t)images[i].width * images[i].height * 4)
+            region = atlas->Add(images[i].width, images[i].height, images[i].pixels.data());
+        placements[i] = { std::max(0, region.page), 0 };
+        if (i < regions.size())
+            regions[i] = region.uvTransform;
+    }
+    atlas->Flush();
+
+    char line[160];
+    snprintf(line, sizeof(line), "Texture atlas: %d textures on %d pages of %d texels, %.0f%% occupied.",
+            atlas->GetImageCount(), atlas->GetPageCount(), atlas->GetPageSize(), atlas->GetOccupancy() * 100.0f);
+    Global::logger.log(INFO, line);
+}
+
+void MaterialTextures::createArrays(const std::vector<MaterialImage>& images, bool streamed) {
+    GLint maxLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    // which images go into which array: one each, or packed by size
+    placements.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        int array = -1;
+        if (mode != MaterialTextureMode::Separate) {
+            for (size_t a = 0; a < arrayImages.size(); a++) {
+                const MaterialImage& first = images[arrayImages[a][0]];
+                if (first.width == images[i].width && first.height == images[i].height
+                        && (GLint)arrayImages[a].size() < maxLayers) {
+                    array = (int)a;
+                    break;
+                }
+            }
+        }
+        if (array == -1) {
+            array = (int)arrayImages.size();
+            arrayImages.emplace_back();
+        }
+        placements[i] = { array, (int)arrayImages[array].size() };
+        arrayImages[array].push_back((int)i);
+    }
+
+    // streamed arrays are built from these later, the file images are read again instead of kept
+    if (streamed) {
+        sourceImages = images;
+        for (MaterialImage& image : sourceImages) {
+            if (!image.path.empty())
+                std::vector<unsigned char>().swap(image.pixels);
+        }
+    }
+
+    for (const std::vector<int>& members : arrayImages) {
+        int width = images[members[0]].width;
+        int height = images[members[0]].height;
+        int layers = (int)members.size();
+
+        GLuint array = resources::CreateTexture("MaterialTextures",
+                std::to_string(width) + "x" + std::to_string(height) + " x " + std::to_string(layers));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        arrays.push_back(array);
+
+        // array a is streamer texture a
+        if (streamed) {
+            int index = (int)arrays.size() - 1;
+            streamer->Add(array, width, height, layers, [this, index](int level, std::vector<unsigned char>& pixels) {
+                buildLevel(index, level, pixels);
+            });
+            continue;
+        }
+
+        resources::SetSize(resources::ResourceType::Texture, array, resources::TextureBytes(width, height, 4, 0) * layers);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        for (int layer = 0; layer < layers; layer++) {
+            const MaterialImage& image = images[members[layer]];
+            if (image.pixels.size() >= (size_t)width * height * 4)
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+        }
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    // a resident texture can't be changed any more, so the handles come last
+    if (mode == MaterialTextureMode::Bindless && !arrays.empty()) {
+        for (GLuint array : arrays) {
+            GLuint64 handle = getTextureHandle(array);
+            makeTextureHandleResident(handle);
+            handles.push_back(handle);
+        }
+
+        handleBuffer = resources::CreateBuffer("MaterialTextures", "bindless handles");
+        resources::SetSize(resources::ResourceType::Buffer, handleBuffer, handles.size() * sizeof(GLuint64));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, handleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+}
+
+void MaterialTextures::buildLevel(int array, int level, std::vector<unsigned char>& pixels) const {
+    const std::vector<int>& members = arrayImages[array];
+    const MaterialImage& first = sourceImages[members[0]];
+    size_t layerBytes = (size_t)std::max(1, first.width >> level) * std::max(1, first.height >> level) * 4;
+    pixels.resize(layerBytes * members.size());
+
+    MaterialImage file;
+    std::vector<unsigned char> current;
+    std::vector<unsigned char> next;
+    for (size_t layer = 0; layer < members.size(); layer++) {
+        const MaterialImage& image = sourceImages[members[layer]];
+        const std::vector<unsigned char>* source = &image.pixels;
+        if (!image.path.empty()) {
+            if (!LoadImageFile(image.path, file) || file.width != image.width || file.height != image.height)
+                file.pixels.assign((size_t)image.width * image.height * 4, 0);
+            source = &file.pixels;
+        }
+        if (source->size() < (size_t)image.width * image.height * 4) {
+            std::fill(pixels.begin() + layer * layerBytes, pixels.begin() + (layer + 1) * layerBytes, 0);
+            continue;
+        }
+
+        int width = image.width;
+        int height = image.height;
+        for (int l = 0; l < level; l++) {
+            downsample(l == 0 ? *source : current, width, height, next);
+            current.swap(next);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        const std::vector<unsigned char>& result = level == 0 ? *source : current;
+        std::copy(result.begin(), result.begin() + layerBytes, pixels.begin() + layer * layerBytes);
+    }
+}
+
+MaterialTextureMode MaterialTextures::GetMode() const {
+    return mode;
+}
+
+int MaterialTextures::GetTextureCount() const {
+    return (int)placements.size();
+}
+
+int MaterialTextures::GetArrayCount() const {
+    return atlas ? atlas->GetPageCount() : (int)arrays.size();
+}
+
+const TextureAtlas* MaterialTextures::GetAtlas() const {
+    return atlas.get();
+}
+
+const std::vector<int>& MaterialTextures::GetGroups() const {
+    return groups;
+}
+
+int MaterialTextures::GetLayer(int texture) const {
+    return texture >= 0 && texture < (int)placements.size() ? placements[texture].layer : 0;
+}
+
+int MaterialTextures::GetHandle(int texture) const {
+    return texture >= 0 && texture < (int)placements.size() ? placements[texture].array : 0;
+}
+
+int MaterialTextures::GetTextureSize(int texture) const {
+    return texture >= 0 && texture < (int)sizes.size() ? sizes[texture] : 0;
+}
+
+TextureStreamer* MaterialTextures::GetStreamer() const {
+    return streamer.get();
+}
+
+void MaterialTextures::RequestLevel(int texture, int level) {
+    if (streamer && texture >= 0 && texture < (int)placements.size())
+        streamer->Request(placements[texture].array, level);
+}
+
+void MaterialTextures::SetStreamingBudget(long long budgetBytes) {
+    streamingBudget = budgetBytes;
+    if (streamer)
+        streamer->SetBudget(budgetBytes);
+}
+
+long long MaterialTextures::GetStreamingBudget() const {
+    return streamingBudget;
+}
+
+void MaterialTextures::BindRegions() const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, REGIONS_BINDING, regionBuffer);
+}
+
+void MaterialTextures::Bind(int group, GLuint unit) const {
+    if (mode == MaterialTextureMode::Bindless) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, HANDLES_BINDING, handleBuffer);
+        return;
+    }
+    if (atlas) {
+        atlas->BindPage(group, unit);
+        return;
+    }
+    if (group < 0 || group >= (int)arrays.size())
+        return;
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[group]);
+}
+
+void MaterialTextures::destroy() {
+    // the loader must be done with the images before they go
+    if (streamer)
+        streamer->Clear();
+    sourceImages.clear();
+    arrayImages.clear();
+
+    for (GLuint64 handle : handles)
+        makeTextureHandleNonResident(handle);
+    handles.clear();
+    resources::Delete(resources::ResourceType::Buffer, handleBuffer);
+
+    for (GLuint& array : arrays)
+        resources::Delete(resources::ResourceType::Texture, array);
+    arrays.clear();
+    atlas.reset();
+    placements.clear();
+    groups.clear();
+    sizes.clear();
+}
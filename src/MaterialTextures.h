@@ -0,0 +1,153 @@
+/*
+ * MaterialTextures.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the material texture backend of the CPU path.
+ *      Material textures are uploaded into GL_TEXTURE_2D_ARRAY layers
+ *      and the shader picks its layer per instance, so objects with
+ *      different textures no longer need their own draw:
+ *
+ *      Separate    one single-layer array per texture, every texture
+ *                  change is a bind and splits the batch (the old way)
+ *      Array       textures of the same size share an array, one bind
+ *                  per size (and per GL_MAX_ARRAY_TEXTURE_LAYERS)
+ *      Bindless    the arrays of Array, made resident with
+ *                  ARB_bindless_texture and their handles put in an
+ *                  SSBO, nothing is bound between draws at all
+ *      Atlas       textures of any size packed into atlas pages
+ *                  (TextureAtlas.h), one bind per page
+ *
+ *      Textures that can be drawn without a bind in between share a
+ *      group, the render queue sorts by group instead of by texture.
+ *      Every texture also has a UV transform in the TextureRegions
+ *      uniform block, the identity unless it sits in an atlas page.
+ *      Bindless needs GL 4.3 and the extension, without them it falls
+ *      back to Array.
+ *
+ *      Separate and Array textures can be streamed (TextureStreamer.h):
+ *      each array starts with its mip tail and gets finer levels as
+ *      RequestLevel() asks for them, read again from the image file
+ *      when the image came from one, or from a copy kept in memory.
+ *      The arrays of Array mode share their levels between all layers.
+ *      Bindless handles and atlas pages can't change their base level,
+ *      those two modes always keep every level.
+ *
+ *      textures.Create(images, MaterialTextureMode::Array);
+ *      ...
+ *      textures.BindRegions();
+ *      textures.Bind(group, 0);
+ *      objectData.material.y = textures.GetLayer(texture);
+ */
+
+#pragma once
+
+#include "TextureAtlas.h"
+#include "TextureStreamer.h"
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+enum class MaterialTextureMode {
+    Separate,
+    Array,
+    Bindless,
+    Atlas
+};
+
+const char* MaterialTextureModeName(MaterialTextureMode mode);
+
+// RGBA8 pixels, bottom row first like GL expects them
+struct MaterialImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    std::string path;               // file it was loaded from, empty for generated images
+};
+
+
+class MaterialTextures {
+
+public:
+    // length of the TextureRegions block in vertex_shader.vert, later textures keep the identity
+    static const int MAX_TEXTURES = 256;
+    // uniform block binding of TextureRegions, SSBO binding of the handle array in fragment_bindless.frag
+    static const GLuint REGIONS_BINDING = 2;
+    static const GLuint HANDLES_BINDING = 4;
+
+    // true when the context has GL 4.3 and ARB_bindless_texture
+    static bool IsBindlessSupported();
+    // loads an image file with stb_image, false when it can't be read
+    static bool LoadImageFile(const std::string& path, MaterialImage& outImage);
+
+    MaterialTextures();
+    ~MaterialTextures();
+
+    // replaces every texture, texture i is images[i]; "streamed" starts the arrays at their mip
+    // tail and streams the rest, Separate and Array mode only
+    void Create(const std::vector<MaterialImage>& images, MaterialTextureMode mode, bool streamed = false);
+
+    // the mode the textures were created with, Bindless may have fallen back to Array
+    MaterialTextureMode GetMode() const;
+    int GetTextureCount() const;
+    // texture arrays, or atlas pages in Atlas mode
+    int GetArrayCount() const;
+    // the atlas in Atlas mode, null otherwise
+    const TextureAtlas* GetAtlas() const;
+
+    // texture -> group, textures of one group draw without rebinding
+    const std::vector<int>& GetGroups() const;
+    // what the shaders index with: the layer of the texture in its array and, for bindless,
+    // which handle that array is
+    int GetLayer(int texture) const;
+    int GetHandle(int texture) const;
+    // longer side of the texture in texels
+    int GetTextureSize(int texture) const;
+
+    // the streamer of the arrays, null unless they were created streamed
+    TextureStreamer* GetStreamer() const;
+    // the finest mip level "texture" needs this frame, before the streamer's Update()
+    void RequestLevel(int texture, int level);
+    // budget of the streamer, kept for the next streamed Create()
+    void SetStreamingBudget(long long budgetBytes);
+    long long GetStreamingBudget() const;
+
+    // binds the UV transforms, once per frame before the draws
+    void BindRegions() const;
+    // binds what the draws of "group" sample: its array or atlas page on texture "unit", or
+    // with bindless the handle buffer
+    void Bind(int group, GLuint unit) const;
+
+private:
+    struct Placement {
+        int array;
+        int layer;
+    };
+
+    MaterialTextureMode mode;
+    std::vector<GLuint> arrays;
+    std::vector<GLuint64> handles;
+    GLuint handleBuffer;
+    GLuint regionBuffer;
+    std::unique_ptr<TextureAtlas> atlas;
+    std::vector<Placement> placements;
+    std::vector<int> groups;
+    std::vector<int> sizes;
+
+    // streaming: the images every array is made of, without the pixels of those read from a file
+    std::unique_ptr<TextureStreamer> streamer;
+    long long streamingBudget;
+    std::vector<MaterialImage> sourceImages;
+    std::vector<std::vector<int>> arrayImages;
+
+    void createArrays(const std::vector<MaterialImage>& images, bool streamed);
+    // mip "level" of every image of "array", runs on the streamer's loader thread
+    void buildLevel(int array, int level, std::vector<unsigned char>& pixels) const;
+    void createAtlas(const std::vector<MaterialImage>& images, std::vector<glm::vec4>& regions);
+    void destroy();
+};
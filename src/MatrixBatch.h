@@ -0,0 +1,82 @@
+/*
+ * MatrixBatch.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the SIMD matrix kernels. glm's own SIMD code
+ *      only covers its aligned types, and aligning the default ones
+ *      would change the layout of every vec3 the renderer mirrors in
+ *      std140 blocks and vertex buffers, so the per-object math the
+ *      scene runs over every moved object is written here directly:
+ *      parent * local matrix products and bounding box transforms.
+ *
+ *      With RENDERER_SIMD (on by default) they use SSE; without it, or
+ *      on other architectures, they are glm's own operations. Without
+ *      FMA both paths add in glm's order and give the same bits.
+ *      bench/matrix_benchmark.cpp times them against glm, together with
+ *      array kernels for one matrix times many (AVX when the compiler
+ *      targets it), which nothing in the scene update has a use for.
+ *
+ *      MultiplyMatrix(world[parent], local, world[index]);
+ */
+
+#pragma once
+
+#include "Bounds.h"
+
+#include <glm/glm.hpp>
+
+#if defined(RENDERER_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RENDERER_SIMD_SSE 1
+#include <immintrin.h>
+#if defined(__AVX__)
+#define RENDERER_SIMD_AVX 1
+#endif
+#endif
+
+
+// out = left * right, "out" may be either input
+inline void MultiplyMatrix(const glm::mat4& left, const glm::mat4& right, glm::mat4& out) {
+#ifdef RENDERER_SIMD_SSE
+    __m128 a0 = _mm_loadu_ps(&left[0][0]);
+    __m128 a1 = _mm_loadu_ps(&left[1][0]);
+    __m128 a2 = _mm_loadu_ps(&left[2][0]);
+    __m128 a3 = _mm_loadu_ps(&left[3][0]);
+    __m128 columns[4];
+    for (int j = 0; j < 4; j++) {
+        __m128 b = _mm_loadu_ps(&right[j][0]);
+        __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+        columns[j] = r;
+    }
+    for (int j = 0; j < 4; j++)
+        _mm_storeu_ps(&out[j][0], columns[j]);
+#else
+    out = left * right;
+#endif
+}
+
+// same as box.Transformed(m)
+inline AABB TransformBox(const glm::mat4& m, const AABB& box) {
+#ifdef RENDERER_SIMD_SSE
+    // Arvo's method with a matrix column per register
+    __m128 newMin = _mm_loadu_ps(&m[3][0]);
+    __m128 newMax = newMin;
+    for (int column = 0; column < 3; column++) {
+        __m128 axis = _mm_loadu_ps(&m[column][0]);
+        __m128 a = _mm_mul_ps(axis, _mm_set1_ps(box.min[column]));
+        __m128 b = _mm_mul_ps(axis, _mm_set1_ps(box.max[column]));
+        newMin = _mm_add_ps(newMin, _mm_min_ps(a, b));
+        newMax = _mm_add_ps(newMax, _mm_max_ps(a, b));
+    }
+    alignas(16) float lo[4], hi[4];
+    _mm_store_ps(lo, newMin);
+    _mm_store_ps(hi, newMax);
+    return AABB(glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]));
+#else
+    return box.Transformed(m);
+#endif
+}
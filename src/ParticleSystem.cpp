@@ -0,0 +1,354 @@
+/*
+ * ParticleSystem.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the GPU particles.
+ */
+
+#include "ParticleSystem.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <vector>
+
+
+namespace {
+
+// work group size in particle_emit.comp and particle_simulate.comp
+const int PARTICLE_GROUP_SIZE = 64;
+
+// one particle: position and seconds left, velocity and seconds it was born with
+const size_t PARTICLE_BYTES = 8 * sizeof(float);
+// the DrawArraysIndirectCommand in front of the draw list
+const size_t COMMAND_BYTES = 4 * sizeof(GLuint);
+
+// shortest and longest life, the emission rate keeps about "capacity" alive on average
+const float MIN_LIFETIME = 2.0f;
+const float MAX_LIFETIME = 4.0f;
+
+// billboard half size in world units and the brightness of a single particle, lower the more
+// there are so the fountain doesn't burn out to white
+const float PARTICLE_SIZE = 0.02f;
+const float BRIGHTNESS_PARTICLES = 20000.0f;
+
+int groups(int size, int groupSize) {
+    return (size + groupSize - 1) / groupSize;
+}
+
+// the vertex layout of particle.vert and particle_update.vert over a buffer of particles
+void particleAttributes(GLuint buffer, GLintptr offset, GLuint divisor) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, PARTICLE_BYTES, (void*)offset);
+    glEnableVertexAttribArray(0);
+    glVertexAttribDivisor(0, divisor);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, PARTICLE_BYTES, (void*)(offset + 4 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, divisor);
+}
+
+}
+
+
+bool ParticleSystem::IsComputeSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+ParticleSystem::ParticleSystem()
+    : emitKernel(nullptr), simulateKernel(nullptr), capacity(0), compute(false), emitted(0.0f), seed(0), emitStart(0),
+      particleBuffer(0), freeListBuffer(0), drawListBuffer(0), drawVAO(0), feedbackBuffers{ 0, 0 }, updateVAOs{ 0, 0 },
+      feedbackVAOs{ 0, 0 }, current(0), queryFrame(0), simulated(false) {
+
+    if (IsComputeSupported()) {
+        emitKernel = new Shader("src/shaders/particle_emit.comp");
+        simulateKernel = new Shader("src/shaders/particle_simulate.comp");
+    }
+    drawShader = new Shader("src/shaders/particle.vert", "src/shaders/particle.frag");
+
+    // the outputs to capture have to be named before linking, so the program is linked again;
+    // rasterization is off while it runs, any fragment shader does
+    updateShader = new Shader("src/shaders/particle_update.vert", "src/shaders/shadow_depth.frag");
+    const char* varyings[] = { "outPositionLife", "outVelocityLifetime" };
+    glTransformFeedbackVaryings(updateShader->ID, 2, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(updateShader->ID);
+    GLint linked = 0;
+    glGetProgramiv(updateShader->ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        Global::logger.log(ERROR, "Particle transform feedback program didn't link.");
+    }
+
+    for (int f = 0; f < QUERY_FRAMES; f++) {
+        glGenQueries(3, queries[f]);
+        queriesIssued[f] = false;
+        countBuffers[f] = resources::CreateBuffer("ParticleSystem", "live count readback");
+        glBindBuffer(GL_COPY_WRITE_BUFFER, countBuffers[f]);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(GLuint), NULL, GL_STREAM_READ);
+        resources::SetSize(resources::ResourceType::Buffer, countBuffers[f], sizeof(GLuint));
+        countFences[f] = nullptr;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+ParticleSystem::~ParticleSystem() {
+    release();
+    for (int f = 0; f < QUERY_FRAMES; f++) {
+        glDeleteQueries(3, queries[f]);
+        resources::Delete(resources::ResourceType::Buffer, countBuffers[f]);
+    }
+    delete emitKernel;
+    delete simulateKernel;
+    delete drawShader;
+    delete updateShader;
+}
+
+void ParticleSystem::SetCapacity(int capacity, bool compute) {
+    capacity = std::min(std::max(capacity, 0), MAX_CAPACITY);
+    compute = compute && IsComputeSupported();
+    if (capacity == this->capacity && (capacity == 0 || compute == this->compute))
+        return;
+
+    release();
+    this->capacity = capacity;
+    this->compute = compute;
+    stats = Stats();
+    stats.capacity = capacity;
+    stats.compute = compute;
+    if (capacity == 0)
+        return;
+
+    // every particle starts dead
+    std::vector<float> dead(capacity * PARTICLE_BYTES / sizeof(float), 0.0f);
+    size_t particleBytes = capacity * PARTICLE_BYTES;
+
+    if (compute) {
+        particleBuffer = resources::CreateBuffer("ParticleSystem", "particles");
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, particleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, particleBytes, dead.data(), GL_DYNAMIC_DRAW);
+        resources::SetSize(resources::ResourceType::Buffer, particleBuffer, particleBytes);
+
+        // so every slot is free: the count, then the slots
+        std::vector<GLuint> freeList(capacity + 1);
+        freeList[0] = (GLuint)capacity;
+        for (int i = 0; i < capacity; i++)
+            freeList[i + 1] = (GLuint)i;
+        freeListBuffer = resources::CreateBuffer("ParticleSystem", "free list");
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, freeListBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, freeList.size() * sizeof(GLuint), freeList.data(), GL_DYNAMIC_DRAW);
+        resources::SetSize(resources::ResourceType::Buffer, freeListBuffer, freeList.size() * sizeof(GLuint));
+
+        // 4 vertices for each of the instanceCount particles simulate copies behind the command
+        GLuint command[4] = { 4, 0, 0, 0 };
+        drawListBuffer = resources::CreateBuffer("ParticleSystem", "draw list");
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawListBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, COMMAND_BYTES + particleBytes, NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, COMMAND_BYTES, command);
+        resources::SetSize(resources::ResourceType::Buffer, drawListBuffer, COMMAND_BYTES + particleBytes);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        drawVAO = resources::CreateVertexArray("ParticleSystem", "draw list");
+        glBindVertexArray(drawVAO);
+        particleAttributes(drawListBuffer, COMMAND_BYTES, 1);
+        stats.bytes = (long long)(particleBytes + freeList.size() * sizeof(GLuint) + COMMAND_BYTES + particleBytes);
+        stats.alive = 0;
+    } else {
+        for (int i = 0; i < 2; i++) {
+            feedbackBuffers[i] = resources::CreateBuffer("ParticleSystem", "particles");
+            glBindBuffer(GL_ARRAY_BUFFER, feedbackBuffers[i]);
+            glBufferData(GL_ARRAY_BUFFER, particleBytes, dead.data(), GL_DYNAMIC_COPY);
+            resources::SetSize(resources::ResourceType::Buffer, feedbackBuffers[i], particleBytes);
+
+            updateVAOs[i] = resources::CreateVertexArray("ParticleSystem", "update");
+            glBindVertexArray(updateVAOs[i]);
+            particleAttributes(feedbackBuffers[i], 0, 0);
+            feedbackVAOs[i] = resources::CreateVertexArray("ParticleSystem", "draw");
+            glBindVertexArray(feedbackVAOs[i]);
+            particleAttributes(feedbackBuffers[i], 0, 1);
+        }
+        stats.bytes = (long long)(2 * particleBytes);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int ParticleSystem::GetCapacity() const {
+    return capacity;
+}
+
+void ParticleSystem::Update(float seconds, const glm::vec3& emitter) {
+    simulated = false;
+    if (capacity == 0)
+        return;
+    collectResults();
+
+    // as many new particles a second as die on average
+    emitted += seconds * capacity / (0.5f * (MIN_LIFETIME + MAX_LIFETIME));
+    int emitCount = std::min((int)emitted, capacity);
+    emitted -= (float)(int)emitted;
+    seed++;
+
+    GLuint* timestamps = queries[queryFrame];
+    glQueryCounter(timestamps[0], GL_TIMESTAMP);
+
+    if (compute) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, freeListBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawListBuffer);
+
+        if (emitCount > 0) {
+            emitKernel->use();
+            glUniform1ui(glGetUniformLocation(emitKernel->ID, "emitCount"), (GLuint)emitCount);
+            glUniform1ui(glGetUniformLocation(emitKernel->ID, "seed"), seed);
+            emitKernel->setVec3("emitter", emitter);
+            emitKernel->setVec2("lifetime", MIN_LIFETIME, MAX_LIFETIME);
+            glDispatchCompute(groups(emitCount, PARTICLE_GROUP_SIZE), 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        }
+
+        // the list is rebuilt from nothing every frame
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawListBuffer);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, sizeof(GLuint), sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        simulateKernel->use();
+        glUniform1ui(glGetUniformLocation(simulateKernel->ID, "capacity"), (GLuint)capacity);
+        simulateKernel->setFloat("deltaTime", seconds);
+        glDispatchCompute(groups(capacity, PARTICLE_GROUP_SIZE), 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+                | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        // the live count for the stats, read once the GPU got there
+        glBindBuffer(GL_COPY_READ_BUFFER, drawListBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, countBuffers[queryFrame]);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(GLuint), 0, sizeof(GLuint));
+        countFences[queryFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    } else {
+        updateShader->use();
+        updateShader->setInt("capacity", capacity);
+        updateShader->setInt("emitStart", emitStart);
+        updateShader->setInt("emitCount", emitCount);
+        glUniform1ui(glGetUniformLocation(updateShader->ID, "seed"), seed);
+        updateShader->setVec3("emitter", emitter);
+        updateShader->setVec2("lifetime", MIN_LIFETIME, MAX_LIFETIME);
+        updateShader->setFloat("deltaTime", seconds);
+
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(updateVAOs[current]);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffers[1 - current]);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, capacity);
+        glEndTransformFeedback();
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glBindVertexArray(0);
+        glDisable(GL_RASTERIZER_DISCARD);
+
+        current = 1 - current;
+        emitStart = (emitStart + emitCount) % capacity;
+    }
+
+    glQueryCounter(timestamps[1], GL_TIMESTAMP);
+    simulated = true;
+}
+
+void ParticleSystem::Draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (!simulated)
+        return;
+
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean depthWrite;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthWrite);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDepthMask(GL_FALSE);
+
+    drawShader->use();
+    drawShader->setMat4("view", view);
+    drawShader->setMat4("projection", projection);
+    drawShader->setFloat("size", PARTICLE_SIZE);
+    drawShader->setFloat("intensity", std::min(1.0f, BRIGHTNESS_PARTICLES / capacity));
+
+    if (compute) {
+        // as many instances as simulate appended, never known on this side
+        glBindVertexArray(drawVAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawListBuffer);
+        glDrawArraysIndirect(GL_TRIANGLE_STRIP, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        glBindVertexArray(feedbackVAOs[current]);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, capacity);
+    }
+    glBindVertexArray(0);
+
+    glDepthMask(depthWrite);
+    if (!blend)
+        glDisable(GL_BLEND);
+
+    glQueryCounter(queries[queryFrame][2], GL_TIMESTAMP);
+    queriesIssued[queryFrame] = true;
+    queryFrame = (queryFrame + 1) % QUERY_FRAMES;
+}
+
+const ParticleSystem::Stats& ParticleSystem::GetStats() const {
+    return stats;
+}
+
+void ParticleSystem::release() {
+    for (int f = 0; f < QUERY_FRAMES; f++) {
+        queriesIssued[f] = false;
+        if (countFences[f]) {
+            glDeleteSync(countFences[f]);
+            countFences[f] = nullptr;
+        }
+    }
+    resources::Delete(resources::ResourceType::Buffer, particleBuffer);
+    resources::Delete(resources::ResourceType::Buffer, freeListBuffer);
+    resources::Delete(resources::ResourceType::Buffer, drawListBuffer);
+    resources::Delete(resources::ResourceType::VertexArray, drawVAO);
+    for (int i = 0; i < 2; i++) {
+        resources::Delete(resources::ResourceType::Buffer, feedbackBuffers[i]);
+        resources::Delete(resources::ResourceType::VertexArray, updateVAOs[i]);
+        resources::Delete(resources::ResourceType::VertexArray, feedbackVAOs[i]);
+    }
+    capacity = 0;
+    emitted = 0.0f;
+    emitStart = 0;
+    current = 0;
+    simulated = false;
+}
+
+void ParticleSystem::collectResults() {
+    // the set about to be reused was issued QUERY_FRAMES frames ago
+    if (queriesIssued[queryFrame]) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[queryFrame][2], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 times[3];
+            for (int i = 0; i < 3; i++)
+                glGetQueryObjectui64v(queries[queryFrame][i], GL_QUERY_RESULT, &times[i]);
+            stats.simulateMs = (float)((times[1] - times[0]) / 1.0e6);
+            stats.renderMs = (float)((times[2] - times[1]) / 1.0e6);
+        }
+        queriesIssued[queryFrame] = false;
+    }
+
+    // never block, if the GPU is still behind keep showing the older count
+    GLsync& fence = countFences[queryFrame];
+    if (fence) {
+        GLenum state = glClientWaitSync(fence, 0, 0);
+        if (state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED) {
+            GLuint alive = 0;
+            glBindBuffer(GL_COPY_READ_BUFFER, countBuffers[queryFrame]);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(GLuint), &alive);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            stats.alive = (int)alive;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * ParticleSystem.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for GPU particles: a fountain that keeps up to
+ *      "capacity" particles alive, emitted, simulated and drawn without
+ *      the CPU ever touching a particle after the buffers are created.
+ *
+ *      With GL 4.3 everything runs in compute shaders on one particle
+ *      buffer:
+ *
+ *      emit        pops dead slots off an atomic free list and spawns
+ *                  the frame's new particles in them
+ *      simulate    moves every live particle; the ones that die push
+ *                  their slot back onto the free list, the others are
+ *                  appended to the draw list, whose count is the
+ *                  instance count of an indirect draw
+ *      draw        one glDrawArraysIndirect of camera facing quads, one
+ *                  instance per particle in the compacted list
+ *
+ *      On GL 3.3 transform feedback runs the same simulation from one
+ *      buffer into the other and back. Without atomics there is no free
+ *      list: particles live in fixed slots, a window of slots that moves
+ *      round the buffer respawns the dead ones in it, and every slot is
+ *      drawn with the dead ones collapsed to nothing.
+ *
+ *      The live count is read back a few frames late for the stats only.
+ */
+
+#pragma once
+
+#include "Shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+
+class ParticleSystem {
+
+public:
+    static const int MAX_CAPACITY = 1 << 20;
+
+    // of the last frame, the times and the live count arrive a few frames late
+    struct Stats {
+        int capacity = 0;
+        int alive = -1;             // -1 with transform feedback, it has no counter
+        bool compute = false;
+        float simulateMs = 0.0f;    // emission and simulation
+        float renderMs = 0.0f;
+        long long bytes = 0;        // every particle buffer together
+    };
+
+    static bool IsComputeSupported();
+
+    ParticleSystem();
+    ~ParticleSystem();
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // recreates the buffers empty, 0 frees them; "compute" falls back to transform feedback
+    // without GL 4.3
+    void SetCapacity(int capacity, bool compute);
+    int GetCapacity() const;
+
+    // advances "seconds", emitting at the rate that keeps the buffer about full
+    void Update(float seconds, const glm::vec3& emitter);
+    // additive quads, depth tested against what is drawn but not written
+    void Draw(const glm::mat4& view, const glm::mat4& projection);
+    const Stats& GetStats() const;
+
+private:
+    static const int QUERY_FRAMES = 4;
+
+    Shader* emitKernel;             // compute path, null without GL 4.3
+    Shader* simulateKernel;
+    Shader* updateShader;           // transform feedback path
+    Shader* drawShader;
+
+    int capacity;
+    bool compute;
+    float emitted;                  // particles owed to the emission rate, fractions carry over
+    unsigned int seed;
+    int emitStart;                  // transform feedback: first slot of the respawn window
+
+    // compute: particles, free list (count + slots), draw list (indirect command + indices)
+    GLuint particleBuffer;
+    GLuint freeListBuffer;
+    GLuint drawListBuffer;
+    GLuint drawVAO;
+    // transform feedback: the two particle buffers with their update and draw vertex arrays
+    GLuint feedbackBuffers[2];
+    GLuint updateVAOs[2];
+    GLuint feedbackVAOs[2];
+    int current;
+
+    // timestamps around the simulation and the draw, live count copies with their fences
+    GLuint queries[QUERY_FRAMES][3];
+    bool queriesIssued[QUERY_FRAMES];
+    GLuint countBuffers[QUERY_FRAMES];
+    GLsync countFences[QUERY_FRAMES];
+    int queryFrame;
+    bool simulated;
+    Stats stats;
+
+    void release();
+    void collectResults();
+};
+
@@ -0,0 +1,259 @@
+/*
+ * PostProcess.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the post-processing chain.
+ */
+
+#include "PostProcess.h"
+
+#include "GpuResources.h"
+
+#include <algorithm>
+
+
+namespace {
+
+// work group sizes in post_downsample.comp and post_blur.comp
+const int DOWNSAMPLE_GROUP_SIZE = 8;
+const int BLUR_GROUP_SIZE = 128;
+
+// texture units of the composite pass, the bloom levels follow the scene
+const int SCENE_UNIT = 0;
+const int BLOOM_UNIT = 1;
+
+int groups(int size, int groupSize) {
+    return (size + groupSize - 1) / groupSize;
+}
+
+}
+
+
+bool PostProcess::IsComputeSupported() {
+    return GLAD_GL_VERSION_4_3;
+}
+
+PostProcess::PostProcess() : pool("PostProcess"), downsampleKernel(nullptr), blurKernel(nullptr), queryFrame(0) {
+    computeSupported = IsComputeSupported();
+    downsampleShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/post_downsample.frag");
+    blurShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/post_blur.frag");
+    if (computeSupported) {
+        downsampleKernel = new Shader("src/shaders/post_downsample.comp");
+        blurKernel = new Shader("src/shaders/post_blur.comp");
+    }
+
+    compositeShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/post_composite.frag");
+    compositeShader->use();
+    compositeShader->setInt("scene", SCENE_UNIT);
+    const char* bloomNames[BLOOM_LEVELS] = { "bloom0", "bloom1", "bloom2", "bloom3" };
+    for (int level = 0; level < BLOOM_LEVELS; level++)
+        compositeShader->setInt(bloomNames[level], BLOOM_UNIT + level);
+
+    fxaaShader = new Shader("src/shaders/fullscreen.vert", "src/shaders/post_fxaa.frag");
+    fxaaShader->use();
+    fxaaShader->setInt("source", 0);
+
+    emptyVAO = resources::CreateVertexArray("PostProcess", "fullscreen pass");
+    for (int f = 0; f < QUERY_FRAMES; f++) {
+        glGenQueries(4, queries[f]);
+        queriesIssued[f] = false;
+    }
+}
+
+PostProcess::~PostProcess() {
+    for (int f = 0; f < QUERY_FRAMES; f++)
+        glDeleteQueries(4, queries[f]);
+    resources::Delete(resources::ResourceType::VertexArray, emptyVAO);
+    delete downsampleShader;
+    delete blurShader;
+    delete downsampleKernel;
+    delete blurKernel;
+    delete compositeShader;
+    delete fxaaShader;
+}
+
+GLuint PostProcess::Apply(GLuint sceneTexture, int width, int height, const PostSettings& settings) {
+    stats.passes = 0;
+    stats.compute = false;
+    if (!settings.tonemap && !settings.bloom && !settings.fxaa) {
+        stats.bloomMs = stats.compositeMs = stats.fxaaMs = 0.0f;
+        return sceneTexture;
+    }
+    collectTimings();
+
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    GLuint* timestamps = queries[queryFrame];
+    glQueryCounter(timestamps[0], GL_TIMESTAMP);
+
+    // bloom: every level is the one before at half the size, blurred there
+    const RenderTarget* bloomLevels[BLOOM_LEVELS] = {};
+    if (settings.bloom) {
+        bool compute = settings.compute && computeSupported;
+        stats.compute = compute;
+        GLuint source = sceneTexture;
+        int sourceWidth = width, sourceHeight = height;
+        for (int level = 0; level < BLOOM_LEVELS; level++) {
+            int levelWidth = std::max(1, sourceWidth / 2);
+            int levelHeight = std::max(1, sourceHeight / 2);
+            const RenderTarget* target = pool.Acquire(levelWidth, levelHeight, GL_RGBA16F);
+            const RenderTarget* scratch = pool.Acquire(levelWidth, levelHeight, GL_RGBA16F);
+            // only the first step keeps just what is brighter than the threshold
+            downsample(source, sourceWidth, sourceHeight, target, level == 0 ? settings.bloomThreshold : -1.0f, compute);
+            blur(target->texture, scratch, true, compute);
+            blur(scratch->texture, target, false, compute);
+            pool.Release(scratch);
+
+            bloomLevels[level] = target;
+            source = target->texture;
+            sourceWidth = levelWidth;
+            sourceHeight = levelHeight;
+        }
+        if (compute)
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+    glQueryCounter(timestamps[1], GL_TIMESTAMP);
+
+    // composite, always runs: the 8 bit image with its luma is what FXAA and the view read
+    const RenderTarget* composite = pool.Acquire(width, height, GL_RGBA8);
+    glBindFramebuffer(GL_FRAMEBUFFER, composite->fbo);
+    glViewport(0, 0, width, height);
+    compositeShader->use();
+    compositeShader->setFloat("bloomIntensity", settings.bloom ? settings.bloomIntensity : 0.0f);
+    compositeShader->setBool("tonemap", settings.tonemap);
+    compositeShader->setFloat("exposure", settings.exposure);
+    glActiveTexture(GL_TEXTURE0 + SCENE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, sceneTexture);
+    for (int level = 0; level < BLOOM_LEVELS; level++) {
+        glActiveTexture(GL_TEXTURE0 + BLOOM_UNIT + level);
+        glBindTexture(GL_TEXTURE_2D, bloomLevels[level] ? bloomLevels[level]->texture : 0);
+    }
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    stats.passes++;
+    for (int level = 0; level < BLOOM_LEVELS; level++) {
+        glActiveTexture(GL_TEXTURE0 + BLOOM_UNIT + level);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        if (bloomLevels[level])
+            pool.Release(bloomLevels[level]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glQueryCounter(timestamps[2], GL_TIMESTAMP);
+
+    const RenderTarget* output = composite;
+    if (settings.fxaa) {
+        output = pool.Acquire(width, height, GL_RGBA8);
+        glBindFramebuffer(GL_FRAMEBUFFER, output->fbo);
+        fxaaShader->use();
+        fxaaShader->setVec2("texel", 1.0f / width, 1.0f / height);
+        glBindTexture(GL_TEXTURE_2D, composite->texture);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        stats.passes++;
+        pool.Release(composite);
+    }
+    glQueryCounter(timestamps[3], GL_TIMESTAMP);
+    queriesIssued[queryFrame] = true;
+    queryFrame = (queryFrame + 1) % QUERY_FRAMES;
+
+    // back to the pool already, nothing acquires it again before the view has shown it
+    pool.Release(output);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+
+    stats.targets = pool.GetCount();
+    stats.targetBytes = (long long)pool.GetBytes();
+    return output->texture;
+}
+
+void PostProcess::EndFrame() {
+    pool.EndFrame();
+}
+
+const PostProcess::Stats& PostProcess::GetStats() const {
+    return stats;
+}
+
+void PostProcess::downsample(GLuint source, int sourceWidth, int sourceHeight, const RenderTarget* destination,
+        float threshold, bool compute) {
+    glm::vec2 sourceTexel(1.0f / sourceWidth, 1.0f / sourceHeight);
+    glBindTexture(GL_TEXTURE_2D, source);
+
+    if (compute) {
+        downsampleKernel->use();
+        downsampleKernel->setInt("source", 0);
+        downsampleKernel->setVec2("sourceTexel", sourceTexel);
+        downsampleKernel->setFloat("threshold", threshold);
+        glUniform2i(glGetUniformLocation(downsampleKernel->ID, "size"), destination->width, destination->height);
+        glBindImageTexture(0, destination->texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        glDispatchCompute(groups(destination->width, DOWNSAMPLE_GROUP_SIZE), groups(destination->height, DOWNSAMPLE_GROUP_SIZE), 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, destination->fbo);
+        glViewport(0, 0, destination->width, destination->height);
+        downsampleShader->use();
+        downsampleShader->setInt("source", 0);
+        downsampleShader->setVec2("sourceTexel", sourceTexel);
+        downsampleShader->setFloat("threshold", threshold);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    stats.passes++;
+}
+
+void PostProcess::blur(GLuint source, const RenderTarget* destination, bool horizontal, bool compute) {
+    int width = destination->width, height = destination->height;
+    glBindTexture(GL_TEXTURE_2D, source);
+
+    if (compute) {
+        // one group per run of BLUR_GROUP_SIZE pixels along a row (or column)
+        blurKernel->use();
+        blurKernel->setInt("source", 0);
+        GLint direction = glGetUniformLocation(blurKernel->ID, "direction");
+        glUniform2i(direction, horizontal ? 1 : 0, horizontal ? 0 : 1);
+        glUniform2i(glGetUniformLocation(blurKernel->ID, "size"), width, height);
+        glBindImageTexture(0, destination->texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        if (horizontal)
+            glDispatchCompute(groups(width, BLUR_GROUP_SIZE), height, 1);
+        else
+            glDispatchCompute(groups(height, BLUR_GROUP_SIZE), width, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, destination->fbo);
+        glViewport(0, 0, width, height);
+        blurShader->use();
+        blurShader->setInt("source", 0);
+        blurShader->setVec2("step", horizontal ? 1.0f / width : 0.0f, horizontal ? 0.0f : 1.0f / height);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    stats.passes++;
+}
+
+void PostProcess::collectTimings() {
+    // the set about to be reused was issued QUERY_FRAMES chains ago
+    if (!queriesIssued[queryFrame])
+        return;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[queryFrame][3], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+
+    GLuint64 times[4];
+    for (int i = 0; i < 4; i++)
+        glGetQueryObjectui64v(queries[queryFrame][i], GL_QUERY_RESULT, &times[i]);
+    stats.bloomMs = (float)((times[1] - times[0]) / 1.0e6);
+    stats.compositeMs = (float)((times[2] - times[1]) / 1.0e6);
+    stats.fxaaMs = (float)((times[3] - times[2]) / 1.0e6);
+    queriesIssued[queryFrame] = false;
+}
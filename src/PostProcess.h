@@ -0,0 +1,103 @@
+/*
+ * PostProcess.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the post-processing chain between the scene
+ *      framebuffer and the scene view. The scene is drawn in half float,
+ *      so lighting can go past 1, and the enabled effects run over it as
+ *      a sequence of fullscreen passes:
+ *
+ *      bloom       the bright part of the scene, downsampled to half
+ *                  resolution and on through BLOOM_LEVELS levels, every
+ *                  level blurred with a separable 9 tap Gaussian
+ *      composite   scene plus bloom, tonemapped (ACES fit) to 8 bits,
+ *                  with the luma in alpha for FXAA
+ *      fxaa        edge antialiasing on the tonemapped image
+ *
+ *      The bloom kernels are compute shaders on GL 4.3, the blur caches
+ *      its row of texels in shared memory, and fragment passes
+ *      otherwise. Every intermediate image comes from a RenderTargetPool
+ *      and goes back as soon as the next pass has read it. The GPU time
+ *      of every effect is measured with timestamp queries read a few
+ *      frames later.
+ */
+
+#pragma once
+
+#include "RenderTargetPool.h"
+#include "Shader.h"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+
+// which effects run, nothing enabled shows the scene texture as it is
+struct PostSettings {
+    bool tonemap = false;
+    bool bloom = false;
+    bool fxaa = false;
+    bool compute = true;            // bloom as compute kernels where the context has GL 4.3
+    float exposure = 1.0f;
+    float bloomThreshold = 1.0f;    // brightness where the bloom starts
+    float bloomIntensity = 0.5f;
+};
+
+
+class PostProcess {
+
+public:
+    static const int BLOOM_LEVELS = 4;      // half to a sixteenth of the scene resolution
+
+    // of the last frame, the times arrive a few frames late
+    struct Stats {
+        float bloomMs = 0.0f;
+        float compositeMs = 0.0f;
+        float fxaaMs = 0.0f;
+        int passes = 0;             // draws and dispatches
+        bool compute = false;       // the bloom ran as compute kernels
+        int targets = 0;            // in the pool
+        long long targetBytes = 0;
+    };
+
+    static bool IsComputeSupported();
+
+    PostProcess();
+    ~PostProcess();
+    PostProcess(const PostProcess&) = delete;
+    PostProcess& operator=(const PostProcess&) = delete;
+
+    // runs the enabled effects over the scene, returns what to show: a pooled target that stays
+    // valid until the next Apply(), or "sceneTexture" when nothing is enabled; the bound
+    // framebuffer and viewport are restored
+    GLuint Apply(GLuint sceneTexture, int width, int height, const PostSettings& settings);
+    // once per frame, the pool frees what wasn't used for a while
+    void EndFrame();
+    const Stats& GetStats() const;
+
+private:
+    static const int QUERY_FRAMES = 4;
+
+    RenderTargetPool pool;
+    bool computeSupported;
+    Shader* downsampleShader;
+    Shader* blurShader;
+    Shader* downsampleKernel;       // compute, null without GL 4.3
+    Shader* blurKernel;
+    Shader* compositeShader;
+    Shader* fxaaShader;
+    GLuint emptyVAO;
+
+    // timestamps before the chain and after every effect
+    GLuint queries[QUERY_FRAMES][4];
+    bool queriesIssued[QUERY_FRAMES];
+    int queryFrame;
+    Stats stats;
+
+    void downsample(GLuint source, int sourceWidth, int sourceHeight, const RenderTarget* destination, float threshold, bool compute);
+    void blur(GLuint source, const RenderTarget* destination, bool horizontal, bool compute);
+    void collectTimings();
+};
+
@@ -0,0 +1,141 @@
+/*
+ * RenderQueue.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the CPU render queue.
+ */
+
+#include "RenderQueue.h"
+
+#include "LODMesh.h"
+
+#include <algorithm>
+
+
+namespace {
+
+const int SUBTREES_PER_THREAD = 8;      // spare tasks so stealing can even out uneven subtrees
+
+const int MESH_BITS = 8;
+const int TEXTURE_BITS = 8;
+const int LEVEL_BITS = 4;
+const int DEPTH_BITS = 16;
+const int OBJECT_BITS = 28;
+
+// drops the last frame's list and rewinds its arena, the new list starts at the old size
+template <typename T>
+void resetList(std::pmr::vector<T>& list, FrameArena& arena) {
+    size_t lastSize = list.size();
+    list = std::pmr::vector<T>(&arena);
+    arena.Reset();
+    list.reserve(lastSize);
+}
+
+}
+
+
+uint64_t MakeSortKey(int mesh, int texture, int level, float viewDepth, float farPlane, int object) {
+    float normalized = glm::clamp(viewDepth / farPlane, 0.0f, 1.0f);
+    uint64_t depth = (uint64_t)(normalized * (float)((1 << DEPTH_BITS) - 1));
+
+    uint64_t key = (uint64_t)(mesh & ((1 << MESH_BITS) - 1));
+    key = (key << TEXTURE_BITS) | (uint64_t)(texture & ((1 << TEXTURE_BITS) - 1));
+    key = (key << LEVEL_BITS) | (uint64_t)(level & ((1 << LEVEL_BITS) - 1));
+    key = (key << DEPTH_BITS) | depth;
+    key = (key << OBJECT_BITS) | (uint64_t)(object & ((1 << OBJECT_BITS) - 1));
+    return key;
+}
+
+RenderQueue::RenderQueue() : merged(&mergeArena) {}
+
+void RenderQueue::Build(const CullInput& input, ThreadPool& pool) {
+    int threads = pool.GetThreadCount();
+    if ((int)threadLists.size() != threads) {
+        threadLists.clear();
+        for (int i = 0; i < threads; i++)
+            threadLists.push_back(std::make_unique<ThreadList>());
+    }
+    for (auto& list : threadLists) {
+        resetList(list->items, list->arena);
+        list->occluded = 0;
+    }
+
+    input.bvh->CollectSubtrees(threads * SUBTREES_PER_THREAD, subtrees);
+
+    const std::vector<AABB>& bounds = *input.bounds;
+    const std::vector<int>& meshes = *input.meshes;
+    const std::vector<int>& meshLevels = *input.meshLevels;
+    std::vector<int>& objectLODs = *input.objectLODs;
+
+    // every object is reached through exactly one subtree, so the LOD state needs no locking
+    pool.ParallelFor((int)subtrees.size(), 1, [&](int begin, int end, int thread) {
+        ThreadList& list = *threadLists[thread];
+        for (int task = begin; task < end; task++) {
+            list.candidates.clear();
+            input.bvh->QueryFrustum(input.frustum, list.candidates, subtrees[task]);
+
+            for (int id : list.candidates) {
+                const AABB& box = bounds[id];
+                if (input.occluded && input.occluded(box)) {
+                    list.occluded++;
+                    continue;
+                }
+
+                int mesh = meshes[id];
+                int levelCount = mesh >= 0 && mesh < (int)meshLevels.size() ? meshLevels[mesh] : 1;
+                int level = 0;
+                if (input.lodEnabled && levelCount > 1) {
+                    float size = ProjectedSize(box, input.cameraPosition, input.fovY);
+                    level = objectLODs[id] = SelectLODLevel(size, objectLODs[id], levelCount);
+                }
+
+                int texture = input.materials ? (*input.materials)[id].texture : 0;
+                if (input.textureGroups)
+                    texture = texture < (int)input.textureGroups->size() ? (*input.textureGroups)[texture] : 0;
+                float viewDepth = glm::dot(box.Center() - input.cameraPosition, input.cameraForward);
+                list.items.push_back({ MakeSortKey(mesh, texture, level, viewDepth, input.farPlane, id), id, mesh, texture, level });
+            }
+        }
+    });
+}
+
+void RenderQueue::Sort() {
+    size_t total = 0;
+    occludedCount = 0;
+    for (const auto& list : threadLists) {
+        total += list->items.size();
+        occludedCount += list->occluded;
+    }
+
+    resetList(merged, mergeArena);
+    merged.reserve(total);
+    for (const auto& list : threadLists)
+        merged.insert(merged.end(), list->items.begin(), list->items.end());
+
+    std::sort(merged.begin(), merged.end(),
+            [](const DrawItem& l, const DrawItem& r) { return l.sortKey < r.sortKey; });
+}
+
+const std::pmr::vector<DrawItem>& RenderQueue::GetItems() const {
+    return merged;
+}
+
+int RenderQueue::GetOccludedCount() const {
+    return occludedCount;
+}
+
+size_t RenderQueue::GetArenaBytes() const {
+    size_t bytes = mergeArena.GetBytesUsed();
+    for (const auto& list : threadLists)
+        bytes += list->arena.GetBytesUsed();
+    return bytes;
+}
+
+size_t RenderQueue::GetArenaCapacity() const {
+    size_t capacity = mergeArena.GetCapacity();
+    for (const auto& list : threadLists)
+        capacity += list->arena.GetCapacity();
+    return capacity;
+}
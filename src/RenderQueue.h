@@ -0,0 +1,103 @@
+/*
+ * RenderQueue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the CPU render queue. Build() runs the parallel
+ *      half of the frame: the BVH is split into subtrees that the
+ *      thread pool culls (frustum + optional occlusion), picks LOD
+ *      levels for and turns into draw items with a sort key, every
+ *      thread appending to its own list. Sort() merges the lists into
+ *      one, ordered by mesh, texture group, LOD level and depth, that the GL
+ *      thread replays without any further decisions.
+ *
+ *      The lists are std::pmr vectors on frame arenas, one per thread
+ *      plus one for the merged list, so once the arenas have grown to
+ *      the scene a frame builds its queue without heap allocations.
+ *
+ *      Nothing in here touches GL, so it also runs in the benchmarks.
+ */
+
+#pragma once
+
+#include "BVH.h"
+#include "FrameArena.h"
+#include "Scene.h"
+#include "ThreadPool.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+
+struct DrawItem {
+    uint64_t sortKey;
+    int object;
+    int mesh;
+    int texture;        // texture group, see CullInput::textureGroups
+    int level;
+};
+
+// mesh, then texture, then LOD level, then front to back, ties broken by object id
+uint64_t MakeSortKey(int mesh, int texture, int level, float viewDepth, float farPlane, int object);
+
+// everything the parallel part of the frame reads, the vectors are indexed by object id
+struct CullInput {
+    const BVH* bvh = nullptr;
+    const std::vector<AABB>* bounds = nullptr;
+    const std::vector<int>* meshes = nullptr;
+    const std::vector<Material>* materials = nullptr; // optional, every object uses texture 0 without it
+    const std::vector<int>* textureGroups = nullptr;  // optional texture -> group, textures of a group draw together
+    const std::vector<int>* meshLevels = nullptr;   // LOD levels per mesh id, 1 for meshes without a chain
+    std::vector<int>* objectLODs = nullptr;         // current level per object, kept between frames for the hysteresis
+
+    Frustum frustum;
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraForward = glm::vec3(0.0f, 0.0f, -1.0f);
+    float fovY = 0.0f;
+    float farPlane = 100.0f;
+    bool lodEnabled = true;
+
+    // optional occlusion test, called from the pool threads so it must be thread safe
+    std::function<bool(const AABB&)> occluded;
+};
+
+
+class RenderQueue {
+
+public:
+    RenderQueue();
+
+    void Build(const CullInput& input, ThreadPool& pool);
+    void Sort();
+
+    // sorted draw items of the last Build()/Sort(), valid until the next Sort()
+    const std::pmr::vector<DrawItem>& GetItems() const;
+    int GetOccludedCount() const;
+
+    // arena memory used by the last frame and reserved in total
+    size_t GetArenaBytes() const;
+    size_t GetArenaCapacity() const;
+
+private:
+    // one per pool thread, aligned so threads never share a cache line
+    struct alignas(64) ThreadList {
+        FrameArena arena;
+        std::pmr::vector<DrawItem> items;
+        std::vector<int> candidates;      // reused by every task of the thread
+        int occluded = 0;
+
+        ThreadList() : items(&arena) {}
+    };
+
+    std::vector<std::unique_ptr<ThreadList>> threadLists;
+    std::vector<int> subtrees;
+    FrameArena mergeArena;
+    std::pmr::vector<DrawItem> merged;
+    int occludedCount = 0;
+};
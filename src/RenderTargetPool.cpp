@@ -0,0 +1,115 @@
+/*
+ * RenderTargetPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the render target pool.
+ */
+
+#include "RenderTargetPool.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+
+namespace {
+
+// frames a free target is kept around, longer than a displayed texture is read after its frame
+const int IDLE_FRAMES = 8;
+
+// GL_RGBA8 or GL_RGBA16F
+int bytesPerPixel(GLenum format) {
+    return format == GL_RGBA16F ? 8 : 4;
+}
+
+}
+
+
+RenderTargetPool::RenderTargetPool(const char* owner) : owner(owner), frame(0) {
+}
+
+RenderTargetPool::~RenderTargetPool() {
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        resources::Delete(resources::ResourceType::Framebuffer, entry->target.fbo);
+        resources::Delete(resources::ResourceType::Texture, entry->target.texture);
+    }
+}
+
+const RenderTarget* RenderTargetPool::Acquire(int width, int height, GLenum internalFormat) {
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        const RenderTarget& target = entry->target;
+        if (!entry->inUse && target.width == width && target.height == height && target.format == internalFormat) {
+            entry->inUse = true;
+            entry->lastUsed = frame;
+            return &entry->target;
+        }
+    }
+
+    std::unique_ptr<Entry> entry = std::make_unique<Entry>();
+    RenderTarget& target = entry->target;
+    target.width = width;
+    target.height = height;
+    target.format = internalFormat;
+    target.texture = resources::CreateTexture(owner, "pooled target");
+    resources::SetSize(resources::ResourceType::Texture, target.texture, resources::TextureBytes(width, height, bytesPerPixel(internalFormat)));
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    // a single level, complete as it is so compute passes can bind it as an image
+    GLenum type = internalFormat == GL_RGBA16F ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE;
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint previousFramebuffer;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    target.fbo = resources::CreateFramebuffer(owner);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        Global::logger.log(ERROR, "Pooled render target isn't complete.");
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    entry->inUse = true;
+    entry->lastUsed = frame;
+    entries.push_back(std::move(entry));
+    return &entries.back()->target;
+}
+
+void RenderTargetPool::Release(const RenderTarget* target) {
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        if (&entry->target == target) {
+            entry->inUse = false;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::EndFrame() {
+    frame++;
+    auto idle = [this](const std::unique_ptr<Entry>& entry) { return !entry->inUse && frame - entry->lastUsed > IDLE_FRAMES; };
+    for (const std::unique_ptr<Entry>& entry : entries) {
+        if (idle(entry)) {
+            resources::Delete(resources::ResourceType::Framebuffer, entry->target.fbo);
+            resources::Delete(resources::ResourceType::Texture, entry->target.texture);
+        }
+    }
+    entries.erase(std::remove_if(entries.begin(), entries.end(), idle), entries.end());
+}
+
+int RenderTargetPool::GetCount() const {
+    return (int)entries.size();
+}
+
+size_t RenderTargetPool::GetBytes() const {
+    size_t bytes = 0;
+    for (const std::unique_ptr<Entry>& entry : entries)
+        bytes += resources::TextureBytes(entry->target.width, entry->target.height, bytesPerPixel(entry->target.format));
+    return bytes;
+}
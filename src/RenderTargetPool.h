@@ -0,0 +1,71 @@
+/*
+ * RenderTargetPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for a pool of single color render targets shared by
+ *      fullscreen passes. A pass acquires a target of the size and
+ *      format it needs, draws or dispatches into it and releases it as
+ *      soon as the next pass has read it, so a chain of passes
+ *      ping-pongs between a few textures instead of owning one per
+ *      step. Targets nobody acquired for a few frames are deleted, so a
+ *      resize or a disabled effect gives its memory back.
+ *
+ *      const RenderTarget* blurred = pool.Acquire(width, height, GL_RGBA16F);
+ *      ...                                     // draw into blurred->fbo
+ *      pool.Release(blurred);
+ *      ...
+ *      pool.EndFrame();
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+// color 0 of "fbo" is "texture", linear filtered and clamped to the edge
+struct RenderTarget {
+    GLuint texture = 0;
+    GLuint fbo = 0;
+    int width = 0;
+    int height = 0;
+    GLenum format = 0;      // internal format, GL_RGBA8 or GL_RGBA16F
+};
+
+
+class RenderTargetPool {
+
+public:
+    // "owner" is what the targets are registered under (see GpuResources.h)
+    explicit RenderTargetPool(const char* owner);
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // a free target like that (GL_RGBA8 or GL_RGBA16F), created when there is none; stays valid
+    // until it was released and then not acquired for a few frames
+    const RenderTarget* Acquire(int width, int height, GLenum internalFormat);
+    void Release(const RenderTarget* target);
+    // once per frame, deletes what has been free for a while
+    void EndFrame();
+
+    int GetCount() const;
+    size_t GetBytes() const;
+
+private:
+    struct Entry {
+        RenderTarget target;
+        bool inUse = false;
+        int lastUsed = 0;
+    };
+
+    const char* owner;
+    std::vector<std::unique_ptr<Entry>> entries;
+    int frame;
+};
+
@@ -0,0 +1,438 @@
+/*
+ * Scene.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the scene data model. Creating an
+ *      entity appends to the pools, which keeps parents in front of
+ *      their children for free. Destroying or reparenting can break
+ *      that, so those only flag the pools and the next
+ *      UpdateTransforms() compacts/reorders them in one go.
+ */
+
+#include "Scene.h"
+
+#include "Logger.h"
+#include "MatrixBatch.h"
+#include "ThreadPool.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+
+
+namespace {
+
+const size_t PARALLEL_THRESHOLD = 4096;     // smaller updates stay on the calling thread
+const int PARALLEL_GRAIN = 1024;
+
+// returned by getters for stale handles
+const glm::vec3 ZERO_VECTOR(0.0f);
+const glm::vec3 UNIT_SCALE(1.0f);
+const glm::quat IDENTITY_ROTATION(1.0f, 0.0f, 0.0f, 0.0f);
+const glm::mat4 IDENTITY_MATRIX(1.0f);
+const AABB EMPTY_BOUNDS;
+const Material DEFAULT_MATERIAL;
+
+template <typename T>
+void gather(std::vector<T>& pool, const std::vector<int>& order) {
+    std::vector<T> sorted;
+    sorted.reserve(order.size());
+    for (int index : order)
+        sorted.push_back(pool[index]);
+    pool.swap(sorted);
+}
+
+}
+
+
+Entity Scene::CreateEntity(Entity parentEntity) {
+    int parentIndex = -1;
+    if (!parentEntity.IsNull()) {
+        parentIndex = dense(parentEntity);
+        if (parentIndex < 0) {
+            Global::logger.log(WARNING, "CreateEntity: parent is not alive, creating a root entity.");
+        }
+    }
+
+    uint32_t index;
+    if (!freeIndices.empty()) {
+        index = freeIndices.back();
+        freeIndices.pop_back();
+    } else {
+        index = (uint32_t)sparse.size();
+        sparse.push_back(0);
+        generations.push_back(0);
+    }
+
+    sparse[index] = (uint32_t)handleIndex.size();
+    handleIndex.push_back(index);
+    parent.push_back(parentIndex);
+    position.push_back(ZERO_VECTOR);
+    rotation.push_back(IDENTITY_ROTATION);
+    scale.push_back(UNIT_SCALE);
+    world.push_back(IDENTITY_MATRIX);
+    localBounds.push_back(EMPTY_BOUNDS);
+    worldBounds.push_back(EMPTY_BOUNDS);
+    mesh.push_back(-1);
+    material.push_back(DEFAULT_MATERIAL);
+    dirty.push_back(1);
+    removed.push_back(0);
+    layoutVersion++;
+
+    Entity entity;
+    entity.index = index;
+    entity.generation = generations[index];
+    return entity;
+}
+
+void Scene::DestroyEntity(Entity entity) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+
+    // descendants follow their parent in the pools, one forward sweep finds them all
+    if (orderDirty)
+        restoreOrder();
+    index = dense(entity);
+
+    removed[index] = 1;
+    generations[handleIndex[index]]++;
+    for (size_t i = index + 1; i < handleIndex.size(); i++) {
+        if (parent[i] >= 0 && removed[parent[i]] && !removed[i]) {
+            removed[i] = 1;
+            generations[handleIndex[i]]++;
+        }
+    }
+    pendingRemovals = true;
+}
+
+bool Scene::IsAlive(Entity entity) const {
+    // destroying bumps the generation, so this also rejects entities waiting for compaction
+    return entity.index < generations.size() && generations[entity.index] == entity.generation;
+}
+
+void Scene::Clear() {
+    // bump every generation so handles from before the clear stay invalid
+    for (uint32_t& generation : generations)
+        generation++;
+    freeIndices.clear();
+    for (uint32_t i = (uint32_t)generations.size(); i > 0; i--)
+        freeIndices.push_back(i - 1);
+
+    handleIndex.clear();
+    parent.clear();
+    position.clear();
+    rotation.clear();
+    scale.clear();
+    world.clear();
+    localBounds.clear();
+    worldBounds.clear();
+    mesh.clear();
+    material.clear();
+    dirty.clear();
+    removed.clear();
+    changed.clear();
+    changedObjects.clear();
+    pendingRemovals = false;
+    orderDirty = false;
+    layoutVersion++;
+}
+
+int Scene::GetEntityCount() const {
+    return (int)handleIndex.size();
+}
+
+void Scene::SetPosition(Entity entity, const glm::vec3& value) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+    position[index] = value;
+    markDirty(index);
+}
+
+void Scene::SetRotation(Entity entity, const glm::quat& value) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+    rotation[index] = value;
+    markDirty(index);
+}
+
+void Scene::SetScale(Entity entity, const glm::vec3& value) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+    scale[index] = value;
+    markDirty(index);
+}
+
+void Scene::SetParent(Entity entity, Entity parentEntity) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+
+    int parentIndex = parentEntity.IsNull() ? -1 : dense(parentEntity);
+    for (int ancestor = parentIndex; ancestor >= 0; ancestor = parent[ancestor]) {
+        if (ancestor == index) {
+            Global::logger.log(ERROR, "SetParent: an entity can't become a child of its own descendant.");
+            return;
+        }
+    }
+
+    parent[index] = parentIndex;
+    markDirty(index);
+    if (parentIndex > index)
+        orderDirty = true;
+}
+
+const glm::vec3& Scene::GetPosition(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? ZERO_VECTOR : position[index];
+}
+
+const glm::quat& Scene::GetRotation(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? IDENTITY_ROTATION : rotation[index];
+}
+
+const glm::vec3& Scene::GetScale(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? UNIT_SCALE : scale[index];
+}
+
+Entity Scene::GetParent(Entity entity) const {
+    int index = dense(entity);
+    if (index < 0 || parent[index] < 0)
+        return Entity();
+    return GetEntity(parent[index]);
+}
+
+const glm::mat4& Scene::GetWorldMatrix(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? IDENTITY_MATRIX : world[index];
+}
+
+void Scene::SetMesh(Entity entity, int value) {
+    int index = dense(entity);
+    if (index >= 0)
+        mesh[index] = value;
+}
+
+void Scene::SetMaterial(Entity entity, const Material& value) {
+    int index = dense(entity);
+    if (index >= 0)
+        material[index] = value;
+}
+
+void Scene::SetLocalBounds(Entity entity, const AABB& bounds) {
+    int index = dense(entity);
+    if (index < 0)
+        return;
+    localBounds[index] = bounds;
+    markDirty(index);
+}
+
+int Scene::GetMesh(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? -1 : mesh[index];
+}
+
+const Material& Scene::GetMaterial(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? DEFAULT_MATERIAL : material[index];
+}
+
+const AABB& Scene::GetWorldBounds(Entity entity) const {
+    int index = dense(entity);
+    return index < 0 ? EMPTY_BOUNDS : worldBounds[index];
+}
+
+void Scene::UpdateTransforms(ThreadPool* pool) {
+    if (pendingRemovals || orderDirty)
+        restoreOrder();
+
+    size_t count = handleIndex.size();
+    changed.assign(count, 0);
+    changedObjects.clear();
+
+    // flag pass: parents come first, so a changed parent is always known before its children
+    for (size_t i = 0; i < count; i++) {
+        int parentIndex = parent[i];
+        if (dirty[i] || (parentIndex >= 0 && changed[parentIndex])) {
+            changed[i] = 1;
+            changedObjects.push_back((int)i);
+        }
+    }
+
+    if (!pool || pool->GetThreadCount() == 1 || changedObjects.size() < PARALLEL_THRESHOLD) {
+        for (int index : changedObjects)
+            updateWorld(index);
+        return;
+    }
+
+    // entities of the same depth only read their (finished) parents, bucket them by depth
+    // and run every bucket as one parallel pass
+    depth.resize(count);
+    int maxDepth = 0;
+    for (size_t i = 0; i < count; i++) {
+        depth[i] = parent[i] < 0 ? 0 : depth[parent[i]] + 1;
+        maxDepth = std::max(maxDepth, depth[i]);
+    }
+
+    depthStart.assign(maxDepth + 2, 0);
+    for (int index : changedObjects)
+        depthStart[depth[index] + 1]++;
+    for (int d = 0; d <= maxDepth; d++)
+        depthStart[d + 1] += depthStart[d];
+
+    depthOrder.resize(changedObjects.size());
+    depthFill.assign(depthStart.begin(), depthStart.end() - 1);
+    for (int index : changedObjects)
+        depthOrder[depthFill[depth[index]]++] = index;
+
+    for (int d = 0; d <= maxDepth; d++) {
+        const int* bucket = depthOrder.data() + depthStart[d];
+        pool->ParallelFor(depthStart[d + 1] - depthStart[d], PARALLEL_GRAIN, [&](int begin, int end, int) {
+            for (int i = begin; i < end; i++)
+                updateWorld(bucket[i]);
+        });
+    }
+}
+
+const std::vector<int>& Scene::GetChangedObjects() const {
+    return changedObjects;
+}
+
+unsigned int Scene::GetLayoutVersion() const {
+    return layoutVersion;
+}
+
+int Scene::GetDenseIndex(Entity entity) const {
+    return dense(entity);
+}
+
+Entity Scene::GetEntity(int denseIndex) const {
+    Entity entity;
+    if (denseIndex < 0 || denseIndex >= (int)handleIndex.size() || removed[denseIndex])
+        return entity;
+    entity.index = handleIndex[denseIndex];
+    entity.generation = generations[entity.index];
+    return entity;
+}
+
+const std::vector<glm::mat4>& Scene::GetWorldMatrices() const {
+    return world;
+}
+
+const std::vector<AABB>& Scene::GetWorldBounds() const {
+    return worldBounds;
+}
+
+const std::vector<AABB>& Scene::GetLocalBounds() const {
+    return localBounds;
+}
+
+const std::vector<int>& Scene::GetMeshes() const {
+    return mesh;
+}
+
+const std::vector<Material>& Scene::GetMaterials() const {
+    return material;
+}
+
+int Scene::dense(Entity entity) const {
+    return IsAlive(entity) ? (int)sparse[entity.index] : -1;
+}
+
+void Scene::markDirty(int index) {
+    dirty[index] = 1;
+}
+
+void Scene::updateWorld(int index) {
+    // translate * rotate * scale written out: the rotation's columns scaled, the position last
+    glm::mat4 local = glm::mat4_cast(rotation[index]);
+    local[0] *= scale[index].x;
+    local[1] *= scale[index].y;
+    local[2] *= scale[index].z;
+    local[3] = glm::vec4(position[index], 1.0f);
+
+    int parentIndex = parent[index];
+    if (parentIndex < 0)
+        world[index] = local;
+    else
+        MultiplyMatrix(world[parentIndex], local, world[index]);
+    worldBounds[index] = localBounds[index].IsValid() ? TransformBox(world[index], localBounds[index]) : EMPTY_BOUNDS;
+    dirty[index] = 0;
+}
+
+void Scene::reorder(const std::vector<int>& order) {
+    std::vector<int> newIndex(handleIndex.size(), -1);
+    for (size_t i = 0; i < order.size(); i++)
+        newIndex[order[i]] = (int)i;
+
+    // handles of dropped entities can be reused now that their slot is gone
+    for (size_t i = 0; i < handleIndex.size(); i++) {
+        if (newIndex[i] < 0)
+            freeIndices.push_back(handleIndex[i]);
+    }
+
+    gather(handleIndex, order);
+    gather(parent, order);
+    gather(position, order);
+    gather(rotation, order);
+    gather(scale, order);
+    gather(world, order);
+    gather(localBounds, order);
+    gather(worldBounds, order);
+    gather(mesh, order);
+    gather(material, order);
+    gather(dirty, order);
+    removed.assign(order.size(), 0);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        sparse[handleIndex[i]] = (uint32_t)i;
+        if (parent[i] >= 0)
+            parent[i] = newIndex[parent[i]];
+    }
+    layoutVersion++;
+}
+
+void Scene::restoreOrder() {
+    size_t count = handleIndex.size();
+    std::vector<int> order;
+    order.reserve(count);
+
+    if (!orderDirty) {
+        // only removals, the surviving order is still valid
+        for (size_t i = 0; i < count; i++) {
+            if (!removed[i])
+                order.push_back((int)i);
+        }
+    } else {
+        // sort by depth in the hierarchy, stable so siblings keep their relative order
+        std::vector<int> depth(count, -1);
+        for (size_t i = 0; i < count; i++) {
+            int walk = (int)i;
+            int steps = 0;
+            while (walk >= 0 && depth[walk] < 0) {
+                walk = parent[walk];
+                steps++;
+            }
+            int base = walk < 0 ? -1 : depth[walk];
+            walk = (int)i;
+            for (int d = base + steps; walk >= 0 && depth[walk] < 0; d--) {
+                depth[walk] = d;
+                walk = parent[walk];
+            }
+            if (!removed[i])
+                order.push_back((int)i);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](int l, int r) { return depth[l] < depth[r]; });
+    }
+
+    pendingRemovals = false;
+    orderDirty = false;
+    reorder(order);
+}
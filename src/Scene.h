@@ -0,0 +1,141 @@
+/*
+ * Scene.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the scene data model. Entities are referred
+ *      to by generational handles, their components (transform, mesh,
+ *      material, bounds) live in dense structure-of-arrays pools so
+ *      the per-frame passes walk plain contiguous arrays.
+ *
+ *      The pools are kept in parent-before-child order, which lets
+ *      UpdateTransforms() propagate the hierarchy in one linear pass.
+ *      Only entities whose local transform (or an ancestor's) changed
+ *      get their world matrix and world bounds recomputed.
+ *
+ *      Scene scene;
+ *      Entity cube = scene.CreateEntity();
+ *      Entity moon = scene.CreateEntity(cube);      // child of cube
+ *      scene.SetPosition(moon, glm::vec3(1, 0, 0));
+ *      scene.UpdateTransforms();                     // world matrices + bounds
+ *      for (int index : scene.GetChangedObjects()) ...
+ */
+
+#pragma once
+
+#include "Bounds.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// generational handle, stale handles of destroyed entities are detected
+struct Entity {
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool IsNull() const { return index == INVALID_INDEX; }
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+struct Material {
+    float mixFactor = 0.0f;     // blend between the two textures of the cube shader
+    int texture = 0;            // which of the renderer's textures takes the first slot
+    float specular = 0.25f;     // strength of the highlights when lit, below 1
+};
+
+
+class Scene {
+
+public:
+    // parent must be alive or null, children are destroyed with their parent
+    // destroyed entities keep their dense slot until the next UpdateTransforms()
+    Entity CreateEntity(Entity parent = Entity());
+    void DestroyEntity(Entity entity);
+    bool IsAlive(Entity entity) const;
+    void Clear();
+    int GetEntityCount() const;
+
+    // transform component, local to the parent
+    void SetPosition(Entity entity, const glm::vec3& position);
+    void SetRotation(Entity entity, const glm::quat& rotation);
+    void SetScale(Entity entity, const glm::vec3& scale);
+    void SetParent(Entity entity, Entity parent);
+    const glm::vec3& GetPosition(Entity entity) const;
+    const glm::quat& GetRotation(Entity entity) const;
+    const glm::vec3& GetScale(Entity entity) const;
+    Entity GetParent(Entity entity) const;
+    const glm::mat4& GetWorldMatrix(Entity entity) const;
+
+    // mesh, material and bounds components
+    void SetMesh(Entity entity, int mesh);
+    void SetMaterial(Entity entity, const Material& material);
+    void SetLocalBounds(Entity entity, const AABB& bounds);
+    int GetMesh(Entity entity) const;
+    const Material& GetMaterial(Entity entity) const;
+    const AABB& GetWorldBounds(Entity entity) const;
+
+    // recomputes world matrices/bounds of dirty entities and their descendants, parents first
+    // with a pool, large updates run one hierarchy depth at a time spread over its threads
+    void UpdateTransforms(ThreadPool* pool = nullptr);
+    // dense indices whose world matrix changed in the last UpdateTransforms()
+    const std::vector<int>& GetChangedObjects() const;
+    // bumps whenever dense indices move (create/destroy/reparent), anything indexed by them must be rebuilt
+    unsigned int GetLayoutVersion() const;
+
+    // dense index <-> handle, valid until the layout version changes
+    int GetDenseIndex(Entity entity) const;
+    Entity GetEntity(int denseIndex) const;
+
+    // whole pools, indexed by dense index
+    const std::vector<glm::mat4>& GetWorldMatrices() const;
+    const std::vector<AABB>& GetWorldBounds() const;
+    const std::vector<AABB>& GetLocalBounds() const;
+    const std::vector<int>& GetMeshes() const;
+    const std::vector<Material>& GetMaterials() const;
+
+private:
+    // handle index -> dense index, with the generation that is currently alive there
+    std::vector<uint32_t> sparse;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeIndices;
+
+    // dense pools, parents always come before their children
+    std::vector<uint32_t> handleIndex;
+    std::vector<int> parent;            // dense index, -1 for roots
+    std::vector<glm::vec3> position;
+    std::vector<glm::quat> rotation;
+    std::vector<glm::vec3> scale;
+    std::vector<glm::mat4> world;
+    std::vector<AABB> localBounds;
+    std::vector<AABB> worldBounds;
+    std::vector<int> mesh;
+    std::vector<Material> material;
+    std::vector<uint8_t> dirty;
+
+    std::vector<uint8_t> changed;
+    std::vector<int> changedObjects;
+    std::vector<int> depth;             // scratch for the parallel update
+    std::vector<int> depthOrder;
+    std::vector<int> depthStart;
+    std::vector<int> depthFill;
+    std::vector<uint8_t> removed;
+    bool pendingRemovals = false;
+    bool orderDirty = false;
+    unsigned int layoutVersion = 0;
+
+    int dense(Entity entity) const;
+    void markDirty(int index);
+    void updateWorld(int index);
+    // rebuilds every pool in "order" (dense indices), dropping removed entities
+    void reorder(const std::vector<int>& order);
+    void restoreOrder();
+};
@@ -10,6 +10,7 @@
 
 #include "Shader.h"
 
+#include "GpuResources.h"
 #include "Logger.h"
 
 #include <fstream>
@@ -21,6 +22,49 @@
 unsigned int ID;
 
 
+namespace {
+
+// how deep included files may include others
+const int MAX_INCLUDE_DEPTH = 4;
+
+// GLSL has no includes: an #include "file" line is replaced by the file, looked up next to the
+// file that includes it, and a #line afterwards keeps compile errors pointing at the right line
+std::string resolveIncludes(const std::string& source, const std::string& path, int depth = 0) {
+    std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+    std::istringstream lines(source);
+    std::string result;
+    std::string line;
+    int number = 0;
+    while (std::getline(lines, line)) {
+        number++;
+        size_t start = line.find_first_not_of(" \t");
+        size_t open = line.find('"');
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0 || close == std::string::npos) {
+            result += line;
+            result += '\n';
+            continue;
+        }
+
+        std::string includePath = directory + line.substr(open + 1, close - open - 1);
+        std::ifstream file(includePath);
+        if (!file.is_open() || depth >= MAX_INCLUDE_DEPTH) {
+            // the line stays, the compiler reports it too
+            Global::logger.log(ERROR, "Shader include " + includePath + " not read.");
+            result += line;
+            result += '\n';
+            continue;
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        result += resolveIncludes(contents.str(), includePath, depth + 1);
+        result += "#line " + std::to_string(number + 1) + "\n";
+    }
+    return result;
+}
+
+}
+
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     // 1. retrieve GLSL source
@@ -44,8 +88,8 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
         vShaderFile.close();
         fShaderFile.close();
         // convert stream into string
-        vertexCode   = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        vertexCode   = resolveIncludes(vShaderStream.str(), vertexPath);
+        fragmentCode = resolveIncludes(fShaderStream.str(), fragmentPath);
     } catch(std::ifstream::failure e) {
         Global::logger.log(ERROR, "Shader file not read.");
     }
@@ -66,6 +110,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     checkCompileErrors(fragment, "FRAGMENT");
     // shader Program
     ID = glCreateProgram();
+    resources::Track(resources::ResourceType::Program, ID, "Shader", std::string(vertexPath) + " + " + fragmentPath);
     glAttachShader(ID, vertex);
     glAttachShader(ID, fragment);
     glLinkProgram(ID);
@@ -76,8 +121,42 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     glDeleteShader(fragment);
 }
 
+Shader::Shader(const char* computePath) {
+    // 1. retrieve GLSL source
+    std::string computeCode;
+    std::ifstream cShaderFile;
+
+    cShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    try {
+        cShaderFile.open(computePath);
+        std::stringstream cShaderStream;
+        cShaderStream << cShaderFile.rdbuf();
+        cShaderFile.close();
+        computeCode = resolveIncludes(cShaderStream.str(), computePath);
+    } catch(const std::ifstream::failure& e) {
+        Global::logger.log(ERROR, "Shader file not read.");
+    }
+    const char* cShaderCode = computeCode.c_str();
+
+    // 2. Compile GLSL shader
+    unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(compute, 1, &cShaderCode, NULL);
+    glCompileShader(compute);
+    checkCompileErrors(compute, "COMPUTE");
+    // shader Program
+    ID = glCreateProgram();
+    resources::Track(resources::ResourceType::Program, ID, "Shader", computePath);
+    glAttachShader(ID, compute);
+    glLinkProgram(ID);
+    checkCompileErrors(ID, "PROGRAM");
+
+    // delete the shader after linkage
+    glDeleteShader(compute);
+}
+
 Shader::~Shader() {
-    glDeleteProgram(ID);
+    resources::Delete(resources::ResourceType::Program, ID);
     Global::logger.log(INFO, "SHADER PROGRAM deleted.");
 }
 
@@ -88,51 +167,57 @@ void Shader::use() {
 
 // UNIFORM FUNCTIONS
 
-void Shader::setBool(const std::string &name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+void Shader::setBool(const char *name, bool value) const {
+    glUniform1i(glGetUniformLocation(ID, name), (int)value);
 }
 
-void Shader::setInt(const std::string &name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setInt(const char *name, int value) const {
+    glUniform1i(glGetUniformLocation(ID, name), value);
 }
 
-void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setFloat(const char *name, float value) const {
+    glUniform1f(glGetUniformLocation(ID, name), value);
 }
 
-void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setVec2(const char *name, const glm::vec2 &value) const {
+    glUniform2fv(glGetUniformLocation(ID, name), 1, &value[0]);
 }
 
-void Shader::setVec2(const std::string &name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+void Shader::setVec2(const char *name, float x, float y) const {
+    glUniform2f(glGetUniformLocation(ID, name), x, y);
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setVec3(const char *name, const glm::vec3 &value) const {
+    glUniform3fv(glGetUniformLocation(ID, name), 1, &value[0]);
+}
+void Shader::setVec3(const char *name, float x, float y, float z) const {
+    glUniform3f(glGetUniformLocation(ID, name), x, y, z);
 }
-void Shader::setVec3(const std::string &name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+
+void Shader::setVec4(const char *name, const glm::vec4 &value) const {
+    glUniform4fv(glGetUniformLocation(ID, name), 1, &value[0]);
 }
 
-void Shader::setVec4(const std::string &name, const glm::vec4 &value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+void Shader::setVec4(const char *name, float x, float y, float z, float w) const {
+    glUniform4f(glGetUniformLocation(ID, name), x, y, z, w);
 }
 
-void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+void Shader::setMat2(const char *name, const glm::mat2 &mat) const {
+    glUniformMatrix2fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void Shader::setMat3(const char *name, const glm::mat3 &mat) const {
+    glUniformMatrix3fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void Shader::setMat4(const char *name, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+void Shader::setUniformBlock(const char *name, unsigned int binding) const {
+    GLuint index = glGetUniformBlockIndex(ID, name);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(ID, index, binding);
 }
 
 
@@ -24,25 +24,30 @@ public:
     // constructor, builds shader from paths
     Shader(const char* vertexPath, const char* fragmentPath);
 
+    // constructor, builds a compute shader program (GL 4.3+)
+    explicit Shader(const char* computePath);
+
     // destructor, calls glDeleteProgram
     ~Shader();
 
     // use/activate shader
     void use();
 
-    // uniform functions
-    void setBool(const std::string &name, bool value) const;
-    void setInt(const std::string &name, int value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setVec2(const std::string &name, const glm::vec2 &value) const;
-    void setVec2(const std::string &name, float x, float y) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setVec3(const std::string &name, float x, float y, float z) const;
-    void setVec4(const std::string &name, const glm::vec4 &value) const;
-    void setVec4(const std::string &name, float x, float y, float z, float w) const;
-    void setMat2(const std::string &name, const glm::mat2 &mat) const;
-    void setMat3(const std::string &name, const glm::mat3 &mat) const;
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
+    // uniform functions, the names are plain C strings so per-frame calls build no std::string
+    void setBool(const char *name, bool value) const;
+    void setInt(const char *name, int value) const;
+    void setFloat(const char *name, float value) const;
+    void setVec2(const char *name, const glm::vec2 &value) const;
+    void setVec2(const char *name, float x, float y) const;
+    void setVec3(const char *name, const glm::vec3 &value) const;
+    void setVec3(const char *name, float x, float y, float z) const;
+    void setVec4(const char *name, const glm::vec4 &value) const;
+    void setVec4(const char *name, float x, float y, float z, float w) const;
+    void setMat2(const char *name, const glm::mat2 &mat) const;
+    void setMat3(const char *name, const glm::mat3 &mat) const;
+    void setMat4(const char *name, const glm::mat4 &mat) const;
+    // ties a uniform block to a GL_UNIFORM_BUFFER binding point
+    void setUniformBlock(const char *name, unsigned int binding) const;
 
 
 private:
@@ -0,0 +1,328 @@
+/*
+ * ShadowCascades.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for cascaded shadow maps.
+ */
+
+#include "ShadowCascades.h"
+
+#include "GpuResources.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace {
+
+// 0 splits uniformly, 1 logarithmically
+const float SPLIT_LAMBDA = 0.75f;
+// the scene's depth range along the light is rounded out to this, so objects moving a little
+// inside it don't change the cascade matrices
+const float DEPTH_ROUNDING = 4.0f;
+// slope scaled and constant depth offset of the shadow pass
+const float OFFSET_FACTOR = 2.0f;
+const float OFFSET_UNITS = 4.0f;
+
+bool casterOrder(const ShadowCaster& a, const ShadowCaster& b) {
+    return a.mesh != b.mesh ? a.mesh < b.mesh : a.level < b.level;
+}
+
+GLuint createDepthArray(const char* label, int resolution, bool compare) {
+    GLuint texture = resources::CreateTexture("ShadowCascades", label);
+    resources::SetSize(resources::ResourceType::Texture, texture,
+            resources::TextureBytes(resolution, resolution, 4) * ShadowCascades::CASCADES);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, resolution, resolution,
+            ShadowCascades::CASCADES, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    if (compare) {
+        // bilinear compares, and everything outside the map is lit
+        const float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+}
+
+
+ShadowCascades::ShadowCascades() : zMin(0.0f), zMax(0.0f), queryFrame(0) {
+    depthShader = new Shader("src/shaders/vertex_shader.vert", "src/shaders/shadow_depth.frag");
+
+    shadowMaps = createDepthArray("shadow maps", RESOLUTION, true);
+    staticMaps = createDepthArray("static shadow cache", CACHE_RESOLUTION, false);
+
+    // depth only, both
+    fbo = resources::CreateFramebuffer("ShadowCascades");
+    copyFbo = resources::CreateFramebuffer("ShadowCascades");
+    for (GLuint framebuffer : { fbo, copyFbo }) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (int c = 0; c < CASCADES; c++) {
+        centres[c] = glm::vec2(0.0f);
+        radii[c] = 0.0f;
+        hasDynamic[c] = false;
+        copiedOffset[c] = glm::ivec2(-1);
+    }
+    for (int f = 0; f < QUERY_FRAMES; f++) {
+        glGenQueries(CASCADES + 1, queries[f]);
+        queriesIssued[f] = false;
+    }
+}
+
+ShadowCascades::~ShadowCascades() {
+    for (int f = 0; f < QUERY_FRAMES; f++)
+        glDeleteQueries(CASCADES + 1, queries[f]);
+    resources::Delete(resources::ResourceType::Framebuffer, fbo);
+    resources::Delete(resources::ResourceType::Framebuffer, copyFbo);
+    resources::Delete(resources::ResourceType::Texture, shadowMaps);
+    resources::Delete(resources::ResourceType::Texture, staticMaps);
+    delete depthShader;
+}
+
+void ShadowCascades::Build(const ShadowInput& input, ThreadPool& pool, ShadowCascade (&cascades)[CASCADES]) {
+    fit(input, cascades);
+
+    for (int c = 0; c < CASCADES; c++) {
+        ShadowCascade& cascade = cascades[c];
+        StaticCache& cache = caches[c];
+        // both centres are on the same texel grid, the window moves by whole texels
+        glm::ivec2 offset = glm::ivec2(glm::round((centres[c] - cache.centre) / cascade.texelSize));
+        bool inside = std::abs(offset.x) <= CACHE_MARGIN && std::abs(offset.y) <= CACHE_MARGIN;
+        cascade.redrawStatic = !cache.valid || !inside || cache.view != cascade.view || cache.radius != radii[c]
+                || cache.zMin != zMin || cache.zMax != zMax || cache.version != input.staticVersion;
+        if (cascade.redrawStatic) {
+            cache.view = cascade.view;
+            cache.centre = centres[c];
+            cache.radius = radii[c];
+            cache.zMin = zMin;
+            cache.zMax = zMax;
+            cache.version = input.staticVersion;
+            cache.valid = true;
+            offset = glm::ivec2(0);
+        }
+
+        float extent = cache.radius + CACHE_MARGIN * cascade.texelSize;
+        cascade.staticProjection = glm::ortho(cache.centre.x - extent, cache.centre.x + extent,
+                cache.centre.y - extent, cache.centre.y + extent, -zMax, -zMin);
+        cascade.staticOffset = offset + CACHE_MARGIN;
+    }
+
+    // one cascade per task, the static casters are only collected for caches that are redrawn,
+    // over the whole cache
+    pool.ParallelFor(CASCADES, 1, [&](int begin, int end, int) {
+        for (int c = begin; c < end; c++) {
+            ShadowCascade& cascade = cascades[c];
+            cascade.staticCasters.clear();
+            cascade.dynamicCasters.clear();
+            cascade.staticCount = 0;
+            candidates[c].clear();
+            input.bvh->QueryFrustum(Frustum(cascade.projection * cascade.view), candidates[c]);
+
+            // the farther the cascade the coarser the rock, its texels are bigger anyway
+            auto caster = [&](int object) {
+                int mesh = (*input.meshes)[object];
+                return ShadowCaster{ (*input.models)[object], mesh, std::min(c, (*input.meshLevels)[mesh] - 1) };
+            };
+            for (int object : candidates[c]) {
+                if ((*input.dynamic)[object])
+                    cascade.dynamicCasters.push_back(caster(object));
+                else
+                    cascade.staticCount++;
+            }
+            if (cascade.redrawStatic) {
+                candidates[c].clear();
+                input.bvh->QueryFrustum(Frustum(cascade.staticProjection * cascade.view), candidates[c]);
+                for (int object : candidates[c]) {
+                    if (!(*input.dynamic)[object])
+                        cascade.staticCasters.push_back(caster(object));
+                }
+            }
+            std::sort(cascade.staticCasters.begin(), cascade.staticCasters.end(), casterOrder);
+            std::sort(cascade.dynamicCasters.begin(), cascade.dynamicCasters.end(), casterOrder);
+        }
+    });
+}
+
+void ShadowCascades::Invalidate() {
+    for (int c = 0; c < CASCADES; c++)
+        caches[c].valid = false;
+}
+
+void ShadowCascades::Render(const ShadowCascade (&cascades)[CASCADES], const DrawCasters& drawCasters) {
+    collectTimings();
+
+    GLint previousFramebuffer;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(OFFSET_FACTOR, OFFSET_UNITS);
+    glViewport(0, 0, RESOLUTION, RESOLUTION);
+    depthShader->use();
+
+    GLuint* timestamps = queries[queryFrame];
+    glQueryCounter(timestamps[0], GL_TIMESTAMP);
+    for (int c = 0; c < CASCADES; c++) {
+        const ShadowCascade& cascade = cascades[c];
+        CascadeStats& cascadeStats = stats[c];
+        cascadeStats.drawCalls = 0;
+        cascadeStats.casters = cascade.staticCount + (int)cascade.dynamicCasters.size();
+        cascadeStats.cached = !cascade.redrawStatic;
+
+        if (cascade.redrawStatic) {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticMaps, 0, c);
+            glViewport(0, 0, CACHE_RESOLUTION, CACHE_RESOLUTION);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            cascadeStats.drawCalls += drawCasters(cascade.staticCasters, cascade.view, cascade.staticProjection);
+            glViewport(0, 0, RESOLUTION, RESOLUTION);
+        }
+
+        // the cascade's window of the cache first, then what moves on top of it
+        const glm::ivec2& window = cascade.staticOffset;
+        if (cascade.redrawStatic || !cascade.dynamicCasters.empty() || hasDynamic[c] || window != copiedOffset[c]) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, copyFbo);
+            glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, staticMaps, 0, c);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+            glFramebufferTextureLayer(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMaps, 0, c);
+            glBlitFramebuffer(window.x, window.y, window.x + RESOLUTION, window.y + RESOLUTION, 0, 0, RESOLUTION, RESOLUTION,
+                    GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            cascadeStats.drawCalls += drawCasters(cascade.dynamicCasters, cascade.view, cascade.projection);
+            hasDynamic[c] = !cascade.dynamicCasters.empty();
+            copiedOffset[c] = window;
+        }
+        glQueryCounter(timestamps[c + 1], GL_TIMESTAMP);
+    }
+    queriesIssued[queryFrame] = true;
+    queryFrame = (queryFrame + 1) % QUERY_FRAMES;
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    if (!depthTest)
+        glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+}
+
+void ShadowCascades::Bind() const {
+    glActiveTexture(GL_TEXTURE0 + SHADOW_UNIT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMaps);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+Shader* ShadowCascades::GetDepthShader() const {
+    return depthShader;
+}
+
+const ShadowCascades::CascadeStats& ShadowCascades::GetStats(int cascade) const {
+    return stats[cascade];
+}
+
+size_t ShadowCascades::GetGpuBytes() const {
+    return (resources::TextureBytes(RESOLUTION, RESOLUTION, 4) + resources::TextureBytes(CACHE_RESOLUTION, CACHE_RESOLUTION, 4))
+            * CASCADES;
+}
+
+void ShadowCascades::fit(const ShadowInput& input, ShadowCascade (&cascades)[CASCADES]) {
+    // frustum shape straight from the perspective matrix
+    const glm::mat4& projection = input.projection;
+    float tanHalfY = 1.0f / projection[1][1];
+    float tanHalfX = 1.0f / projection[0][0];
+    float nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+    float farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+    float diagonal = std::sqrt(tanHalfX * tanHalfX + tanHalfY * tanHalfY);
+
+    // the light looks down its direction from the origin, the cascades only move in its xy plane
+    glm::vec3 up = std::abs(input.lightDirection.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), input.lightDirection, up);
+
+    // depth range of the whole scene along the light, every caster fits
+    zMin = -1.0f;
+    zMax = 1.0f;
+    if (input.bvh->GetNodeCount() > 0) {
+        const AABB& bounds = input.bvh->GetNodes()[0].bounds;
+        zMin = std::numeric_limits<float>::max();
+        zMax = -std::numeric_limits<float>::max();
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 point((corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y,
+                    (corner & 4) ? bounds.max.z : bounds.min.z);
+            float z = (lightView * glm::vec4(point, 1.0f)).z;
+            zMin = std::min(zMin, z);
+            zMax = std::max(zMax, z);
+        }
+    }
+    zMin = std::floor(zMin / DEPTH_ROUNDING - 1.0f) * DEPTH_ROUNDING;
+    zMax = std::ceil(zMax / DEPTH_ROUNDING + 1.0f) * DEPTH_ROUNDING;
+
+    glm::mat4 inverseView = glm::inverse(input.view);
+    float previous = nearPlane;
+    for (int c = 0; c < CASCADES; c++) {
+        float fraction = (float)(c + 1) / CASCADES;
+        float uniform = nearPlane + (farPlane - nearPlane) * fraction;
+        float logarithmic = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        float split = uniform + (logarithmic - uniform) * SPLIT_LAMBDA;
+
+        // bounding sphere of the slice, its centre on the view axis where the near and far
+        // corners are equally far away
+        float nearHalf = previous * diagonal;
+        float farHalf = split * diagonal;
+        float centreDepth = (split * split - previous * previous + farHalf * farHalf - nearHalf * nearHalf) / (2.0f * (split - previous));
+        centreDepth = std::clamp(centreDepth, previous, split);
+        float radius = std::sqrt((split - centreDepth) * (split - centreDepth) + farHalf * farHalf);
+
+        // whole texels only, a moving camera shifts the map by full texels
+        float texel = 2.0f * radius / RESOLUTION;
+        glm::vec3 centre = glm::vec3(lightView * inverseView * glm::vec4(0.0f, 0.0f, -centreDepth, 1.0f));
+        centre.x = std::floor(centre.x / texel) * texel;
+        centre.y = std::floor(centre.y / texel) * texel;
+
+        ShadowCascade& cascade = cascades[c];
+        cascade.view = lightView;
+        cascade.projection = glm::ortho(centre.x - radius, centre.x + radius, centre.y - radius, centre.y + radius, -zMax, -zMin);
+        cascade.splitDepth = split;
+        cascade.texelSize = texel;
+        centres[c] = glm::vec2(centre);
+        radii[c] = radius;
+        previous = split;
+    }
+}
+
+void ShadowCascades::collectTimings() {
+    // the set about to be reused was issued QUERY_FRAMES frames ago
+    if (!queriesIssued[queryFrame])
+        return;
+    GLint available = 0;
+    glGetQueryObjectiv(queries[queryFrame][CASCADES], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return;
+
+    GLuint64 times[CASCADES + 1];
+    for (int i = 0; i <= CASCADES; i++)
+        glGetQueryObjectui64v(queries[queryFrame][i], GL_QUERY_RESULT, &times[i]);
+    for (int c = 0; c < CASCADES; c++)
+        stats[c].gpuMs = (float)((times[c + 1] - times[c]) / 1.0e6);
+}
@@ -0,0 +1,171 @@
+/*
+ * ShadowCascades.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for cascaded shadow maps of the directional sun
+ *      light. The view frustum up to the far plane is split into
+ *      CASCADES slices (practical split scheme, a blend of logarithmic
+ *      and uniform), each slice gets an orthographic light projection
+ *      around its bounding sphere, so the projection keeps its size
+ *      when the camera turns, and its centre is snapped to whole
+ *      shadow texels, so edges don't crawl when it moves. The depth
+ *      range covers the whole scene so casters outside the slice still
+ *      throw their shadow into it.
+ *
+ *      Objects that never moved since the scene was laid out are
+ *      static, their depth is cached per cascade in a second array of
+ *      CACHE_RESOLUTION layers. A cache covers CACHE_MARGIN more texels
+ *      on every side than its cascade, around where the cascade was
+ *      when it was drawn, with the same texel size and depth range, so
+ *      the cascade is an exact texel-aligned window into it while the
+ *      camera moves. It is only drawn again when the light turns, the
+ *      static content changes, the scene's depth range changes, or the
+ *      cascade leaves the margin. The shadow map of a cascade is its
+ *      window of the cache plus the dynamic objects in it, a cascade
+ *      without dynamic casters whose window didn't move isn't touched
+ *      at all.
+ *
+ *      Build() culls the casters of every cascade against its light
+ *      frustum on the pool and touches no GL, so it runs as part of the
+ *      simulation; Render() and Bind() are for the GL thread:
+ *
+ *      cascades.Build(input, pool, frame);
+ *      ...
+ *      cascades.Render(frame, drawCasters);
+ *      cascades.Bind();
+ */
+
+#pragma once
+
+#include "BVH.h"
+#include "Shader.h"
+#include "ThreadPool.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+
+// an object drawn into a shadow map
+struct ShadowCaster {
+    glm::mat4 model;
+    int mesh;
+    int level;
+};
+
+// what Build() reads, the vectors are indexed by object id like CullInput's
+struct ShadowInput {
+    const BVH* bvh = nullptr;
+    const std::vector<glm::mat4>* models = nullptr;
+    const std::vector<int>* meshes = nullptr;
+    const std::vector<int>* meshLevels = nullptr;           // LOD levels per mesh id
+    const std::vector<unsigned char>* dynamic = nullptr;    // objects that moved since the layout
+    unsigned int staticVersion = 0;                         // changes whenever the static set does
+
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);                 // perspective, the cascades split its range
+    glm::vec3 lightDirection = glm::vec3(0.0f, -1.0f, 0.0f); // the way the light travels
+};
+
+// one cascade of a frame, matrices in the Camera block layout
+struct ShadowCascade {
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+    float splitDepth = 0.0f;        // far end of the slice in view depth
+    float texelSize = 0.0f;         // world size of a shadow texel
+    bool redrawStatic = false;      // the static cache is out of date, staticCasters are filled
+    glm::mat4 staticProjection = glm::mat4(1.0f);   // the cache's, same view
+    glm::ivec2 staticOffset = glm::ivec2(0);        // the cascade's corner in the cache, in texels
+    int staticCount = 0;            // static casters in the cascade, drawn or cached
+    std::vector<ShadowCaster> staticCasters;
+    std::vector<ShadowCaster> dynamicCasters;
+};
+
+
+class ShadowCascades {
+
+public:
+    static const int CASCADES = 4;
+    static const int RESOLUTION = 1024;
+    // texels the static cache reaches past its cascade on every side
+    static const int CACHE_MARGIN = RESOLUTION / 4;
+    static const int CACHE_RESOLUTION = RESOLUTION + 2 * CACHE_MARGIN;
+    // texture unit of the shadow map array, after the deferred G-buffer
+    static const GLuint SHADOW_UNIT = 8;
+
+    // GL thread: per cascade, of the last rendered frame, gpuMs arrives a few frames late
+    struct CascadeStats {
+        int drawCalls = 0;
+        int casters = 0;            // static and dynamic, culled against the cascade
+        bool cached = false;        // the static depth came from the cache
+        float gpuMs = 0.0f;
+    };
+
+    // draws "casters" with the camera block set to "view" and "projection", returns the draw calls
+    using DrawCasters = std::function<int(const std::vector<ShadowCaster>& casters, const glm::mat4& view,
+            const glm::mat4& projection)>;
+
+    ShadowCascades();
+    ~ShadowCascades();
+    ShadowCascades(const ShadowCascades&) = delete;
+    ShadowCascades& operator=(const ShadowCascades&) = delete;
+
+    // fits the cascades and culls their casters, any thread but only one at a time
+    void Build(const ShadowInput& input, ThreadPool& pool, ShadowCascade (&cascades)[CASCADES]);
+    // forgets which static caches Build() thinks are valid, for frames that were built but never
+    // rendered; only while nothing calls Build()
+    void Invalidate();
+
+    // GL thread: draws what is out of date, the bound framebuffer and viewport are restored
+    void Render(const ShadowCascade (&cascades)[CASCADES], const DrawCasters& drawCasters);
+    void Bind() const;
+
+    // depth only, shares vertex_shader.vert, the caller sets its blocks like the scene shaders'
+    Shader* GetDepthShader() const;
+    const CascadeStats& GetStats(int cascade) const;
+    size_t GetGpuBytes() const;
+
+private:
+    static const int QUERY_FRAMES = 4;
+
+    // Build(): what every static cache was last drawn with
+    struct StaticCache {
+        glm::mat4 view = glm::mat4(0.0f);
+        glm::vec2 centre = glm::vec2(0.0f);
+        float radius = 0.0f;
+        float zMin = 0.0f;
+        float zMax = 0.0f;
+        unsigned int version = 0;
+        bool valid = false;
+    };
+
+    // fit(): the cascades' snapped centres in light space and their shared depth range
+    glm::vec2 centres[CASCADES];
+    float radii[CASCADES];
+    float zMin;
+    float zMax;
+
+    StaticCache caches[CASCADES];
+    std::vector<int> candidates[CASCADES];
+
+    Shader* depthShader;
+    GLuint shadowMaps;              // what the shaders sample, cache + dynamic casters
+    GLuint staticMaps;              // static casters only
+    GLuint fbo;
+    GLuint copyFbo;
+    bool hasDynamic[CASCADES];      // the shadow map layer holds more than its cache
+    glm::ivec2 copiedOffset[CASCADES];  // the window of the cache the layer holds
+
+    // timestamps around every cascade, read QUERY_FRAMES frames later so nothing waits
+    GLuint queries[QUERY_FRAMES][CASCADES + 1];
+    bool queriesIssued[QUERY_FRAMES];
+    int queryFrame;
+    CascadeStats stats[CASCADES];
+
+    void fit(const ShadowInput& input, ShadowCascade (&cascades)[CASCADES]);
+    void collectTimings();
+};
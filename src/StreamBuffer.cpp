@@ -0,0 +1,181 @@
+/*
+ * StreamBuffer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the per-frame ring buffer.
+ */
+
+#include "StreamBuffer.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+
+// how long one glClientWaitSync call may block before it is retried
+const GLuint64 FENCE_TIMEOUT_NS = 1000000;
+
+GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+
+StreamBuffer::StreamBuffer(GLsizeiptr frameSize)
+    : buffer(0), persistent(false), mapping(nullptr), fences{}, frame(0), frameSize(0),
+      cursor(0), flushed(0), bytesLastFrame(0), fenceWaitMs(0.0), overflowLogged(false) {
+
+    create(frameSize);
+}
+
+StreamBuffer::~StreamBuffer() {
+    destroy();
+}
+
+void StreamBuffer::BeginFrame(GLsizeiptr expectedBytes) {
+    // growing means a new buffer, every partition has to be idle first
+    if (expectedBytes > frameSize) {
+        GLsizeiptr newFrameSize = std::max(expectedBytes, frameSize * 2);
+        Global::logger.log(INFO, "Stream buffer grows to " + std::to_string(newFrameSize / 1024) + " KB per frame.");
+        glFinish();
+        destroy();
+        create(newFrameSize);
+    }
+
+    double start = glfwGetTime();
+    waitFence(frame);
+    fenceWaitMs = (glfwGetTime() - start) * 1000.0;
+
+    cursor = 0;
+    flushed = 0;
+}
+
+void* StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset) {
+    // partitions start on a multiple of the largest alignment anyone asks for, so
+    // aligning the offset inside the partition aligns the buffer offset too
+    GLsizeiptr start = alignUp(cursor, std::max<GLsizeiptr>(1, alignment));
+    if (start + size > frameSize) {
+        if (!overflowLogged) {
+            Global::logger.log(WARNING, "Stream buffer frame partition is full, allocation dropped.");
+            overflowLogged = true;
+        }
+        return nullptr;
+    }
+
+    cursor = start + size;
+    outOffset = frame * frameSize + start;
+    return persistent ? mapping + outOffset : staging.data() + start;
+}
+
+void StreamBuffer::Flush() {
+    if (persistent || cursor == flushed)
+        return;
+
+    // the fence already guarantees the GPU is done with this range, so skip GL's own sync
+    GLintptr offset = frame * frameSize + flushed;
+    GLsizeiptr length = cursor - flushed;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    void* target = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, length,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (target) {
+        std::memcpy(target, staging.data() + flushed, length);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    flushed = cursor;
+}
+
+void StreamBuffer::EndFrame() {
+    Flush();
+
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    bytesLastFrame = cursor;
+    frame = (frame + 1) % FRAME_COUNT;
+}
+
+GLuint StreamBuffer::GetBuffer() const {
+    return buffer;
+}
+
+bool StreamBuffer::IsPersistent() const {
+    return persistent;
+}
+
+GLsizeiptr StreamBuffer::GetFrameSize() const {
+    return frameSize;
+}
+
+GLsizeiptr StreamBuffer::GetBytesLastFrame() const {
+    return bytesLastFrame;
+}
+
+double StreamBuffer::GetFenceWaitMs() const {
+    return fenceWaitMs;
+}
+
+GLsizeiptr StreamBuffer::UniformAlignment() {
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment;
+}
+
+void StreamBuffer::create(GLsizeiptr newFrameSize) {
+    // 256 covers every uniform/storage offset alignment real drivers report
+    frameSize = alignUp(newFrameSize, 256);
+    persistent = GLAD_GL_VERSION_4_4;
+
+    buffer = resources::CreateBuffer("StreamBuffer", persistent ? "persistent ring" : "mapped ring");
+    resources::SetSize(resources::ResourceType::Buffer, buffer, frameSize * FRAME_COUNT);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, frameSize * FRAME_COUNT, NULL, flags);
+        mapping = (uint8_t*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, frameSize * FRAME_COUNT, flags);
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, frameSize * FRAME_COUNT, NULL, GL_STREAM_DRAW);
+        staging.resize(frameSize);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    frame = 0;
+    overflowLogged = false;
+}
+
+void StreamBuffer::destroy() {
+    for (GLsync& fence : fences) {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (mapping) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mapping = nullptr;
+    }
+    resources::Delete(resources::ResourceType::Buffer, buffer);
+}
+
+void StreamBuffer::waitFence(int partition) {
+    GLsync& fence = fences[partition];
+    if (!fence)
+        return;
+
+    while (true) {
+        GLenum state = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+        if (state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED || state == GL_WAIT_FAILED)
+            break;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
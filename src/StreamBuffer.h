@@ -0,0 +1,87 @@
+/*
+ * StreamBuffer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the ring buffer that carries per-frame dynamic
+ *      GPU data (uniform blocks, SSBO updates, vertices). The buffer is
+ *      split into FRAME_COUNT partitions, one per frame in flight, and
+ *      a fence guards each partition so the CPU never overwrites data
+ *      the GPU is still reading and never waits on an implicit sync.
+ *
+ *      With GL 4.4 the buffer is created with glBufferStorage and
+ *      mapped once, persistent and coherent, so allocations are plain
+ *      pointers into GPU visible memory. On older contexts allocations
+ *      are written into a CPU staging copy and Flush() moves them over
+ *      with one unsynchronized glMapBufferRange per batch.
+ *
+ *      stream.BeginFrame(expectedBytes);
+ *      GLintptr offset;
+ *      auto* block = (Block*)stream.Allocate(sizeof(Block), StreamBuffer::UniformAlignment(), offset);
+ *      ...                                             // fill the blocks
+ *      stream.Flush();                                 // before the first draw reading them
+ *      glBindBufferRange(GL_UNIFORM_BUFFER, 1, stream.GetBuffer(), offset, sizeof(Block));
+ *      stream.EndFrame();
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+
+class StreamBuffer {
+
+public:
+    static const int FRAME_COUNT = 3;
+
+    // frameSize is the space every frame gets, BeginFrame() grows it when asked for more
+    explicit StreamBuffer(GLsizeiptr frameSize);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // waits until the GPU is done with the partition this frame reuses
+    void BeginFrame(GLsizeiptr expectedBytes = 0);
+    // "size" bytes at an offset that is a multiple of "alignment", outOffset is relative to
+    // the start of the buffer; nullptr when the frame's partition is full
+    void* Allocate(GLsizeiptr size, GLsizeiptr alignment, GLintptr& outOffset);
+    // makes everything allocated so far visible to GL, nothing to do for persistent mappings
+    void Flush();
+    // fences the partition and moves on to the next one
+    void EndFrame();
+
+    GLuint GetBuffer() const;
+    bool IsPersistent() const;
+    GLsizeiptr GetFrameSize() const;
+    // bytes allocated during the last finished frame
+    GLsizeiptr GetBytesLastFrame() const;
+    // time BeginFrame() of the last frame spent waiting on its fence
+    double GetFenceWaitMs() const;
+
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT of the current context
+    static GLsizeiptr UniformAlignment();
+
+private:
+    GLuint buffer;
+    bool persistent;
+    uint8_t* mapping;                   // persistent mode only
+    std::vector<uint8_t> staging;       // fallback mode only, one frame's worth
+
+    GLsync fences[FRAME_COUNT];
+    int frame;
+    GLsizeiptr frameSize;
+    GLsizeiptr cursor;
+    GLsizeiptr flushed;
+    GLsizeiptr bytesLastFrame;
+    double fenceWaitMs;
+    bool overflowLogged;
+
+    void create(GLsizeiptr newFrameSize);
+    void destroy();
+    void waitFence(int partition);
+};
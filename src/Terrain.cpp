@@ -0,0 +1,411 @@
+/*
+ * Terrain.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the streamed quadtree terrain.
+ */
+
+#include "Terrain.h"
+
+#include "GpuResources.h"
+
+#include <stb_perlin.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+const double STATS_WINDOW = 0.5;
+
+// the height field: rolling hills plus ridged mountains, well below the cube grid
+const float BASE_HEIGHT = -40.0f;
+const float HILL_HEIGHT = 15.0f;
+const float RIDGE_HEIGHT = 25.0f;
+const float HILL_FREQUENCY = 1.0f / 120.0f;
+const float RIDGE_FREQUENCY = 1.0f / 250.0f;
+// what the noise can reach, the height range of tiles that aren't generated yet
+const float MIN_HEIGHT = BASE_HEIGHT - HILL_HEIGHT;
+const float MAX_HEIGHT = BASE_HEIGHT + HILL_HEIGHT + RIDGE_HEIGHT * 1.5f;
+
+// skirts hang this many cells of their tile below its edges
+const float SKIRT_CELLS = 3.0f;
+// tiles nobody drew this frame go once they are this many split distances away
+const float EVICT_DISTANCE = 4.0f;
+
+const int GRID_VERTICES = (Terrain::TILE_QUADS + 1) * (Terrain::TILE_QUADS + 1);
+const int TILE_VERTICES = GRID_VERTICES + 4 * (Terrain::TILE_QUADS + 1);
+const int TILE_INDICES = 6 * Terrain::TILE_QUADS * Terrain::TILE_QUADS + 4 * 6 * Terrain::TILE_QUADS;
+// position, then the normal as four signed normalized bytes
+const int VERTEX_BYTES = 3 * sizeof(float) + 4;
+const GLsizeiptr TILE_BYTES = (GLsizeiptr)TILE_VERTICES * VERTEX_BYTES;
+
+float tileSize(int level) {
+    return Terrain::ROOT_SIZE / (float)(1 << level);
+}
+
+float distanceTo(const AABB& box, const glm::vec3& point) {
+    glm::vec3 outside = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+    return glm::length(outside);
+}
+
+int8_t packNormal(float value) {
+    return (int8_t)std::lround(glm::clamp(value, -1.0f, 1.0f) * 127.0f);
+}
+
+}
+
+
+Terrain::Terrain()
+    : frame(0), camera(0.0f), windowStart(std::chrono::steady_clock::now()), windowTiles(0),
+      windowLatencyMs(0.0), windowMaxLatencyMs(0.0), windowGenerateMs(0.0) {
+    shader = new Shader("src/shaders/terrain.vert", "src/shaders/terrain.frag");
+
+    // every tile is the same grid followed by its four skirts, one index buffer serves them all
+    const int n = TILE_QUADS;
+    std::vector<GLuint> indices;
+    indices.reserve(TILE_INDICES);
+    for (int j = 0; j < n; j++) {
+        for (int i = 0; i < n; i++) {
+            GLuint a = j * (n + 1) + i;
+            GLuint b = a + 1;
+            GLuint c = a + n + 1;
+            GLuint d = c + 1;
+            indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+    }
+    for (int edge = 0; edge < 4; edge++) {
+        for (int k = 0; k < n; k++) {
+            // edges: z = 0, z = n, x = 0, x = n
+            auto gridVertex = [edge, n](int i) -> GLuint {
+                switch (edge) {
+                case 0: return i;
+                case 1: return n * (n + 1) + i;
+                case 2: return i * (n + 1);
+                default: return i * (n + 1) + n;
+                }
+            };
+            GLuint top0 = gridVertex(k);
+            GLuint top1 = gridVertex(k + 1);
+            GLuint bottom0 = GRID_VERTICES + edge * (n + 1) + k;
+            GLuint bottom1 = bottom0 + 1;
+            indices.insert(indices.end(), { top0, bottom0, top1, top1, bottom0, bottom1 });
+        }
+    }
+
+    vao = resources::CreateVertexArray("Terrain", "tiles");
+    vertexBuffer = resources::CreateBuffer("Terrain", "tile cache");
+    indexBuffer = resources::CreateBuffer("Terrain", "tile indices");
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, TILE_BYTES * CACHE_TILES, nullptr, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_BYTES, (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_BYTE, GL_TRUE, VERTEX_BYTES, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    resources::SetSize(resources::ResourceType::Buffer, vertexBuffer, TILE_BYTES * CACHE_TILES);
+    resources::SetSize(resources::ResourceType::Buffer, indexBuffer, indices.size() * sizeof(GLuint));
+    stats.bufferBytes = TILE_BYTES * CACHE_TILES + (long long)indices.size() * sizeof(GLuint);
+
+    // lowest slots first
+    for (int slot = CACHE_TILES - 1; slot >= 0; slot--)
+        freeSlots.push_back(slot);
+
+    tileQueue.Start(GENERATOR_THREADS, [](TileJob& job, int) {
+        auto start = std::chrono::steady_clock::now();
+        generate(job);
+        job.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+}
+
+Terrain::~Terrain() {
+    tileQueue.Stop();
+
+    resources::Delete(resources::ResourceType::VertexArray, vao);
+    resources::Delete(resources::ResourceType::Buffer, vertexBuffer);
+    resources::Delete(resources::ResourceType::Buffer, indexBuffer);
+    delete shader;
+}
+
+float Terrain::GetHeight(float x, float z) {
+    float hills = stb_perlin_fbm_noise3(x * HILL_FREQUENCY, 0.25f, z * HILL_FREQUENCY, 2.0f, 0.5f, 6);
+    float ridges = stb_perlin_ridge_noise3(x * RIDGE_FREQUENCY, 0.75f, z * RIDGE_FREQUENCY, 2.0f, 0.5f, 1.0f, 4);
+    return BASE_HEIGHT + HILL_HEIGHT * hills + RIDGE_HEIGHT * ridges;
+}
+
+uint64_t Terrain::tileKey(int level, int x, int z) {
+    return (uint64_t)level << 56 | (uint64_t)(uint32_t)(x & 0x0fffffff) << 28 | (uint64_t)(uint32_t)(z & 0x0fffffff);
+}
+
+AABB Terrain::tileBounds(int level, int x, int z) {
+    float size = tileSize(level);
+    float skirt = size / TILE_QUADS * SKIRT_CELLS;
+    return AABB(glm::vec3(x * size, MIN_HEIGHT - skirt, z * size), glm::vec3((x + 1) * size, MAX_HEIGHT, (z + 1) * size));
+}
+
+GLsizeiptr Terrain::GetUploadSize() {
+    tileQueue.Collect(finished);
+    return (GLsizeiptr)std::min((int)finished.size(), UPLOADS_PER_FRAME) * (TILE_BYTES + 4);
+}
+
+void Terrain::Update(StreamBuffer& stream, const glm::vec3& cameraPosition, const glm::mat4& viewProjection) {
+    frame++;
+    camera = cameraPosition;
+    frustum = Frustum(viewProjection);
+
+    // finished tiles, in the order they were made
+    tileQueue.Collect(finished);
+    size_t taken = 0;
+    for (; taken < finished.size() && (int)taken < UPLOADS_PER_FRAME; taken++) {
+        if (!upload(finished[taken], stream))
+            break;
+        tileQueue.Recycle(std::move(finished[taken]));
+    }
+    finished.erase(finished.begin(), finished.begin() + taken);
+
+    // the quadtree under the 3x3 root tiles around the camera
+    drawCounts.clear();
+    drawIndices.clear();
+    drawBaseVertices.clear();
+    requests.clear();
+    stats.deepestLevel = 0;
+    int rootX = (int)std::floor(camera.x / ROOT_SIZE);
+    int rootZ = (int)std::floor(camera.z / ROOT_SIZE);
+    for (int z = rootZ - 1; z <= rootZ + 1; z++) {
+        for (int x = rootX - 1; x <= rootX + 1; x++) {
+            if (isReady(0, x, z))
+                select(0, x, z);
+        }
+    }
+    stats.drawnTiles = (int)drawCounts.size();
+    stats.triangles = (long long)drawCounts.size() * (TILE_INDICES / 3);
+
+    // missing tiles, coarse ones first so holes close before detail arrives
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.level != b.level ? a.level < b.level : a.distance < b.distance;
+    });
+    auto now = std::chrono::steady_clock::now();
+    for (const Request& wanted : requests) {
+        if (stats.pendingTiles >= MAX_PENDING_TILES)
+            break;
+
+        Tile& tile = tiles[wanted.key];
+        tile.level = wanted.level;
+        tile.x = wanted.x;
+        tile.z = wanted.z;
+        tile.bounds = tileBounds(wanted.level, wanted.x, wanted.z);
+        tile.lastUsed = frame;
+        tile.requestedAt = now;
+
+        TileJob job = tileQueue.Acquire();
+        job.key = wanted.key;
+        job.level = wanted.level;
+        job.x = wanted.x;
+        job.z = wanted.z;
+        tileQueue.Submit(std::move(job));
+        stats.pendingTiles++;
+    }
+
+    // the camera has moved on from these
+    evictions.clear();
+    for (const auto& [key, tile] : tiles) {
+        if (tile.slot >= 0 && tile.lastUsed < frame
+                && distanceTo(tile.bounds, camera) > tileSize(tile.level) * SPLIT_DISTANCE * EVICT_DISTANCE)
+            evictions.push_back(key);
+    }
+    for (uint64_t key : evictions)
+        evict(key);
+
+    stats.residentTiles = CACHE_TILES - (int)freeSlots.size();
+    stats.residentBytes = (long long)stats.residentTiles * TILE_BYTES;
+
+    double seconds = std::chrono::duration<double>(now - windowStart).count();
+    if (seconds >= STATS_WINDOW) {
+        stats.tilesPerSecond = windowTiles / seconds;
+        stats.latencyMs = windowTiles > 0 ? (float)(windowLatencyMs / windowTiles) : 0.0f;
+        stats.maxLatencyMs = (float)windowMaxLatencyMs;
+        stats.generateMs = windowTiles > 0 ? (float)(windowGenerateMs / windowTiles) : 0.0f;
+        windowStart = now;
+        windowTiles = 0;
+        windowLatencyMs = 0.0;
+        windowMaxLatencyMs = 0.0;
+        windowGenerateMs = 0.0;
+    }
+}
+
+bool Terrain::isReady(int level, int x, int z) {
+    uint64_t key = tileKey(level, x, z);
+    auto found = tiles.find(key);
+    if (found == tiles.end()) {
+        // nothing to draw outside the view, so nothing to wait for
+        if (!frustum.Intersects(tileBounds(level, x, z)))
+            return true;
+        float distance = distanceTo(tileBounds(level, x, z), camera);
+        requests.push_back({ key, level, x, z, distance });
+        return false;
+    }
+
+    Tile& tile = found->second;
+    if (!frustum.Intersects(tile.bounds))
+        return true;
+    tile.lastUsed = frame;
+    return tile.slot >= 0;
+}
+
+void Terrain::select(int level, int x, int z) {
+    auto found = tiles.find(tileKey(level, x, z));
+    if (found == tiles.end() || found->second.slot < 0 || !frustum.Intersects(found->second.bounds))
+        return;
+
+    Tile& tile = found->second;
+    tile.lastUsed = frame;
+    if (level < MAX_LEVEL && distanceTo(tile.bounds, camera) < tileSize(level) * SPLIT_DISTANCE) {
+        // all four children or none, asking for every missing one
+        bool ready = true;
+        for (int child = 0; child < 4; child++)
+            ready &= isReady(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1));
+        if (ready) {
+            for (int child = 0; child < 4; child++)
+                select(level + 1, x * 2 + (child & 1), z * 2 + (child >> 1));
+            return;
+        }
+    }
+
+    drawCounts.push_back(TILE_INDICES);
+    drawIndices.push_back(nullptr);
+    drawBaseVertices.push_back(tile.slot * TILE_VERTICES);
+    stats.deepestLevel = std::max(stats.deepestLevel, level);
+}
+
+bool Terrain::upload(const TileJob& job, StreamBuffer& stream) {
+    if (freeSlots.empty() && !evictFurthest())
+        return false;
+    GLintptr offset;
+    void* target = stream.Allocate(TILE_BYTES, 4, offset);
+    if (!target)
+        return false;
+    std::memcpy(target, job.vertices.data(), TILE_BYTES);
+    stream.Flush();
+
+    int slot = freeSlots.back();
+    freeSlots.pop_back();
+    glBindBuffer(GL_COPY_READ_BUFFER, stream.GetBuffer());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, slot * TILE_BYTES, TILE_BYTES);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // the real height range replaces the guess
+    Tile& tile = tiles[job.key];
+    tile.slot = slot;
+    tile.bounds.min.y = job.minHeight - tileSize(job.level) / TILE_QUADS * SKIRT_CELLS;
+    tile.bounds.max.y = job.maxHeight;
+
+    double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tile.requestedAt).count();
+    windowTiles++;
+    windowLatencyMs += latency;
+    windowMaxLatencyMs = std::max(windowMaxLatencyMs, latency);
+    windowGenerateMs += job.ms;
+    stats.generatedTiles++;
+    stats.pendingTiles--;
+    return true;
+}
+
+bool Terrain::evictFurthest() {
+    // the furthest tile that wasn't drawn last frame
+    uint64_t furthest = 0;
+    float furthestDistance = -1.0f;
+    for (const auto& [key, tile] : tiles) {
+        if (tile.slot < 0 || tile.lastUsed >= frame - 1)
+            continue;
+        float distance = distanceTo(tile.bounds, camera);
+        if (distance > furthestDistance) {
+            furthest = key;
+            furthestDistance = distance;
+        }
+    }
+    if (furthestDistance < 0.0f)
+        return false;
+    evict(furthest);
+    return true;
+}
+
+void Terrain::evict(uint64_t key) {
+    auto found = tiles.find(key);
+    freeSlots.push_back(found->second.slot);
+    tiles.erase(found);
+    stats.evictedTiles++;
+}
+
+void Terrain::Draw(const glm::mat4& viewProjection) {
+    if (drawCounts.empty())
+        return;
+
+    shader->use();
+    shader->setMat4("viewProjection", viewProjection);
+    glBindVertexArray(vao);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawIndices.data(),
+                                  (GLsizei)drawCounts.size(), drawBaseVertices.data());
+    glBindVertexArray(0);
+}
+
+const Terrain::Stats& Terrain::GetStats() const {
+    return stats;
+}
+
+void Terrain::generate(TileJob& job) {
+    const int n = TILE_QUADS;
+    float size = tileSize(job.level);
+    float cell = size / n;
+    glm::vec2 origin(job.x * size, job.z * size);
+
+    // heights with a ring of one cell around the tile for the normals at its edges
+    float heights[(TILE_QUADS + 3) * (TILE_QUADS + 3)];
+    auto height = [&heights, n](int i, int j) -> float& { return heights[(j + 1) * (n + 3) + (i + 1)]; };
+    job.minHeight = MAX_HEIGHT;
+    job.maxHeight = MIN_HEIGHT;
+    for (int j = -1; j <= n + 1; j++) {
+        for (int i = -1; i <= n + 1; i++) {
+            float h = GetHeight(origin.x + i * cell, origin.y + j * cell);
+            height(i, j) = h;
+            if (i >= 0 && j >= 0 && i <= n && j <= n) {
+                job.minHeight = std::min(job.minHeight, h);
+                job.maxHeight = std::max(job.maxHeight, h);
+            }
+        }
+    }
+
+    job.vertices.resize(TILE_BYTES);
+    auto writeVertex = [&job](int index, const glm::vec3& position, const int8_t normal[4]) {
+        uint8_t* vertex = job.vertices.data() + (size_t)index * VERTEX_BYTES;
+        std::memcpy(vertex, &position, 3 * sizeof(float));
+        std::memcpy(vertex + 3 * sizeof(float), normal, 4);
+    };
+    auto gridVertex = [&](int i, int j, float drop, int index) {
+        glm::vec3 normal = glm::normalize(glm::vec3(height(i - 1, j) - height(i + 1, j), 2.0f * cell,
+                                                    height(i, j - 1) - height(i, j + 1)));
+        int8_t packed[4] = { packNormal(normal.x), packNormal(normal.y), packNormal(normal.z), 0 };
+        writeVertex(index, glm::vec3(origin.x + i * cell, height(i, j) - drop, origin.y + j * cell), packed);
+    };
+
+    for (int j = 0; j <= n; j++) {
+        for (int i = 0; i <= n; i++)
+            gridVertex(i, j, 0.0f, j * (n + 1) + i);
+    }
+    // the skirts in the order of the edges in the index buffer
+    float skirt = cell * SKIRT_CELLS;
+    for (int k = 0; k <= n; k++) {
+        gridVertex(k, 0, skirt, GRID_VERTICES + k);
+        gridVertex(k, n, skirt, GRID_VERTICES + (n + 1) + k);
+        gridVertex(0, k, skirt, GRID_VERTICES + 2 * (n + 1) + k);
+        gridVertex(n, k, skirt, GRID_VERTICES + 3 * (n + 1) + k);
+    }
+}
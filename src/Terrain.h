@@ -0,0 +1,175 @@
+/*
+ * Terrain.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for streamed procedural terrain: an endless height
+ *      field from stb_perlin noise, cut into a quadtree of square tiles
+ *      whose root tiles are ROOT_SIZE across. Every tile has the same
+ *      TILE_QUADS^2 grid however large it is, so deeper levels are
+ *      finer.
+ *
+ *      Each frame Update() walks the quadtree from the root tiles
+ *      around the camera. A tile is split into its four children when
+ *      the camera is closer than SPLIT_DISTANCE times its size and all
+ *      four children are resident; until they are, the tile itself is
+ *      drawn and the missing children are requested. Coarse tiles are
+ *      requested before fine ones, so the terrain is never missing
+ *      more than its first few frames.
+ *
+ *      Tiles are generated on GENERATOR_THREADS threads of a BackgroundQueue
+ *      and uploaded, at most UPLOADS_PER_FRAME a frame, through the
+ *      frame's StreamBuffer into one of the CACHE_TILES slots of a
+ *      single vertex buffer. Tiles the camera has left behind are
+ *      evicted once they are far enough; when no slot is free the
+ *      furthest tile not drawn this frame makes room.
+ *
+ *      Neighbouring tiles of different levels don't share their edge
+ *      vertices. Every tile has a skirt, a strip hanging down from its
+ *      edges, that hides the cracks between them. All tiles share one
+ *      index buffer and the visible ones are drawn with a single
+ *      glMultiDrawElementsBaseVertex.
+ *
+ *      Terrain terrain;
+ *      ...
+ *      stream.BeginFrame(terrain.GetUploadSize() + ...);
+ *      terrain.Update(stream, cameraPosition, projection * view);
+ *      terrain.Draw(projection * view);
+ */
+
+#pragma once
+
+#include "BackgroundQueue.h"
+#include "Bounds.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+class Terrain {
+
+public:
+    static constexpr float ROOT_SIZE = 1024.0f;
+    // deepest level, its tiles are ROOT_SIZE >> MAX_LEVEL across
+    static const int MAX_LEVEL = 7;
+    static const int TILE_QUADS = 32;
+    static constexpr float SPLIT_DISTANCE = 1.5f;
+    // tile slots in the vertex buffer
+    static const int CACHE_TILES = 512;
+    static const int UPLOADS_PER_FRAME = 16;
+    // tiles queued or being generated at once
+    static const int MAX_PENDING_TILES = 64;
+    static const int GENERATOR_THREADS = 2;
+
+    struct Stats {
+        int residentTiles = 0;
+        int pendingTiles = 0;               // queued, generating or waiting for upload
+        int drawnTiles = 0;                 // last Update()
+        int deepestLevel = 0;               // of the drawn tiles
+        long long triangles = 0;
+        long long generatedTiles = 0;       // since the terrain was created
+        long long evictedTiles = 0;
+        // over the last half second
+        float latencyMs = 0.0f;             // average from request to resident
+        float maxLatencyMs = 0.0f;
+        float generateMs = 0.0f;            // average per tile on a generator thread
+        double tilesPerSecond = 0.0;
+        long long residentBytes = 0;        // vertices of the resident tiles
+        long long bufferBytes = 0;          // the tile cache and the index buffer
+    };
+
+    Terrain();
+    ~Terrain();
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    // the height field itself, in scene units
+    static float GetHeight(float x, float z);
+
+    // collects the finished tiles, what the next Update() may want from the stream buffer at most
+    GLsizeiptr GetUploadSize();
+    // on the GL thread once per frame, between the stream buffer's BeginFrame() and EndFrame():
+    // uploads finished tiles, picks the tiles to draw, requests missing ones and evicts
+    void Update(StreamBuffer& stream, const glm::vec3& cameraPosition, const glm::mat4& viewProjection);
+    // the tiles the last Update() picked
+    void Draw(const glm::mat4& viewProjection);
+    const Stats& GetStats() const;
+
+private:
+    // a tile's level and position in the grid of that level, packed by tileKey()
+    struct Tile {
+        int level;
+        int x, z;
+        AABB bounds;                        // the height range is a guess until it is generated
+        int slot = -1;                      // -1 while it is generated
+        long long lastUsed = -1;            // frame it was drawn or wanted
+        std::chrono::steady_clock::time_point requestedAt;
+    };
+
+    struct TileJob {
+        uint64_t key;
+        int level;
+        int x, z;
+        std::vector<uint8_t> vertices;      // TILE_BYTES
+        float minHeight = 0.0f;
+        float maxHeight = 0.0f;
+        double ms = 0.0;
+    };
+
+    struct Request {
+        uint64_t key;
+        int level;
+        int x, z;
+        float distance;
+    };
+
+    Shader* shader;
+    GLuint vertexBuffer;                    // CACHE_TILES slots of TILE_VERTICES
+    GLuint indexBuffer;
+    GLuint vao;
+    std::unordered_map<uint64_t, Tile> tiles;
+    std::vector<int> freeSlots;
+    long long frame;
+    glm::vec3 camera;
+    Frustum frustum;
+
+    // picked by Update(), drawn by Draw()
+    std::vector<GLsizei> drawCounts;
+    std::vector<const void*> drawIndices;
+    std::vector<GLint> drawBaseVertices;
+    std::vector<Request> requests;
+    std::vector<uint64_t> evictions;
+
+    std::vector<TileJob> finished;          // collected, waiting for upload
+
+    std::chrono::steady_clock::time_point windowStart;
+    int windowTiles;
+    double windowLatencyMs;
+    double windowMaxLatencyMs;
+    double windowGenerateMs;
+    Stats stats;
+
+    // last, the generators stop before anything they use goes away
+    BackgroundQueue<TileJob> tileQueue;
+
+    static uint64_t tileKey(int level, int x, int z);
+    static AABB tileBounds(int level, int x, int z);
+    // true when the tile is resident or outside the view, otherwise it is requested
+    bool isReady(int level, int x, int z);
+    // picks the tiles to draw in place of a resident one, itself or its descendants
+    void select(int level, int x, int z);
+    // false when there is no slot or stream buffer space for it this frame
+    bool upload(const TileJob& job, StreamBuffer& stream);
+    void evict(uint64_t key);
+    bool evictFurthest();
+    static void generate(TileJob& job);
+};
+
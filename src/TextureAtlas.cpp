@@ -0,0 +1,153 @@
+/*
+ * TextureAtlas.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the runtime texture atlas.
+ */
+
+#include "TextureAtlas.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <stb_rect_pack.h>
+
+#include <string>
+
+
+// the packer works in blocks of PADDING texels, which keeps every image aligned for the mip chain
+struct TextureAtlas::Page {
+    GLuint texture = 0;
+    stbrp_context context;
+    std::vector<stbrp_node> nodes;
+    bool dirty = false;
+};
+
+
+TextureAtlas::TextureAtlas(int pageSize)
+    : pageSize(pageSize), imageTexels(0), imageCount(0) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    for (std::unique_ptr<Page>& page : pages)
+        resources::Delete(resources::ResourceType::Texture, page->texture);
+}
+
+AtlasRegion TextureAtlas::Add(int width, int height, const unsigned char* pixels) {
+    AtlasRegion region;
+    int paddedWidth = width + 2 * PADDING;
+    int paddedHeight = height + 2 * PADDING;
+    if (width <= 0 || height <= 0 || paddedWidth > pageSize || paddedHeight > pageSize) {
+        Global::logger.log(WARNING, "Image of " + std::to_string(width) + "x" + std::to_string(height)
+                + " does not fit into a " + std::to_string(pageSize) + " texel atlas page.");
+        return region;
+    }
+
+    stbrp_rect rect = {};
+    rect.w = (paddedWidth + PADDING - 1) / PADDING;
+    rect.h = (paddedHeight + PADDING - 1) / PADDING;
+
+    // first page with room, a failed attempt leaves the page as it was
+    Page* page = nullptr;
+    for (size_t i = 0; i < pages.size() && !page; i++) {
+        if (stbrp_pack_rects(&pages[i]->context, &rect, 1)) {
+            page = pages[i].get();
+            region.page = (int)i;
+        }
+    }
+    if (!page) {
+        page = addPage();
+        region.page = (int)pages.size() - 1;
+        stbrp_pack_rects(&page->context, &rect, 1);
+    }
+
+    // the image plus a border taken from the opposite edges, like GL_REPEAT would sample it
+    padded.resize((size_t)paddedWidth * paddedHeight * 4);
+    for (int y = 0; y < paddedHeight; y++) {
+        int sourceY = ((y - PADDING) % height + height) % height;
+        for (int x = 0; x < paddedWidth; x++) {
+            int sourceX = ((x - PADDING) % width + width) % width;
+            const unsigned char* source = pixels + ((size_t)sourceY * width + sourceX) * 4;
+            unsigned char* target = &padded[((size_t)y * paddedWidth + x) * 4];
+            target[0] = source[0];
+            target[1] = source[1];
+            target[2] = source[2];
+            target[3] = source[3];
+        }
+    }
+
+    int x = rect.x * PADDING;
+    int y = rect.y * PADDING;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page->texture);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, 0, paddedWidth, paddedHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, padded.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    page->dirty = true;
+
+    region.uvTransform = glm::vec4((float)width, (float)height, (float)(x + PADDING), (float)(y + PADDING)) / (float)pageSize;
+    imageTexels += (long long)width * height;
+    imageCount++;
+    return region;
+}
+
+void TextureAtlas::Flush() {
+    for (std::unique_ptr<Page>& page : pages) {
+        if (!page->dirty)
+            continue;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, page->texture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        page->dirty = false;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureAtlas::BindPage(int page, GLuint unit) const {
+    if (page < 0 || page >= (int)pages.size())
+        return;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, pages[page]->texture);
+}
+
+int TextureAtlas::GetPageSize() const {
+    return pageSize;
+}
+
+int TextureAtlas::GetPageCount() const {
+    return (int)pages.size();
+}
+
+int TextureAtlas::GetImageCount() const {
+    return imageCount;
+}
+
+float TextureAtlas::GetOccupancy() const {
+    if (pages.empty())
+        return 0.0f;
+    return (float)((double)imageTexels / ((double)pageSize * pageSize * pages.size()));
+}
+
+TextureAtlas::Page* TextureAtlas::addPage() {
+    std::unique_ptr<Page> page(new Page());
+    int blocks = pageSize / PADDING;
+    page->nodes.resize(blocks);
+    stbrp_init_target(&page->context, blocks, blocks, page->nodes.data(), blocks);
+
+    page->texture = resources::CreateTexture("TextureAtlas", "page " + std::to_string(pages.size()));
+    resources::SetSize(resources::ResourceType::Texture, page->texture, resources::TextureBytes(pageSize, pageSize, 4, MIP_LEVELS));
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page->texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, MIP_LEVELS - 1);
+
+    // cleared once, so texels no image covers are defined
+    std::vector<unsigned char> clear((size_t)pageSize * pageSize * 4, 0);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, pageSize, pageSize, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    pages.push_back(std::move(page));
+    return pages.back().get();
+}
@@ -0,0 +1,79 @@
+/*
+ * TextureAtlas.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the runtime texture atlas. Small images are
+ *      packed into large pages with stb_rect_pack as they are added,
+ *      a page that has no room left spills into a new one, and every
+ *      image gets the UV transform that maps its own 0..1 coordinates
+ *      into its page. Drawing many small textures then costs one bind
+ *      per page instead of one per texture.
+ *
+ *      Every image is surrounded by PADDING texels copied from its
+ *      opposite edge, so sampling right at the border behaves like
+ *      GL_REPEAT, and images start on multiples of PADDING so the
+ *      first MIP_LEVELS mip levels never mix neighbours. Coordinates
+ *      outside 0..1 do not wrap, the atlas is for meshes that stay
+ *      inside their texture.
+ *
+ *      Pages are single-layer GL_TEXTURE_2D_ARRAYs so the shaders that
+ *      sample texture arrays (MaterialTextures.h) read them unchanged.
+ *
+ *      TextureAtlas atlas;
+ *      AtlasRegion region = atlas.Add(width, height, pixels);
+ *      atlas.Flush();                          // mip levels of the pages that changed
+ *      atlas.BindPage(region.page, 0);
+ *      uv = uv * region.uvTransform.xy + region.uvTransform.zw;
+ */
+
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+
+struct AtlasRegion {
+    int page = -1;                                          // -1 when the image did not fit into a page
+    glm::vec4 uvTransform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f); // xy scale, zw offset
+};
+
+
+class TextureAtlas {
+
+public:
+    static const int PADDING = 8;
+    // levels 0..3, at level 3 the padding is still one texel wide
+    static const int MIP_LEVELS = 4;
+
+    explicit TextureAtlas(int pageSize = 1024);
+    ~TextureAtlas();
+
+    // packs an RGBA8 image (bottom row first) into the first page with room for it
+    AtlasRegion Add(int width, int height, const unsigned char* pixels);
+    // regenerates the mip levels of every page that was added to since the last call
+    void Flush();
+
+    void BindPage(int page, GLuint unit) const;
+
+    int GetPageSize() const;
+    int GetPageCount() const;
+    int GetImageCount() const;
+    // texels covered by images, without their padding, over all page texels
+    float GetOccupancy() const;
+
+private:
+    struct Page;
+
+    int pageSize;
+    std::vector<std::unique_ptr<Page>> pages;
+    std::vector<unsigned char> padded;      // reused for every image's padded copy
+    long long imageTexels;
+    int imageCount;
+
+    Page* addPage();
+};
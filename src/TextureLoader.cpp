@@ -11,6 +11,7 @@
 #include "TextureLoader.h"
 #include <glad/glad.h>
 #include "Logger.h"
+#include "GpuResources.h"
 #include <string>
 #include <iostream>
 
@@ -26,7 +27,7 @@
 TextureLoader::TextureLoader(std::string texturePath) {
 
     // generate and bind textures
-    glGenTextures(1, &texture);
+    texture = resources::CreateTexture("TextureLoader", texturePath);
     glBindTexture(GL_TEXTURE_2D, texture);
 
     // wrapping parameters
@@ -47,6 +48,7 @@ TextureLoader::TextureLoader(std::string texturePath) {
     if (data) {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        resources::SetSize(resources::ResourceType::Texture, texture, resources::TextureBytes(width, height, 4, 0));
         Global::logger.log(INFO, "Texture loaded successfully.");
     } else {
         Global::logger.log(ERROR, "Texture failed to load!");
@@ -55,6 +57,10 @@ TextureLoader::TextureLoader(std::string texturePath) {
     stbi_image_free(data);
 }
 
+TextureLoader::~TextureLoader() {
+    resources::Delete(resources::ResourceType::Texture, texture);
+}
+
 // get texture ID of object
 unsigned int TextureLoader::getTextureID() {
     return texture;
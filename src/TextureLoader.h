@@ -20,6 +20,7 @@ public:
 
     // constructor
     TextureLoader(std::string texturePath);
+    ~TextureLoader();
     unsigned int getTextureID();
 
 
@@ -0,0 +1,273 @@
+/*
+ * TextureStreamer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for mip level streaming.
+ */
+
+#include "TextureStreamer.h"
+
+#include "GpuResources.h"
+
+#include <algorithm>
+
+
+namespace {
+
+const double STATS_WINDOW = 0.5;
+
+int levelCount(int width, int height) {
+    int levels = 1;
+    while ((std::max(width, height) >> levels) > 0)
+        levels++;
+    return levels;
+}
+
+int levelSize(int size, int level) {
+    return std::max(1, size >> level);
+}
+
+}
+
+
+TextureStreamer::TextureStreamer(long long budgetBytes)
+    : budget(budgetBytes), residentBytes(0), fullBytes(0), frame(0), pendingLoads(0),
+      windowStart(std::chrono::steady_clock::now()), windowBytes(0), windowEvictions(0), bandwidth(0.0),
+      evictionsPerSecond(0) {
+    loadQueue.Start(1, [](Load& load, int) {
+        load.pixels.clear();
+        load.source(load.level, load.pixels);
+        load.source = nullptr;
+    });
+}
+
+TextureStreamer::~TextureStreamer() {
+    loadQueue.Stop();
+}
+
+int TextureStreamer::Add(GLuint texture, int width, int height, int layers, LevelSource source) {
+    Texture entry;
+    entry.texture = texture;
+    entry.width = width;
+    entry.height = height;
+    entry.layers = layers;
+    entry.tailLevel = 0;
+    while (std::max(levelSize(width, entry.tailLevel), levelSize(height, entry.tailLevel)) > TAIL_SIZE)
+        entry.tailLevel++;
+    entry.residentLevel = entry.tailLevel;
+    entry.requestedLevel = entry.tailLevel;
+    entry.loadingLevel = -1;
+    entry.source = std::move(source);
+
+    int levels = levelCount(width, height);
+    entry.lastUsed.assign(levels, -1);
+    for (int level = 0; level < levels; level++)
+        fullBytes += levelBytes(entry, level);
+
+    // the tail right away, the texture is complete from the first frame on
+    std::vector<unsigned char> pixels;
+    for (int level = levels - 1; level >= entry.tailLevel; level--) {
+        pixels.clear();
+        entry.source(level, pixels);
+        uploadLevel(entry, level, pixels.data());
+        residentBytes += levelBytes(entry, level);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    setResidentLevel(entry, entry.tailLevel);
+
+    textures.push_back(std::move(entry));
+    return (int)textures.size() - 1;
+}
+
+void TextureStreamer::Clear() {
+    loadQueue.Cancel();
+    for (Load& load : finished)
+        loadQueue.Recycle(std::move(load));
+    finished.clear();
+
+    textures.clear();
+    residentBytes = 0;
+    fullBytes = 0;
+    pendingLoads = 0;
+}
+
+void TextureStreamer::Request(int id, int level) {
+    if (id < 0 || id >= (int)textures.size())
+        return;
+
+    Texture& texture = textures[id];
+    level = std::clamp(level, 0, texture.tailLevel);
+    texture.requestedLevel = std::min(texture.requestedLevel, level);
+    for (int l = level; l < texture.tailLevel; l++)
+        texture.lastUsed[l] = frame;
+}
+
+void TextureStreamer::Update() {
+    // finished loads, in the order they were made, up to the frame's upload allowance
+    long long uploaded = 0;
+    loadQueue.Collect(finished);
+    size_t taken = 0;
+    for (; taken < finished.size() && uploaded < UPLOAD_BYTES_PER_FRAME; taken++) {
+        Load& load = finished[taken];
+        Texture& texture = textures[load.id];
+        texture.loadingLevel = -1;
+        pendingLoads--;
+
+        // a load for a level whose coarser neighbour was evicted meanwhile is dropped
+        if (load.level == texture.residentLevel - 1) {
+            uploadLevel(texture, load.level, load.pixels.data());
+            residentBytes += levelBytes(texture, load.level);
+            uploaded += levelBytes(texture, load.level);
+            setResidentLevel(texture, load.level);
+        }
+        loadQueue.Recycle(std::move(load));
+    }
+    finished.erase(finished.begin(), finished.begin() + taken);
+    windowBytes += uploaded;
+
+    while (residentBytes > budget && evictOne()) {
+    }
+
+    // the textures furthest from what they need first
+    candidates.clear();
+    for (int id = 0; id < (int)textures.size(); id++) {
+        if (textures[id].requestedLevel < textures[id].residentLevel && textures[id].loadingLevel == -1)
+            candidates.push_back(id);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+        int gapA = textures[a].residentLevel - textures[a].requestedLevel;
+        int gapB = textures[b].residentLevel - textures[b].requestedLevel;
+        return gapA != gapB ? gapA > gapB : a < b;
+    });
+
+    long long pendingBytes = 0;
+    for (const Texture& texture : textures) {
+        if (texture.loadingLevel != -1)
+            pendingBytes += levelBytes(texture, texture.loadingLevel);
+    }
+
+    for (int id : candidates) {
+        if (pendingLoads >= MAX_PENDING_LOADS)
+            break;
+
+        // room comes from levels no texture needed this frame, otherwise the load waits
+        Texture& texture = textures[id];
+        long long bytes = levelBytes(texture, texture.residentLevel - 1);
+        while (residentBytes + pendingBytes + bytes > budget && evictOne()) {
+        }
+        if (residentBytes + pendingBytes + bytes > budget)
+            continue;
+
+        Load job = loadQueue.Acquire();
+        job.id = id;
+        job.level = texture.residentLevel - 1;
+        job.source = texture.source;
+        texture.loadingLevel = job.level;
+        loadQueue.Submit(std::move(job));
+        pendingLoads++;
+        pendingBytes += bytes;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - windowStart).count();
+    if (seconds >= STATS_WINDOW) {
+        bandwidth = windowBytes / seconds;
+        evictionsPerSecond = (int)(windowEvictions / seconds + 0.5);
+        windowStart = now;
+        windowBytes = 0;
+        windowEvictions = 0;
+    }
+
+    frame++;
+    for (Texture& texture : textures)
+        texture.requestedLevel = texture.tailLevel;
+}
+
+void TextureStreamer::SetBudget(long long budgetBytes) {
+    budget = budgetBytes;
+}
+
+long long TextureStreamer::GetBudget() const {
+    return budget;
+}
+
+int TextureStreamer::GetTextureCount() const {
+    return (int)textures.size();
+}
+
+int TextureStreamer::GetResidentLevel(int id) const {
+    return id >= 0 && id < (int)textures.size() ? textures[id].residentLevel : 0;
+}
+
+long long TextureStreamer::GetResidentBytes() const {
+    return residentBytes;
+}
+
+long long TextureStreamer::GetFullBytes() const {
+    return fullBytes;
+}
+
+int TextureStreamer::GetPendingLoads() const {
+    return pendingLoads;
+}
+
+double TextureStreamer::GetBandwidth() const {
+    return bandwidth;
+}
+
+int TextureStreamer::GetEvictionsPerSecond() const {
+    return evictionsPerSecond;
+}
+
+long long TextureStreamer::levelBytes(const Texture& texture, int level) {
+    return (long long)levelSize(texture.width, level) * levelSize(texture.height, level) * 4 * texture.layers;
+}
+
+void TextureStreamer::uploadLevel(Texture& texture, int level, const unsigned char* pixels) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture.texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize(texture.width, level), levelSize(texture.height, level),
+            texture.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureStreamer::setResidentLevel(Texture& texture, int level) {
+    texture.residentLevel = level;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture.texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, level);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    long long bytes = 0;
+    for (int l = level; l < (int)texture.lastUsed.size(); l++)
+        bytes += levelBytes(texture, l);
+    resources::SetSize(resources::ResourceType::Texture, texture.texture, (size_t)bytes);
+}
+
+bool TextureStreamer::evictOne() {
+    // least recently needed finest level, the bigger one when two were last needed together
+    Texture* victim = nullptr;
+    for (Texture& texture : textures) {
+        if (texture.residentLevel >= texture.tailLevel || texture.lastUsed[texture.residentLevel] >= frame)
+            continue;
+        if (!victim || texture.lastUsed[texture.residentLevel] < victim->lastUsed[victim->residentLevel]
+                || (texture.lastUsed[texture.residentLevel] == victim->lastUsed[victim->residentLevel]
+                    && levelBytes(texture, texture.residentLevel) > levelBytes(*victim, victim->residentLevel))) {
+            victim = &texture;
+        }
+    }
+    if (!victim)
+        return false;
+
+    // clamped away first, then its storage is released by redefining it empty
+    int level = victim->residentLevel;
+    setResidentLevel(*victim, level + 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, victim->texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    residentBytes -= levelBytes(*victim, level);
+    windowEvictions++;
+    return true;
+}
@@ -0,0 +1,132 @@
+/*
+ * TextureStreamer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for mip level streaming. A streamed texture starts
+ *      with only its small mip tail resident (levels of at most
+ *      TAIL_SIZE texels), every frame the renderer requests the finest
+ *      level each texture needs and Update() makes the textures
+ *      converge towards it:
+ *
+ *      - missing levels are produced by a loader thread (a
+ *        BackgroundQueue of one thread) through the
+ *        texture's LevelSource, one level at a time from coarse to
+ *        fine, and uploaded on the GL thread, at most
+ *        UPLOAD_BYTES_PER_FRAME per frame
+ *      - GL_TEXTURE_BASE_LEVEL is clamped to the finest resident level
+ *        so the sampler never touches a missing one
+ *      - while the resident levels exceed the budget, the finest level
+ *        of the texture that was needed least recently is evicted (its
+ *        storage is redefined to 0x0), levels needed this frame are
+ *        never evicted, a load that does not fit waits instead
+ *
+ *      Textures are mutable GL_TEXTURE_2D_ARRAYs with RGBA8 levels, the
+ *      owner creates and deletes them, Clear() has to come first.
+ *
+ *      TextureStreamer streamer(64 << 20);
+ *      int id = streamer.Add(texture, width, height, layers, source);
+ *      ...
+ *      streamer.Request(id, level);            // every frame, for every texture in use
+ *      streamer.Update();
+ */
+
+#pragma once
+
+#include "BackgroundQueue.h"
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+
+class TextureStreamer {
+
+public:
+    // writes the RGBA8 texels of mip "level" of every layer, layer after layer, into "pixels";
+    // called on the loader thread, and on the caller's for the tail in Add()
+    using LevelSource = std::function<void(int level, std::vector<unsigned char>& pixels)>;
+
+    // levels of at most this many texels on their longer side stay resident
+    static const int TAIL_SIZE = 16;
+    static const long long UPLOAD_BYTES_PER_FRAME = 4 << 20;
+    // loads queued or in flight at once
+    static const int MAX_PENDING_LOADS = 8;
+
+    explicit TextureStreamer(long long budgetBytes);
+    ~TextureStreamer();
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    // uploads the mip tail of "texture" and returns its id for Request()
+    int Add(GLuint texture, int width, int height, int layers, LevelSource source);
+    // forgets every texture, waits for the load in flight and drops the ones that finish later
+    void Clear();
+
+    // "level" is the finest level the texture needs this frame, requests of one frame keep the finest
+    void Request(int id, int level);
+    // once per frame on the GL thread: uploads finished loads, evicts, queues new loads
+    void Update();
+
+    void SetBudget(long long budgetBytes);
+    long long GetBudget() const;
+    int GetTextureCount() const;
+    // finest level the sampler can reach
+    int GetResidentLevel(int id) const;
+    long long GetResidentBytes() const;
+    // what every texture costs with all its levels resident
+    long long GetFullBytes() const;
+    int GetPendingLoads() const;
+    // uploaded bytes per second and evicted levels, averaged over the last half second
+    double GetBandwidth() const;
+    int GetEvictionsPerSecond() const;
+
+private:
+    struct Texture {
+        GLuint texture;
+        int width;
+        int height;
+        int layers;
+        int tailLevel;                  // first level that is always resident
+        int residentLevel;              // finest resident level, the base level
+        int requestedLevel;             // finest level requested this frame
+        int loadingLevel;               // level the loader works on, -1 for none
+        std::vector<long long> lastUsed; // per level, the frame it was last needed
+        LevelSource source;
+    };
+
+    struct Load {
+        int id;
+        int level;
+        LevelSource source;
+        std::vector<unsigned char> pixels;
+    };
+
+    std::vector<Texture> textures;
+    long long budget;
+    long long residentBytes;
+    long long fullBytes;
+    long long frame;
+    std::vector<int> candidates;        // reused by Update()
+
+    std::vector<Load> finished;         // collected, waiting for upload
+    int pendingLoads;
+
+    // bandwidth window
+    std::chrono::steady_clock::time_point windowStart;
+    long long windowBytes;
+    int windowEvictions;
+    double bandwidth;
+    int evictionsPerSecond;
+
+    // last, the loader stops before anything it uses goes away
+    BackgroundQueue<Load> loadQueue;
+
+    static long long levelBytes(const Texture& texture, int level);
+    void uploadLevel(Texture& texture, int level, const unsigned char* pixels);
+    void setResidentLevel(Texture& texture, int level);
+    bool evictOne();
+};
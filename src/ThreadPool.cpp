@@ -0,0 +1,148 @@
+/*
+ * ThreadPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the work-stealing thread pool.
+ *      The deques are guarded by one small mutex each, tasks are
+ *      whole chunks of a ParallelFor range so they are coarse enough
+ *      that lock traffic never shows up next to the actual work.
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+namespace {
+
+// the calling thread counts as one of the threads
+unsigned int workerCount(unsigned int threadCount) {
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    return std::max(1u, threadCount) - 1;
+}
+
+}
+
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+    : queues(workerCount(threadCount) + 1), pendingTasks(0), steals(0), stopping(false) {
+
+    for (size_t i = 0; i + 1 < queues.size(); i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, (int)i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::parallelFor(int count, int grain, BodyFunction function, const void* body) {
+    if (count <= 0)
+        return;
+
+    int caller = (int)workers.size();
+    grain = std::max(1, grain);
+    int chunks = (count + grain - 1) / grain;
+
+    // nothing to share, skip the queues entirely
+    if (workers.empty() || chunks == 1) {
+        function(body, 0, count, caller);
+        return;
+    }
+
+    // deal the chunks out round robin, the caller's queue gets its share as well
+    std::atomic<int> remaining(chunks);
+    for (int chunk = 0; chunk < chunks; chunk++) {
+        Task task = { function, body, chunk * grain, std::min(count, (chunk + 1) * grain), &remaining };
+        WorkerQueue& queue = queues[chunk % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks += chunks;
+    }
+    wakeUp.notify_all();
+
+    // help until every chunk of this range has finished
+    Task task;
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        if (popOrSteal(caller, task)) {
+            run(task, caller);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+int ThreadPool::GetThreadCount() const {
+    return (int)workers.size() + 1;
+}
+
+long long ThreadPool::GetStealCount() const {
+    return steals.load();
+}
+
+void ThreadPool::workerLoop(int thread) {
+    Task task;
+    while (true) {
+        if (popOrSteal(thread, task)) {
+            run(task, thread);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping || pendingTasks.load() > 0; });
+        if (stopping)
+            return;
+    }
+}
+
+bool ThreadPool::popOrSteal(int thread, Task& task) {
+    // newest task of our own first, it is the most likely to still be in cache
+    {
+        WorkerQueue& own = queues[thread];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.tasks.size() > own.oldest) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            if (own.tasks.size() == own.oldest) {
+                own.tasks.clear();
+                own.oldest = 0;
+            }
+            pendingTasks--;
+            return true;
+        }
+    }
+
+    // then the oldest task of someone else
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkerQueue& victim = queues[(thread + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.size() > victim.oldest) {
+            task = victim.tasks[victim.oldest++];
+            if (victim.tasks.size() == victim.oldest) {
+                victim.tasks.clear();
+                victim.oldest = 0;
+            }
+            pendingTasks--;
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(const Task& task, int thread) {
+    task.function(task.body, task.begin, task.end, thread);
+    task.remaining->fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,93 @@
+/*
+ * ThreadPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for the work-stealing thread pool used by the
+ *      per-frame update. Every worker owns a task deque, it pops new
+ *      work from the back of its own deque and steals from the front
+ *      of the others once it runs dry.
+ *
+ *      ParallelFor() blocks until the whole range is done, the calling
+ *      thread works on the range too, so a pool of N workers runs
+ *      N + 1 threads and thread index N is the caller. It is meant to
+ *      be called from one thread, never from inside a running task.
+ *
+ *      ThreadPool pool(4);     // 3 workers + the caller
+ *      pool.ParallelFor(count, 256, [&](int begin, int end, int thread) {
+ *          for (int i = begin; i < end; i++) results[thread] += work(i);
+ *      });
+ *
+ *      The body is passed by reference and never copied or wrapped in a
+ *      std::function, so a ParallelFor call does not allocate.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class ThreadPool {
+
+public:
+    // threadCount includes the caller, 0 matches the hardware, 1 runs everything inline
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // splits [0, count) into chunks of at most "grain" items and runs them on every thread,
+    // as body(begin, end, threadIndex) with threadIndex in [0, GetThreadCount())
+    template <typename Body>
+    void ParallelFor(int count, int grain, const Body& body) {
+        parallelFor(count, grain, &invokeBody<Body>, &body);
+    }
+
+    // workers plus the thread calling ParallelFor
+    int GetThreadCount() const;
+    // tasks taken from another worker's deque since the pool was created
+    long long GetStealCount() const;
+
+private:
+    using BodyFunction = void (*)(const void* body, int begin, int end, int thread);
+
+    struct Task {
+        BodyFunction function;
+        const void* body;
+        int begin;
+        int end;
+        std::atomic<int>* remaining;
+    };
+
+    // a vector plus the index of the oldest task instead of a deque, the deque frees
+    // and reallocates its blocks as tasks come and go
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        size_t oldest = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<WorkerQueue> queues;        // one per worker plus one for the caller
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> pendingTasks;
+    std::atomic<long long> steals;
+    bool stopping;
+
+    template <typename Body>
+    static void invokeBody(const void* body, int begin, int end, int thread) {
+        (*(const Body*)body)(begin, end, thread);
+    }
+
+    void parallelFor(int count, int grain, BodyFunction function, const void* body);
+    void workerLoop(int thread);
+    bool popOrSteal(int thread, Task& task);
+    void run(const Task& task, int thread);
+};
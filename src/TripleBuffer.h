@@ -0,0 +1,76 @@
+/*
+ * TripleBuffer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Lock-free handoff of whole values from one producer thread to
+ *      one consumer thread. The producer fills the back buffer and
+ *      publishes it, the consumer acquires the newest published buffer,
+ *      neither side ever waits on the other and neither ever sees a
+ *      buffer the other side is still working on. A value published
+ *      twice before the consumer looks is replaced by the newer one.
+ *
+ *      TripleBuffer<Frame> frames;
+ *      // producer                             // consumer
+ *      Fill(frames.GetWriteBuffer());          if (frames.Acquire())
+ *      frames.Publish();                           Use(frames.GetReadBuffer());
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+template <typename T>
+class TripleBuffer {
+
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // producer side: the buffer to fill next, keeps its previous contents so it can be reused
+    T& GetWriteBuffer() {
+        return buffers[back];
+    }
+
+    // producer side: hands the write buffer over, the previous middle one becomes writable
+    void Publish() {
+        back = middle.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // consumer side: swaps in the newest published buffer, false if nothing new arrived
+    bool Acquire() {
+        if (!HasFresh())
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // consumer side: the last acquired buffer
+    const T& GetReadBuffer() const {
+        return buffers[front];
+    }
+
+    // true while a published buffer is waiting to be acquired
+    bool HasFresh() const {
+        return (middle.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    // drops a published but unacquired buffer, only while neither side is running
+    void Discard() {
+        middle.fetch_and(INDEX_MASK, std::memory_order_acq_rel);
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T buffers[3];
+    uint8_t back;                   // owned by the producer
+    std::atomic<uint8_t> middle;    // index of the shared buffer plus FRESH_BIT
+    uint8_t front;                  // owned by the consumer
+};
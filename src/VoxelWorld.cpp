@@ -0,0 +1,451 @@
+/*
+ * VoxelWorld.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Implementation file for the chunked voxel world.
+ */
+
+#include "VoxelWorld.h"
+
+#include "GpuResources.h"
+#include "Logger.h"
+
+// mode 20: one 32 bit vertex (position, ambient occlusion) followed by a 32 bit face
+// (red, green, blue, normal) per vertex, no textures
+#define STBVOX_CONFIG_MODE 20
+#define STBVOX_CONFIG_PRECISION_Z 0
+#define STB_VOXEL_RENDER_IMPLEMENTATION
+#include <stb_voxel_render.h>
+
+#include <stb_perlin.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+
+namespace {
+
+const double STATS_WINDOW = 0.5;
+
+// the world's corner in scene units, centered on the origin in x and z with the surface below
+// the cube grid
+const glm::vec3 WORLD_ORIGIN(-128.0f, -40.0f, -128.0f);
+
+// terrain height in voxels, fbm noise around BASE_HEIGHT
+const float BASE_HEIGHT = 24.0f;
+const float HEIGHT_RANGE = 14.0f;
+const float TERRAIN_FREQUENCY = 0.012f;
+const float CAVE_FREQUENCY = 0.07f;
+const float CAVE_THRESHOLD = 0.35f;
+
+// stb_voxel_render output in mode 20: 4 vertices of 8 bytes per quad
+const int QUAD_BYTES = 4 * 8;
+// the quads one stbvox_make_mesh() call may write before it has to be called again
+const int SCRATCH_QUADS = 16384;
+// chunk vertex buffers grow in these steps
+const GLsizeiptr BUFFER_GRANULARITY = 16 << 10;
+
+const stbvox_rgb PALETTE[VoxelWorld::BLOCK_TYPES] = {
+    {   0,   0,   0 },      // air
+    {  86, 140,  52 },      // grass
+    { 121,  85,  58 },      // dirt
+    { 122, 122, 128 },      // stone
+    { 212, 196, 140 },      // sand
+    { 236, 240, 245 },      // snow
+};
+
+unsigned char blockGeometry[VoxelWorld::BLOCK_TYPES] = {
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_empty, 0, 0),
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_solid, 0, 0),
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_solid, 0, 0),
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_solid, 0, 0),
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_solid, 0, 0),
+    STBVOX_MAKE_GEOMETRY(STBVOX_GEOM_solid, 0, 0),
+};
+
+// a little brightness noise per voxel so flat ground doesn't read as one color
+unsigned char vary(unsigned char channel, int x, int y, int z) {
+    unsigned int hash = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ (unsigned int)z * 83492791u;
+    hash = (hash ^ (hash >> 13)) * 1274126177u;
+    float scale = 0.9f + 0.2f * ((hash >> 8) & 255) / 255.0f;
+    return (unsigned char)std::min(255.0f, channel * scale);
+}
+
+}
+
+
+struct VoxelWorld::Mesher {
+    std::vector<stbvox_rgb> colors;
+    std::vector<unsigned char> lighting;
+    std::vector<uint8_t> scratch;
+    stbvox_mesh_maker maker;
+};
+
+VoxelWorld::VoxelWorld(ThreadPool* pool)
+    : indexBuffer(0), indexQuads(0), built(false), windowMeshes(0), windowMs(0.0) {
+    shader = new Shader("src/shaders/voxel.vert", "src/shaders/voxel.frag");
+
+    // stb_voxel_render's face normals, indexed by the normal in every face
+    stbvox_uniform_info normals;
+    if (stbvox_get_uniform_info(&normals, STBVOX_UNIFORM_normals) && normals.default_value) {
+        shader->use();
+        glUniform3fv(glGetUniformLocation(shader->ID, "normals"), normals.array_length, normals.default_value);
+    }
+
+    generate(pool);
+
+    for (int cx = 0; cx < CHUNKS_X; cx++) {
+        for (int cz = 0; cz < CHUNKS_Z; cz++) {
+            for (int cy = 0; cy < CHUNKS_Y; cy++) {
+                Chunk chunk;
+                chunk.origin = glm::ivec3(cx, cy, cz) * CHUNK_SIZE;
+                chunk.bounds = AABB(WORLD_ORIGIN + glm::vec3(chunk.origin),
+                                    WORLD_ORIGIN + glm::vec3(chunk.origin + CHUNK_SIZE));
+                chunks.push_back(chunk);
+            }
+        }
+    }
+    indexBuffer = resources::CreateBuffer("VoxelWorld", "quad indices");
+
+    stats.chunks = (int)chunks.size();
+    stats.meshThreads = MESH_THREADS;
+    stats.voxelBytes = (long long)voxels.size();
+    generatedAt = std::chrono::steady_clock::now();
+    windowStart = generatedAt;
+
+    const size_t paddedVoxels = (size_t)PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+    for (int i = 0; i < MESH_THREADS; i++) {
+        meshers.push_back(std::make_unique<Mesher>());
+        meshers.back()->colors.resize(paddedVoxels);
+        meshers.back()->lighting.resize(paddedVoxels);
+        meshers.back()->scratch.resize((size_t)SCRATCH_QUADS * QUAD_BYTES);
+    }
+    meshQueue.Start(MESH_THREADS, [this](MeshJob& job, int thread) { mesh(job, *meshers[thread]); });
+}
+
+VoxelWorld::~VoxelWorld() {
+    meshQueue.Stop();
+
+    for (Chunk& chunk : chunks) {
+        resources::Delete(resources::ResourceType::VertexArray, chunk.vao);
+        resources::Delete(resources::ResourceType::Buffer, chunk.buffer);
+    }
+    resources::Delete(resources::ResourceType::Buffer, indexBuffer);
+    delete shader;
+}
+
+size_t VoxelWorld::voxelIndex(int x, int y, int z) {
+    return ((size_t)x * SIZE_Z + z) * SIZE_Y + y;
+}
+
+void VoxelWorld::generate(ThreadPool* pool) {
+    voxels.assign((size_t)SIZE_X * SIZE_Y * SIZE_Z, AIR);
+
+    pool->ParallelFor(SIZE_X, 8, [this](int begin, int end, int) {
+        for (int x = begin; x < end; x++) {
+            for (int z = 0; z < SIZE_Z; z++) {
+                float noise = stb_perlin_fbm_noise3(x * TERRAIN_FREQUENCY, 0.5f, z * TERRAIN_FREQUENCY, 2.0f, 0.5f, 5);
+                int height = std::clamp((int)(BASE_HEIGHT + HEIGHT_RANGE * noise), 4, SIZE_Y - 4);
+                uint8_t* column = &voxels[voxelIndex(x, 0, z)];
+
+                for (int y = 0; y < height; y++) {
+                    int depth = height - 1 - y;
+                    uint8_t block;
+                    if (depth == 0)
+                        block = height > BASE_HEIGHT + 10 ? SNOW : height < BASE_HEIGHT - 6 ? SAND : GRASS;
+                    else if (depth < 4)
+                        block = height < BASE_HEIGHT - 6 ? SAND : DIRT;
+                    else
+                        block = STONE;
+
+                    // caves below the soil, never through the floor
+                    if (depth >= 4 && y > 1 && stb_perlin_noise3(x * CAVE_FREQUENCY, y * CAVE_FREQUENCY * 1.5f,
+                                                                 z * CAVE_FREQUENCY, 0, 0, 0) > CAVE_THRESHOLD)
+                        block = AIR;
+                    column[y] = block;
+                }
+            }
+        }
+    });
+}
+
+AABB VoxelWorld::GetBounds() const {
+    return AABB(WORLD_ORIGIN, WORLD_ORIGIN + glm::vec3(SIZE_X, SIZE_Y, SIZE_Z));
+}
+
+uint8_t VoxelWorld::GetVoxel(const glm::vec3& position) const {
+    glm::ivec3 voxel = glm::ivec3(glm::floor(position - WORLD_ORIGIN));
+    if (voxel.x < 0 || voxel.y < 0 || voxel.z < 0 || voxel.x >= SIZE_X || voxel.y >= SIZE_Y || voxel.z >= SIZE_Z)
+        return AIR;
+    return voxels[voxelIndex(voxel.x, voxel.y, voxel.z)];
+}
+
+void VoxelWorld::SetSphere(const glm::vec3& center, float radius, uint8_t block) {
+    glm::vec3 local = center - WORLD_ORIGIN;
+    glm::ivec3 first = glm::max(glm::ivec3(glm::floor(local - radius)), glm::ivec3(0));
+    glm::ivec3 last = glm::min(glm::ivec3(glm::floor(local + radius)), glm::ivec3(SIZE_X, SIZE_Y, SIZE_Z) - 1);
+
+    glm::ivec3 changedFirst(SIZE_X, SIZE_Y, SIZE_Z);
+    glm::ivec3 changedLast(-1);
+    for (int x = first.x; x <= last.x; x++) {
+        for (int z = first.z; z <= last.z; z++) {
+            for (int y = first.y; y <= last.y; y++) {
+                glm::vec3 offset = glm::vec3(x, y, z) + 0.5f - local;
+                uint8_t& voxel = voxels[voxelIndex(x, y, z)];
+                if (glm::dot(offset, offset) > radius * radius || voxel == block)
+                    continue;
+                voxel = block;
+                changedFirst = glm::min(changedFirst, glm::ivec3(x, y, z));
+                changedLast = glm::max(changedLast, glm::ivec3(x, y, z));
+            }
+        }
+    }
+    if (changedLast.x >= 0)
+        markDirty(changedFirst, changedLast);
+}
+
+void VoxelWorld::markDirty(const glm::ivec3& first, const glm::ivec3& last) {
+    // a chunk's mesh depends on the voxel border around it as well
+    glm::ivec3 firstChunk = glm::max((first - 1) / CHUNK_SIZE, glm::ivec3(0));
+    glm::ivec3 lastChunk = glm::min((last + 1) / CHUNK_SIZE, glm::ivec3(CHUNKS_X, CHUNKS_Y, CHUNKS_Z) - 1);
+    for (int cx = firstChunk.x; cx <= lastChunk.x; cx++) {
+        for (int cz = firstChunk.z; cz <= lastChunk.z; cz++) {
+            for (int cy = firstChunk.y; cy <= lastChunk.y; cy++)
+                chunks[(cx * CHUNKS_Z + cz) * CHUNKS_Y + cy].dirty = true;
+        }
+    }
+}
+
+void VoxelWorld::copyBlocks(const Chunk& chunk, std::vector<uint8_t>& blocks) const {
+    blocks.assign((size_t)PADDED_SIZE * PADDED_SIZE * PADDED_SIZE, AIR);
+    for (int px = 0; px < PADDED_SIZE; px++) {
+        int x = chunk.origin.x + px - 1;
+        if (x < 0 || x >= SIZE_X)
+            continue;
+        for (int pz = 0; pz < PADDED_SIZE; pz++) {
+            int z = chunk.origin.z + pz - 1;
+            if (z < 0 || z >= SIZE_Z)
+                continue;
+            // the column is contiguous on both sides, only its ends may fall outside the world
+            int firstY = std::max(chunk.origin.y - 1, 0);
+            int lastY = std::min(chunk.origin.y + CHUNK_SIZE, SIZE_Y - 1);
+            uint8_t* target = &blocks[((size_t)px * PADDED_SIZE + pz) * PADDED_SIZE + (firstY - chunk.origin.y + 1)];
+            std::memcpy(target, &voxels[voxelIndex(x, firstY, z)], lastY - firstY + 1);
+        }
+    }
+}
+
+GLsizeiptr VoxelWorld::GetUploadSize() {
+    meshQueue.Collect(finished);
+    GLsizeiptr bytes = 0;
+    for (size_t i = 0; i < finished.size() && bytes < UPLOAD_BYTES_PER_FRAME; i++)
+        bytes += (GLsizeiptr)finished[i].vertices.size() + 4;
+    return bytes;
+}
+
+void VoxelWorld::Update(StreamBuffer& stream, const glm::vec3& cameraPosition) {
+    // finished meshes, in the order they were made, up to the frame's upload allowance
+    long long uploaded = 0;
+    int pending = 0;
+    meshQueue.Collect(finished);
+    size_t taken = 0;
+    for (; taken < finished.size() && uploaded < UPLOAD_BYTES_PER_FRAME; taken++) {
+        MeshJob& job = finished[taken];
+        GLintptr offset = 0;
+        if (!job.vertices.empty()) {
+            void* target = stream.Allocate((GLsizeiptr)job.vertices.size(), 4, offset);
+            if (!target)
+                break;
+            std::memcpy(target, job.vertices.data(), job.vertices.size());
+            stream.Flush();
+        }
+        upload(chunks[job.chunk], job, stream.GetBuffer(), offset);
+        uploaded += (long long)job.vertices.size();
+        chunks[job.chunk].meshing = false;
+        chunks[job.chunk].meshed = true;
+
+        windowMeshes++;
+        windowMs += job.ms;
+        stats.meshedChunks++;
+        meshQueue.Recycle(std::move(job));
+    }
+    finished.erase(finished.begin(), finished.begin() + taken);
+
+    // the dirty chunks nearest to the camera first
+    candidates.clear();
+    for (int i = 0; i < (int)chunks.size(); i++) {
+        if (chunks[i].meshing)
+            pending++;
+        else if (chunks[i].dirty)
+            candidates.push_back(i);
+    }
+    std::sort(candidates.begin(), candidates.end(), [this, &cameraPosition](int a, int b) {
+        glm::vec3 toA = chunks[a].bounds.Center() - cameraPosition;
+        glm::vec3 toB = chunks[b].bounds.Center() - cameraPosition;
+        float distanceA = glm::dot(toA, toA);
+        float distanceB = glm::dot(toB, toB);
+        return distanceA != distanceB ? distanceA < distanceB : a < b;
+    });
+
+    size_t queued = 0;
+    for (; queued < candidates.size() && pending < MAX_PENDING_MESHES; queued++) {
+        Chunk& chunk = chunks[candidates[queued]];
+        MeshJob job = meshQueue.Acquire();
+        job.chunk = candidates[queued];
+        job.origin = chunk.origin;
+        copyBlocks(chunk, job.blocks);
+        meshQueue.Submit(std::move(job));
+        chunk.dirty = false;
+        chunk.meshing = true;
+        pending++;
+    }
+
+    stats.dirtyChunks = (int)(candidates.size() - queued);
+    stats.pendingMeshes = pending;
+    stats.uploadedBytes = uploaded;
+
+    auto now = std::chrono::steady_clock::now();
+    if (!built && std::all_of(chunks.begin(), chunks.end(), [](const Chunk& chunk) { return chunk.meshed; })) {
+        built = true;
+        stats.buildMs = (float)std::chrono::duration<double, std::milli>(now - generatedAt).count();
+    }
+    double seconds = std::chrono::duration<double>(now - windowStart).count();
+    if (seconds >= STATS_WINDOW) {
+        stats.meshesPerSecond = windowMeshes / seconds;
+        stats.meshMs = windowMeshes > 0 ? (float)(windowMs / windowMeshes) : 0.0f;
+        windowStart = now;
+        windowMeshes = 0;
+        windowMs = 0.0;
+    }
+}
+
+void VoxelWorld::upload(Chunk& chunk, const MeshJob& job, GLuint streamBuffer, GLintptr offset) {
+    GLsizeiptr bytes = (GLsizeiptr)job.vertices.size();
+    chunk.quads = job.quads;
+    if (bytes == 0)
+        return;
+
+    // the shared index buffer covers the largest chunk, bound to no vertex array while it grows
+    if (job.quads > indexQuads) {
+        int quads = std::max(indexQuads, 1024);
+        while (quads < job.quads)
+            quads *= 2;
+        std::vector<GLuint> indices((size_t)quads * 6);
+        for (int q = 0; q < quads; q++) {
+            GLuint* quad = &indices[(size_t)q * 6];
+            GLuint first = (GLuint)q * 4;
+            quad[0] = first;
+            quad[1] = first + 1;
+            quad[2] = first + 2;
+            quad[3] = first;
+            quad[4] = first + 2;
+            quad[5] = first + 3;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        resources::SetSize(resources::ResourceType::Buffer, indexBuffer, indices.size() * sizeof(GLuint));
+        stats.meshBytes += (long long)(quads - indexQuads) * 6 * sizeof(GLuint);
+        indexQuads = quads;
+    }
+
+    if (chunk.buffer == 0) {
+        chunk.buffer = resources::CreateBuffer("VoxelWorld", "chunk vertices");
+        chunk.vao = resources::CreateVertexArray("VoxelWorld", "chunk");
+        glBindVertexArray(chunk.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.buffer);
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, 8, (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(1, 4, GL_UNSIGNED_BYTE, 8, (void*)4);
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBindVertexArray(0);
+    }
+    if (bytes > chunk.capacity) {
+        GLsizeiptr capacity = (bytes + BUFFER_GRANULARITY - 1) / BUFFER_GRANULARITY * BUFFER_GRANULARITY;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, chunk.buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STATIC_DRAW);
+        resources::SetSize(resources::ResourceType::Buffer, chunk.buffer, capacity);
+        stats.meshBytes += capacity - chunk.capacity;
+        chunk.capacity = capacity;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, streamBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, chunk.buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, 0, bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void VoxelWorld::Draw(const glm::mat4& viewProjection) {
+    Frustum frustum(viewProjection);
+    shader->use();
+    shader->setMat4("viewProjection", viewProjection);
+
+    stats.visibleChunks = 0;
+    stats.quads = 0;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.quads == 0 || !frustum.Intersects(chunk.bounds))
+            continue;
+        // stb_voxel_render positions start at the padded border, one voxel before the chunk
+        shader->setVec3("chunkOrigin", WORLD_ORIGIN + glm::vec3(chunk.origin - 1));
+        glBindVertexArray(chunk.vao);
+        glDrawElements(GL_TRIANGLES, chunk.quads * 6, GL_UNSIGNED_INT, (void*)0);
+        stats.visibleChunks++;
+        stats.quads += chunk.quads;
+    }
+    glBindVertexArray(0);
+}
+
+const VoxelWorld::Stats& VoxelWorld::GetStats() const {
+    return stats;
+}
+
+void VoxelWorld::mesh(MeshJob& job, Mesher& mesher) const {
+    auto start = std::chrono::steady_clock::now();
+
+    // colors per voxel, fully lit air and dark solids, which is what the ambient occlusion reads
+    for (int px = 0; px < PADDED_SIZE; px++) {
+        for (int pz = 0; pz < PADDED_SIZE; pz++) {
+            size_t column = ((size_t)px * PADDED_SIZE + pz) * PADDED_SIZE;
+            for (int py = 0; py < PADDED_SIZE; py++) {
+                uint8_t block = job.blocks[column + py];
+                mesher.lighting[column + py] = block == AIR ? 255 : 0;
+                if (block == AIR)
+                    continue;
+                int x = job.origin.x + px, y = job.origin.y + py, z = job.origin.z + pz;
+                const stbvox_rgb& base = PALETTE[block];
+                mesher.colors[column + py] = { vary(base.r, x, y, z), vary(base.g, x, y, z), vary(base.b, x, y, z) };
+            }
+        }
+    }
+
+    // stb_voxel_render is z up: its x, y and z are the world's x, z and y, and the layout of
+    // the padded block array matches that with y fastest
+    stbvox_mesh_maker& maker = mesher.maker;
+    stbvox_init_mesh_maker(&maker);
+    stbvox_input_description* input = stbvox_get_input_description(&maker);
+    std::memset(input, 0, sizeof(*input));
+    input->blocktype = job.blocks.data();
+    input->block_geometry = blockGeometry;
+    input->rgb = mesher.colors.data();
+    input->lighting = mesher.lighting.data();
+    stbvox_set_input_stride(&maker, PADDED_SIZE * PADDED_SIZE, PADDED_SIZE);
+    stbvox_set_input_range(&maker, 1, 1, 1, PADDED_SIZE - 1, PADDED_SIZE - 1, PADDED_SIZE - 1);
+
+    std::vector<uint8_t>& scratch = mesher.scratch;
+    job.vertices.clear();
+    job.quads = 0;
+    while (true) {
+        stbvox_set_buffer(&maker, 0, 0, scratch.data(), scratch.size());
+        int done = stbvox_make_mesh(&maker);
+        int quads = stbvox_get_quad_count(&maker, 0);
+        job.vertices.insert(job.vertices.end(), scratch.begin(), scratch.begin() + (size_t)quads * QUAD_BYTES);
+        job.quads += quads;
+        if (done)
+            break;
+    }
+    job.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,161 @@
+/*
+ * VoxelWorld.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: gjin
+ *
+ *      Header file for a chunked voxel world: a block terrain generated
+ *      from Perlin noise, cut into CHUNK_SIZE^3 chunks that are meshed
+ *      independently with stb_voxel_render (mode 20, a 24 bit color per
+ *      face and ambient occlusion per vertex).
+ *
+ *      Meshing runs on MESH_THREADS threads of a BackgroundQueue. Every frame
+ *      Update() on the GL thread
+ *
+ *      - uploads finished meshes, at most UPLOAD_BYTES_PER_FRAME, by
+ *        writing them into the frame's StreamBuffer partition and
+ *        copying them from there into the chunk's vertex buffer
+ *      - hands dirty chunks to the mesher threads, nearest to the
+ *        camera first, as a copy of their voxels with a one voxel
+ *        border, so the threads never read the world itself
+ *
+ *      An edit marks only the chunks it touches dirty, those whose
+ *      border it reaches included, and only they are meshed again. A
+ *      chunk keeps drawing its old mesh until the new one is uploaded.
+ *
+ *      VoxelWorld world(pool);
+ *      world.SetSphere(center, 4.0f, VoxelWorld::AIR);
+ *      ...
+ *      stream.BeginFrame(world.GetUploadSize() + ...);
+ *      world.Update(stream, cameraPosition);
+ *      world.Draw(projection * view);
+ */
+
+#pragma once
+
+#include "BackgroundQueue.h"
+#include "Bounds.h"
+#include "Shader.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+class VoxelWorld {
+
+public:
+    static const int CHUNK_SIZE = 32;
+    // world size in chunks, x and z across, y up
+    static const int CHUNKS_X = 8;
+    static const int CHUNKS_Y = 2;
+    static const int CHUNKS_Z = 8;
+    static const long long UPLOAD_BYTES_PER_FRAME = 4 << 20;
+    // chunks queued or in flight at once
+    static const int MAX_PENDING_MESHES = 32;
+    static const int MESH_THREADS = 2;
+
+    // block types, 0 is empty for stb_voxel_render
+    enum Block : uint8_t { AIR, GRASS, DIRT, STONE, SAND, SNOW, BLOCK_TYPES };
+
+    struct Stats {
+        int chunks = 0;
+        int meshThreads = 0;
+        int dirtyChunks = 0;            // waiting for a mesher
+        int pendingMeshes = 0;          // queued, in flight or waiting for upload
+        long long meshedChunks = 0;     // since the world was generated
+        double meshesPerSecond = 0.0;   // over the last half second
+        float meshMs = 0.0f;            // average per chunk on a mesher thread, same window
+        float buildMs = 0.0f;           // from generation until every chunk was drawable
+        long long uploadedBytes = 0;    // last frame
+        int visibleChunks = 0;          // last Draw()
+        long long quads = 0;
+        long long meshBytes = 0;        // chunk vertex buffers and the shared index buffer
+        long long voxelBytes = 0;
+    };
+
+    // generates the terrain, the columns are spread over "pool"
+    explicit VoxelWorld(ThreadPool* pool);
+    ~VoxelWorld();
+    VoxelWorld(const VoxelWorld&) = delete;
+    VoxelWorld& operator=(const VoxelWorld&) = delete;
+
+    // world bounds in scene units, one unit per voxel
+    AABB GetBounds() const;
+    // the voxel at a scene position, AIR outside the world
+    uint8_t GetVoxel(const glm::vec3& position) const;
+    // every voxel whose center is inside the sphere becomes "block"
+    void SetSphere(const glm::vec3& center, float radius, uint8_t block);
+
+    // collects the finished meshes, what the next Update() may want from the stream buffer at most
+    GLsizeiptr GetUploadSize();
+    // on the GL thread once per frame, between the stream buffer's BeginFrame() and EndFrame()
+    void Update(StreamBuffer& stream, const glm::vec3& cameraPosition);
+    void Draw(const glm::mat4& viewProjection);
+    const Stats& GetStats() const;
+
+private:
+    static const int PADDED_SIZE = CHUNK_SIZE + 2;
+    static const int SIZE_X = CHUNKS_X * CHUNK_SIZE;
+    static const int SIZE_Y = CHUNKS_Y * CHUNK_SIZE;
+    static const int SIZE_Z = CHUNKS_Z * CHUNK_SIZE;
+
+    struct Chunk {
+        glm::ivec3 origin;              // first voxel
+        AABB bounds;
+        GLuint vao = 0;
+        GLuint buffer = 0;
+        GLsizeiptr capacity = 0;
+        int quads = 0;
+        bool dirty = true;
+        bool meshing = false;
+        bool meshed = false;            // has had a mesh uploaded
+    };
+
+    // a chunk's voxels with their border on the way in, its vertices on the way out
+    struct MeshJob {
+        int chunk;
+        glm::ivec3 origin;
+        std::vector<uint8_t> blocks;    // PADDED_SIZE^3, stb_voxel_render order (y fastest)
+        std::vector<uint8_t> vertices;
+        int quads;
+        double ms;
+    };
+
+    // a mesher thread's scratch, kept from one job to the next
+    struct Mesher;
+
+    Shader* shader;
+    std::vector<uint8_t> voxels;        // x, then z, then y fastest
+    std::vector<Chunk> chunks;
+    GLuint indexBuffer;                 // 6 indices per quad, shared by every chunk
+    int indexQuads;
+    std::vector<int> candidates;        // reused by Update()
+
+    std::vector<MeshJob> finished;      // collected, waiting for upload
+
+    std::chrono::steady_clock::time_point generatedAt;
+    bool built;
+    std::chrono::steady_clock::time_point windowStart;
+    int windowMeshes;
+    double windowMs;
+    Stats stats;
+
+    // last, the threads stop before anything they use goes away
+    std::vector<std::unique_ptr<Mesher>> meshers;
+    BackgroundQueue<MeshJob> meshQueue;
+
+    static size_t voxelIndex(int x, int y, int z);
+    void generate(ThreadPool* pool);
+    void markDirty(const glm::ivec3& first, const glm::ivec3& last);
+    void copyBlocks(const Chunk& chunk, std::vector<uint8_t>& blocks) const;
+    void upload(Chunk& chunk, const MeshJob& job, GLuint streamBuffer, GLintptr offset);
+    void mesh(MeshJob& job, Mesher& mesher) const;
+};
+
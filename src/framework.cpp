@@ -11,11 +11,20 @@
  */
 
 #include "framework.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <filesystem>
 #include <string>
+#include <thread>
 #include <imgui.h>
+#include "AllocationCounter.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
+#include "GpuResources.h"
+#include "InputRecorder.h"
 #include "Logger.h"
+#include "graphics.h"
 
 // declare fonts at high scope
 ImFont* font_regular;
@@ -77,6 +86,8 @@ void framework::Update(FrameBuffer* sceneBuffer) {
     static bool show_console_window = true;
     static bool show_performance_window = true;
     static bool show_controls_window = false;
+    static bool show_scene_info_window = false;
+    static bool show_memory_window = false;
     static int scroll = Global::GLlogBuffer.size();
     static float fps;
     static float fpsms;
@@ -99,6 +110,8 @@ void framework::Update(FrameBuffer* sceneBuffer) {
             if (ImGui::MenuItem("OpenGL Scene")) { if (!show_scene_window){show_scene_window = true;}}
             if (ImGui::MenuItem("Console Log")) { if (!show_console_window){show_console_window = true;}}
             if (ImGui::MenuItem("Performance")) { if (!show_performance_window){show_performance_window = true;}}
+            if (ImGui::MenuItem("Scene Info")) { if (!show_scene_info_window){show_scene_info_window = true;}}
+            if (ImGui::MenuItem("Memory")) { if (!show_memory_window){show_memory_window = true;}}
 
             ImGui::Separator();
             if (ImGui::MenuItem("Imgui Demo")) { if (!show_demo_window){show_demo_window = true;}}
@@ -181,6 +194,48 @@ void framework::Update(FrameBuffer* sceneBuffer) {
 
             // find way to display ms per frame
 
+            // per-frame dynamic GPU data
+            const graphics::SceneStats& stream_stats = graphics::GetSceneStats();
+            ImGui::Text("Stream buffer: %.1f / %.0f KB per frame (%s)", stream_stats.streamBytes / 1024.0f,
+                    stream_stats.streamFrameSize / 1024.0f, stream_stats.streamPersistent ? "persistent" : "mapped");
+            ImGui::Text("Fence wait: %.3f ms", stream_stats.fenceWaitMs);
+            ImGui::Text("Frame arenas: %.1f / %.0f KB", stream_stats.arenaBytes / 1024.0f, stream_stats.arenaCapacity / 1024.0f);
+            if (IsAllocationCountingEnabled())
+                ImGui::Text("Heap allocations: %d per frame (%d bytes)", stream_stats.frameAllocations, stream_stats.frameAllocatedBytes);
+
+            // present mode and frame pacing over the last frames
+            FramePacer& pacer = GlobalPacer::pacer;
+            int present_mode = (int)pacer.GetPresentMode();
+            const char* present_modes[] = { "VSync", "Adaptive VSync", "Uncapped", "Frame limiter" };
+            if (ImGui::Combo("Present mode", &present_mode, present_modes, IM_ARRAYSIZE(present_modes))) {
+                pacer.SetPresentMode((PresentMode)present_mode);
+            }
+            if (pacer.GetPresentMode() == PresentMode::Limited) {
+                float target_fps = pacer.GetTargetFps();
+                if (ImGui::SliderFloat("Target FPS", &target_fps, 15.0f, 360.0f, "%.0f")) {
+                    pacer.SetTargetFps(target_fps);
+                }
+            }
+
+            const FramePacingStats& pacing = pacer.GetStats();
+            ImGui::Text("Frame time: %.2f ms avg, %.2f median, %.2f p95, %.2f p99, %.2f max",
+                    pacing.averageMs, pacing.medianMs, pacing.p95Ms, pacing.p99Ms, pacing.maxMs);
+            ImGui::Text("FPS: %.1f avg, %.1f 1%% low", pacing.averageFps, pacing.onePercentLowFps);
+            ImGui::Text("Stutters: %d of the last %d frames", pacing.stutters, pacing.frames);
+
+            // fixed simulation step, independent of the present mode above
+            FixedTimestep& clock = GlobalTimestep::clock;
+            if (clock.IsLockstep()) {
+                ImGui::Text("Simulation: one %.1f ms step per frame (replay)", clock.GetStep() * 1000.0);
+            } else {
+                int simulation_rate = (int)std::lround(1.0 / clock.GetStep());
+                if (ImGui::SliderInt("Simulation rate (Hz)", &simulation_rate, 20, 240)) {
+                    clock.SetStep(1.0 / simulation_rate);
+                }
+                ImGui::Text("Simulation: %d steps last frame, interpolated %.2f, %.1f s dropped",
+                        clock.GetLastSteps(), clock.GetAlpha(), clock.GetDroppedSeconds());
+            }
+
             // frame-rate graph
             // 60FPS max
             static float speed = 1.0f;
@@ -226,6 +281,425 @@ void framework::Update(FrameBuffer* sceneBuffer) {
     }
 
 
+    // show memory window
+    if (show_memory_window) {
+        if (!ImGui::Begin("Memory", &show_memory_window)) {
+            ImGui::End();
+        } else {
+            // CPU side: the counting operator new and the frame arenas
+            const graphics::SceneStats& memory_stats = graphics::GetSceneStats();
+            if (IsAllocationCountingEnabled()) {
+                ImGui::Text("Heap: %.2f MB in use, %.2f MB peak", GetHeapBytesInUse() / 1048576.0, GetHeapBytesPeak() / 1048576.0);
+                ImGui::Text("Heap allocations: %d last frame (%d bytes)", memory_stats.frameAllocations, memory_stats.frameAllocatedBytes);
+            } else {
+                ImGui::Text("Heap: not counted (RENDERER_COUNT_ALLOCATIONS is off)");
+            }
+            ImGui::Text("Frame arenas: %.1f / %.0f KB", memory_stats.arenaBytes / 1024.0f, memory_stats.arenaCapacity / 1024.0f);
+
+            // material texture mip streaming, the budget covers the streamed arrays only
+            ImGui::SeparatorText("Texture streaming");
+            bool texture_streaming = graphics::IsTextureStreaming();
+            if (ImGui::Checkbox("Stream material textures", &texture_streaming)) {
+                graphics::SetTextureStreaming(texture_streaming);
+            }
+            float budget_mb = (float)(graphics::GetTextureBudget() / 1048576.0);
+            if (ImGui::SliderFloat("Budget", &budget_mb, 0.25f, 256.0f, "%.2f MB", ImGuiSliderFlags_Logarithmic)) {
+                graphics::SetTextureBudget((long long)(budget_mb * 1048576.0));
+            }
+            if (memory_stats.textureStreaming) {
+                ImGui::Text("Resident: %.2f MB of %.2f MB budget (%.2f MB with every level)", memory_stats.textureResidentBytes / 1048576.0,
+                        memory_stats.textureBudget / 1048576.0, memory_stats.textureFullBytes / 1048576.0);
+                ImGui::Text("Streaming: %.2f MB/s, %d loads pending, %d evictions/s", memory_stats.textureBandwidth / 1048576.0,
+                        memory_stats.textureLoads, memory_stats.textureEvictions);
+            } else if (texture_streaming) {
+                ImGui::Text("Only Separate and Array textures stream.");
+            }
+
+            // GL objects by type, sizes are what the renderer asked for
+            resources::ResourceTotals totals = resources::GetTotals();
+            ImGui::SeparatorText("GPU resources");
+            ImGui::Text("%d objects, %.2f MB (estimated)", totals.totalCount, totals.totalBytes / 1048576.0);
+            if (ImGui::BeginTable("resource types", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Type");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("KB");
+                ImGui::TableHeadersRow();
+                for (int type = 0; type < (int)resources::ResourceType::COUNT; type++) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(resources::ResourceTypeName((resources::ResourceType)type));
+                    ImGui::TableNextColumn(); ImGui::Text("%d", totals.count[type]);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", totals.bytes[type] / 1024.0);
+                }
+                ImGui::EndTable();
+            }
+
+            // the same by owner, there are only a handful so a linear search does
+            struct OwnerTotal { const char* owner; int count; size_t bytes; };
+            static std::vector<OwnerTotal> owners;
+            owners.clear();
+            const std::vector<resources::GpuResource>& all_resources = resources::GetResources();
+            for (const resources::GpuResource& resource : all_resources) {
+                auto it = std::find_if(owners.begin(), owners.end(), [&](const OwnerTotal& o) { return o.owner == resource.owner; });
+                if (it == owners.end()) {
+                    owners.push_back({ resource.owner, 0, 0 });
+                    it = owners.end() - 1;
+                }
+                it->count++;
+                it->bytes += resource.bytes;
+            }
+            std::sort(owners.begin(), owners.end(), [](const OwnerTotal& a, const OwnerTotal& b) { return a.bytes > b.bytes; });
+            if (ImGui::BeginTable("resource owners", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Owner");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("KB");
+                ImGui::TableHeadersRow();
+                for (const OwnerTotal& owner : owners) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(owner.owner);
+                    ImGui::TableNextColumn(); ImGui::Text("%d", owner.count);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", owner.bytes / 1024.0);
+                }
+                ImGui::EndTable();
+            }
+
+            // every object, largest first
+            if (ImGui::CollapsingHeader("All resources")) {
+                static std::vector<int> order;
+                order.resize(all_resources.size());
+                for (size_t i = 0; i < order.size(); i++)
+                    order[i] = (int)i;
+                std::sort(order.begin(), order.end(), [&](int a, int b) { return all_resources[a].bytes > all_resources[b].bytes; });
+
+                if (ImGui::BeginTable("resources", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.0f, 300.0f))) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Type");
+                    ImGui::TableSetupColumn("Name");
+                    ImGui::TableSetupColumn("KB");
+                    ImGui::TableSetupColumn("Owner");
+                    ImGui::TableHeadersRow();
+                    for (int index : order) {
+                        const resources::GpuResource& resource = all_resources[index];
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn(); ImGui::TextUnformatted(resources::ResourceTypeName(resource.type));
+                        ImGui::TableNextColumn(); ImGui::Text("%u", resource.id);
+                        ImGui::TableNextColumn(); ImGui::Text("%.1f", resource.bytes / 1024.0);
+                        ImGui::TableNextColumn(); ImGui::Text("%s%s%s", resource.owner, resource.label.empty() ? "" : ": ", resource.label.c_str());
+                    }
+                    ImGui::EndTable();
+                }
+            }
+
+            ImGui::End();
+        }
+    }
+
+
+    // show scene info window
+    if (show_scene_info_window) {
+        if (!ImGui::Begin("Scene Info", &show_scene_info_window)) {
+            ImGui::End();
+        } else {
+            const graphics::SceneStats& stats = graphics::GetSceneStats();
+
+            static int grid_size = 0;
+            ImGui::Text("Cube grid size");
+            if (ImGui::SliderInt("##grid", &grid_size, 0, 300)) {
+                graphics::SetCubeGrid(grid_size);
+            }
+
+            // synthetic materials, handed out round robin, every texture group splits the CPU path's batches
+            int material_count = graphics::GetMaterialCount();
+            int texture_count = graphics::GetTextureCount();
+            bool materials_changed = ImGui::SliderInt("Materials", &material_count, 1, 4096);
+            materials_changed |= ImGui::SliderInt("Textures", &texture_count, 1, graphics::MAX_MATERIAL_TEXTURES);
+            if (materials_changed) {
+                graphics::SetMaterials(material_count, texture_count);
+            }
+            MaterialTextureMode texture_mode = graphics::GetTextureMode();
+            if (ImGui::BeginCombo("Texture binding", MaterialTextureModeName(texture_mode))) {
+                const MaterialTextureMode texture_modes[] = { MaterialTextureMode::Separate, MaterialTextureMode::Array,
+                        MaterialTextureMode::Atlas, MaterialTextureMode::Bindless };
+                for (MaterialTextureMode mode : texture_modes) {
+                    bool supported = mode != MaterialTextureMode::Bindless || MaterialTextures::IsBindlessSupported();
+                    if (ImGui::Selectable(MaterialTextureModeName(mode), mode == texture_mode, supported ? 0 : ImGuiSelectableFlags_Disabled)) {
+                        graphics::SetTextureMode(mode);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Separate: one texture per bind. Array: same-size textures share a texture array.");
+                ImGui::Text("Atlas: textures of any size packed into atlas pages, one bind per page.");
+                ImGui::Text("Bindless: resident array handles in an SSBO (ARB_bindless_texture), no binds.");
+                ImGui::EndTooltip();
+            }
+
+            // point lights, the GPU-driven path draws unlit
+            LightingMode lighting_mode = graphics::GetLighting();
+            if (ImGui::BeginCombo("Lighting", LightingModeName(lighting_mode))) {
+                const LightingMode lighting_modes[] = { LightingMode::Off, LightingMode::Naive, LightingMode::Clustered };
+                for (LightingMode mode : lighting_modes) {
+                    if (ImGui::Selectable(LightingModeName(mode), mode == lighting_mode)) {
+                        graphics::SetLighting(mode);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Naive: every fragment loops over every light.");
+                ImGui::Text("Clustered: lights are assigned to %dx%dx%d view clusters, fragments only walk their own.",
+                        LightClusters::CLUSTERS_X, LightClusters::CLUSTERS_Y, LightClusters::CLUSTERS_Z);
+                ImGui::EndTooltip();
+            }
+            int light_count = graphics::GetLightCount();
+            if (ImGui::SliderInt("Lights", &light_count, 0, graphics::MAX_LIGHTS, "%d", ImGuiSliderFlags_Logarithmic)) {
+                graphics::SetLightCount(light_count);
+            }
+
+            RenderPath render_path = graphics::GetRenderPath();
+            if (ImGui::BeginCombo("Render path", RenderPathName(render_path))) {
+                const RenderPath render_paths[] = { RenderPath::Forward, RenderPath::Deferred };
+                for (RenderPath path : render_paths) {
+                    if (ImGui::Selectable(RenderPathName(path), path == render_path)) {
+                        graphics::SetRenderPath(path);
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Forward: fragments are lit as they are drawn.");
+                ImGui::Text("Deferred: the scene goes into a G-buffer first, every pixel is lit once.");
+                ImGui::EndTooltip();
+            }
+
+            // the sun only shines with its shadows, azimuth and elevation of where it stands
+            bool shadows = graphics::IsShadows();
+            if (ImGui::Checkbox("Sun shadows (cascaded)", &shadows)) {
+                graphics::SetShadows(shadows);
+            }
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("%d cascades of %dx%d, static objects are cached until the cascade moves.",
+                        ShadowCascades::CASCADES, ShadowCascades::RESOLUTION, ShadowCascades::RESOLUTION);
+                ImGui::EndTooltip();
+            }
+            if (shadows) {
+                glm::vec3 sun = graphics::GetSunDirection();
+                float sun_angles[2] = { glm::degrees(std::atan2(-sun.z, -sun.x)), glm::degrees(std::asin(std::clamp(-sun.y, -1.0f, 1.0f))) };
+                if (ImGui::SliderFloat2("Sun azimuth, elevation", sun_angles, -180.0f, 180.0f, "%.0f")) {
+                    float azimuth = glm::radians(sun_angles[0]);
+                    float elevation = glm::radians(std::clamp(sun_angles[1], 5.0f, 90.0f));
+                    graphics::SetSunDirection(-glm::vec3(std::cos(elevation) * std::cos(azimuth), std::sin(elevation),
+                            std::cos(elevation) * std::sin(azimuth)));
+                }
+            }
+
+            // post effects between the scene framebuffer and this view
+            PostSettings post = graphics::GetPostSettings();
+            bool post_changed = ImGui::Checkbox("Tonemap", &post.tonemap);
+            if (post.tonemap) {
+                post_changed |= ImGui::SliderFloat("Exposure", &post.exposure, 0.25f, 4.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            }
+            post_changed |= ImGui::Checkbox("Bloom", &post.bloom);
+            if (post.bloom) {
+                post_changed |= ImGui::SliderFloat("Bloom threshold", &post.bloomThreshold, 0.0f, 2.0f, "%.2f");
+                post_changed |= ImGui::SliderFloat("Bloom intensity", &post.bloomIntensity, 0.0f, 2.0f, "%.2f");
+            }
+            post_changed |= ImGui::Checkbox("FXAA", &post.fxaa);
+            ImGui::BeginDisabled(!PostProcess::IsComputeSupported());
+            post_changed |= ImGui::Checkbox("Compute kernels", &post.compute);
+            ImGui::EndDisabled();
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Bloom downsample and blur as compute shaders (GL 4.3+), fragment passes otherwise.");
+                ImGui::EndTooltip();
+            }
+            if (post_changed) {
+                graphics::SetPostSettings(post);
+            }
+
+            // GPU particles, the fountain over the spinning cube
+            int particle_count = graphics::GetParticleCount();
+            if (ImGui::SliderInt("Particles", &particle_count, 0, graphics::MAX_PARTICLES, "%d", ImGuiSliderFlags_Logarithmic)) {
+                graphics::SetParticleCount(particle_count);
+            }
+            bool particle_compute = graphics::IsParticleCompute();
+            ImGui::BeginDisabled(!ParticleSystem::IsComputeSupported());
+            if (ImGui::Checkbox("Compute particles", &particle_compute)) {
+                graphics::SetParticleCompute(particle_compute);
+            }
+            ImGui::EndDisabled();
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Emission, simulation and compaction in compute shaders (GL 4.3+), transform feedback otherwise.");
+                ImGui::EndTooltip();
+            }
+
+            // voxel terrain under the scene
+            bool voxel_world = graphics::IsVoxelWorld();
+            if (ImGui::Checkbox("Voxel world", &voxel_world)) {
+                graphics::SetVoxelWorld(voxel_world);
+            }
+            bool voxel_edits = graphics::IsVoxelEdits();
+            ImGui::BeginDisabled(!voxel_world);
+            if (ImGui::Checkbox("Voxel edits", &voxel_edits)) {
+                graphics::SetVoxelEdits(voxel_edits);
+            }
+            ImGui::EndDisabled();
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Digs a sphere along a circle every frame, the chunks it touches are meshed again.");
+                ImGui::EndTooltip();
+            }
+            bool terrain = graphics::IsTerrain();
+            if (ImGui::Checkbox("Terrain", &terrain)) {
+                graphics::SetTerrain(terrain);
+            }
+
+            bool gpu_driven = graphics::IsGpuDriven();
+            ImGui::BeginDisabled(!graphics::IsGpuDrivenSupported());
+            if (ImGui::Checkbox("GPU-driven rendering", &gpu_driven)) {
+                graphics::SetGpuDriven(gpu_driven);
+            }
+            ImGui::EndDisabled();
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Compute shader culling + a single glMultiDrawElementsIndirect (GL 4.3+).");
+                ImGui::EndTooltip();
+            }
+
+            bool occlusion_culling = graphics::IsOcclusionCulling();
+            if (ImGui::Checkbox("Occlusion culling (Hi-Z)", &occlusion_culling)) {
+                graphics::SetOcclusionCulling(occlusion_culling);
+            }
+            bool occluder_wall = graphics::IsOccluderWall();
+            if (ImGui::Checkbox("Occluder wall", &occluder_wall)) {
+                graphics::SetOccluderWall(occluder_wall);
+            }
+            bool stress_scene = graphics::IsStressScene();
+            if (ImGui::Checkbox("LOD stress scene (rocks)", &stress_scene)) {
+                graphics::SetStressScene(stress_scene);
+            }
+            bool lod_enabled = graphics::IsLODEnabled();
+            if (ImGui::Checkbox("Level of detail", &lod_enabled)) {
+                graphics::SetLODEnabled(lod_enabled);
+            }
+
+            bool pipelined = graphics::IsPipelined();
+            if (ImGui::Checkbox("Pipelined simulation thread", &pipelined)) {
+                graphics::SetPipelined(pipelined);
+            }
+            if (ImGui::BeginItemTooltip()) {
+                ImGui::Text("Simulates frame N+1 on its own thread while frame N is submitted.");
+                ImGui::EndTooltip();
+            }
+            int worker_threads = graphics::GetWorkerThreads();
+            ImGui::Text("Update threads");
+            if (ImGui::SliderInt("##threads", &worker_threads, 1, (int)std::max(1u, std::thread::hardware_concurrency()))) {
+                graphics::SetWorkerThreads(worker_threads);
+            }
+
+            ImGui::Separator();
+            ImGui::Text("Objects: %d", stats.objects);
+            ImGui::Text("Visible: %d", stats.visible);
+            ImGui::Text("Occluded: %d", stats.occluded);
+            ImGui::Text("Draw calls: %d", stats.drawCalls);
+            if (graphics::GetTextureMode() == MaterialTextureMode::Atlas) {
+                ImGui::Text("Texture binds: %d (%d atlas pages for %d textures, %.0f%% occupied)", stats.textureBinds,
+                        graphics::GetTextureArrayCount(), graphics::GetTextureCount(), graphics::GetAtlasOccupancy() * 100.0f);
+            } else {
+                ImGui::Text("Texture binds: %d (%d texture arrays)", stats.textureBinds, graphics::GetTextureArrayCount());
+            }
+            ImGui::Text("Triangles: %d (%d at full detail)", stats.triangles, stats.fullDetailTriangles);
+            if (graphics::GetLighting() != LightingMode::Off) {
+                ImGui::Text("Lights: %d, %d cluster entries, at most %d per fragment, %.1f KB of buffers", stats.lights,
+                        stats.lightIndices, stats.maxClusterLights, stats.lightBufferBytes / 1024.0f);
+            }
+            if (stats.renderPath == RenderPath::Deferred) {
+                ImGui::Text("G-buffer: %d bytes per pixel, %.1f MB", stats.gBufferBytesPerPixel, stats.gBufferBytes / 1048576.0f);
+            }
+            if (stats.shadows) {
+                ImGui::Text("Shadow maps: %d draw calls, %.2f ms GPU, %.1f MB", stats.shadowDrawCalls, stats.shadowGpuMs,
+                        stats.shadowMapBytes / 1048576.0f);
+                if (ImGui::BeginTable("shadow cascades", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Cascade");
+                    ImGui::TableSetupColumn("Up to");
+                    ImGui::TableSetupColumn("Draws");
+                    ImGui::TableSetupColumn("Casters");
+                    ImGui::TableSetupColumn("GPU ms");
+                    ImGui::TableHeadersRow();
+                    for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+                        const graphics::CascadeStats& cascade = stats.cascades[c];
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d%s", c, cascade.cached ? " (cached)" : "");
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.1f", cascade.splitDepth);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", cascade.drawCalls);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%d", cascade.casters);
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f", cascade.gpuMs);
+                    }
+                    ImGui::EndTable();
+                }
+            }
+            if (stats.post.passes > 0) {
+                ImGui::Text("Post: bloom %.3f ms, composite %.3f ms, FXAA %.3f ms GPU", stats.post.bloomMs,
+                        stats.post.compositeMs, stats.post.fxaaMs);
+                ImGui::Text("Post: %d passes%s, %d pooled targets, %.1f MB", stats.post.passes, stats.post.compute ? " (compute bloom)" : "",
+                        stats.post.targets, stats.post.targetBytes / 1048576.0f);
+            }
+            if (stats.particles.capacity > 0) {
+                if (stats.particles.alive >= 0) {
+                    ImGui::Text("Particles: %d of %d alive (compute), %.1f MB", stats.particles.alive, stats.particles.capacity,
+                            stats.particles.bytes / 1048576.0f);
+                } else {
+                    ImGui::Text("Particles: %d slots (transform feedback), %.1f MB", stats.particles.capacity,
+                            stats.particles.bytes / 1048576.0f);
+                }
+                ImGui::Text("Particles: simulate %.3f ms, render %.3f ms GPU", stats.particles.simulateMs, stats.particles.renderMs);
+            }
+            if (stats.voxels.chunks > 0) {
+                ImGui::Text("Voxels: %d of %d chunks visible, %lld quads, %.1f MB meshes, %.1f MB voxels", stats.voxels.visibleChunks,
+                        stats.voxels.chunks, stats.voxels.quads, stats.voxels.meshBytes / 1048576.0f, stats.voxels.voxelBytes / 1048576.0f);
+                ImGui::Text("Voxels: %d dirty, %d pending, %.0f meshes/s on %d threads, %.3f ms per chunk", stats.voxels.dirtyChunks,
+                        stats.voxels.pendingMeshes, stats.voxels.meshesPerSecond, stats.voxels.meshThreads, stats.voxels.meshMs);
+                ImGui::Text("Voxels: built in %.0f ms, %.1f KB uploaded last frame", stats.voxels.buildMs, stats.voxels.uploadedBytes / 1024.0f);
+            }
+            if (stats.terrain.bufferBytes > 0) {
+                ImGui::Text("Terrain: %d tiles drawn down to level %d, %lld triangles", stats.terrain.drawnTiles,
+                        stats.terrain.deepestLevel, stats.terrain.triangles);
+                ImGui::Text("Terrain: %d of %d tiles resident (%.1f MB), %d pending, %lld evicted", stats.terrain.residentTiles,
+                        Terrain::CACHE_TILES, stats.terrain.residentBytes / 1048576.0f, stats.terrain.pendingTiles, stats.terrain.evictedTiles);
+                ImGui::Text("Terrain: %.0f tiles/s, %.2f ms generation, %.1f ms latency (%.1f max)", stats.terrain.tilesPerSecond,
+                        stats.terrain.generateMs, stats.terrain.latencyMs, stats.terrain.maxLatencyMs);
+            }
+            ImGui::Text("BVH nodes: %d", stats.bvhNodes);
+
+            ImGui::Separator();
+            ImGui::Text("Frame phases (%d threads)", stats.threads);
+            ImGui::Text("Transforms: %.3f ms", stats.updateMs);
+            ImGui::Text("Cull + LOD: %.3f ms", stats.cullMs);
+            ImGui::Text("Sort: %.3f ms", stats.sortMs);
+            ImGui::Text("Lights: %.3f ms", stats.lightMs);
+            ImGui::Text("Shadow cascades: %.3f ms", stats.shadowMs);
+            ImGui::Text("Submit: %.3f ms", stats.submitMs);
+            ImGui::Text("Frame: %.2f ms, input latency %.2f ms (%s)", stats.frameMs, stats.latencyMs,
+                    stats.pipelined ? "pipelined" : "single thread");
+            ImGui::Text("Frame by render path: forward %.2f ms, deferred %.2f ms", stats.forwardFrameMs, stats.deferredFrameMs);
+
+            ImGui::Separator();
+            if (stats.pickedObject != -1) {
+                ImGui::Text("Picked object: %d", stats.pickedObject);
+            } else {
+                ImGui::Text("Picked object: none (click in the scene view)");
+            }
+            if (stats.nearestObject != -1) {
+                ImGui::Text("Nearest object: %d (%.2f units)", stats.nearestObject, stats.nearestDistance);
+            }
+
+            ImGui::End();
+        }
+    }
+
+
     // show about window
     if (show_about_window) {
         if (!ImGui::Begin("About", &show_about_window)) {
@@ -261,6 +735,30 @@ void framework::Update(FrameBuffer* sceneBuffer) {
             ImGui::Text("LShift: Increased camera speed (while holding)");
             ImGui::Text("LCtrl: Decreased camera speed (while holding)");
 
+            // camera input recording, replayed with a fixed step so every replay is the same
+            ImGui::SeparatorText("Input recording");
+            InputRecorder& recorder = GlobalInput::recorder;
+            if (recorder.IsRecording()) {
+                ImGui::Text("Recording...");
+                if (ImGui::Button("Stop recording")) {
+                    recorder.StopRecording(DEFAULT_INPUT_RECORDING);
+                }
+            } else if (recorder.IsReplaying()) {
+                ImGui::ProgressBar(recorder.GetReplayProgress(), ImVec2(-1.0f, 0.0f), "Replaying");
+                if (ImGui::Button("Stop replay")) {
+                    recorder.StopReplay();
+                }
+            } else {
+                if (ImGui::Button("Record")) {
+                    recorder.StartRecording(GlobalCamera::camera);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Replay")) {
+                    recorder.StartReplay(DEFAULT_INPUT_RECORDING, GlobalCamera::camera, 1.0f / 60.0f);
+                }
+            }
+            ImGui::TextWrapped("File: %s", DEFAULT_INPUT_RECORDING);
+
             ImGui::EndChild();
 
             ImGui::End();
@@ -283,13 +781,24 @@ void framework::Update(FrameBuffer* sceneBuffer) {
             ImGui::Image(
 
                         //(ImTextureID)sceneBuffer->getFrameTexture(),
-                        static_cast<ImTextureID>(sceneBuffer->getFrameTexture()),
+                        static_cast<ImTextureID>(graphics::GetDisplayTexture(sceneBuffer)),
 
                         ImGui::GetContentRegionAvail(),
                         ImVec2(0,1),
                         ImVec2(1,0)
             );
 
+            // pick the object under the cursor, the image is flipped so the top row is +1 in NDC
+            if (ImGui::IsItemClicked(ImGuiMouseButton_Left)) {
+                ImVec2 image_min = ImGui::GetItemRectMin();
+                ImVec2 image_size = ImGui::GetItemRectSize();
+                ImVec2 mouse = ImGui::GetMousePos();
+
+                float ndc_x = (mouse.x - image_min.x) / image_size.x * 2.0f - 1.0f;
+                float ndc_y = 1.0f - (mouse.y - image_min.y) / image_size.y * 2.0f;
+                graphics::PickObject(ndc_x, ndc_y);
+            }
+
 
             ImGui::EndChild();
             ImGui::End();
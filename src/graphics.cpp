@@ -10,13 +10,46 @@
  */
 
 
+#include "AllocationCounter.h"
+#include "BVH.h"
 #include "Camera.h"
+#include "DeferredRenderer.h"
+#include "FrameArena.h"
+#include "FrameBuffer.h"
+#include "GpuResources.h"
+#include "HiZBuffer.h"
+#include "IndirectRenderer.h"
+#include "LODMesh.h"
+#include "LightClusters.h"
 #include "Logger.h"
+#include "MaterialTextures.h"
+#include "ParticleSystem.h"
+#include "Terrain.h"
+#include "VoxelWorld.h"
+#include "PostProcess.h"
+#include "RenderQueue.h"
+#include "Scene.h"
 #include "Shader.h"
+#include "ShadowCascades.h"
+#include "StreamBuffer.h"
+#include "ThreadPool.h"
+#include "TripleBuffer.h"
 #include "graphics.h"
 
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -24,6 +57,9 @@
 
 #include "TextureLoader.h"
 
+#define STB_PERLIN_IMPLEMENTATION
+#include <stb_perlin.h>
+
 
 namespace graphics {
 
@@ -33,11 +69,412 @@ GLuint VBO;
 GLuint VAO;
 GLuint EBO;
 
-// shaders and textures
+// shaders and textures, the bindless shader only exists when the context supports it
 Shader* cube_shader;
+Shader* bindless_shader = nullptr;
 TextureLoader* testTexture1;
 TextureLoader* testTexture2;
 
+// synthetic materials handed out round robin, material m uses texture m % textureCount;
+// texture 0 is the image of testTexture1, the others are generated checkerboards of
+// MATERIAL_TEXTURE_SIZE, half and a quarter of it in turn, so there are small textures of
+// several sizes to pack
+const char* MATERIAL_TEXTURE_PATH = "resources/textures/test-texture.png";
+const int MATERIAL_TEXTURE_SIZE = 128;
+MaterialTextures* materialTextures = nullptr;
+MaterialTextureMode textureMode = MaterialTextureMode::Array;
+bool textureStreaming = false;
+int materialCount = 1;
+int textureCount = 1;
+
+// dynamic point lights circling above the grid, the CPU path lights with them in LightingMode,
+// the GPU-driven path stays unlit
+const GLuint LIGHTING_BLOCK_BINDING = 3;
+const glm::vec3 AMBIENT_LIGHT(0.15f);
+LightClusters* lightClusters = nullptr;
+LightingMode lightingMode = LightingMode::Off;
+std::vector<PointLight> lightSources;       // the centre of every light's circle
+int lightCount = 0;
+
+// forward draws and lights the queue in one go, deferred goes through a G-buffer (CPU path)
+DeferredRenderer* deferredRenderer = nullptr;
+RenderPath renderPath = RenderPath::Forward;
+
+// directional sun with cascaded shadow maps (CPU path), objects that moved since the layout
+// are dynamic and drawn into the shadow maps every frame, the others are cached
+const glm::vec3 SUN_COLOR(0.85f, 0.8f, 0.7f);
+ShadowCascades* shadowCascades = nullptr;
+bool shadows = false;
+glm::vec3 sunDirection = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f));
+std::vector<unsigned char> dynamicObjects;
+unsigned int staticVersion = 0;
+
+// tonemapping, bloom and FXAA between the scene framebuffer and the view, on both paths;
+// the texture the view shows, 0 until the first frame went through
+PostProcess* postProcess = nullptr;
+PostSettings postSettings;
+GLuint displayTexture = 0;
+
+// GPU particles, stepped by the animation time of the submitted frame and drawn over the scene
+const glm::vec3 PARTICLE_EMITTER(0.0f, 0.6f, 0.0f);
+const float MAX_PARTICLE_STEP = 0.05f;
+ParticleSystem* particles = nullptr;
+int particleCount = 0;
+bool particleCompute = true;
+float particleTime = -1.0f;
+
+// a chunked voxel terrain under the scene, meshed on threads of its own; with edits on a sphere
+// digs along a circle every frame so chunks keep being meshed again
+const float VOXEL_EDIT_RADIUS = 4.0f;
+const float VOXEL_EDIT_PATH_RADIUS = 40.0f;
+const float VOXEL_EDIT_SPEED = 0.3f;
+VoxelWorld* voxelWorld = nullptr;
+bool voxelEdits = false;
+
+// streamed quadtree terrain under everything, its tiles follow the camera
+Terrain* terrain = nullptr;
+
+// negative animates with the wall clock, otherwise the time the caller's simulation is at
+float animationTime = -1.0f;
+
+// scene objects: the spinning cube with a small cube orbiting it, then an optional grid
+// object ids used by the BVH, picking and the GPU path are the scene's dense indices
+enum SceneMesh { MESH_CUBE, MESH_ROCK };
+const AABB CUBE_BOUNDS(glm::vec3(-0.5f), glm::vec3(0.5f));
+const unsigned int CUBE_INDEX_COUNT = 36;
+const std::vector<LODLevel> CUBE_LEVELS = { { 0, CUBE_INDEX_COUNT, 0.0f } };
+Scene scene;
+Entity spinningCube;
+unsigned int sceneLayout = 0;
+BVH sceneBVH;
+SceneStats stats;
+bool occluderWall = false;
+
+// LOD stress scene: every object becomes a dense rock mesh with a generated LOD chain
+const int ROCK_RESOLUTION = 24;
+LODMesh* rockMesh = nullptr;
+std::vector<int> objectLODs;
+bool lodEnabled = true;
+bool stressScene = false;
+
+// CPU path: transforms, culling, LOD selection and sort keys run on the pool,
+// the GL thread only replays the sorted queue
+ThreadPool* pool = nullptr;
+RenderQueue renderQueue;
+std::vector<int> meshLevels;
+
+// optional GPU-driven path, null when the context is older than 4.3
+IndirectRenderer* indirectRenderer = nullptr;
+bool gpuDriven = false;
+
+// per-frame dynamic data (camera and per-draw uniform blocks, GPU object updates)
+// goes through one fenced ring buffer instead of glUniform*/glBufferSubData calls
+const GLsizeiptr STREAM_FRAME_SIZE = 1 << 20;
+const GLuint CAMERA_BLOCK_BINDING = 0;
+const GLuint OBJECTS_BLOCK_BINDING = 1;
+const int OBJECT_BATCH_SIZE = 204;      // ObjectData array length in vertex_shader.vert, 16 KB
+
+// std140 layouts of the Camera and Object blocks in the cube shaders
+struct CameraBlock {
+    glm::mat4 projection;
+    glm::mat4 view;
+};
+
+struct LightingBlock {
+    glm::vec4 clusterScale;
+    glm::ivec4 clusterCounts;
+    glm::ivec4 lightInfo;
+    glm::vec4 ambient;
+    glm::vec4 cameraPosition;
+    glm::mat4 inverseViewProjection;
+    glm::vec4 sunDirection;
+    glm::vec4 sunColor;
+    glm::vec4 cascadeSplits;
+    glm::vec4 cascadeTexels;
+    glm::mat4 cascadeMatrices[ShadowCascades::CASCADES];
+};
+
+struct ObjectData {
+    glm::mat4 model;
+    glm::vec4 material;     // x = texture mix factor, y/z/w = texture layer, bindless handle and texture,
+                            // the specular strength is the fraction of w
+};
+
+// consecutive draw items sharing mesh and LOD level, drawn as one instanced call
+struct DrawBatch {
+    size_t first;
+    int count;
+};
+
+// transient data of the render thread, reset by EndFrame()
+FrameArena renderArena;
+
+StreamBuffer* streamBuffer = nullptr;
+GLsizeiptr uniformAlignment = 256;
+
+// depth pyramid of the previous frame for occlusion culling
+HiZBuffer* hiZ = nullptr;
+bool occlusionCulling = true;
+
+// everything the simulation reads from the render thread for one frame
+struct FrameInput {
+    double sampledAt = 0.0;         // glfwGetTime() when the camera was read, for the latency numbers
+    float time = 0.0f;
+    glm::mat4 projection = glm::mat4(1.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+    float fovY = 0.0f;
+    bool gpuDriven = false;
+    bool lodEnabled = true;
+    bool occlusionCulling = true;
+    bool textureStreaming = false;
+    LightingMode lightingMode = LightingMode::Off;
+    bool shadows = false;
+    glm::vec3 sunDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+    float viewportWidth = 1280.0f;
+    float viewportHeight = 720.0f;
+};
+
+// result of simulating one frame, the render thread only reads it
+struct FrameSnapshot {
+    FrameInput input;
+
+    // CPU path: sorted draw items with their model matrix and material
+    std::vector<DrawItem> items;
+    std::vector<glm::mat4> itemModels;
+    std::vector<Material> itemMaterials;
+    // texture streaming: finest mip level each texture needs, INT_MAX for the unused ones
+    std::vector<int> textureLevels;
+    // CPU path: this frame's light positions and, when clustered, their cluster lists
+    LightGrid lightGrid;
+    // CPU path with shadows: the cascades and their casters
+    ShadowCascade shadowCascades[ShadowCascades::CASCADES];
+
+    // GPU-driven path: objects that moved, or all of them after a layout change
+    bool layoutChanged = false;
+    std::vector<int> changedObjects;
+    std::vector<glm::mat4> changedModels;
+    std::vector<AABB> changedBounds;
+
+    int objects = 0;
+    int occluded = 0;
+    int bvhNodes = 0;
+    int nearestObject = -1;
+    float nearestDistance = 0.0f;
+    float updateMs = 0.0f;
+    float cullMs = 0.0f;
+    float sortMs = 0.0f;
+    float lightMs = 0.0f;
+    float shadowMs = 0.0f;
+    int arenaBytes = 0;
+    int arenaCapacity = 0;
+};
+
+// optional two-stage pipeline: a simulation thread builds frame N+1 while the render
+// thread submits frame N, the triple buffers hand whole frames over without locks; the
+// threads only lock to sleep while the other side is behind, instead of spinning on them
+bool pipelined = false;
+std::thread simulationThread;
+std::atomic<bool> simulationRunning(false);
+std::mutex handoffMutex;
+std::condition_variable handoff;        // a snapshot was published or taken, or the simulation stops
+TripleBuffer<FrameInput> inputBuffer;                       // render thread -> simulation
+TripleBuffer<HiZBuffer::CpuPyramid> occlusionBuffer;        // render thread -> simulation
+TripleBuffer<FrameSnapshot> frameSnapshots;                 // simulation -> render thread
+FrameSnapshot serialFrame;                                  // single-threaded mode reuses this one
+int occlusionVersion = -1;
+glm::mat4 submittedViewProjection(1.0f);
+
+// frame interval and input latency, averaged over a short window
+const double TIMING_WINDOW = 0.5;
+double timingWindowStart = 0.0;
+double timingLatency = 0.0;
+int timingFrames = 0;
+
+// heap allocation totals at the end of the previous frame
+AllocationCount frameAllocationStart;
+
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+glm::mat4 projectionMatrix() {
+    return glm::perspective(glm::radians(GlobalCamera::renderCamera.Zoom), (float)1280/(float)720, 0.1f, 100.0f);
+}
+
+// cube subdivided into resolution^2 quads per face, pushed onto a noisy sphere
+// that still fits inside CUBE_BOUNDS, so culling and picking treat it like a cube
+void buildRockMesh(int resolution, std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices) {
+    const glm::vec3 faces[6][2] = {
+        { glm::vec3( 1, 0, 0), glm::vec3(0, 1, 0) }, { glm::vec3(-1, 0, 0), glm::vec3(0, 0, 1) },
+        { glm::vec3(0,  1, 0), glm::vec3(0, 0, 1) }, { glm::vec3(0, -1, 0), glm::vec3(1, 0, 0) },
+        { glm::vec3(0, 0,  1), glm::vec3(1, 0, 0) }, { glm::vec3(0, 0, -1), glm::vec3(0, 1, 0) }
+    };
+
+    for (const auto& face : faces) {
+        glm::vec3 normal = face[0];
+        glm::vec3 u = face[1];
+        glm::vec3 v = glm::cross(normal, u);
+        unsigned int first = (unsigned int)vertices.size();
+
+        for (int i = 0; i <= resolution; i++) {
+            for (int j = 0; j <= resolution; j++) {
+                // (2i - res) / res keeps shared face edges bit-identical
+                float a = (float)(2 * i - resolution) / resolution;
+                float b = (float)(2 * j - resolution) / resolution;
+                glm::vec3 direction = glm::normalize(normal + a * u + b * v);
+                float noise = stb_perlin_fbm_noise3(direction.x * 2.0f, direction.y * 2.0f, direction.z * 2.0f, 2.0f, 0.5f, 4);
+                float radius = glm::clamp(0.4f + 0.1f * noise, 0.3f, 0.5f);
+                vertices.push_back({ direction * radius, glm::vec2((float)i / resolution, (float)j / resolution) });
+            }
+        }
+
+        for (int i = 0; i < resolution; i++) {
+            for (int j = 0; j < resolution; j++) {
+                unsigned int corner = first + i * (resolution + 1) + j;
+                unsigned int quad[] = { corner, corner + resolution + 1, corner + resolution + 2,
+                                        corner + resolution + 2, corner + 1, corner };
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+    }
+}
+
+Entity addObject(const glm::vec3& position, const glm::vec3& scale = glm::vec3(1.0f), Entity parent = Entity()) {
+    Entity entity = scene.CreateEntity(parent);
+    scene.SetPosition(entity, position);
+    scene.SetScale(entity, scale);
+    scene.SetMesh(entity, stressScene ? MESH_ROCK : MESH_CUBE);
+    scene.SetLocalBounds(entity, CUBE_BOUNDS);
+
+    if (materialCount > 1) {
+        int index = (scene.GetEntityCount() - 1) % materialCount;
+        Material material;
+        material.mixFactor = 0.5f * index / (materialCount - 1);
+        material.texture = index % textureCount;
+        material.specular = 0.75f * index / (materialCount - 1);
+        scene.SetMaterial(entity, material);
+    }
+    return entity;
+}
+
+// checkerboards tinted along the hue circle, one per texture past the first
+void createMaterialTextures(int count) {
+    std::vector<MaterialImage> images(count);
+    for (int t = 0; t < count; t++) {
+        if (t == 0 && MaterialTextures::LoadImageFile(MATERIAL_TEXTURE_PATH, images[0]))
+            continue;
+
+        int size = MATERIAL_TEXTURE_SIZE >> (t % 3);
+        MaterialImage& image = images[t];
+        image.width = image.height = size;
+        image.pixels.resize(size * size * 4);
+        glm::vec3 tint = 0.5f + 0.5f * glm::cos(6.2831853f * ((float)t / count + glm::vec3(0.0f, 0.33f, 0.67f)));
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                float shade = ((x * 8 / size + y * 8 / size) & 1) ? 1.0f : 0.6f;
+                unsigned char* pixel = &image.pixels[(y * size + x) * 4];
+                pixel[0] = (unsigned char)(tint.r * shade * 255.0f);
+                pixel[1] = (unsigned char)(tint.g * shade * 255.0f);
+                pixel[2] = (unsigned char)(tint.b * shade * 255.0f);
+                pixel[3] = 255;
+            }
+        }
+    }
+    materialTextures->Create(images, textureMode, textureStreaming);
+    textureMode = materialTextures->GetMode();
+}
+
+// mip level at which "textureSize" texels cover a cube face of the object about one to one,
+// the face is 1/sqrt(3) of the bounding sphere's diameter
+int requiredMipLevel(int textureSize, float projectedSize, float viewportHeight) {
+    float facePixels = projectedSize * viewportHeight * 0.57735f;
+    if (facePixels <= 0.0f)
+        return INT_MAX;
+    return std::max(0, (int)std::floor(std::log2((float)textureSize / facePixels)));
+}
+
+// lightCount lights scattered over the grid area, each one reaching a few cubes around it
+void generateLights() {
+    float extent = std::max(stats.gridSize * 2.0f, 8.0f);
+    float radius = glm::clamp(extent / std::sqrt((float)std::max(lightCount, 1)) * 1.5f, 2.0f, 8.0f);
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    lightSources.resize(lightCount);
+    for (PointLight& light : lightSources) {
+        light.position = glm::vec3((unit(random) - 0.5f) * extent, -1.0f + unit(random) * 2.5f, (unit(random) - 0.5f) * extent);
+        light.radius = radius;
+        light.color = 0.5f + 0.5f * glm::cos(6.2831853f * (unit(random) + glm::vec3(0.0f, 0.33f, 0.67f)));
+        light.intensity = 1.5f;
+    }
+}
+
+// ties the blocks and samplers of a scene shader to what the frame binds them to,
+// the ones the shader doesn't have are skipped
+void setSceneShaderInputs(Shader* shader) {
+    shader->use();
+    shader->setInt("texture1", 0);
+    shader->setInt("texture2", 1);
+    shader->setUniformBlock("Camera", CAMERA_BLOCK_BINDING);
+    shader->setUniformBlock("Objects", OBJECTS_BLOCK_BINDING);
+    shader->setUniformBlock("TextureRegions", MaterialTextures::REGIONS_BINDING);
+    shader->setUniformBlock("Lighting", LIGHTING_BLOCK_BINDING);
+    shader->setInt("lights", LightClusters::LIGHTS_UNIT);
+    shader->setInt("lightClusters", LightClusters::CLUSTERS_UNIT);
+    shader->setInt("lightIndices", LightClusters::INDICES_UNIT);
+    shader->setInt("shadowMaps", ShadowCascades::SHADOW_UNIT);
+}
+
+// everything indexed by dense scene index is rebuilt whenever the scene layout changes,
+// this is the CPU side that the simulation can run on its own
+void rebuildSceneIndex() {
+    objectLODs.assign(scene.GetEntityCount(), 0);
+    dynamicObjects.assign(scene.GetEntityCount(), 0);
+    staticVersion++;
+    sceneBVH.Build(scene.GetWorldBounds());
+    sceneLayout = scene.GetLayoutVersion();
+}
+
+void syncSceneLayout() {
+    rebuildSceneIndex();
+    if (indirectRenderer) {
+        indirectRenderer->SetObjects(scene.GetWorldMatrices(), scene.GetWorldBounds());
+    }
+    stats.objects = scene.GetEntityCount();
+    stats.bvhNodes = sceneBVH.GetNodeCount();
+    stats.pickedObject = -1;
+}
+
+void rebuildScene(int gridSize) {
+    scene.Clear();
+
+    spinningCube = addObject(glm::vec3(0.0f));
+    addObject(glm::vec3(1.2f, 0.4f, 0.0f), glm::vec3(0.35f), spinningCube);
+
+    // lay the grid out on the XZ plane below the spinning cube
+    float spacing = 2.0f;
+    float offset = (gridSize - 1) * spacing * 0.5f;
+    for (int x = 0; x < gridSize; x++) {
+        for (int z = 0; z < gridSize; z++) {
+            addObject(glm::vec3(x * spacing - offset, -1.5f, z * spacing - offset));
+        }
+    }
+
+    // a stretched cube standing across the grid, everything behind it is occluded
+    if (occluderWall) {
+        float width = std::max(gridSize * spacing, 4.0f);
+        addObject(glm::vec3(0.0f, -0.25f, -1.5f), glm::vec3(width, 3.5f, 0.5f));
+    }
+
+    scene.UpdateTransforms();
+    syncSceneLayout();
+    stats.gridSize = gridSize;
+    generateLights();
+}
+
 
 void Prerender() {
 
@@ -48,59 +485,64 @@ void Prerender() {
 
 
     // TEMP - FOR CUBE DEMONSTRATION
+    // four corners per face so every face keeps its own texture coordinates
     float vertices[] = {
         -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
          0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
          0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
         -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
 
         -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
          0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
          0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
         -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
 
         -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
         -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
         -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
         -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
 
          0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
          0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
          0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-         0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
          0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
 
         -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
          0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
          0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
         -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
 
         -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
          0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
          0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-         0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-        -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        -0.5f,  0.5f,  0.5f,  0.0f, 0.0f
     };
 
+    // two triangles per face
+    unsigned int indices[36];
+    for (unsigned int face = 0; face < 6; face++) {
+        unsigned int corner = face * 4;
+        unsigned int quad[] = { corner, corner + 1, corner + 2, corner + 2, corner + 3, corner };
+        for (int i = 0; i < 6; i++) {
+            indices[face * 6 + i] = quad[i];
+        }
+    }
+
     // INITIALIZE VBO: DECLARED AT HIGHER SCOPE
-    glGenBuffers(1, &VBO);
+    VBO = resources::CreateBuffer("graphics", "cube vertices");
+    resources::SetSize(resources::ResourceType::Buffer, VBO, sizeof(vertices));
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     // INITIALIZE VAO: DECLARED AT HIGHER SCOPE
-    glGenVertexArrays(1, &VAO);
+    VAO = resources::CreateVertexArray("graphics", "cube");
     glBindVertexArray(VAO);
+
+    // INITIALIZE EBO: DECLARED AT HIGHER SCOPE, recorded in the VAO
+    EBO = resources::CreateBuffer("graphics", "cube indices");
+    resources::SetSize(resources::ResourceType::Buffer, EBO, sizeof(indices));
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
     // UNCOMMENT FOR WIREFRAME MODE
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
@@ -118,12 +560,58 @@ void Prerender() {
     testTexture1 = new TextureLoader("resources/textures/test-texture.png");
     testTexture2 = new TextureLoader("resources/textures/test-texture-underline.png");
 
-    // activate shader
-    cube_shader->use();
+    // texture units and uniform block bindings
+    setSceneShaderInputs(cube_shader);
 
-    // set uniforms for mix factor
-    cube_shader->setInt("texture1", 0);
-    cube_shader->setInt("texture2", 1);
+    // same vertex shader, the material textures come from resident handles
+    if (MaterialTextures::IsBindlessSupported()) {
+        bindless_shader = new Shader("src/shaders/vertex_shader.vert", "src/shaders/fragment_bindless.frag");
+        setSceneShaderInputs(bindless_shader);
+        Global::logger.log(INFO, "ARB_bindless_texture available for material textures.");
+    }
+
+    // the deferred path draws the same queue into its G-buffer, then lights it in one pass
+    deferredRenderer = new DeferredRenderer();
+    setSceneShaderInputs(deferredRenderer->GetGeometryShader(false));
+    if (deferredRenderer->GetGeometryShader(true))
+        setSceneShaderInputs(deferredRenderer->GetGeometryShader(true));
+    setSceneShaderInputs(deferredRenderer->GetLightingShader());
+
+    shadowCascades = new ShadowCascades();
+    setSceneShaderInputs(shadowCascades->GetDepthShader());
+
+    streamBuffer = new StreamBuffer(STREAM_FRAME_SIZE);
+    uniformAlignment = StreamBuffer::UniformAlignment();
+    Global::logger.log(INFO, streamBuffer->IsPersistent()
+            ? "Stream buffer is persistently mapped (GL 4.4)."
+            : "Stream buffer uses unsynchronized glMapBufferRange (GL < 4.4).");
+
+    // the GPU-driven path shares the cube buffers, it needs GL 4.3+
+    if (IndirectRenderer::IsSupported()) {
+        indirectRenderer = new IndirectRenderer(VBO, EBO, CUBE_LEVELS);
+    } else {
+        Global::logger.log(WARNING, "GL 4.3 not available, GPU-driven rendering disabled.");
+    }
+
+    hiZ = new HiZBuffer();
+    postProcess = new PostProcess();
+    particles = new ParticleSystem();
+
+    // "import" the stress scene mesh, its LOD chain is generated here
+    std::vector<MeshVertex> rockVertices;
+    std::vector<unsigned int> rockIndices;
+    buildRockMesh(ROCK_RESOLUTION, rockVertices, rockIndices);
+    rockMesh = new LODMesh(rockVertices, rockIndices);
+    meshLevels = { 1, (int)rockMesh->GetLevels().size() };
+
+    pool = new ThreadPool();
+    stats.threads = pool->GetThreadCount();
+    Global::logger.log(INFO, "Scene update runs on " + std::to_string(stats.threads) + " threads.");
+
+    materialTextures = new MaterialTextures();
+    createMaterialTextures(textureCount);
+    lightClusters = new LightClusters();
+    rebuildScene(0);
 
 
 
@@ -131,9 +619,623 @@ void Prerender() {
 }
 
 
-void Render() {
+FrameInput sampleInput() {
+    FrameInput input;
+    input.sampledAt = glfwGetTime();
+    input.time = animationTime >= 0.0f ? animationTime : (float)input.sampledAt;
+    input.projection = projectionMatrix();
+    input.view = GlobalCamera::renderCamera.GetViewMatrix();
+    input.cameraPosition = GlobalCamera::renderCamera.Position;
+    input.cameraFront = GlobalCamera::renderCamera.Front;
+    input.fovY = glm::radians(GlobalCamera::renderCamera.Zoom);
+    input.gpuDriven = gpuDriven;
+    input.lodEnabled = lodEnabled;
+    input.occlusionCulling = occlusionCulling;
+    input.textureStreaming = materialTextures->GetStreamer() != nullptr;
+
+    // the scene framebuffer is bound by now
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    input.viewportWidth = (float)std::max(1, viewport[2]);
+    input.viewportHeight = (float)std::max(1, viewport[3]);
+    input.lightingMode = lightingMode;
+    input.shadows = shadows;
+    input.sunDirection = sunDirection;
+    return input;
+}
+
+// CPU half of a frame: animation, transforms, BVH refit, culling, LOD and sorting.
+// Touches no GL and no global stats, so it can run on the simulation thread.
+void simulate(const FrameInput& input, const std::function<bool(const AABB&)>& occluded, FrameSnapshot& frame) {
+    frame.input = input;
+
+    // spin the first cube, its child follows through the hierarchy and only their
+    // world matrices are recomputed and refit in the BVH
+    auto phaseStart = std::chrono::steady_clock::now();
+    scene.SetRotation(spinningCube, glm::angleAxis(glm::radians(input.time*50), glm::vec3(0.0f, 1.0f, 0.0f)));
+    scene.UpdateTransforms(pool);
+
+    const std::vector<glm::mat4>& models = scene.GetWorldMatrices();
+    const std::vector<AABB>& bounds = scene.GetWorldBounds();
+    frame.changedObjects.clear();
+    frame.changedModels.clear();
+    frame.changedBounds.clear();
+    frame.layoutChanged = scene.GetLayoutVersion() != sceneLayout;
+    if (frame.layoutChanged) {
+        rebuildSceneIndex();
+        frame.changedModels = models;
+        frame.changedBounds = bounds;
+    } else {
+        for (int id : scene.GetChangedObjects()) {
+            // the first move takes the object out of the cached shadows for good
+            if (!dynamicObjects[id]) {
+                dynamicObjects[id] = 1;
+                staticVersion++;
+            }
+            sceneBVH.UpdateObject(id, bounds[id]);
+            frame.changedObjects.push_back(id);
+            frame.changedModels.push_back(models[id]);
+            frame.changedBounds.push_back(bounds[id]);
+        }
+        sceneBVH.Refit();
+    }
+    frame.updateMs = (float)millisecondsSince(phaseStart);
+
+    frame.objects = scene.GetEntityCount();
+    frame.bvhNodes = sceneBVH.GetNodeCount();
+    frame.nearestObject = sceneBVH.Nearest(input.cameraPosition, frame.nearestDistance);
+
+    frame.items.clear();
+    frame.itemModels.clear();
+    frame.itemMaterials.clear();
+    frame.textureLevels.assign(input.textureStreaming ? materialTextures->GetTextureCount() : 0, INT_MAX);
+    frame.occluded = 0;
+    frame.arenaBytes = 0;
+    frame.arenaCapacity = (int)renderQueue.GetArenaCapacity();
+
+    // GPU-driven: culling and LOD selection happen in cull.comp
+    if (input.gpuDriven)
+        return;
+
+    // parallel phase: hierarchical frustum culling, occlusion against last frame's depth,
+    // LOD selection and sort keys, one subtree of the BVH per task
+    CullInput cull;
+    cull.bvh = &sceneBVH;
+    cull.bounds = &bounds;
+    cull.meshes = &scene.GetMeshes();
+    cull.materials = &scene.GetMaterials();
+    cull.textureGroups = &materialTextures->GetGroups();
+    cull.meshLevels = &meshLevels;
+    cull.objectLODs = &objectLODs;
+    cull.frustum = Frustum(input.projection * input.view);
+    cull.cameraPosition = input.cameraPosition;
+    cull.cameraForward = input.cameraFront;
+    cull.fovY = input.fovY;
+    cull.lodEnabled = input.lodEnabled;
+    if (input.occlusionCulling)
+        cull.occluded = occluded;
+
+    phaseStart = std::chrono::steady_clock::now();
+    renderQueue.Build(cull, *pool);
+    frame.cullMs = (float)millisecondsSince(phaseStart);
+
+    phaseStart = std::chrono::steady_clock::now();
+    renderQueue.Sort();
+
+    // copy out what submission reads, the scene keeps moving while the frame is drawn
+    const std::vector<Material>& materials = scene.GetMaterials();
+    for (const DrawItem& item : renderQueue.GetItems()) {
+        frame.items.push_back(item);
+        frame.itemModels.push_back(models[item.object]);
+        frame.itemMaterials.push_back(materials[item.object]);
+    }
+    if (input.textureStreaming) {
+        for (const DrawItem& item : renderQueue.GetItems()) {
+            int texture = materials[item.object].texture;
+            if (texture < 0 || texture >= (int)frame.textureLevels.size())
+                continue;
+            float projectedSize = ProjectedSize(bounds[item.object], input.cameraPosition, input.fovY);
+            int level = requiredMipLevel(materialTextures->GetTextureSize(texture), projectedSize, input.viewportHeight);
+            frame.textureLevels[texture] = std::min(frame.textureLevels[texture], level);
+        }
+    }
+    frame.occluded = renderQueue.GetOccludedCount();
+    frame.sortMs = (float)millisecondsSince(phaseStart);
+    frame.arenaBytes = (int)renderQueue.GetArenaBytes();
+    frame.arenaCapacity = (int)renderQueue.GetArenaCapacity();
+
+    // sun shadows: fit the cascades around the view and cull their casters
+    frame.shadowMs = 0.0f;
+    if (input.shadows) {
+        phaseStart = std::chrono::steady_clock::now();
+        ShadowInput shadowInput;
+        shadowInput.bvh = &sceneBVH;
+        shadowInput.models = &models;
+        shadowInput.meshes = &scene.GetMeshes();
+        shadowInput.meshLevels = &meshLevels;
+        shadowInput.dynamic = &dynamicObjects;
+        shadowInput.staticVersion = staticVersion;
+        shadowInput.view = input.view;
+        shadowInput.projection = input.projection;
+        shadowInput.lightDirection = input.sunDirection;
+        shadowCascades->Build(shadowInput, *pool, frame.shadowCascades);
+        frame.shadowMs = (float)millisecondsSince(phaseStart);
+    }
+
+    // every light runs around its own circle, a golden angle out of phase with the previous one
+    frame.lightMs = 0.0f;
+    if (input.lightingMode == LightingMode::Off)
+        return;
+    phaseStart = std::chrono::steady_clock::now();
+    frame.lightGrid.lights.resize(lightSources.size());
+    for (size_t i = 0; i < lightSources.size(); i++) {
+        float angle = input.time * 0.7f + i * 2.39996f;
+        frame.lightGrid.lights[i] = lightSources[i];
+        frame.lightGrid.lights[i].position += glm::vec3(std::cos(angle), 0.25f * std::sin(angle * 2.0f), std::sin(angle));
+    }
+    frame.lightGrid.clusters.clear();
+    frame.lightGrid.indices.clear();
+    if (input.lightingMode == LightingMode::Clustered) {
+        lightClusters->Build(input.view, input.projection, input.viewportWidth, input.viewportHeight, *pool, frame.lightGrid);
+    }
+    frame.lightMs = (float)millisecondsSince(phaseStart);
+}
+
+// keeps the GPU-driven path's object buffers in step with the scene, on both paths
+void uploadObjectUpdates(const FrameSnapshot& frame) {
+    if (frame.layoutChanged)
+        stats.pickedObject = -1;
+    if (!indirectRenderer)
+        return;
+
+    if (frame.layoutChanged) {
+        indirectRenderer->SetObjects(frame.changedModels, frame.changedBounds);
+        return;
+    }
+    indirectRenderer->UpdateObjects(frame.changedObjects, frame.changedModels, frame.changedBounds, *streamBuffer);
+}
+
+GLsizeiptr alignedSize(GLsizeiptr size) {
+    return (size + uniformAlignment - 1) / uniformAlignment * uniformAlignment;
+}
+
+// hands the frame's mip levels to the streamer and lets it upload and evict
+void streamMaterialTextures(const FrameSnapshot& frame) {
+    TextureStreamer* streamer = materialTextures->GetStreamer();
+    stats.textureStreaming = streamer != nullptr;
+    if (!streamer)
+        return;
+
+    for (int texture = 0; texture < (int)frame.textureLevels.size(); texture++) {
+        if (frame.textureLevels[texture] != INT_MAX)
+            materialTextures->RequestLevel(texture, frame.textureLevels[texture]);
+    }
+    streamer->Update();
+
+    stats.textureBudget = streamer->GetBudget();
+    stats.textureResidentBytes = streamer->GetResidentBytes();
+    stats.textureFullBytes = streamer->GetFullBytes();
+    stats.textureLoads = streamer->GetPendingLoads();
+    stats.textureEvictions = streamer->GetEvictionsPerSecond();
+    stats.textureBandwidth = (float)streamer->GetBandwidth();
+}
+
+void updateStreamStats() {
+    stats.streamBytes = (int)streamBuffer->GetBytesLastFrame();
+    stats.streamFrameSize = (int)streamBuffer->GetFrameSize();
+    stats.streamPersistent = streamBuffer->IsPersistent();
+    stats.fenceWaitMs = (float)streamBuffer->GetFenceWaitMs();
+}
+
+// instanced draws a list of shadow casters takes, runs of one mesh and level cut at OBJECT_BATCH_SIZE
+int shadowBatchCount(const std::vector<ShadowCaster>& casters) {
+    int batches = 0;
+    int run = 0;
+    for (size_t i = 0; i < casters.size(); i++) {
+        if (i == 0 || run == OBJECT_BATCH_SIZE || casters[i].mesh != casters[i - 1].mesh || casters[i].level != casters[i - 1].level) {
+            batches++;
+            run = 0;
+        }
+        run++;
+    }
+    return batches;
+}
+
+// what the shadow pass of a frame streams, camera blocks included
+GLsizeiptr shadowStreamSize(const FrameSnapshot& frame) {
+    if (!frame.input.shadows)
+        return 0;
+    GLsizeiptr bytes = 0;
+    for (const ShadowCascade& cascade : frame.shadowCascades) {
+        int batches = shadowBatchCount(cascade.staticCasters) + shadowBatchCount(cascade.dynamicCasters);
+        bytes += 2 * alignedSize(sizeof(CameraBlock)) + batches * alignedSize(OBJECT_BATCH_SIZE * sizeof(ObjectData));
+    }
+    return bytes;
+}
+
+// ShadowCascades::DrawCasters, the depth shader is bound; streams like the main pass but
+// without materials
+int drawShadowCasters(const std::vector<ShadowCaster>& casters, const glm::mat4& view, const glm::mat4& projection) {
+    if (casters.empty())
+        return 0;
+
+    GLintptr cameraOffset;
+    CameraBlock* camera = (CameraBlock*)streamBuffer->Allocate(sizeof(CameraBlock), uniformAlignment, cameraOffset);
+    camera->projection = projection;
+    camera->view = view;
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, streamBuffer->GetBuffer(), cameraOffset, sizeof(CameraBlock));
+
+    int drawCalls = 0;
+    size_t first = 0;
+    while (first < casters.size()) {
+        const ShadowCaster& caster = casters[first];
+        int count = 1;
+        while (count < OBJECT_BATCH_SIZE && first + count < casters.size()
+                && casters[first + count].mesh == caster.mesh && casters[first + count].level == caster.level) {
+            count++;
+        }
+
+        GLintptr offset;
+        GLsizeiptr blockSize = OBJECT_BATCH_SIZE * sizeof(ObjectData);
+        ObjectData* objects = (ObjectData*)streamBuffer->Allocate(blockSize, uniformAlignment, offset);
+        for (int i = 0; i < count; i++) {
+            objects[i].model = casters[first + i].model;
+            objects[i].material = glm::vec4(0.0f);
+        }
+        streamBuffer->Flush();
+        glBindBufferRange(GL_UNIFORM_BUFFER, OBJECTS_BLOCK_BINDING, streamBuffer->GetBuffer(), offset, blockSize);
+
+        if (caster.mesh == MESH_ROCK) {
+            glBindVertexArray(rockMesh->GetVAO());
+            rockMesh->Draw(caster.level, count);
+        } else {
+            glBindVertexArray(VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, CUBE_INDEX_COUNT, GL_UNSIGNED_INT, 0, count);
+        }
+        drawCalls++;
+        first += count;
+    }
+    glBindVertexArray(0);
+    return drawCalls;
+}
+
+// uploads generated tiles through the stream buffer, picks and requests tiles around the camera
+// and draws them
+void drawTerrain(const FrameInput& input) {
+    if (!terrain)
+        return;
+
+    glm::mat4 viewProjection = input.projection * input.view;
+    terrain->Update(*streamBuffer, input.cameraPosition, viewProjection);
+    terrain->Draw(viewProjection);
+    stats.terrain = terrain->GetStats();
+}
+
+// digs if edits are on, uploads finished chunk meshes through the stream buffer, queues dirty
+// chunks and draws the visible ones
+void drawVoxels(const FrameInput& input) {
+    if (!voxelWorld)
+        return;
+
+    if (voxelEdits) {
+        // the center digs into the surface under a point moving round the circle
+        float angle = input.time * VOXEL_EDIT_SPEED;
+        glm::vec3 center(std::cos(angle) * VOXEL_EDIT_PATH_RADIUS, 0.0f, std::sin(angle) * VOXEL_EDIT_PATH_RADIUS);
+        AABB bounds = voxelWorld->GetBounds();
+        center.y = bounds.min.y;
+        for (float y = bounds.max.y - 0.5f; y > bounds.min.y; y -= 1.0f) {
+            if (voxelWorld->GetVoxel(glm::vec3(center.x, y, center.z)) != VoxelWorld::AIR) {
+                center.y = y;
+                break;
+            }
+        }
+        voxelWorld->SetSphere(center, VOXEL_EDIT_RADIUS, VoxelWorld::AIR);
+    }
+
+    voxelWorld->Update(*streamBuffer, input.cameraPosition);
+    voxelWorld->Draw(input.projection * input.view);
+    stats.voxels = voxelWorld->GetStats();
+}
+
+// emits and moves the particles by the time since the last frame, then draws them over the
+// finished scene
+void drawParticles(const FrameInput& input) {
+    float seconds = particleTime < 0.0f ? 0.0f : glm::clamp(input.time - particleTime, 0.0f, MAX_PARTICLE_STEP);
+    particleTime = input.time;
+    particles->Update(seconds, PARTICLE_EMITTER);
+    particles->Draw(input.view, input.projection);
+    stats.particles = particles->GetStats();
+}
+
+// GL half of a frame, always on the render thread
+void submit(const FrameSnapshot& frame) {
+    const FrameInput& input = frame.input;
+    submittedViewProjection = input.projection * input.view;
+
+    stats.objects = frame.objects;
+    stats.bvhNodes = frame.bvhNodes;
+    stats.nearestObject = frame.nearestObject;
+    stats.nearestDistance = frame.nearestDistance;
+    stats.updateMs = frame.updateMs;
+    stats.arenaBytes = frame.arenaBytes;
+    stats.arenaCapacity = frame.arenaCapacity;
+
+    // the sorted queue falls apart into runs of the same mesh, texture group and level, each run
+    // becomes instanced draws of at most OBJECT_BATCH_SIZE objects
+    std::pmr::vector<DrawBatch> drawBatches(&renderArena);
+    for (size_t i = 0; i < frame.items.size(); i++) {
+        const DrawItem& item = frame.items[i];
+        if (drawBatches.empty() || drawBatches.back().count == OBJECT_BATCH_SIZE
+                || item.mesh != frame.items[drawBatches.back().first].mesh
+                || item.texture != frame.items[drawBatches.back().first].texture
+                || item.level != frame.items[drawBatches.back().first].level) {
+            drawBatches.push_back({ i, 0 });
+        }
+        drawBatches.back().count++;
+    }
+
+    // everything this frame streams, sized up front so the partition never overflows
+    GLsizeiptr expectedBytes = IndirectRenderer::UploadSize((int)frame.changedObjects.size()) + uniformAlignment
+            + alignedSize(sizeof(CameraBlock)) + alignedSize(sizeof(LightingBlock)) + drawBatches.size() * alignedSize(OBJECT_BATCH_SIZE * sizeof(ObjectData))
+            + shadowStreamSize(frame) + (voxelWorld ? voxelWorld->GetUploadSize() : 0)
+            + (terrain ? terrain->GetUploadSize() : 0);
+    streamBuffer->BeginFrame(expectedBytes);
+
+    uploadObjectUpdates(frame);
+    streamMaterialTextures(frame);
+
+    // GPU-driven: culling and draw submission happen on the GPU, one draw call total
+    // (every object shares the renderer's mesh)
+    if (input.gpuDriven && indirectRenderer) {
+        indirectRenderer->Draw(input.projection, input.view, stats.pickedObject, input.occlusionCulling ? hiZ : nullptr);
+        stats.visible = indirectRenderer->GetVisibleCount();
+        stats.occluded = indirectRenderer->GetOccludedCount();
+        stats.triangles = indirectRenderer->GetTriangleCount();
+        stats.fullDetailTriangles = stats.visible * (stressScene ? rockMesh->GetTriangleCount(0) : CUBE_INDEX_COUNT / 3);
+        stats.drawCalls = 1;
+        stats.textureBinds = 0;
+        stats.lightMs = 0.0f;
+        stats.renderPath = RenderPath::Forward;
+        stats.gBufferBytesPerPixel = 0;
+        stats.gBufferBytes = 0;
+        stats.shadows = false;
+        drawTerrain(input);
+        drawVoxels(input);
+        drawParticles(input);
+
+        streamBuffer->EndFrame();
+        updateStreamStats();
+        return;
+    }
+
+    stats.cullMs = frame.cullMs;
+    stats.sortMs = frame.sortMs;
+    stats.occluded = frame.occluded;
+    stats.visible = (int)frame.items.size();
+
+    // the shadow maps go first, the depth shader shares the vertex shader and its blocks
+    materialTextures->BindRegions();
+    auto phaseStart = std::chrono::steady_clock::now();
+    stats.shadows = input.shadows;
+    stats.shadowMs = frame.shadowMs;
+    stats.shadowDrawCalls = 0;
+    stats.shadowGpuMs = 0.0f;
+    if (input.shadows) {
+        shadowCascades->Render(frame.shadowCascades, drawShadowCasters);
+        shadowCascades->Bind();
+        for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+            const ShadowCascades::CascadeStats& cascadeStats = shadowCascades->GetStats(c);
+            stats.cascades[c].drawCalls = cascadeStats.drawCalls;
+            stats.cascades[c].casters = cascadeStats.casters;
+            stats.cascades[c].cached = cascadeStats.cached;
+            stats.cascades[c].gpuMs = cascadeStats.gpuMs;
+            stats.cascades[c].splitDepth = frame.shadowCascades[c].splitDepth;
+            stats.shadowDrawCalls += cascadeStats.drawCalls;
+            stats.shadowGpuMs += cascadeStats.gpuMs;
+        }
+    }
+    stats.shadowMapBytes = (long long)shadowCascades->GetGpuBytes();
+
+    // activate shader, the deferred path draws into its G-buffer until Resolve()
+    bool bindless = materialTextures->GetMode() == MaterialTextureMode::Bindless && bindless_shader;
+    bool deferred = renderPath == RenderPath::Deferred;
+    Shader* shader = bindless ? bindless_shader : cube_shader;
+    if (deferred) {
+        shader = deferredRenderer->GetGeometryShader(bindless);
+        deferredRenderer->BeginGeometry();
+    }
+    shader->use();
+
+    // the camera block is shared by every draw of the frame
+    GLintptr cameraOffset;
+    CameraBlock* camera = (CameraBlock*)streamBuffer->Allocate(sizeof(CameraBlock), uniformAlignment, cameraOffset);
+    camera->projection = input.projection;
+    camera->view = input.view;
+    glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, streamBuffer->GetBuffer(), cameraOffset, sizeof(CameraBlock));
+
+    // the lights of the frame go up whole, the fragment shaders read them from texture buffers
+    const LightGrid& lightGrid = frame.lightGrid;
+    GLintptr lightingOffset;
+    LightingBlock* lighting = (LightingBlock*)streamBuffer->Allocate(sizeof(LightingBlock), uniformAlignment, lightingOffset);
+    lighting->clusterScale = lightGrid.clusterScale;
+    lighting->clusterCounts = glm::ivec4(LightClusters::CLUSTERS_X, LightClusters::CLUSTERS_Y, LightClusters::CLUSTERS_Z, 0);
+    lighting->lightInfo = glm::ivec4((int)input.lightingMode, (int)lightGrid.lights.size(), input.shadows ? 1 : 0, 0);
+    lighting->ambient = glm::vec4(AMBIENT_LIGHT, 1.0f);
+    lighting->cameraPosition = glm::vec4(input.cameraPosition, 1.0f);
+    lighting->inverseViewProjection = glm::inverse(submittedViewProjection);
+    lighting->sunDirection = glm::vec4(input.sunDirection, 0.0f);
+    lighting->sunColor = glm::vec4(SUN_COLOR, 1.0f);
+    for (int c = 0; c < ShadowCascades::CASCADES; c++) {
+        const ShadowCascade& cascade = frame.shadowCascades[c];
+        lighting->cascadeSplits[c] = cascade.splitDepth;
+        lighting->cascadeTexels[c] = cascade.texelSize;
+        lighting->cascadeMatrices[c] = cascade.projection * cascade.view;
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTING_BLOCK_BINDING, streamBuffer->GetBuffer(), lightingOffset, sizeof(LightingBlock));
+    stats.lights = lightCount;
+    stats.lightMs = frame.lightMs;
+    stats.lightIndices = 0;
+    stats.maxClusterLights = 0;
+    if (input.lightingMode != LightingMode::Off) {
+        lightClusters->Upload(lightGrid);
+        lightClusters->Bind();
+        stats.lightIndices = (int)lightGrid.indices.size();
+        stats.maxClusterLights = input.lightingMode == LightingMode::Clustered ? lightGrid.maxClusterLights : (int)lightGrid.lights.size();
+    }
+    stats.lightBufferBytes = (int)lightClusters->GetGpuBytes();
+
+    // replay the queue, it is sorted by mesh and texture group so the VAO changes once per
+    // mesh and the textures once per group within a mesh
+    int boundMesh = -1;
+    int boundGroup = -1;
+
+    stats.triangles = 0;
+    stats.textureBinds = 0;
+    stats.fullDetailTriangles = 0;
+    stats.drawCalls = (int)drawBatches.size();
+    for (const DrawBatch& batch : drawBatches) {
+        const DrawItem& first = frame.items[batch.first];
+
+        // the whole array is bound even for short batches, the block size is fixed
+        GLintptr offset;
+        GLsizeiptr blockSize = OBJECT_BATCH_SIZE * sizeof(ObjectData);
+        ObjectData* objects = (ObjectData*)streamBuffer->Allocate(blockSize, uniformAlignment, offset);
+        for (int i = 0; i < batch.count; i++) {
+            size_t index = batch.first + i;
+            objects[i].model = frame.itemModels[index];
+            // picked object shows the underlined texture
+            const Material& material = frame.itemMaterials[index];
+            float mixFactor = frame.items[index].object == stats.pickedObject ? 1.0f : material.mixFactor;
+            objects[i].material = glm::vec4(mixFactor, (float)materialTextures->GetLayer(material.texture),
+                    (float)materialTextures->GetHandle(material.texture), material.texture + std::min(material.specular, 0.99f));
+        }
+        streamBuffer->Flush();
+        glBindBufferRange(GL_UNIFORM_BUFFER, OBJECTS_BLOCK_BINDING, streamBuffer->GetBuffer(), offset, blockSize);
+
+        if (first.texture != boundGroup) {
+            boundGroup = first.texture;
+            materialTextures->Bind(boundGroup, 0);
+            stats.textureBinds++;
+        }
+
+        // bind vertex array
+        if (first.mesh != boundMesh) {
+            boundMesh = first.mesh;
+            glBindVertexArray(boundMesh == MESH_ROCK ? rockMesh->GetVAO() : VAO);
+        }
+
+        if (boundMesh == MESH_ROCK) {
+            rockMesh->Draw(first.level, batch.count);
+            stats.triangles += rockMesh->GetTriangleCount(first.level) * batch.count;
+            stats.fullDetailTriangles += rockMesh->GetTriangleCount(0) * batch.count;
+            continue;
+        }
+
+        // draw with indicies
+        glDrawElementsInstanced(GL_TRIANGLES, CUBE_INDEX_COUNT, GL_UNSIGNED_INT, 0, batch.count);
+        stats.triangles += CUBE_INDEX_COUNT / 3 * batch.count;
+        stats.fullDetailTriangles += CUBE_INDEX_COUNT / 3 * batch.count;
+    }
+
+    // end bind vertex array
+    glBindVertexArray(0);
+    if (deferred)
+        deferredRenderer->Resolve();
+    drawTerrain(input);
+    drawVoxels(input);
+    drawParticles(input);
+    stats.renderPath = renderPath;
+    stats.gBufferBytesPerPixel = deferred ? deferredRenderer->GetBytesPerPixel() : 0;
+    stats.gBufferBytes = deferred ? (long long)deferredRenderer->GetBytes() : 0;
+    stats.submitMs = (float)millisecondsSince(phaseStart);
+
+    streamBuffer->EndFrame();
+    updateStreamStats();
+}
+
+void simulationLoop() {
+    while (true) {
+        // stay one frame ahead at most, the render thread must take the last one first
+        {
+            std::unique_lock<std::mutex> lock(handoffMutex);
+            handoff.wait(lock, [] { return !frameSnapshots.HasFresh() || !simulationRunning.load(); });
+        }
+        if (!simulationRunning.load())
+            return;
+
+        inputBuffer.Acquire();
+        occlusionBuffer.Acquire();
+        const HiZBuffer::CpuPyramid& pyramid = occlusionBuffer.GetReadBuffer();
+        auto occluded = [&pyramid](const AABB& box) { return pyramid.IsOccluded(box); };
+
+        simulate(inputBuffer.GetReadBuffer(), occluded, frameSnapshots.GetWriteBuffer());
+        {
+            std::lock_guard<std::mutex> lock(handoffMutex);
+            frameSnapshots.Publish();
+        }
+        handoff.notify_all();
+    }
+}
+
+void startSimulation() {
+    inputBuffer.GetWriteBuffer() = sampleInput();
+    inputBuffer.Publish();
+    occlusionVersion = -1;
+
+    simulationRunning = true;
+    simulationThread = std::thread(simulationLoop);
+}
 
-    float timeValue = glfwGetTime();
+void stopSimulation() {
+    {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        simulationRunning = false;
+    }
+    handoff.notify_all();
+    simulationThread.join();
+    // Build() may have taken a static cache as drawn for a frame that never will be
+    shadowCascades->Invalidate();
+
+    // a frame that was simulated but never drawn still carries object updates for the GPU path
+    if (frameSnapshots.Acquire()) {
+        const FrameSnapshot& frame = frameSnapshots.GetReadBuffer();
+        streamBuffer->BeginFrame(IndirectRenderer::UploadSize((int)frame.changedObjects.size()) + uniformAlignment);
+        uploadObjectUpdates(frame);
+        streamBuffer->EndFrame();
+    }
+}
+
+// scene edits from the UI stop the simulation thread while they run
+struct SimulationPause {
+    bool resume;
+
+    SimulationPause() : resume(pipelined) {
+        if (resume)
+            stopSimulation();
+    }
+    ~SimulationPause() {
+        if (resume)
+            startSimulation();
+    }
+};
+
+void updateFrameTiming(const FrameSnapshot& frame) {
+    double now = glfwGetTime();
+    timingLatency += now - frame.input.sampledAt;
+    timingFrames++;
+
+    if (now - timingWindowStart >= TIMING_WINDOW) {
+        stats.frameMs = (float)((now - timingWindowStart) * 1000.0 / timingFrames);
+        stats.latencyMs = (float)(timingLatency * 1000.0 / timingFrames);
+        (stats.renderPath == RenderPath::Deferred ? stats.deferredFrameMs : stats.forwardFrameMs) = stats.frameMs;
+        timingWindowStart = now;
+        timingLatency = 0.0;
+        timingFrames = 0;
+    }
+}
+
+
+void Render() {
 
     // bind textures to appropriate texture units
     glActiveTexture(GL_TEXTURE0);
@@ -141,42 +1243,430 @@ void Render() {
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, testTexture2->getTextureID());
 
-    // activate shader
-    cube_shader->use();
+    FrameInput input = sampleInput();
 
-    // pass projection matrix to shader
-    glm::mat4 projection = glm::perspective(glm::radians(GlobalCamera::camera.Zoom), (float)1280/(float)720, 0.1f, 100.0f);
-    cube_shader->setMat4("projection", projection);
+    if (!pipelined) {
+        std::function<bool(const AABB&)> occluded;
+        if (hiZ->IsValid())
+            occluded = [](const AABB& box) { return hiZ->IsOccluded(box); };
 
-    // camera/view transformation
-    glm::mat4 view = GlobalCamera::camera.GetViewMatrix();
-    cube_shader->setMat4("view", view);
+        simulate(input, occluded, serialFrame);
+        submit(serialFrame);
+        updateFrameTiming(serialFrame);
+        return;
+    }
 
-    // calculate model for each object
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::rotate(model, glm::radians(timeValue*50), glm::vec3(0.0f, 1.0f, 0.0f));
-    cube_shader->setMat4("model", model);
+    // hand the camera to the simulation, then draw the frame it finished last
+    inputBuffer.GetWriteBuffer() = input;
+    inputBuffer.Publish();
+    {
+        std::unique_lock<std::mutex> lock(handoffMutex);
+        handoff.wait(lock, [] { return frameSnapshots.HasFresh(); });
+        frameSnapshots.Acquire();
+    }
+    handoff.notify_all();
 
-    // bind vertex array
-    glBindVertexArray(VAO);
+    submit(frameSnapshots.GetReadBuffer());
+    updateFrameTiming(frameSnapshots.GetReadBuffer());
+}
 
-    // draw with indicies
-    //glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    // draw w/o indicies
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+void EndFrame() {
+    stats.arenaBytes += (int)renderArena.GetBytesUsed();
+    stats.arenaCapacity += (int)renderArena.GetCapacity();
+    renderArena.Reset();
+    postProcess->EndFrame();
 
-    // end bind vertex array
-    glBindVertexArray(0);
+    AllocationCount now = GetAllocationCount();
+    AllocationCount made = now - frameAllocationStart;
+    stats.frameAllocations = (int)made.allocations;
+    stats.frameAllocatedBytes = (int)made.bytes;
+    frameAllocationStart = now;
+}
+
+int PickObject(float ndcX, float ndcY) {
+    SimulationPause pause;
+
+    // unproject the cursor onto the near and far planes
+    glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix() * GlobalCamera::renderCamera.GetViewMatrix());
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint  = inverseViewProjection * glm::vec4(ndcX, ndcY,  1.0f, 1.0f);
+    nearPoint /= nearPoint.w;
+    farPoint  /= farPoint.w;
+
+    Ray ray(glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint));
+
+    // exact test against the cube in object space, the BVH only knows world bounds
+    auto hitCube = [](int id, const Ray& worldRay, float& t) {
+        glm::mat4 inverseModel = glm::inverse(scene.GetWorldMatrices()[id]);
+        glm::vec3 origin = glm::vec3(inverseModel * glm::vec4(worldRay.Origin, 1.0f));
+        glm::vec3 direction = glm::vec3(inverseModel * glm::vec4(worldRay.Direction, 0.0f));
+        float scale = glm::length(direction);
+
+        float localT;
+        if (!IntersectRayAABB(Ray(origin, direction), scene.GetLocalBounds()[id], std::numeric_limits<float>::max(), localT))
+            return false;
+        t = localT / scale;
+        return true;
+    };
+
+    float distance;
+    stats.pickedObject = sceneBVH.Raycast(ray, distance, hitCube);
+
+    if (stats.pickedObject != -1) {
+        Global::logger.log(DEBUG, "Picked object " + std::to_string(stats.pickedObject) + ".");
+    }
+    return stats.pickedObject;
+}
+
+bool IsGpuDrivenSupported() {
+    return indirectRenderer != nullptr;
+}
+
+void SetGpuDriven(bool enabled) {
+    gpuDriven = enabled && indirectRenderer;
+}
+
+bool IsGpuDriven() {
+    return gpuDriven;
+}
+
+void SetCubeGrid(int gridSize) {
+    if (gridSize != stats.gridSize) {
+        SimulationPause pause;
+        rebuildScene(gridSize);
+    }
+}
+
+void SetOccluderWall(bool enabled) {
+    if (enabled != occluderWall) {
+        SimulationPause pause;
+        occluderWall = enabled;
+        rebuildScene(stats.gridSize);
+    }
+}
+
+bool IsOccluderWall() {
+    return occluderWall;
+}
+
+void SetStressScene(bool enabled) {
+    if (enabled == stressScene)
+        return;
+
+    SimulationPause pause;
+    stressScene = enabled;
+
+    if (indirectRenderer) {
+        if (stressScene) {
+            indirectRenderer->SetMesh(rockMesh->GetVertexBuffer(), rockMesh->GetIndexBuffer(), rockMesh->GetLevels());
+        } else {
+            indirectRenderer->SetMesh(VBO, EBO, CUBE_LEVELS);
+        }
+    }
+    rebuildScene(stats.gridSize);
+}
+
+bool IsStressScene() {
+    return stressScene;
+}
+
+void SetLODEnabled(bool enabled) {
+    lodEnabled = enabled;
+    if (indirectRenderer)
+        indirectRenderer->SetLODEnabled(enabled);
+}
+
+bool IsLODEnabled() {
+    return lodEnabled;
+}
+
+void SetOcclusionCulling(bool enabled) {
+    occlusionCulling = enabled;
+    if (!enabled)
+        stats.occluded = 0;
+}
+
+bool IsOcclusionCulling() {
+    return occlusionCulling;
+}
+
+void UpdateOcclusion(FrameBuffer* sceneBuffer) {
+    if (!occlusionCulling)
+        return;
+
+    // built with the matrices the frame was actually drawn with, the camera may have moved since
+    hiZ->Build(sceneBuffer->getDepthTexture(), sceneBuffer->getWidth(), sceneBuffer->getHeight(), submittedViewProjection);
+
+    // the simulation thread tests against its own copy of the newest downloaded level
+    if (pipelined && hiZ->GetCpuVersion() != occlusionVersion) {
+        occlusionVersion = hiZ->GetCpuVersion();
+        hiZ->CopyCpuPyramid(occlusionBuffer.GetWriteBuffer());
+        occlusionBuffer.Publish();
+    }
+}
+
+void ApplyPostProcessing(FrameBuffer* sceneBuffer) {
+    displayTexture = postProcess->Apply(sceneBuffer->getFrameTexture(), sceneBuffer->getWidth(), sceneBuffer->getHeight(), postSettings);
+    stats.post = postProcess->GetStats();
+}
+
+unsigned int GetDisplayTexture(FrameBuffer* sceneBuffer) {
+    return displayTexture ? displayTexture : sceneBuffer->getFrameTexture();
+}
+
+void SetPostSettings(const PostSettings& settings) {
+    postSettings = settings;
+}
+
+const PostSettings& GetPostSettings() {
+    return postSettings;
+}
+
+void SetParticleCount(int count) {
+    particleCount = glm::clamp(count, 0, MAX_PARTICLES);
+    particles->SetCapacity(particleCount, particleCompute);
+    stats.particles = particles->GetStats();
+}
+
+int GetParticleCount() {
+    return particleCount;
+}
+
+void SetParticleCompute(bool enabled) {
+    particleCompute = enabled;
+    particles->SetCapacity(particleCount, particleCompute);
+    stats.particles = particles->GetStats();
+}
+
+bool IsParticleCompute() {
+    return particleCompute;
+}
+
+void SetVoxelWorld(bool enabled) {
+    if (enabled == (voxelWorld != nullptr))
+        return;
+    if (enabled) {
+        // generation runs on the pool the simulation uses
+        SimulationPause pause;
+        voxelWorld = new VoxelWorld(pool);
+    } else {
+        delete voxelWorld;
+        voxelWorld = nullptr;
+    }
+    stats.voxels = voxelWorld ? voxelWorld->GetStats() : VoxelWorld::Stats();
+}
+
+bool IsVoxelWorld() {
+    return voxelWorld != nullptr;
+}
+
+void SetVoxelEdits(bool enabled) {
+    voxelEdits = enabled;
+}
+
+bool IsVoxelEdits() {
+    return voxelEdits;
+}
+
+void SetTerrain(bool enabled) {
+    if (enabled == (terrain != nullptr))
+        return;
+    if (enabled) {
+        terrain = new Terrain();
+    } else {
+        delete terrain;
+        terrain = nullptr;
+    }
+    stats.terrain = terrain ? terrain->GetStats() : Terrain::Stats();
+}
+
+bool IsTerrain() {
+    return terrain != nullptr;
+}
+
+void SetWorkerThreads(int threadCount) {
+    threadCount = std::max(1, threadCount);
+    if (threadCount == pool->GetThreadCount())
+        return;
+
+    SimulationPause pause;
+    delete pool;
+    pool = new ThreadPool(threadCount);
+    stats.threads = pool->GetThreadCount();
+}
+
+int GetWorkerThreads() {
+    return pool->GetThreadCount();
+}
+
+void SetMaterials(int materials, int textures) {
+    materials = std::max(1, materials);
+    textures = std::clamp(textures, 1, MAX_MATERIAL_TEXTURES);
+    if (materials == materialCount && textures == textureCount)
+        return;
+
+    SimulationPause pause;
+    if (textures != textureCount)
+        createMaterialTextures(textures);
+    materialCount = materials;
+    textureCount = textures;
+    rebuildScene(stats.gridSize);
+}
+
+void SetTextureMode(MaterialTextureMode mode) {
+    if (mode == textureMode)
+        return;
+
+    SimulationPause pause;
+    textureMode = mode;
+    createMaterialTextures(textureCount);
+}
+
+MaterialTextureMode GetTextureMode() {
+    return textureMode;
+}
+
+void SetTextureStreaming(bool enabled) {
+    if (enabled == textureStreaming)
+        return;
+
+    SimulationPause pause;
+    textureStreaming = enabled;
+    createMaterialTextures(textureCount);
+}
+
+bool IsTextureStreaming() {
+    return textureStreaming;
+}
+
+void SetTextureBudget(long long bytes) {
+    materialTextures->SetStreamingBudget(std::max(0LL, bytes));
+}
+
+long long GetTextureBudget() {
+    return materialTextures->GetStreamingBudget();
+}
+
+int GetTextureArrayCount() {
+    return materialTextures->GetArrayCount();
+}
+
+float GetAtlasOccupancy() {
+    const TextureAtlas* atlas = materialTextures->GetAtlas();
+    return atlas ? atlas->GetOccupancy() : 0.0f;
+}
+
+int GetMaterialCount() {
+    return materialCount;
+}
+
+int GetTextureCount() {
+    return textureCount;
+}
+
+void SetLighting(LightingMode mode) {
+    lightingMode = mode;
+}
+
+LightingMode GetLighting() {
+    return lightingMode;
+}
+
+void SetLightCount(int count) {
+    count = std::clamp(count, 0, MAX_LIGHTS);
+    if (count == lightCount)
+        return;
+
+    SimulationPause pause;
+    lightCount = count;
+    generateLights();
+}
+
+int GetLightCount() {
+    return lightCount;
+}
+
+void SetRenderPath(RenderPath path) {
+    renderPath = path;
+}
+
+RenderPath GetRenderPath() {
+    return renderPath;
+}
+
+void SetShadows(bool enabled) {
+    if (enabled == shadows)
+        return;
+
+    SimulationPause pause;
+    shadows = enabled;
+    shadowCascades->Invalidate();
+}
+
+bool IsShadows() {
+    return shadows;
+}
+
+void SetSunDirection(const glm::vec3& direction) {
+    if (glm::length(direction) > 0.0f)
+        sunDirection = glm::normalize(direction);
+}
+
+glm::vec3 GetSunDirection() {
+    return sunDirection;
+}
+
+void SetAnimationTime(float seconds) {
+    animationTime = seconds;
+}
+
+void SetPipelined(bool enabled) {
+    if (enabled == pipelined)
+        return;
+
+    if (enabled) {
+        pipelined = true;
+        startSimulation();
+    } else {
+        stopSimulation();
+        pipelined = false;
+    }
+    stats.pipelined = pipelined;
+}
+
+bool IsPipelined() {
+    return pipelined;
+}
+
+const SceneStats& GetSceneStats() {
+    return stats;
 }
 
 void Cleanup() {
+    SetPipelined(false);
+
     Global::logger.log(INFO, "Cleanup, deleting vertex arrays.");
-    glDeleteVertexArrays(1, &VAO);
+    resources::Delete(resources::ResourceType::VertexArray, VAO);
     Global::logger.log(INFO, "Cleanup, deleting buffers.");
-    glDeleteBuffers(1, &VBO);
+    resources::Delete(resources::ResourceType::Buffer, VBO);
+    resources::Delete(resources::ResourceType::Buffer, EBO);
     Global::logger.log(INFO, "Cleanup, deleting shader program.");
 
+    delete pool;
+    delete streamBuffer;
+    delete indirectRenderer;
+    delete hiZ;
+    delete postProcess;
+    delete particles;
+    delete voxelWorld;
+    delete terrain;
+    delete rockMesh;
     delete cube_shader;
+    delete bindless_shader;
+    delete materialTextures;
+    delete lightClusters;
+    delete deferredRenderer;
+    delete shadowCascades;
     delete testTexture1;
     delete testTexture2;
 
@@ -13,14 +13,202 @@
 
 #pragma once
 
+#include "DeferredRenderer.h"
+#include "LightClusters.h"
+#include "MaterialTextures.h"
+#include "ParticleSystem.h"
+#include "Terrain.h"
+#include "VoxelWorld.h"
+#include "PostProcess.h"
+#include "ShadowCascades.h"
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+class FrameBuffer;
 
 namespace graphics {
 
+// one shadow cascade of the last frame, gpuMs arrives a few frames late
+struct CascadeStats {
+    int drawCalls = 0;
+    int casters = 0;
+    bool cached = false;            // the static casters came from the cache
+    float gpuMs = 0.0f;
+    float splitDepth = 0.0f;        // far end in view depth
+};
+
+// per-frame scene numbers shown in the "Scene" window
+struct SceneStats {
+    int objects = 0;
+    int visible = 0;
+    int occluded = 0;
+    int drawCalls = 0;
+    int textureBinds = 0;           // CPU path, material texture binds (see MaterialTextures.h)
+    int triangles = 0;
+    int fullDetailTriangles = 0;    // what the same visible set costs with LOD off
+    int bvhNodes = 0;
+    int gridSize = 0;
+    int pickedObject = -1;
+    int nearestObject = -1;
+    float nearestDistance = 0.0f;
+    // CPU frame phases in milliseconds, cull/sort/submit stay at their last value on the GPU path
+    int threads = 1;
+    float updateMs = 0.0f;          // transform propagation + BVH refit
+    float cullMs = 0.0f;            // frustum/occlusion culling, LOD selection and sort keys
+    float sortMs = 0.0f;            // merging the per-thread lists and sorting them
+    float submitMs = 0.0f;          // replaying the queue on the GL thread
+    // averaged over the last half second
+    bool pipelined = false;
+    float frameMs = 0.0f;           // time between frames
+    float latencyMs = 0.0f;         // camera sampled -> its frame submitted
+    float forwardFrameMs = 0.0f;    // the last frame time of each render path, to compare them
+    float deferredFrameMs = 0.0f;
+    // per-frame stream buffer
+    int streamBytes = 0;
+    int streamFrameSize = 0;
+    bool streamPersistent = false;
+    float fenceWaitMs = 0.0f;
+    // heap allocations of the whole last frame loop iteration (see AllocationCounter.h)
+    int frameAllocations = 0;
+    int frameAllocatedBytes = 0;
+    // frame arenas: render queue plus the render thread's own
+    int arenaBytes = 0;
+    int arenaCapacity = 0;
+    // material texture streaming (see TextureStreamer.h), bandwidth in bytes per second
+    bool textureStreaming = false;
+    long long textureBudget = 0;
+    long long textureResidentBytes = 0;
+    long long textureFullBytes = 0;
+    int textureLoads = 0;
+    int textureEvictions = 0;       // levels evicted per second
+    float textureBandwidth = 0.0f;
+    // point lights, CPU path
+    int lights = 0;
+    float lightMs = 0.0f;           // moving the lights and assigning them to clusters
+    int lightIndices = 0;           // entries of all cluster lists together
+    int maxClusterLights = 0;       // lights in the fullest cluster, every light when naive
+    int lightBufferBytes = 0;
+    // CPU path, the G-buffer is only allocated once the deferred path has drawn
+    RenderPath renderPath = RenderPath::Forward;
+    int gBufferBytesPerPixel = 0;
+    long long gBufferBytes = 0;
+    // sun shadows, CPU path
+    bool shadows = false;
+    float shadowMs = 0.0f;          // fitting the cascades and culling their casters
+    int shadowDrawCalls = 0;
+    float shadowGpuMs = 0.0f;
+    long long shadowMapBytes = 0;   // shadow maps and the static caches
+    CascadeStats cascades[ShadowCascades::CASCADES];
+    // post-processing chain, both paths
+    PostProcess::Stats post;
+    // GPU particles, both paths
+    ParticleSystem::Stats particles;
+    // voxel world, both paths, zero while it is off
+    VoxelWorld::Stats voxels;
+    // streamed terrain, both paths, zero while it is off
+    Terrain::Stats terrain;
+};
+
 void Prerender();
 void Render();
+// end of a main loop iteration, after the swap
+void EndFrame();
 void Cleanup();
 
+// casts a ray through the scene view at normalized device coordinates, returns the object id or -1
+int PickObject(float ndcX, float ndcY);
+// GPU-driven path: compute culling + one multi-draw-indirect, needs GL 4.3+
+bool IsGpuDrivenSupported();
+void SetGpuDriven(bool enabled);
+bool IsGpuDriven();
+// replaces the cube grid with a gridSize x gridSize one (0 leaves only the spinning cube)
+void SetCubeGrid(int gridSize);
+// adds a large wall behind the spinning cube that hides part of the grid
+void SetOccluderWall(bool enabled);
+bool IsOccluderWall();
+// LOD stress scene, swaps the cubes for dense rocks that carry a generated LOD chain
+void SetStressScene(bool enabled);
+bool IsStressScene();
+// picks a rock LOD per object from its projected size, off draws everything at full detail
+void SetLODEnabled(bool enabled);
+bool IsLODEnabled();
+// Hi-Z occlusion culling against last frame's depth, works on both paths
+void SetOcclusionCulling(bool enabled);
+bool IsOcclusionCulling();
+// builds the Hi-Z pyramid from the depth Render() just produced, call while sceneBuffer is bound
+void UpdateOcclusion(FrameBuffer* sceneBuffer);
+// runs the enabled post effects over what Render() drew (see PostProcess.h), call after
+// UpdateOcclusion() while sceneBuffer is still bound
+void ApplyPostProcessing(FrameBuffer* sceneBuffer);
+// what the scene view shows, the post chain's output or the scene itself
+unsigned int GetDisplayTexture(FrameBuffer* sceneBuffer);
+void SetPostSettings(const PostSettings& settings);
+const PostSettings& GetPostSettings();
+// threads used for the parallel part of the frame, the render thread included
+void SetWorkerThreads(int threadCount);
+int GetWorkerThreads();
+// synthetic materials: "materials" distinct materials handed out round robin over the objects,
+// material m draws with texture m % textures (up to MAX_MATERIAL_TEXTURES), the CPU path
+// batches by texture group, the GPU-driven path ignores textures
+const int MAX_MATERIAL_TEXTURES = MaterialTextures::MAX_TEXTURES;
+void SetMaterials(int materials, int textures);
+int GetMaterialCount();
+int GetTextureCount();
+// how the CPU path stores and binds the material textures, Bindless falls back to Array
+// when the context lacks ARB_bindless_texture
+void SetTextureMode(MaterialTextureMode mode);
+MaterialTextureMode GetTextureMode();
+// streams the mip levels of the material textures under a memory budget instead of keeping
+// all of them, only takes effect in Separate and Array mode (SceneStats::textureStreaming)
+void SetTextureStreaming(bool enabled);
+bool IsTextureStreaming();
+void SetTextureBudget(long long bytes);
+long long GetTextureBudget();
+// texture arrays, or atlas pages in Atlas mode, and how full the pages are
+int GetTextureArrayCount();
+float GetAtlasOccupancy();
+// dynamic point lights scattered over the grid, lit per fragment on the CPU path (see LightClusters.h)
+const int MAX_LIGHTS = 16384;
+void SetLighting(LightingMode mode);
+LightingMode GetLighting();
+void SetLightCount(int count);
+int GetLightCount();
+// forward lights every fragment as it is drawn, deferred draws the queue into a G-buffer and
+// lights each pixel once (see DeferredRenderer.h); the GPU-driven path always draws forward
+void SetRenderPath(RenderPath path);
+RenderPath GetRenderPath();
+// a directional sun on the CPU path, shadowed by cascaded shadow maps that cache everything
+// static (see ShadowCascades.h); the sun only shines while shadows are on
+void SetShadows(bool enabled);
+bool IsShadows();
+// the way the sunlight travels, normalized
+void SetSunDirection(const glm::vec3& direction);
+glm::vec3 GetSunDirection();
+// GPU particles from a fountain over the spinning cube, 0 turns them off; simulated by compute
+// shaders on GL 4.3, by transform feedback otherwise or with compute off (see ParticleSystem.h)
+const int MAX_PARTICLES = ParticleSystem::MAX_CAPACITY;
+void SetParticleCount(int count);
+int GetParticleCount();
+void SetParticleCompute(bool enabled);
+bool IsParticleCompute();
+// a chunked voxel terrain under the scene, generated when turned on and meshed with
+// stb_voxel_render on threads of its own (see VoxelWorld.h); edits dig through it all the time
+void SetVoxelWorld(bool enabled);
+bool IsVoxelWorld();
+void SetVoxelEdits(bool enabled);
+bool IsVoxelEdits();
+// endless procedural terrain below the scene, quadtree tiles generated around the camera on
+// threads of their own and evicted once it has moved on (see Terrain.h)
+void SetTerrain(bool enabled);
+bool IsTerrain();
+// the animation shows "seconds" instead of following the clock, set before every Render(),
+// negative goes back to the clock
+void SetAnimationTime(float seconds);
+// runs the CPU half of the frame on a simulation thread one frame ahead of the
+// render thread, overlaps the two at the cost of about a frame of latency
+void SetPipelined(bool enabled);
+bool IsPipelined();
+const SceneStats& GetSceneStats();
+
 }
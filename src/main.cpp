@@ -9,14 +9,39 @@
  *      window using OpenGL and GLFW. Calls
  *      code from "framework" class at Imgui
  *      initialization and runtime loop.
+ *
+ *      Command line:
+ *      --present-mode vsync|adaptive|uncapped|limited
+ *      --fps N                 frame rate of the limited mode
+ *      --benchmark SECONDS     runs uncapped (unless a present mode is given) for
+ *                              SECONDS after a warm-up, writes the frame pacing
+ *                              statistics to a JSON file and exits
+ *      --warmup SECONDS        warm-up before the benchmark records, 2 by default
+ *      --output FILE           benchmark report, benchmark.json by default
+ *      --timestep SECONDS      simulation step, 1/120 by default; camera movement and
+ *                              animation advance in steps of this length whatever the
+ *                              frame rate and are interpolated to the frame
+ *      --record FILE           records the camera input and writes it to FILE on exit
+ *      --replay FILE           drives the camera from a recording instead of the
+ *                              mouse and keyboard, one simulation step per frame so
+ *                              every replay draws the same frames; a benchmark ends
+ *                              with the replay
+ *      --replay-step SECONDS   simulation step of the replay, 1/60 by default
  */
 
 
 #include <iostream>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "Camera.h"
+#include "FixedTimestep.h"
+#include "FramePacer.h"
+#include "GpuResources.h"
+#include "InputRecorder.h"
 #include "Logger.h"
 #include "graphics.h"
 #include "framework.h"
@@ -36,11 +61,26 @@
 //void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow *window);
+uint8_t processInput(GLFWwindow *window);
+
+// command line
+struct LaunchOptions {
+    PresentMode presentMode = PresentMode::VSync;
+    bool presentModeGiven = false;
+    float targetFps = 60.0f;
+    double benchmarkSeconds = 0.0;  // 0 = no benchmark
+    double warmupSeconds = 2.0;
+    std::string outputPath = "benchmark.json";
+    double timestep = 1.0 / 120.0;
+    std::string recordPath;
+    std::string replayPath;
+    float replayStep = 1.0f / 60.0f;
+};
+LaunchOptions parseArguments(int argc, char** argv);
+bool writeBenchmarkReport(const LaunchOptions& options, double seconds);
 
 // timing
-float deltaTime = 0.0f; // time between current frame and last frame
-float lastFrame = 0.0f;
+double lastFrame = 0.0;     // glfwGetTime() at the start of the last frame
 
 // camera variables
 float lastX = 1280 / 2.0f;
@@ -49,13 +89,17 @@ bool firstMouse = true;
 
 
 
-int main() {
+int main(int argc, char** argv) {
 
     //////////////////
     // SETUP WINDOW //
     //////////////////
     Global::logger.log(INFO, "Program started.");
 
+    LaunchOptions options = parseArguments(argc, argv);
+    if (options.benchmarkSeconds > 0.0 && !options.presentModeGiven) {
+        options.presentMode = PresentMode::Uncapped;
+    }
 
     if (!glfwInit()) {
         return 1;
@@ -64,14 +108,21 @@ int main() {
     // Decide GL+GLSL versions
     // GL 3.0 + GLSL 130
     const char *glsl_version = "#version 130";
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);  // 3.2+ only
     //glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);            // 3.0+ only
 
-
-    // Create window with graphics context
-    GLFWwindow *window = glfwCreateWindow(1280, 720, "GLFW 3.4 Window", NULL, NULL);
+    // Create window with graphics context, newest first: 4.3+ enables the
+    // GPU-driven path, 4.5 is as far as Mesa llvmpipe goes, 3.3 is the baseline
+    const int GL_versions[][2] = { {4, 6}, {4, 5}, {4, 3}, {3, 3} };
+    GLFWwindow *window = NULL;
+    for (const auto& version : GL_versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        window = glfwCreateWindow(1280, 720, "GLFW 3.4 Window", NULL, NULL);
+        if (window != NULL) {
+            break;
+        }
+    }
     if (window == NULL) {
         return 1;
     }
@@ -83,12 +134,14 @@ int main() {
     //glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
 
-    glfwSwapInterval(1); // Enable vsync (fps cap too)
-
     if(!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         throw("Unable to context to OpenGL, failed to initialize GLAD");
     }
 
+    // vsync unless the command line asks for something else, changeable in the Performance window
+    GlobalPacer::pacer.SetTargetFps(options.targetFps);
+    GlobalPacer::pacer.SetPresentMode(options.presentMode);
+
     int screen_width, screen_height;
     glfwGetFramebufferSize(window, &screen_width, &screen_height);
     glViewport(0, 0, screen_width, screen_height);
@@ -115,6 +168,26 @@ int main() {
 
     graphics::Prerender();
 
+    // camera input recording and replay
+    InputRecorder& recorder = GlobalInput::recorder;
+    if (!options.replayPath.empty()) {
+        recorder.StartReplay(options.replayPath, GlobalCamera::camera, options.replayStep);
+    } else if (!options.recordPath.empty()) {
+        recorder.StartRecording(GlobalCamera::camera);
+    }
+
+    // the simulation runs in fixed steps, "previousCamera" is the camera one step back
+    // and the renderer draws in between the two
+    FixedTimestep& clock = GlobalTimestep::clock;
+    clock.SetStep(options.timestep);
+    Camera previousCamera = GlobalCamera::camera;
+    double liveStep = options.timestep;     // the step to go back to after a replay
+    lastFrame = glfwGetTime();
+
+    // benchmark: warm up first so shader compiles and buffer growth stay out of the numbers
+    double benchmarkStart = glfwGetTime();
+    bool benchmarkRecording = false;
+
     while(!glfwWindowShouldClose(window)) {
 
         glfwPollEvents();
@@ -126,14 +199,39 @@ int main() {
         sceneBuffer->Bind();
 
         // handle per-frame time logic
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        double currentFrame = glfwGetTime();
+        double frameSeconds = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        // process keyboard input
-        if(const auto& io = ImGui::GetIO(); !io.WantCaptureKeyboard) {
-            processInput(window);
+        // a replay runs in lockstep with the frames and starts the animation from 0 like
+        // it did when the recording was made; switching either way starts a new schedule
+        if (recorder.IsReplaying() != clock.IsLockstep()) {
+            if (recorder.IsReplaying()) {
+                liveStep = clock.GetStep();
+                clock.SetStep(recorder.GetReplayStep());
+                clock.Reset();
+            } else {
+                clock.SetStep(liveStep);
+            }
+            clock.SetLockstep(recorder.IsReplaying());
+            previousCamera = GlobalCamera::camera;
+        }
+
+        // keyboard input (or the replay) moves the camera step by step, mouse look already
+        // turned it while polling
+        bool replayFinished = false;
+        uint8_t keys = recorder.IsReplaying() ? 0 : processInput(window);
+        int steps = clock.Advance(frameSeconds);
+        for (int i = 0; i < steps; i++) {
+            previousCamera = GlobalCamera::camera;
+            if (recorder.IsReplaying()) {
+                replayFinished = !recorder.Step(GlobalCamera::camera);
+            } else {
+                ApplyCameraKeys(GlobalCamera::camera, keys, (float)clock.GetStep());
+            }
         }
+        GlobalCamera::renderCamera.Interpolate(previousCamera, GlobalCamera::camera, clock.GetAlpha());
+        graphics::SetAnimationTime((float)clock.GetInterpolatedTime());
 
         ///////////////////////
         // begin opengl code //
@@ -144,28 +242,150 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         graphics::Render();
+        graphics::UpdateOcclusion(sceneBuffer);
+        graphics::ApplyPostProcessing(sceneBuffer);
         /////////////////////
         // end opengl code //
         /////////////////////
 
         sceneBuffer->Unbind();
+        GlobalPacer::pacer.Wait();
         glfwSwapBuffers(window);
+        GlobalPacer::pacer.FrameEnd();
+
+        graphics::EndFrame();
+
+        if (options.benchmarkSeconds > 0.0) {
+            double now = glfwGetTime();
+            if (!benchmarkRecording && now - benchmarkStart >= options.warmupSeconds) {
+                GlobalPacer::pacer.StartRecording((size_t)(options.benchmarkSeconds * 1000.0));
+                benchmarkStart = now;
+                benchmarkRecording = true;
+            } else if (benchmarkRecording && (now - benchmarkStart >= options.benchmarkSeconds || replayFinished)) {
+                GlobalPacer::pacer.StopRecording();
+                writeBenchmarkReport(options, now - benchmarkStart);
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
+        }
     }
 
     Global::logger.log(INFO, "Program beginning exit sequence.");
 
+    if (recorder.IsRecording()) {
+        recorder.StopRecording(options.recordPath.empty() ? DEFAULT_INPUT_RECORDING : options.recordPath);
+    }
+
 
     graphics::Cleanup();
     program.Shutdown();
     delete sceneBuffer;
+    resources::ReportLeaks();
 
     Global::logger.log(INFO, "Program terminated by user.\n\n\n");
 }
 
 
+LaunchOptions parseArguments(int argc, char** argv) {
+    LaunchOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (argument == "--present-mode" && value) {
+            if (ParsePresentMode(value, options.presentMode)) {
+                options.presentModeGiven = true;
+            } else {
+                Global::logger.log(WARNING, std::string("Unknown present mode \"") + value + "\", using vsync.");
+            }
+            i++;
+        } else if (argument == "--fps" && value) {
+            options.targetFps = (float)std::atof(value);
+            i++;
+        } else if (argument == "--benchmark" && value) {
+            options.benchmarkSeconds = std::atof(value);
+            i++;
+        } else if (argument == "--warmup" && value) {
+            options.warmupSeconds = std::atof(value);
+            i++;
+        } else if (argument == "--output" && value) {
+            options.outputPath = value;
+            i++;
+        } else if (argument == "--timestep" && value) {
+            options.timestep = std::atof(value);
+            i++;
+        } else if (argument == "--record" && value) {
+            options.recordPath = value;
+            i++;
+        } else if (argument == "--replay" && value) {
+            options.replayPath = value;
+            i++;
+        } else if (argument == "--replay-step" && value) {
+            options.replayStep = (float)std::atof(value);
+            i++;
+        } else {
+            Global::logger.log(WARNING, "Ignoring command line argument \"" + argument + "\".");
+        }
+    }
+    return options;
+}
+
+// JSON string with quotes and backslashes escaped, driver strings need nothing more
+void writeJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool writeBenchmarkReport(const LaunchOptions& options, double seconds) {
+    std::vector<float> scratch;
+    FramePacingStats pacing = ComputePacingStats(GlobalPacer::pacer.GetRecording(), scratch);
+    const graphics::SceneStats& scene = graphics::GetSceneStats();
+
+    char summary[160];
+    snprintf(summary, sizeof(summary), "Benchmark: %d frames in %.1f s, %.1f fps average, %.1f fps 1%% low, %d stutters.",
+            pacing.frames, seconds, pacing.averageFps, pacing.onePercentLowFps, pacing.stutters);
+    Global::logger.log(INFO, summary);
+
+    FILE* file = fopen(options.outputPath.c_str(), "w");
+    if (!file) {
+        Global::logger.log(ERROR, "Unable to write benchmark report to " + options.outputPath + ".");
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"renderer\": ");
+    writeJsonString(file, (const char*)glGetString(GL_RENDERER));
+    fprintf(file, ",\n  \"gl_version\": ");
+    writeJsonString(file, (const char*)glGetString(GL_VERSION));
+    fprintf(file, ",\n  \"present_mode\": \"%s\",\n", PresentModeName(GlobalPacer::pacer.GetPresentMode()));
+    fprintf(file, "  \"duration_s\": %.3f,\n", seconds);
+    fprintf(file, "  \"frames\": %d,\n", pacing.frames);
+    fprintf(file, "  \"average_fps\": %.2f,\n", pacing.averageFps);
+    fprintf(file, "  \"average_ms\": %.4f,\n", pacing.averageMs);
+    fprintf(file, "  \"median_ms\": %.4f,\n", pacing.medianMs);
+    fprintf(file, "  \"p95_ms\": %.4f,\n", pacing.p95Ms);
+    fprintf(file, "  \"p99_ms\": %.4f,\n", pacing.p99Ms);
+    fprintf(file, "  \"max_ms\": %.4f,\n", pacing.maxMs);
+    fprintf(file, "  \"one_percent_low_fps\": %.2f,\n", pacing.onePercentLowFps);
+    fprintf(file, "  \"stutters\": %d,\n", pacing.stutters);
+    fprintf(file, "  \"scene\": { \"objects\": %d, \"visible\": %d, \"draw_calls\": %d, \"triangles\": %d }\n",
+            scene.objects, scene.visible, scene.drawCalls, scene.triangles);
+    fprintf(file, "}\n");
+    fclose(file);
+
+    Global::logger.log(INFO, "Benchmark report written to " + options.outputPath + ".");
+    return true;
+}
+
+
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
 
-    if(const auto& io = ImGui::GetIO(); !io.WantCaptureMouse) {
+    if(const auto& io = ImGui::GetIO(); !io.WantCaptureMouse && !GlobalInput::recorder.IsReplaying()) {
         float xpos = static_cast<float>(xposIn);
         float ypos = static_cast<float>(yposIn);
 
@@ -182,38 +402,44 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
         lastX = xpos;
         lastY = ypos;
 
+        GlobalInput::recorder.RecordMouse(xoffset, yoffset);
         GlobalCamera::camera.ProcessMouseMovement(xoffset, yoffset);
     }
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-    if(const auto& io = ImGui::GetIO(); !io.WantCaptureMouse) {
+    if(const auto& io = ImGui::GetIO(); !io.WantCaptureMouse && !GlobalInput::recorder.IsReplaying()) {
+        GlobalInput::recorder.RecordScroll(static_cast<float>(yoffset));
         GlobalCamera::camera.ProcessMouseScroll(static_cast<float>(yoffset));
     }
 }
 
-void processInput(GLFWwindow *window) {
-
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-        deltaTime *= 5;
-    }
-
-    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
-        deltaTime /= 5;
+uint8_t processInput(GLFWwindow *window) {
+
+    // held keys as one mask, so a recording sees exactly what moves the camera
+    uint8_t keys = 0;
+    if (const auto& io = ImGui::GetIO(); !io.WantCaptureKeyboard) {
+        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+            keys |= INPUT_KEY_FAST;
+        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+            keys |= INPUT_KEY_SLOW;
+
+        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+            keys |= InputKeyBit(FORWARD);
+        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+            keys |= InputKeyBit(BACKWARD);
+        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+            keys |= InputKeyBit(LEFT);
+        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+            keys |= InputKeyBit(RIGHT);
+        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+            keys |= InputKeyBit(DOWN);
+        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+            keys |= InputKeyBit(UP);
     }
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(FORWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(BACKWARD, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(LEFT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(RIGHT, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(DOWN, deltaTime);
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-        GlobalCamera::camera.ProcessKeyboard(UP, deltaTime);
+    GlobalInput::recorder.RecordKeys(keys);
+    return keys;
 }
 
 
@@ -0,0 +1,49 @@
+#version 330 core
+
+// lighting pass of the deferred path (DeferredRenderer.h), one fullscreen triangle that lights
+// every covered pixel of the G-buffer the way fragment_shader.frag lights a fragment
+
+out vec4 FragColor;
+
+// the G-buffer: albedo + specular strength, octahedral normal, depth
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+};
+
+#include "lighting.glsl"
+
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 folded = encoded * 2.0 - 1.0;
+    vec3 normal = vec3(folded, 1.0 - abs(folded.x) - abs(folded.y));
+    if (normal.z < 0.0)
+        normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(normal);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    // nothing was drawn here, the target keeps its clear color
+    if (depth == 1.0)
+        discard;
+
+    vec4 albedo = texelFetch(gAlbedo, pixel, 0);
+    if (lightInfo.x == 0 && lightInfo.z == 0) {
+        FragColor = vec4(albedo.rgb, 1.0);
+        return;
+    }
+
+    vec2 ndc = gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    vec3 position = world.xyz / world.w;
+    float viewDepth = -(view * vec4(position, 1.0)).z;
+    vec3 normal = decodeNormal(texelFetch(gNormal, pixel, 0).xy);
+    FragColor = vec4(lighting(albedo.rgb, albedo.a, position, normal, viewDepth), 1.0);
+}
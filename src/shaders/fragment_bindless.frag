@@ -0,0 +1,34 @@
+#version 430 core
+#extension GL_ARB_bindless_texture : require
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec2 MaterialTexCoord;
+flat in float MixFactor;
+flat in int TextureLayer;
+flat in int TextureHandle;
+flat in float Specular;
+in vec3 WorldPosition;
+in float ViewDepth;
+
+// resident handles of the material texture arrays (MaterialTextures::HANDLES_BINDING),
+// nothing has to be bound between draws
+layout (std430, binding = 4) readonly buffer MaterialHandles {
+    uvec2 handles[];
+};
+
+uniform sampler2D texture2;
+
+#include "lighting.glsl"
+
+void main()
+{
+    sampler2DArray materialTexture = sampler2DArray(handles[TextureHandle]);
+    FragColor = mix(texture(materialTexture, vec3(MaterialTexCoord, TextureLayer)), texture(texture2, TexCoord), MixFactor);
+    if (lightInfo.x != 0 || lightInfo.z != 0) {
+        // flat face normal from the screen space derivatives, no mesh carries normals
+        vec3 normal = normalize(cross(dFdx(WorldPosition), dFdy(WorldPosition)));
+        FragColor.rgb = lighting(FragColor.rgb, Specular, WorldPosition, normal, ViewDepth);
+    }
+}
@@ -1,14 +1,28 @@
-#version 460 core
+#version 330 core
 
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in vec2 MaterialTexCoord;
+flat in float MixFactor;
+flat in int TextureLayer;
+flat in float Specular;
+in vec3 WorldPosition;
+in float ViewDepth;
 
-uniform sampler2D texture1;
+// material textures are layers of an array (MaterialTextures.h), texture2 marks the picked object
+uniform sampler2DArray texture1;
 uniform sampler2D texture2;
 
+#include "lighting.glsl"
+
 void main()
 {
     // last param controls mixture factor
-    FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.0);
+    FragColor = mix(texture(texture1, vec3(MaterialTexCoord, TextureLayer)), texture(texture2, TexCoord), MixFactor);
+    if (lightInfo.x != 0 || lightInfo.z != 0) {
+        // flat face normal from the screen space derivatives, no mesh carries normals
+        vec3 normal = normalize(cross(dFdx(WorldPosition), dFdy(WorldPosition)));
+        FragColor.rgb = lighting(FragColor.rgb, Specular, WorldPosition, normal, ViewDepth);
+    }
 }
\ No newline at end of file
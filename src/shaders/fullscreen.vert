@@ -0,0 +1,13 @@
+#version 330 core
+
+// single triangle covering the whole target, no vertex buffer needed
+// (draw 3 vertices with an empty vertex array bound)
+
+out vec2 TexCoord;
+
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    TexCoord = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
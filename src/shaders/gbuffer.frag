@@ -0,0 +1,33 @@
+#version 330 core
+
+// geometry pass of the deferred path (DeferredRenderer.h), same inputs as fragment_shader.frag
+// but the surface goes into the G-buffer instead of being lit
+layout (location = 0) out vec4 Albedo;      // rgb albedo, a specular strength
+layout (location = 1) out vec2 Normal;      // octahedral, mapped to [0, 1]
+
+in vec2 TexCoord;
+in vec2 MaterialTexCoord;
+flat in float MixFactor;
+flat in int TextureLayer;
+flat in float Specular;
+in vec3 WorldPosition;
+
+uniform sampler2DArray texture1;
+uniform sampler2D texture2;
+
+// unit vector folded onto the octahedron and flattened into the unit square
+vec2 encodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    vec2 folded = normal.z >= 0.0 ? normal.xy
+            : (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    return folded * 0.5 + 0.5;
+}
+
+void main()
+{
+    vec4 color = mix(texture(texture1, vec3(MaterialTexCoord, TextureLayer)), texture(texture2, TexCoord), MixFactor);
+    Albedo = vec4(color.rgb, Specular);
+    // flat face normal from the screen space derivatives, no mesh carries normals
+    Normal = encodeNormal(normalize(cross(dFdx(WorldPosition), dFdy(WorldPosition))));
+}
@@ -0,0 +1,36 @@
+#version 430 core
+#extension GL_ARB_bindless_texture : require
+
+// gbuffer.frag with the material textures of fragment_bindless.frag
+layout (location = 0) out vec4 Albedo;      // rgb albedo, a specular strength
+layout (location = 1) out vec2 Normal;      // octahedral, mapped to [0, 1]
+
+in vec2 TexCoord;
+in vec2 MaterialTexCoord;
+flat in float MixFactor;
+flat in int TextureLayer;
+flat in int TextureHandle;
+flat in float Specular;
+in vec3 WorldPosition;
+
+layout (std430, binding = 4) readonly buffer MaterialHandles {
+    uvec2 handles[];
+};
+
+uniform sampler2D texture2;
+
+vec2 encodeNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    vec2 folded = normal.z >= 0.0 ? normal.xy
+            : (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+    return folded * 0.5 + 0.5;
+}
+
+void main()
+{
+    sampler2DArray materialTexture = sampler2DArray(handles[TextureHandle]);
+    vec4 color = mix(texture(materialTexture, vec3(MaterialTexCoord, TextureLayer)), texture(texture2, TexCoord), MixFactor);
+    Albedo = vec4(color.rgb, Specular);
+    Normal = encodeNormal(normalize(cross(dFdx(WorldPosition), dFdy(WorldPosition))));
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+// level 0 of the Hi-Z pyramid, a straight copy of the scene depth
+
+out float Depth;
+
+uniform sampler2D depthTexture;
+
+void main()
+{
+    Depth = texelFetch(depthTexture, ivec2(gl_FragCoord.xy), 0).r;
+}
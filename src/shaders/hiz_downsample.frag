@@ -0,0 +1,37 @@
+#version 330 core
+
+// builds one Hi-Z level from the previous one, every texel keeps the
+// farthest depth of the texels it covers. The previous level is the
+// texture's base level while this runs, so lod 0 addresses it.
+
+out float Depth;
+
+uniform sampler2D previousLevel;
+uniform ivec2 previousSize;
+
+float fetch(ivec2 coord)
+{
+    // clamping only ever repeats texels that are already part of the footprint
+    return texelFetch(previousLevel, min(coord, previousSize - 1), 0).r;
+}
+
+void main()
+{
+    ivec2 coord = ivec2(gl_FragCoord.xy) * 2;
+
+    float depth = max(max(fetch(coord), fetch(coord + ivec2(1, 0))),
+                      max(fetch(coord + ivec2(0, 1)), fetch(coord + ivec2(1, 1))));
+
+    // odd sizes: the last column/row also has to cover the leftover texel
+    bool extraColumn = (previousSize.x & 1) != 0 && coord.x == previousSize.x - 3;
+    bool extraRow    = (previousSize.y & 1) != 0 && coord.y == previousSize.y - 3;
+
+    if (extraColumn)
+        depth = max(depth, max(fetch(coord + ivec2(2, 0)), fetch(coord + ivec2(2, 1))));
+    if (extraRow)
+        depth = max(depth, max(fetch(coord + ivec2(0, 2)), fetch(coord + ivec2(1, 2))));
+    if (extraColumn && extraRow)
+        depth = max(depth, fetch(coord + ivec2(2, 2)));
+
+    Depth = depth;
+}
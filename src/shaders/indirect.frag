@@ -0,0 +1,14 @@
+#version 430 core
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+flat in float MixFactor;
+
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+    FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), MixFactor);
+}
@@ -0,0 +1,34 @@
+#version 430 core
+
+// vertex shader for the GPU-driven path, per-object data is
+// fetched from the object SSBO instead of per-draw uniforms
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in uint aObjectID;    // instanced, advanced by the command's baseInstance
+
+struct ObjectData {
+    mat4 model;
+    vec4 boundsMin;
+    vec4 boundsMax;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+    ObjectData objects[];
+};
+
+out vec2 TexCoord;
+flat out float MixFactor;
+
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform int pickedObject;
+
+
+void main()
+{
+   gl_Position = projection * view * objects[aObjectID].model * vec4(aPos, 1.0);
+   TexCoord = aTexCoord;
+   MixFactor = int(aObjectID) == pickedObject ? 1.0 : 0.0;
+}
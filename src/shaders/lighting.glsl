@@ -0,0 +1,97 @@
+// lights, sun shadows and the lighting() they add up to, shared by fragment_shader.frag,
+// fragment_bindless.frag and deferred_lighting.frag; Shader.cpp pastes it in where they say
+// #include "lighting.glsl"
+
+// point lights (LightClusters.h): two texels per light, position + radius and color + intensity,
+// the first index and light count of every cluster, and the lights of all clusters back to back
+uniform samplerBuffer lights;
+uniform usamplerBuffer lightClusters;
+uniform usamplerBuffer lightIndices;
+
+// sun shadows (ShadowCascades.h), the cascades are layers of one depth array compared in hardware
+uniform sampler2DArrayShadow shadowMaps;
+
+// streamed once per frame, lightInfo.x is the LightingMode (0 = off, 1 = every light, 2 = clustered)
+layout (std140) uniform Lighting {
+    vec4 clusterScale;      // xy tiles per pixel, zw scale and bias of log(view depth) to the slice
+    ivec4 clusterCounts;    // clusters in x, y and z
+    ivec4 lightInfo;        // x = mode, y = light count, z = sun with shadows
+    vec4 ambient;
+    vec4 cameraPosition;    // xyz, for the highlights
+    mat4 inverseViewProjection;     // deferred_lighting.frag rebuilds positions from depth with it
+    vec4 sunDirection;      // the way the sunlight travels
+    vec4 sunColor;
+    vec4 cascadeSplits;     // far view depth of every shadow cascade
+    vec4 cascadeTexels;     // world size of a shadow texel in every cascade
+    mat4 cascadeMatrices[4];
+};
+
+const float SHININESS = 32.0;
+
+// how much sunlight reaches "position", 3x3 compares in the cascade the view depth falls into
+float sunShadow(vec3 position, vec3 normal, float viewDepth)
+{
+    if (viewDepth > cascadeSplits[3])
+        return 1.0;
+    int cascade = 0;
+    while (cascade < 3 && viewDepth > cascadeSplits[cascade])
+        cascade++;
+
+    // pushed off the surface by a texel and a half, against acne on the slopes
+    vec4 lightPosition = cascadeMatrices[cascade] * vec4(position + normal * cascadeTexels[cascade] * 1.5, 1.0);
+    vec3 coord = lightPosition.xyz * 0.5 + 0.5;
+    vec2 texel = 1.0 / vec2(textureSize(shadowMaps, 0).xy);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++)
+            lit += texture(shadowMaps, vec4(coord.xy + vec2(x, y) * texel, float(cascade), coord.z));
+    }
+    return lit / 9.0;
+}
+
+// diffuse and Blinn-Phong highlight of one light, added to "diffuse" and "highlight"
+void pointLight(int light, vec3 position, vec3 normal, vec3 toEye, inout vec3 diffuse, inout vec3 highlight)
+{
+    vec4 positionRadius = texelFetch(lights, 2 * light);
+    vec4 colorIntensity = texelFetch(lights, 2 * light + 1);
+    vec3 toLight = positionRadius.xyz - position;
+    float distanceSquared = dot(toLight, toLight);
+    float falloff = clamp(1.0 - distanceSquared / (positionRadius.w * positionRadius.w), 0.0, 1.0);
+    vec3 direction = toLight * inversesqrt(max(distanceSquared, 1e-6));
+    float lambert = max(dot(normal, direction), 0.0);
+    vec3 radiance = colorIntensity.rgb * (colorIntensity.w * falloff * falloff);
+    diffuse += radiance * lambert;
+    if (lambert > 0.0)
+        highlight += radiance * pow(max(dot(normal, normalize(direction + toEye)), 0.0), SHININESS);
+}
+
+vec3 lighting(vec3 albedo, float specular, vec3 position, vec3 normal, float viewDepth)
+{
+    vec3 toEye = normalize(cameraPosition.xyz - position);
+    vec3 diffuse = ambient.rgb;
+    vec3 highlight = vec3(0.0);
+
+    if (lightInfo.z != 0) {
+        float lambert = max(dot(normal, -sunDirection.xyz), 0.0);
+        if (lambert > 0.0) {
+            vec3 radiance = sunColor.rgb * sunShadow(position, normal, viewDepth);
+            diffuse += radiance * lambert;
+            highlight += radiance * pow(max(dot(normal, normalize(toEye - sunDirection.xyz)), 0.0), SHININESS);
+        }
+    }
+
+    if (lightInfo.x == 1) {
+        for (int i = 0; i < lightInfo.y; i++)
+            pointLight(i, position, normal, toEye, diffuse, highlight);
+        return albedo * diffuse + specular * highlight;
+    }
+    if (lightInfo.x == 0)
+        return albedo * diffuse + specular * highlight;
+
+    ivec3 cluster = ivec3(gl_FragCoord.xy * clusterScale.xy, log(viewDepth) * clusterScale.z + clusterScale.w);
+    cluster = clamp(cluster, ivec3(0), clusterCounts.xyz - 1);
+    uvec2 range = texelFetch(lightClusters, (cluster.z * clusterCounts.y + cluster.y) * clusterCounts.x + cluster.x).xy;
+    for (uint i = 0u; i < range.y; i++)
+        pointLight(int(texelFetch(lightIndices, int(range.x + i)).r), position, normal, toEye, diffuse, highlight);
+    return albedo * diffuse + specular * highlight;
+}
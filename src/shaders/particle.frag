@@ -0,0 +1,17 @@
+#version 330 core
+
+// particle billboards, a soft round sprite added to the HDR scene
+
+in vec2 Corner;
+in vec3 Color;
+
+out vec4 FragColor;
+
+
+void main()
+{
+    float falloff = 1.0 - dot(Corner, Corner);
+    if (falloff <= 0.0)
+        discard;
+    FragColor = vec4(Color * falloff * falloff, 0.0);
+}
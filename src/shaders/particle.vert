@@ -0,0 +1,39 @@
+#version 330 core
+
+// particle billboards (ParticleSystem.h), a triangle strip of 4 vertices
+// per instance and one particle per instance: the draw list on the
+// compute path, every slot with transform feedback, where the dead ones
+// collapse to a point outside the view
+
+layout (location = 0) in vec4 positionLife;
+layout (location = 1) in vec4 velocityLifetime;
+
+out vec2 Corner;
+out vec3 Color;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float size;
+uniform float intensity;
+
+
+void main()
+{
+    if (positionLife.w <= 0.0) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        Corner = vec2(0.0);
+        Color = vec3(0.0);
+        return;
+    }
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+    vec4 viewPosition = view * vec4(positionLife.xyz, 1.0);
+    viewPosition.xy += corner * size;
+    gl_Position = projection * viewPosition;
+    Corner = corner;
+
+    // hot and bright when born, dim red at the end, fading out over the last half second
+    float age = 1.0 - positionLife.w / velocityLifetime.w;
+    vec3 color = mix(vec3(4.0, 2.4, 0.9), vec3(0.8, 0.15, 0.05), age);
+    Color = color * intensity * min(positionLife.w * 2.0, 1.0);
+}
@@ -0,0 +1,74 @@
+#version 330 core
+
+// particle simulation for GL 3.3 (ParticleSystem.h), one vertex per slot
+// captured with transform feedback into the other buffer. A dead slot
+// inside the respawn window [emitStart, emitStart + emitCount) round the
+// buffer spawns a new particle, a live one moves like in
+// particle_simulate.comp.
+
+layout (location = 0) in vec4 positionLife;
+layout (location = 1) in vec4 velocityLifetime;
+
+out vec4 outPositionLife;
+out vec4 outVelocityLifetime;
+
+uniform int capacity;
+uniform int emitStart;
+uniform int emitCount;
+uniform uint seed;
+uniform vec3 emitter;
+uniform vec2 lifetime;
+uniform float deltaTime;
+
+const float GRAVITY = 6.0;
+const float DRAG = 0.1;
+const float GROUND = -1.0;
+const float BOUNCE = 0.4;
+
+
+uint hash(uint value)
+{
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state) / 4294967295.0;
+}
+
+void main()
+{
+    outPositionLife = positionLife;
+    outVelocityLifetime = velocityLifetime;
+
+    if (positionLife.w <= 0.0) {
+        int offset = (gl_VertexID - emitStart + capacity) % capacity;
+        if (offset >= emitCount)
+            return;
+
+        uint state = hash(uint(gl_VertexID) ^ hash(seed));
+        float angle = random(state) * 6.2831853;
+        float spread = sqrt(random(state)) * 1.2;
+        vec3 velocity = vec3(cos(angle) * spread, 4.5 + random(state) * 1.5, sin(angle) * spread);
+        float seconds = mix(lifetime.x, lifetime.y, random(state));
+        outPositionLife = vec4(emitter, seconds);
+        outVelocityLifetime = vec4(velocity, seconds);
+        return;
+    }
+
+    vec3 position = positionLife.xyz;
+    vec3 velocity = velocityLifetime.xyz;
+    velocity.y -= GRAVITY * deltaTime;
+    velocity *= 1.0 - DRAG * deltaTime;
+    position += velocity * deltaTime;
+    if (position.y < GROUND && velocity.y < 0.0) {
+        position.y = GROUND;
+        velocity.y *= -BOUNCE;
+        velocity.xz *= 0.8;
+    }
+    outPositionLife = vec4(position, max(positionLife.w - deltaTime, 0.0));
+    outVelocityLifetime = vec4(velocity, velocityLifetime.w);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+
+// one direction of the separable 9 tap Gaussian of the bloom (PostProcess.h)
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 step;              // one texel along the blur direction
+
+const float WEIGHTS[5] = float[](0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
+
+void main()
+{
+    vec3 color = texture(source, TexCoord).rgb * WEIGHTS[0];
+    for (int i = 1; i < 5; i++) {
+        color += texture(source, TexCoord + step * float(i)).rgb * WEIGHTS[i];
+        color += texture(source, TexCoord - step * float(i)).rgb * WEIGHTS[i];
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+
+// scene plus bloom, tonemapped into the 8 bit image (PostProcess.h); alpha carries the luma
+// the FXAA pass looks for edges in
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D scene;
+uniform sampler2D bloom0;       // half resolution
+uniform sampler2D bloom1;
+uniform sampler2D bloom2;
+uniform sampler2D bloom3;       // a sixteenth
+uniform float bloomIntensity;   // 0 without bloom, its samplers are unbound then
+uniform bool tonemap;
+uniform float exposure;
+
+// Narkowicz's fit of the ACES filmic curve
+vec3 aces(vec3 x)
+{
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+    vec3 color = texture(scene, TexCoord).rgb;
+    if (bloomIntensity > 0.0) {
+        vec3 bloom = texture(bloom0, TexCoord).rgb + texture(bloom1, TexCoord).rgb
+                   + texture(bloom2, TexCoord).rgb + texture(bloom3, TexCoord).rgb;
+        color += bloom * (bloomIntensity * 0.25);
+    }
+    color = tonemap ? aces(color * exposure) : clamp(color, 0.0, 1.0);
+    FragColor = vec4(color, dot(color, vec3(0.299, 0.587, 0.114)));
+}
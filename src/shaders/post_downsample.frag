@@ -0,0 +1,25 @@
+#version 330 core
+
+// bloom downsample (PostProcess.h): a tent of four bilinear taps around the texel corner the
+// half size pixel sits on, the first level only keeps what is brighter than the threshold
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 sourceTexel;
+uniform float threshold;        // negative keeps everything
+
+void main()
+{
+    vec3 color = 0.25 * (texture(source, TexCoord + vec2(-sourceTexel.x, -sourceTexel.y)).rgb
+                       + texture(source, TexCoord + vec2( sourceTexel.x, -sourceTexel.y)).rgb
+                       + texture(source, TexCoord + vec2(-sourceTexel.x,  sourceTexel.y)).rgb
+                       + texture(source, TexCoord + vec2( sourceTexel.x,  sourceTexel.y)).rgb);
+    if (threshold >= 0.0) {
+        float brightness = max(color.r, max(color.g, color.b));
+        color *= max(brightness - threshold, 0.0) / max(brightness, 0.0001);
+    }
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,47 @@
+#version 330 core
+
+// FXAA (PostProcess.h), the compact variant of Lottes' algorithm: the luma gradient of the
+// four diagonal neighbours gives the edge direction, the pixel is blended along it unless that
+// overshoots the local luma range; the luma comes in alpha from post_composite.frag
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+uniform sampler2D source;
+uniform vec2 texel;
+
+const float REDUCE_MIN = 1.0 / 128.0;
+const float REDUCE_MUL = 1.0 / 8.0;
+const float SPAN_MAX = 8.0;
+const float EDGE_THRESHOLD = 0.125;
+const float EDGE_THRESHOLD_MIN = 0.0312;
+
+void main()
+{
+    vec4 centre = texture(source, TexCoord);
+    float lumaNW = textureOffset(source, TexCoord, ivec2(-1, -1)).a;
+    float lumaNE = textureOffset(source, TexCoord, ivec2( 1, -1)).a;
+    float lumaSW = textureOffset(source, TexCoord, ivec2(-1,  1)).a;
+    float lumaSE = textureOffset(source, TexCoord, ivec2( 1,  1)).a;
+    float lumaMin = min(centre.a, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+    float lumaMax = max(centre.a, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+    // flat areas stay as they are
+    if (lumaMax - lumaMin < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD)) {
+        FragColor = vec4(centre.rgb, 1.0);
+        return;
+    }
+
+    vec2 direction = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+    float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);
+    float scale = 1.0 / (min(abs(direction.x), abs(direction.y)) + reduce);
+    direction = clamp(direction * scale, -SPAN_MAX, SPAN_MAX) * texel;
+
+    vec3 inner = 0.5 * (texture(source, TexCoord + direction * (1.0 / 3.0 - 0.5)).rgb
+                      + texture(source, TexCoord + direction * (2.0 / 3.0 - 0.5)).rgb);
+    vec3 outer = inner * 0.5 + 0.25 * (texture(source, TexCoord - direction * 0.5).rgb
+                                     + texture(source, TexCoord + direction * 0.5).rgb);
+    float lumaOuter = dot(outer, vec3(0.299, 0.587, 0.114));
+    FragColor = vec4(lumaOuter < lumaMin || lumaOuter > lumaMax ? inner : outer, 1.0);
+}
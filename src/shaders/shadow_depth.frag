@@ -0,0 +1,7 @@
+#version 330 core
+
+// shadow map pass (ShadowCascades.h), only the depth is written, the framebuffer has no color
+
+void main()
+{
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// terrain tiles: grass on the flats, rock on the slopes, snow on the
+// peaks, lit by a fixed sun
+
+in vec3 WorldPos;
+in vec3 Normal;
+
+out vec4 FragColor;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.3));
+const vec3 GRASS = vec3(0.30, 0.45, 0.20);
+const vec3 ROCK = vec3(0.42, 0.39, 0.36);
+const vec3 SNOW = vec3(0.92, 0.94, 0.97);
+const float SNOW_LINE = -12.0;
+
+
+void main()
+{
+    vec3 normal = normalize(Normal);
+    vec3 color = mix(ROCK, GRASS, smoothstep(0.75, 0.9, normal.y));
+    color = mix(color, SNOW, smoothstep(SNOW_LINE, SNOW_LINE + 4.0, WorldPos.y) * smoothstep(0.6, 0.8, normal.y));
+    float light = 0.3 + 0.7 * max(dot(normal, LIGHT_DIRECTION), 0.0);
+    FragColor = vec4(color * light, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// terrain tiles (Terrain.h), world space positions with the normal in
+// four signed normalized bytes
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aNormal;
+
+out vec3 WorldPos;
+out vec3 Normal;
+
+uniform mat4 viewProjection;
+
+
+void main()
+{
+    WorldPos = aPos;
+    Normal = aNormal.xyz;
+    gl_Position = viewProjection * vec4(aPos, 1.0);
+}
@@ -1,4 +1,4 @@
-#version 460 core
+#version 330 core
 
 // vertex shaders inherently need to have input data
 // layout (location = 0) means that the input data is
@@ -10,16 +10,53 @@ layout (location = 1) in vec2 aTexCoord;
 
 //out vec3 ourColor;
 out vec2 TexCoord;
-
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+out vec2 MaterialTexCoord;
+flat out float MixFactor;
+flat out int TextureLayer;
+flat out int TextureHandle;
+flat out float Specular;
+out vec3 WorldPosition;
+out float ViewDepth;
+
+
+// both blocks are streamed from a ring buffer: Camera once per frame, Objects once per
+// instanced draw, indexed by gl_InstanceID (OBJECT_BATCH_SIZE in graphics.cpp)
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+};
+
+struct ObjectData {
+    mat4 model;
+    vec4 material;      // x = texture mix factor, y = material texture layer, z = its bindless handle, w = the texture
+                        // plus the specular strength as its fraction
+};
+
+layout (std140) uniform Objects {
+    ObjectData objects[204];
+};
+
+// where every material texture sits in what is bound for it, xy scale and zw offset, the
+// identity unless it was packed into an atlas page (MaterialTextures::MAX_TEXTURES entries)
+layout (std140) uniform TextureRegions {
+    vec4 textureRegions[256];
+};
 
 
 void main()
 {
+   ObjectData object = objects[gl_InstanceID];
    //gl_Position = transform * vec4(aPos, 1.0);
-   gl_Position = projection * view * model * vec4(aPos, 1.0);
+   vec4 world = object.model * vec4(aPos, 1.0);
+   vec4 viewPosition = view * world;
+   gl_Position = projection * viewPosition;
+   WorldPosition = world.xyz;
+   ViewDepth = -viewPosition.z;
    TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+   vec4 region = textureRegions[int(object.material.w)];
+   MaterialTexCoord = aTexCoord * region.xy + region.zw;
+   MixFactor = object.material.x;
+   TextureLayer = int(object.material.y);
+   TextureHandle = int(object.material.z);
+   Specular = fract(object.material.w);
 }
\ No newline at end of file
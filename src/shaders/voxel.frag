@@ -0,0 +1,19 @@
+#version 330 core
+
+// voxel chunks, half-lambert sun light scaled by the vertex ambient
+// occlusion
+
+in vec3 Normal;
+in vec3 Color;
+in float Occlusion;
+
+out vec4 FragColor;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(0.4, 1.0, 0.3));
+
+
+void main()
+{
+    float halfLambert = dot(normalize(Normal), LIGHT_DIRECTION) * 0.5 + 0.5;
+    FragColor = vec4(Color * halfLambert * (0.3 + 0.7 * Occlusion), 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// voxel chunks (VoxelWorld.h), stb_voxel_render mode 20 vertices: a
+// packed position and ambient occlusion, then the face's color and normal
+// index. stb_voxel_render is z up, hence the .xzy swizzles
+
+layout (location = 0) in uint vertex;
+layout (location = 1) in uvec4 face;
+
+out vec3 Normal;
+out vec3 Color;
+out float Occlusion;
+
+uniform mat4 viewProjection;
+uniform vec3 chunkOrigin;
+uniform vec3 normals[32];
+
+
+void main()
+{
+    vec3 offset = vec3(float(vertex & 127u), float((vertex >> 7u) & 127u), float((vertex >> 14u) & 511u));
+    Occlusion = float((vertex >> 23u) & 63u) / 63.0;
+    Normal = normals[(face.w >> 2u) & 31u].xzy;
+    Color = vec3(face.xyz) / 255.0;
+    gl_Position = viewProjection * vec4(chunkOrigin + offset.xzy, 1.0);
+}